@@ -1,10 +1,43 @@
 #include "Application.h"
 
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "../Tests/ChunkGenerationTests.h"
+#include "../Tests/LightClusterTests.h"
+#include "../Tests/LightingTests.h"
+#include "../Tests/NoiseTests.h"
+#include "../Tests/TextureCompressionTests.h"
+#include "../World/BlockDatabase.h"
 #include "Events/WindowEventFocusChange.h"
 #include "Events/WindowEventResize.h"
+#include "Profiler.h"
 
 namespace
 {
+	constexpr auto blockDefinitionsPath = "./Resources/Blocks.txt";
+	constexpr auto blockCachePath		= "./Resources/Blocks.cache";
+
+	// Where the renderer loads the textures from as well
+	constexpr auto texturesPath	   = "./Resources/Textures/";
+	constexpr auto texturePackPath = "./Resources/Textures.pack";
+
+	// Open in chrome://tracing or ui.perfetto.dev
+	constexpr auto profilerTracePath = "./Profile.json";
+
+	constexpr auto metricsCsvPath  = "./Metrics.csv";
+	constexpr auto metricsJsonPath = "./Metrics.json";
+
+	constexpr auto inputRecordingPath = "./Input.rec";
+	constexpr auto replayTracePath	  = "./Replay.csv";
+
+	// The renderer's, the replay has none to ask
+	constexpr float replayNearZ = 0.1f;
+	constexpr float replayFarZ	= 1000.0f;
+
 	template <typename T>
 	std::string ToStringWithPrecision(const T value, const int decimalPlaces = 6)
 	{
@@ -33,6 +66,13 @@ bool Application::Init()
 		return false;
 	}
 
+	// Textures and the world both go by the block definitions
+	initSucceeded = BlockDatabase::Load(blockDefinitionsPath, blockCachePath);
+	if (initSucceeded == false)
+	{
+		return false;
+	}
+
 	initSucceeded = renderer_.Initialize(window_.GetHandle(),
 										 settings_.screenWidth,
 										 settings_.screenHeight,
@@ -57,7 +97,12 @@ bool Application::Init()
 	const float aspectRatio = static_cast<float>(settings_.screenWidth) /**/
 							/ static_cast<float>(settings_.screenHeight);
 
-	world_.Initialize(renderer_.GetDevice().Get());
+	initSucceeded = world_.Initialize(renderer_.GetDevice().Get());
+	if (initSucceeded == false)
+	{
+		return false;
+	}
+
 	collisionSystem_.Initialize(&world_);
 
 	initSucceeded = player_.Initialize(&collisionSystem_,
@@ -75,6 +120,172 @@ bool Application::Init()
 	return true;
 }
 
+bool Application::PackTextures()
+{
+	if (BlockDatabase::Load(blockDefinitionsPath, blockCachePath) == false)
+	{
+		return false;
+	}
+
+	return TextureManager::BuildTexturePack(texturesPath, texturePackPath);
+}
+
+bool Application::RunTests()
+{
+	if (BlockDatabase::Load(blockDefinitionsPath, blockCachePath) == false)
+	{
+		return false;
+	}
+
+	const bool lightingPassed	 = LightingTests::Run();
+	const bool clustersPassed	 = LightClusterTests::Run();
+	const bool noisePassed		 = NoiseTests::Run();
+	const bool generationPassed	 = ChunkGenerationTests::Run();
+	const bool compressionPassed = TextureCompressionTests::Run();
+	return lightingPassed && clustersPassed && noisePassed && generationPassed && compressionPassed;
+}
+
+void Application::EnableMetricsDump()
+{
+	metricsDump_.emplace(metricsCsvPath, metricsJsonPath);
+}
+
+bool Application::EnableInputRecording()
+{
+	return inputRecorder_.Open(inputRecordingPath);
+}
+
+bool Application::ReplayInput()
+{
+	std::vector<InputFrame> frames;
+	if (LoadInputRecording(inputRecordingPath, frames) == false)
+	{
+		return false;
+	}
+
+	if (BlockDatabase::Load(blockDefinitionsPath, blockCachePath) == false)
+	{
+		return false;
+	}
+
+	// No window and no swap chain, the world only needs a device to create the chunk meshes with
+	HRESULT result = D3D11CreateDevice(nullptr,
+									   D3D_DRIVER_TYPE_HARDWARE,
+									   nullptr,
+									   0,
+									   nullptr,
+									   0,
+									   D3D11_SDK_VERSION,
+									   &replayDevice_,
+									   nullptr,
+									   nullptr);
+	if (FAILED(result))
+	{
+		std::cerr << "Failed to create a Direct3D device for the replay" << std::endl;
+		return false;
+	}
+
+	// Generated only, a save would make the replay depend on earlier runs, and the replayed edits must not end up in it
+	if (world_.Initialize(replayDevice_.Get(), false) == false)
+	{
+		return false;
+	}
+
+	collisionSystem_.Initialize(&world_);
+
+	const float aspectRatio = static_cast<float>(settings_.screenWidth) /**/
+							/ static_cast<float>(settings_.screenHeight);
+
+	const bool playerInitialized = player_.Initialize(&collisionSystem_,
+													  &world_,
+													  &input_,
+													  settings_.fovDeg,
+													  aspectRatio,
+													  replayNearZ,
+													  replayFarZ);
+	if (playerInitialized == false)
+	{
+		return false;
+	}
+
+	std::ofstream trace(replayTracePath, std::ios::trunc);
+	if (trace.is_open() == false)
+	{
+		std::cerr << "Failed to open " << replayTracePath << " for writing the replay trace" << std::endl;
+		return false;
+	}
+	trace << std::fixed << std::setprecision(4) << "frame,deltaTime,worldTime,x,y,z,lookingAtX,lookingAtY,lookingAtZ\n";
+
+	PROFILE_THREAD_NAME("Main");
+
+	Timer perfCounter;
+	Timer frameCounter;
+	for (std::size_t i = 0; i < frames.size(); ++i)
+	{
+		PROFILE_ZONE("Frame");
+		const InputFrame& frame = frames[i];
+		frameCounter.Reset();
+
+		input_.ReplayFrame(frame);
+		player_.OnTick(frame.deltaTime);
+
+		perfCounter.Reset();
+		world_.Update(player_.GetCamera().GetPosition());
+		perfCounter.TickUncapped();
+		const float worldPerf = perfCounter.GetDeltaTime();
+
+		frameCounter.TickUncapped();
+		const float frameTime = frameCounter.GetDeltaTime();
+		frameStats_.AddFrame(frameTime, worldPerf, 0.0f);
+
+		if (metricsDump_.has_value())
+		{
+			metricsDump_->Update(frame.deltaTime);
+		}
+
+		DirectX::XMFLOAT3 cameraPos;
+		DirectX::XMStoreFloat3(&cameraPos, player_.GetCamera().GetPosition());
+		trace << i << "," << frame.deltaTime << "," << world_.GetWorldTime() << "," << cameraPos.x << ","
+			  << cameraPos.y << "," << cameraPos.z;
+
+		const BlockRaycastResult& raycastResult = player_.GetLastBlockRaycastResult();
+		if (raycastResult.success)
+		{
+			trace << "," << raycastResult.blockPosition.x << "," << raycastResult.blockPosition.y << ","
+				  << raycastResult.blockPosition.z << "\n";
+		}
+		else
+		{
+			trace << ",,,\n";
+		}
+
+		// Rendering would have taken the rest of the frame
+		if (frameTime < frame.deltaTime)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<float>(frame.deltaTime - frameTime));
+		}
+	}
+
+	if (metricsDump_.has_value())
+	{
+		metricsDump_->Dump();
+	}
+
+	const std::uint64_t windowFrames = (std::min)(frameStats_.GetFrameCount(),
+												  std::uint64_t{FrameStats::DEFAULT_WINDOW_SIZE});
+	std::cout << "Replayed " << frames.size() << " frames, last " << windowFrames << " frames: Frame "
+			  << frameStats_.FormatSummary(FrameStats::Timing::Frame) << " | World "
+			  << frameStats_.FormatSummary(FrameStats::Timing::World) << " | " << frameStats_.GetHitchCount()
+			  << " hitches" << std::endl;
+
+	if (trace.good() == false)
+	{
+		std::cerr << "Failed to write the replay trace to " << replayTracePath << std::endl;
+		return false;
+	}
+	return true;
+}
+
 void Application::Run()
 {
 	MSG	 msg;
@@ -83,14 +294,19 @@ void Application::Run()
 	// Initalize message structure
 	ZeroMemory(&msg, sizeof(msg));
 
-	world_.GenerateTestWorld();
+	PROFILE_THREAD_NAME("Main");
+
 	// Reset the timer, it might have some small amount of time from the initialization
 	timer_.Reset();
 	Timer perfCounter;
 
-	float currentFrameFPS	 = 0.0f;
-	float FPSTimeAccumulator = 0.0f;
-	float FPS				 = 0.0f;
+	// Unlike timer_, doesn't cap the frame time, the hitches would hide otherwise
+	Timer frameCounter;
+	frameCounter.Reset();
+
+	// Sorting the frame times every frame would be a waste, the title only needs to be readable
+	float		statsTimeAccumulator = 0.0f;
+	std::string statsText;
 	// Loop until a quit message appears
 	while (!done)
 	{
@@ -107,10 +323,16 @@ void Application::Run()
 		}
 		else // Per-frame stuff goes here
 		{
+			PROFILE_ZONE("Frame");
 			timer_.Tick();
 			float deltaTime = timer_.GetDeltaTime();
 			Update(deltaTime);
 
+			if (metricsDump_.has_value())
+			{
+				metricsDump_->Update(deltaTime);
+			}
+
 			if (input_.IsEscapePressed() == true)
 			{
 				done = true;
@@ -119,7 +341,7 @@ void Application::Run()
 			HandleDebugInput();
 
 			perfCounter.Reset();
-			world_.Update();
+			world_.Update(player_.GetCamera().GetPosition());
 			perfCounter.TickUncapped();
 			double worldPerf = perfCounter.GetDeltaTime();
 
@@ -141,13 +363,24 @@ void Application::Run()
 			renderer_.EndScene();
 			perfCounter.Reset();
 
-			// Calculate FPS
-			currentFrameFPS		= 1.0f / deltaTime;
-			FPSTimeAccumulator += deltaTime;
-			if (FPSTimeAccumulator >= 0.07f)
+			frameCounter.TickUncapped();
+			frameStats_.AddFrame(frameCounter.GetDeltaTime(), static_cast<float>(worldPerf), renderPerf);
+
+			statsTimeAccumulator += deltaTime;
+			if (statsTimeAccumulator >= 0.25f || statsText.empty())
 			{
-				FPS				   = (0.85f * FPS) + (0.15f * currentFrameFPS);
-				FPSTimeAccumulator = 0.0f;
+				const FrameStats::Summary frame = frameStats_.GetSummary(FrameStats::Timing::Frame);
+
+				statsText = ToStringWithPrecision(1.0f / frame.mean, 0)
+						  + " FPS | Frame "
+						  + frameStats_.FormatSummary(FrameStats::Timing::Frame)
+						  + " | Hitches: "
+						  + std::to_string(frame.hitches)
+						  + " | World "
+						  + frameStats_.FormatSummary(FrameStats::Timing::World)
+						  + " | Renderer "
+						  + frameStats_.FormatSummary(FrameStats::Timing::Render);
+				statsTimeAccumulator = 0.0f;
 			}
 
 			DirectX::XMVECTOR cameraPos	   = player_.GetCamera().GetPosition();
@@ -157,14 +390,7 @@ void Application::Run()
 			Chunk*			  currentChunk = world_.GetChunkFromBlock(DirectX::XMFLOAT3{x, y, z});
 
 			std::string windowTitle = ("Bloczki: "
-									   + ToStringWithPrecision(FPS, 0)
-									   + " FPS"
-									   + " | World took: "
-									   + std::to_string(worldPerf * 1000.0)
-									   + "ms"
-									   + " | Renderer took: "
-									   + std::to_string(renderPerf * 1000.0)
-									   + "ms"
+									   + statsText
 									   + " | World Time: "
 									   + std::to_string(world_.GetWorldTime())
 									   + " | Camera Position: "
@@ -205,6 +431,28 @@ void Application::Run()
 			window_.SetWindowTitle(windowTitle);
 		}
 	}
+
+	if (metricsDump_.has_value())
+	{
+		metricsDump_->Dump();
+	}
+
+	const std::uint64_t windowFrames = (std::min)(frameStats_.GetFrameCount(),
+												  std::uint64_t{FrameStats::DEFAULT_WINDOW_SIZE});
+	std::cout << "Last " << windowFrames << " frames: Frame "
+			  << frameStats_.FormatSummary(FrameStats::Timing::Frame) << " | World "
+			  << frameStats_.FormatSummary(FrameStats::Timing::World) << " | Renderer "
+			  << frameStats_.FormatSummary(FrameStats::Timing::Render) << " | " << frameStats_.GetHitchCount()
+			  << " hitches over " << frameStats_.GetFrameCount() << " frames" << std::endl;
+
+	if (inputRecorder_.IsOpen())
+	{
+		const std::uint64_t recordedFrames = inputRecorder_.GetFrameCount();
+		if (inputRecorder_.Close())
+		{
+			std::cout << "Recorded " << recordedFrames << " frames of input to " << inputRecordingPath << std::endl;
+		}
+	}
 }
 
 void Application::Update(float deltaTime)
@@ -212,6 +460,10 @@ void Application::Update(float deltaTime)
 	// Anything that requires deltaTime will be called from here
 
 	input_.Frame(deltaTime);
+	if (inputRecorder_.IsOpen())
+	{
+		inputRecorder_.Record(input_.CaptureFrame(deltaTime));
+	}
 	player_.OnTick(deltaTime);
 }
 
@@ -308,4 +560,13 @@ void Application::HandleDebugInput()
 			wireframeEnabled = !wireframeEnabled;
 		}
 	}
+
+#if defined(ENABLE_PROFILER)
+	static bool tracePressed = false;
+	if (input_.IsKeyPressed(DIK_P) && tracePressed == false) // Profiler trace of the last few seconds
+	{
+		Profiler::WriteChromeTrace(profilerTracePath);
+	}
+	tracePressed = input_.IsKeyPressed(DIK_P);
+#endif
 }
@@ -1,8 +1,13 @@
 #pragma once
+#include <optional>
+
 #include "../Graphics/Renderer.h"
 #include "../World/World.h"
 #include "CollisionSystem.h"
+#include "FrameStats.h"
 #include "Input.h"
+#include "InputRecording.h"
+#include "Metrics.h"
 #include "Player.h"
 #include "Timer.h"
 #include "Window.h"
@@ -27,6 +32,37 @@ public:
 	[[nodiscard]] bool Init();
 	void			   Run();
 
+	/**
+	 * Builds the texture pack without starting the game, what Init does whenever the pack is out of date
+	 * @return false if the blocks or the pack failed to load or write
+	 */
+	[[nodiscard]] static bool PackTextures();
+
+	/**
+	 * Runs the engine's tests without starting the game, they print their failures
+	 * @return false if the blocks failed to load or any of the tests failed
+	 */
+	[[nodiscard]] static bool RunTests();
+
+	// Dumps the metrics to Metrics.csv and Metrics.json every second of the run, and once more at its end
+	void EnableMetricsDump();
+
+	/**
+	 * Records the input of every frame to Input.rec, for ReplayInput
+	 * @return false if the file couldn't be opened
+	 */
+	[[nodiscard]] bool EnableInputRecording();
+
+	/**
+	 * Takes the place of Init and Run. Plays Input.rec back through the player and the world without a window or
+	 * rendering, paced to the recorded frame times so the streaming threads get as long as they did in the game.
+	 * Writes where the camera was every frame to Replay.csv, for diffing runs. Only as repeatable as the streaming
+	 * threads are, an edit may miss a chunk that got loaded a frame later than when recording. The world gets generated
+	 * from scratch and nothing gets saved
+	 * @return false if the recording, the blocks or the world failed to load
+	 */
+	[[nodiscard]] bool ReplayInput();
+
 	[[nodiscard]] Settings GetSettings() const { return settings_; }
 
 private:
@@ -34,6 +70,9 @@ private:
 	void OnWindowEvent(WindowEventBase& event);
 	void HandleDebugInput();
 
+	// Stands in for the renderer's device in ReplayInput, has to outlive the world's meshes
+	Microsoft::WRL::ComPtr<ID3D11Device> replayDevice_;
+
 	Window			window_;
 	Renderer		renderer_;
 	Input			input_;
@@ -42,4 +81,8 @@ private:
 	Timer			timer_;
 	Player			player_;
 	CollisionSystem collisionSystem_;
+	FrameStats		frameStats_;
+
+	std::optional<Metrics::PeriodicDump> metricsDump_;
+	InputRecorder						 inputRecorder_;
 };
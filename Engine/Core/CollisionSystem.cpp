@@ -3,6 +3,7 @@
 #include <cmath>
 
 #include "../World/World.h"
+#include "Profiler.h"
 bool CollisionSystem::Initialize(World* world)
 {
 	if (world == nullptr)
@@ -19,6 +20,7 @@ DirectX::XMVECTOR CollisionSystem::ResolveMovement(const DirectX::BoundingBox& e
 												   DirectX::XMFLOAT3		   entityVelocity,
 												   float					   deltaTime) const
 {
+	PROFILE_FUNCTION();
 	DirectX::XMFLOAT3 entitySize = entityBox.Extents;
 
 	DirectX::XMFLOAT3 position	 = entityBox.Center;
@@ -84,6 +86,7 @@ BlockRaycastResult CollisionSystem::BlockRaycast(DirectX::XMFLOAT3 origin,
 												 DirectX::XMFLOAT3 direction,
 												 float			   maxDistance) const
 {
+	PROFILE_FUNCTION();
 	// Using an integer grid of blocks, make the origin into a block on the grid
 	int x = static_cast<int>(std::floorf(origin.x));
 	int y = static_cast<int>(std::floorf(origin.y));
@@ -168,6 +171,7 @@ BlockRaycastResult CollisionSystem::BlockRaycast(DirectX::XMFLOAT3 origin,
 
 bool CollisionSystem::CheckBlockCollision(const DirectX::BoundingBox& box) const
 {
+	PROFILE_FUNCTION();
 
 	// Get box corners
 	DirectX::XMFLOAT3 minPos = {box.Center.x - box.Extents.x,
@@ -0,0 +1,93 @@
+﻿#include "FrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+
+FrameStats::FrameStats(std::size_t windowSize, float hitchThreshold) :
+	windowSize_((std::max)(windowSize, std::size_t{1})),
+	hitchThreshold_(hitchThreshold)
+{
+	for (auto& samples : samples_)
+	{
+		samples.reserve(windowSize_);
+	}
+	sortScratch_.reserve(windowSize_);
+}
+
+void FrameStats::AddFrame(float frameTime, float worldTime, float renderTime)
+{
+	const std::array<float, static_cast<std::size_t>(Timing::COUNT_)> times = {frameTime, worldTime, renderTime};
+	for (std::size_t i = 0; i < samples_.size(); ++i)
+	{
+		// Fills up first, then overwrites the oldest
+		if (samples_[i].size() < windowSize_)
+		{
+			samples_[i].push_back(times[i]);
+		}
+		else
+		{
+			samples_[i][nextSample_] = times[i];
+		}
+	}
+	nextSample_ = (nextSample_ + 1) % windowSize_;
+
+	++frameCount_;
+	if (frameTime > hitchThreshold_)
+	{
+		++hitchCount_;
+	}
+}
+
+void FrameStats::Clear()
+{
+	for (auto& samples : samples_)
+	{
+		samples.clear();
+	}
+	nextSample_ = 0;
+	frameCount_ = 0;
+	hitchCount_ = 0;
+}
+
+FrameStats::Summary FrameStats::GetSummary(Timing timing) const
+{
+	const std::vector<float>& samples = samples_[static_cast<std::size_t>(timing)];
+	if (samples.empty())
+	{
+		return {};
+	}
+
+	sortScratch_.assign(samples.begin(), samples.end());
+	std::ranges::sort(sortScratch_);
+
+	// Nearest rank, the smallest sample at least the given fraction of the window is no larger than
+	auto GetPercentile = [&](float fraction)
+	{
+		const auto rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<float>(sortScratch_.size())));
+		return sortScratch_[std::clamp(rank, std::size_t{1}, sortScratch_.size()) - 1];
+	};
+
+	Summary summary;
+	summary.mean	= std::accumulate(sortScratch_.begin(), sortScratch_.end(), 0.0f)
+					/ static_cast<float>(sortScratch_.size());
+	summary.p50		= GetPercentile(0.50f);
+	summary.p95		= GetPercentile(0.95f);
+	summary.p99		= GetPercentile(0.99f);
+	summary.max		= sortScratch_.back();
+	summary.hitches = static_cast<std::uint32_t>(
+		sortScratch_.end() - std::ranges::upper_bound(sortScratch_, hitchThreshold_));
+	return summary;
+}
+
+std::string FrameStats::FormatSummary(Timing timing) const
+{
+	const Summary summary = GetSummary(timing);
+
+	std::ostringstream out;
+	out.precision(1);
+	out << std::fixed << "p50/p95/p99/max: " << summary.p50 * 1000.0f << "/" << summary.p95 * 1000.0f << "/"
+		<< summary.p99 * 1000.0f << "/" << summary.max * 1000.0f << " ms";
+	return std::move(out).str();
+}
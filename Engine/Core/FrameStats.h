@@ -0,0 +1,78 @@
+﻿#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Keeps the times of the last frames, the frame as a whole and the world update and rendering within it, and sums
+ * them up as percentiles. An average hides the frames that stutter, the high percentiles and the hitch count don't.
+ * The HUD's stats line shows them, and so do the summaries printed on exit and after an input replay
+ */
+class FrameStats
+{
+public:
+	enum class Timing : std::uint8_t
+	{
+		Frame,
+		World,
+		Render,
+		COUNT_
+	};
+
+	// In seconds
+	struct Summary
+	{
+		float		  mean	  = 0.0f;
+		float		  p50	  = 0.0f;
+		float		  p95	  = 0.0f;
+		float		  p99	  = 0.0f;
+		float		  max	  = 0.0f;
+		std::uint32_t hitches = 0; // samples over the hitch threshold
+	};
+
+	static constexpr std::size_t DEFAULT_WINDOW_SIZE	 = 600;			  // 10 seconds at 60 FPS
+	static constexpr float		 DEFAULT_HITCH_THRESHOLD = 1.0f / 30.0f; // two frames at 60 FPS
+
+	/**
+	 * @param windowSize how many of the latest frames the summaries go over
+	 * @param hitchThreshold seconds, frames that take longer count as hitches
+	 */
+	explicit FrameStats(std::size_t windowSize = DEFAULT_WINDOW_SIZE, float hitchThreshold = DEFAULT_HITCH_THRESHOLD);
+
+	/**
+	 * @param frameTime seconds, uncapped, so that the hitches show
+	 * @param worldTime seconds of frameTime spent updating the world
+	 * @param renderTime seconds of frameTime spent rendering
+	 */
+	void AddFrame(float frameTime, float worldTime, float renderTime);
+
+	void Clear();
+
+	/**
+	 * Sorts a copy of the window, cheap enough for every frame at the default window size
+	 * @return zeros if there are no frames yet
+	 */
+	[[nodiscard]] Summary GetSummary(Timing timing) const;
+
+	// "p50/p95/p99/max: 16.6/16.9/17.4/18.0 ms"
+	[[nodiscard]] std::string FormatSummary(Timing timing) const;
+
+private:
+	std::array<std::vector<float>, static_cast<std::size_t>(Timing::COUNT_)> samples_; // rings of windowSize_
+	std::size_t																  windowSize_;
+	std::size_t																  nextSample_ = 0;
+	float																	  hitchThreshold_;
+
+	std::uint64_t frameCount_ = 0;
+	std::uint64_t hitchCount_ = 0;
+
+	mutable std::vector<float> sortScratch_;
+
+public:
+	// Getters
+	[[nodiscard]] std::uint64_t GetFrameCount() const { return frameCount_; }
+	[[nodiscard]] std::uint64_t GetHitchCount() const { return hitchCount_; } // since the start, not just the window
+	[[nodiscard]] float			GetHitchThreshold() const { return hitchThreshold_; }
+};
@@ -2,7 +2,7 @@
 
 #include <tuple>
 
-Input::Input()
+Input::Input() : mouseState_{}, windowWidth_(0), windowHeight_(0), mouseX_(0), mouseY_(0)
 {
 }
 
@@ -96,6 +96,44 @@ bool Input::Frame(double deltaTime)
 	return true;
 }
 
+void Input::ReplayFrame(const InputFrame& frame)
+{
+	for (std::size_t i = 0; i < keyboardState_.size(); ++i)
+	{
+		UpdateKeyState(keyboardState_[i], frame.keys[i], frame.deltaTime);
+	}
+
+	mouseState_.lX = frame.mouseX;
+	mouseState_.lY = frame.mouseY;
+	mouseState_.lZ = frame.mouseWheel;
+	for (std::size_t i = 0; i < std::size(mouseState_.rgbButtons); ++i)
+	{
+		const bool isDown		  = (frame.mouseButtons >> i) & 1;
+		mouseState_.rgbButtons[i] = isDown ? 0x80 : 0;
+		UpdateKeyState(mouseButtonState_[i], isDown, frame.deltaTime);
+	}
+
+	ProcessInput();
+}
+
+InputFrame Input::CaptureFrame(float deltaTime) const
+{
+	InputFrame frame;
+	frame.deltaTime = deltaTime;
+	for (std::size_t i = 0; i < keyboardState_.size(); ++i)
+	{
+		frame.keys[i] = keyboardState_[i].isDown;
+	}
+	for (std::size_t i = 0; i < std::size(mouseState_.rgbButtons); ++i)
+	{
+		frame.mouseButtons |= static_cast<std::uint8_t>(mouseButtonState_[i].isDown << i);
+	}
+	frame.mouseX	 = mouseState_.lX;
+	frame.mouseY	 = mouseState_.lY;
+	frame.mouseWheel = mouseState_.lZ;
+	return frame;
+}
+
 bool Input::IsEscapePressed() const
 {
 	return keyboardState_[DIK_ESCAPE].isDown;
@@ -155,26 +193,7 @@ bool Input::ReadKeyboardState(double deltaTime)
 	// put the data into the actual keyboard state struct
 	for (std::size_t i = 0; i < kbState.size(); ++i)
 	{
-		KeyState& state = keyboardState_[i];
-		state.wasDown	= state.isDown;
-		state.isDown	= kbState[i] & 0x80;
-
-
-		// Falling edge
-		if (state.wasDown && state.isDown == false)
-		{
-			state.timeHeld		   = 0.0;
-			state.timeSinceRelease = 0.0;
-		}
-
-		if (state.isDown)
-		{
-			state.timeHeld += deltaTime;
-		}
-		else
-		{
-			state.timeSinceRelease += deltaTime;
-		}
+		UpdateKeyState(keyboardState_[i], kbState[i] & 0x80, deltaTime);
 	}
 
 	return true;
@@ -198,29 +217,32 @@ bool Input::ReadMouseState(double deltaTime)
 
 	for (std::size_t i = 0; i < std::size(mouseState_.rgbButtons); ++i)
 	{
-		KeyState& state = mouseButtonState_[i];
-		state.wasDown	= state.isDown;
-		state.isDown	= mouseState_.rgbButtons[i] & 0x80;
+		UpdateKeyState(mouseButtonState_[i], mouseState_.rgbButtons[i] & 0x80, deltaTime);
+	}
 
+	return true;
+}
 
-		// Falling edge
-		if (state.wasDown && state.isDown == false)
-		{
-			state.timeHeld		   = 0.0;
-			state.timeSinceRelease = 0.0;
-		}
+void Input::UpdateKeyState(KeyState& state, bool isDown, double deltaTime)
+{
+	state.wasDown	= state.isDown;
+	state.isDown	= isDown;
 
-		if (state.isDown)
-		{
-			state.timeHeld += deltaTime;
-		}
-		else
-		{
-			state.timeSinceRelease += deltaTime;
-		}
+	// Falling edge
+	if (state.wasDown && state.isDown == false)
+	{
+		state.timeHeld		   = 0.0;
+		state.timeSinceRelease = 0.0;
 	}
 
-	return true;
+	if (state.isDown)
+	{
+		state.timeHeld += deltaTime;
+	}
+	else
+	{
+		state.timeSinceRelease += deltaTime;
+	}
 }
 
 void Input::ProcessInput()
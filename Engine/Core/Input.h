@@ -5,6 +5,8 @@
 #include <windows.h>
 #include <wrl/client.h>
 
+#include "InputRecording.h"
+
 #pragma comment(lib, "dinput8.lib")
 #pragma comment(lib, "dxguid.lib")
 
@@ -29,6 +31,17 @@ public:
 	bool Init(HINSTANCE hInstance, HWND handle, int windowWidth, int windowHeight);
 	bool Frame(double deltaTime);
 
+	/**
+	 * Stands in for Frame, takes the state from a recording instead of the devices, which don't need to be initialized
+	 */
+	void ReplayFrame(const InputFrame& frame);
+
+	/**
+	 * The state the last Frame or ReplayFrame left
+	 * @param deltaTime seconds the frame took, stored with the state
+	 */
+	[[nodiscard]] InputFrame CaptureFrame(float deltaTime) const;
+
 	[[nodiscard]] bool IsEscapePressed() const;
 	[[nodiscard]] bool IsKeyPressed(std::uint8_t key) const;
 	[[nodiscard]] bool IsKeyPressed(MouseButton button) const;
@@ -41,6 +54,8 @@ private:
 	bool ReadMouseState(double deltaTime);
 	void ProcessInput();
 
+	static void UpdateKeyState(KeyState& state, bool isDown, double deltaTime);
+
 	Microsoft::WRL::ComPtr<IDirectInput8>		directInput_;
 	Microsoft::WRL::ComPtr<IDirectInputDevice8> keyboard_;
 	Microsoft::WRL::ComPtr<IDirectInputDevice8> mouse_;
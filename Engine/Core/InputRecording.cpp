@@ -0,0 +1,244 @@
+﻿#include "InputRecording.h"
+
+#include <array>
+#include <bit>
+#include <iostream>
+#include <iterator>
+
+namespace
+{
+	// "BLIR" then the version, bumped whenever the frame layout changes
+	constexpr std::array<std::uint8_t, 4> recordingMagic   = {'B', 'L', 'I', 'R'};
+	constexpr std::uint32_t				  recordingVersion = 1;
+
+	void WriteUInt32(std::vector<std::uint8_t>& buffer, std::uint32_t value)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			buffer.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+		}
+	}
+
+	// 7 bits per byte, the high bit set on every byte but the last
+	void WriteVarint(std::vector<std::uint8_t>& buffer, std::uint32_t value)
+	{
+		while (value >= 0x80)
+		{
+			buffer.push_back(static_cast<std::uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+		buffer.push_back(static_cast<std::uint8_t>(value));
+	}
+
+	// Zigzag, so that small negative movements take a byte as well
+	void WriteSignedVarint(std::vector<std::uint8_t>& buffer, std::int32_t value)
+	{
+		const auto bits = static_cast<std::uint32_t>(value);
+		WriteVarint(buffer, (bits << 1) ^ (value < 0 ? 0xFFFFFFFFu : 0u));
+	}
+
+	class Reader
+	{
+	public:
+		explicit Reader(const std::vector<std::uint8_t>& data) : data_(data) {}
+
+		bool ReadByte(std::uint8_t& outValue)
+		{
+			if (position_ >= data_.size())
+			{
+				return false;
+			}
+			outValue = data_[position_++];
+			return true;
+		}
+
+		bool ReadUInt32(std::uint32_t& outValue)
+		{
+			outValue = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				std::uint8_t byte;
+				if (ReadByte(byte) == false)
+				{
+					return false;
+				}
+				outValue |= static_cast<std::uint32_t>(byte) << (i * 8);
+			}
+			return true;
+		}
+
+		bool ReadVarint(std::uint32_t& outValue)
+		{
+			outValue = 0;
+			for (int shift = 0; shift < 35; shift += 7)
+			{
+				std::uint8_t byte;
+				if (ReadByte(byte) == false)
+				{
+					return false;
+				}
+				outValue |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool ReadSignedVarint(std::int32_t& outValue)
+		{
+			std::uint32_t bits;
+			if (ReadVarint(bits) == false)
+			{
+				return false;
+			}
+			outValue = static_cast<std::int32_t>((bits >> 1) ^ (0u - (bits & 1)));
+			return true;
+		}
+
+		[[nodiscard]] bool IsAtEnd() const { return position_ == data_.size(); }
+
+	private:
+		const std::vector<std::uint8_t>& data_;
+		std::size_t						 position_ = 0;
+	};
+} // namespace
+
+InputRecorder::~InputRecorder()
+{
+	Close();
+}
+
+bool InputRecorder::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	file_.open(path, std::ios::binary | std::ios::trunc);
+	if (file_.is_open() == false)
+	{
+		std::cerr << "Failed to open " << path << " for recording the input" << std::endl;
+		return false;
+	}
+
+	lastKeys_.reset();
+	frameCount_ = 0;
+
+	buffer_.assign(recordingMagic.begin(), recordingMagic.end());
+	WriteUInt32(buffer_, recordingVersion);
+	file_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+	return true;
+}
+
+void InputRecorder::Record(const InputFrame& frame)
+{
+	if (file_.is_open() == false)
+	{
+		return;
+	}
+
+	buffer_.clear();
+	WriteUInt32(buffer_, std::bit_cast<std::uint32_t>(frame.deltaTime));
+
+	// Keys that went down or up since the last frame, most frames have none
+	const std::bitset<256> changedKeys = frame.keys ^ lastKeys_;
+	WriteVarint(buffer_, static_cast<std::uint32_t>(changedKeys.count()));
+	for (std::size_t key = 0; key < changedKeys.size(); ++key)
+	{
+		if (changedKeys[key])
+		{
+			buffer_.push_back(static_cast<std::uint8_t>(key));
+		}
+	}
+	lastKeys_ = frame.keys;
+
+	buffer_.push_back(frame.mouseButtons);
+	WriteSignedVarint(buffer_, frame.mouseX);
+	WriteSignedVarint(buffer_, frame.mouseY);
+	WriteSignedVarint(buffer_, frame.mouseWheel);
+
+	file_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+	++frameCount_;
+}
+
+bool InputRecorder::Close()
+{
+	if (file_.is_open() == false)
+	{
+		return true;
+	}
+
+	file_.close();
+	if (file_.fail())
+	{
+		std::cerr << "Failed to write the input recording" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool LoadInputRecording(const std::filesystem::path& path, std::vector<InputFrame>& outFrames)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (file.is_open() == false)
+	{
+		std::cerr << "Failed to open the input recording " << path << std::endl;
+		return false;
+	}
+
+	const std::vector<std::uint8_t> data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+	Reader							reader(data);
+
+	std::array<std::uint8_t, 4> magic{};
+	for (std::uint8_t& byte : magic)
+	{
+		if (reader.ReadByte(byte) == false)
+		{
+			break;
+		}
+	}
+
+	std::uint32_t version = 0;
+	if (magic != recordingMagic || reader.ReadUInt32(version) == false || version != recordingVersion)
+	{
+		std::cerr << path << " isn't an input recording of version " << recordingVersion << std::endl;
+		return false;
+	}
+
+	outFrames.clear();
+	InputFrame frame;
+	while (reader.IsAtEnd() == false)
+	{
+		std::uint32_t deltaTimeBits;
+		std::uint32_t changedKeyCount;
+		bool		  frameRead = reader.ReadUInt32(deltaTimeBits) && reader.ReadVarint(changedKeyCount);
+
+		frame.deltaTime = std::bit_cast<float>(deltaTimeBits);
+		for (std::uint32_t i = 0; frameRead && i < changedKeyCount; ++i)
+		{
+			std::uint8_t key;
+			frameRead = reader.ReadByte(key);
+			if (frameRead)
+			{
+				frame.keys.flip(key);
+			}
+		}
+
+		frameRead = frameRead
+				 && reader.ReadByte(frame.mouseButtons)
+				 && reader.ReadSignedVarint(frame.mouseX)
+				 && reader.ReadSignedVarint(frame.mouseY)
+				 && reader.ReadSignedVarint(frame.mouseWheel);
+
+		if (frameRead == false)
+		{
+			// Most likely the game got killed mid write, the frames before are still good
+			std::cerr << "The input recording " << path << " is cut off after " << outFrames.size() << " frames"
+					  << std::endl;
+			break;
+		}
+		outFrames.push_back(frame);
+	}
+
+	return true;
+}
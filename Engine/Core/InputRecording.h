@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <bitset>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+/**
+ * What the player did in one frame, everything Player::OnTick reads from Input plus the frame's delta time. Recorded
+ * frames replayed through Input::ReplayFrame walk the same path, place and break the same blocks, so the world,
+ * lighting, meshing and collision get the same work to do from one run to the next
+ */
+struct InputFrame
+{
+	float			 deltaTime	  = 0.0f; // seconds, as the player got it, so capped
+	std::bitset<256> keys;				  // held down, indexed by DIK_ code
+	std::uint8_t	 mouseButtons = 0;	  // held down, bit i for button i
+	std::int32_t	 mouseX		  = 0;	  // movement since the last frame
+	std::int32_t	 mouseY		  = 0;
+	std::int32_t	 mouseWheel	  = 0;
+};
+
+/**
+ * Writes frames to a file as they come. Keys only get written when they go down or up and the mouse movement as
+ * variable length integers, so a frame of walking around takes about 10 bytes
+ */
+class InputRecorder
+{
+public:
+	InputRecorder() = default;
+	~InputRecorder();
+
+	InputRecorder(const InputRecorder&)			   = delete;
+	InputRecorder(InputRecorder&&)				   = delete;
+	InputRecorder& operator=(const InputRecorder&) = delete;
+	InputRecorder& operator=(InputRecorder&&)	   = delete;
+
+	/**
+	 * Starts a new recording, overwriting the file
+	 * @return false if the file couldn't be opened
+	 */
+	[[nodiscard]] bool Open(const std::filesystem::path& path);
+
+	void Record(const InputFrame& frame);
+
+	/**
+	 * Flushes the frames, the destructor closes the file as well
+	 * @return false if any of the frames failed to write
+	 */
+	bool Close();
+
+private:
+	std::ofstream			  file_;
+	std::vector<std::uint8_t> buffer_; // the frame being encoded
+	std::bitset<256>		  lastKeys_;
+	std::uint64_t			  frameCount_ = 0;
+
+public:
+	// Getters
+	[[nodiscard]] bool			IsOpen() const { return file_.is_open(); }
+	[[nodiscard]] std::uint64_t GetFrameCount() const { return frameCount_; }
+};
+
+/**
+ * Reads a whole recording up front, so that reading it doesn't get in the way of the frames being measured
+ * @param outFrames the frames in the order they were recorded
+ * @return false if the file couldn't be read or isn't a recording of this version
+ */
+[[nodiscard]] bool LoadInputRecording(const std::filesystem::path& path, std::vector<InputFrame>& outFrames);
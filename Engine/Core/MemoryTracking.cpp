@@ -0,0 +1,27 @@
+﻿#include "MemoryTracking.h"
+
+#include <array>
+
+namespace Memory
+{
+	namespace
+	{
+		Metrics::Gauge chunkBytes("Memory.Chunks");
+		Metrics::Gauge chunkBlockBytes("Memory.ChunkBlocks");
+		Metrics::Gauge chunkContextBytes("Memory.ChunkContexts");
+		Metrics::Gauge mesherCacheBytes("Memory.MesherCaches");
+		Metrics::Gauge lightingBytes("Memory.Lighting");
+
+		// In the order of Tag
+		const std::array<Metrics::Gauge*, static_cast<std::size_t>(Tag::COUNT_)> gauges = {&chunkBytes,
+																							&chunkBlockBytes,
+																							&chunkContextBytes,
+																							&mesherCacheBytes,
+																							&lightingBytes};
+	} // namespace
+
+	void Track(Tag tag, std::int64_t bytes)
+	{
+		gauges[static_cast<std::size_t>(tag)]->Add(bytes);
+	}
+} // namespace Memory
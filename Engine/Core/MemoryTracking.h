@@ -0,0 +1,75 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Metrics.h"
+
+/**
+ * Bytes in use per subsystem, as a "Memory.<Tag>" gauge each, whose max is the peak. Containers opt in through
+ * TrackedAllocator, pooled and one-off allocations by calling Track themselves. What lives on the GPU goes by the
+ * subsystem owning it instead: "World.MeshBytes", "Textures.Bytes" and "Renderer.TargetBytes"
+ */
+namespace Memory
+{
+	enum class Tag : std::uint8_t
+	{
+		Chunks,		   // the Chunk objects themselves
+		ChunkBlocks,   // block arrays, their reference counts and the compressed blocks of idle chunks
+		ChunkContexts, // meshing jobs, queued or being meshed
+		MesherCaches,  // every mesher's vertex and index caches, sized for the worst case
+		Lighting,	   // point lights per chunk and the regions of parallel propagations
+		COUNT_
+	};
+
+	/**
+	 * Safe from any thread, but not from static initializers, the gauges might not be registered yet
+	 * @param bytes negative when freeing
+	 */
+	void Track(Tag tag, std::int64_t bytes);
+
+	// Counts what a standard container allocates against TAG, allocates like std::allocator otherwise
+	template <typename T, Tag TAG>
+	class TrackedAllocator
+	{
+	public:
+		using value_type = T;
+
+		// The tag isn't a type, std::allocator_traits can't rebind it on its own
+		template <typename U>
+		struct rebind
+		{
+			using other = TrackedAllocator<U, TAG>;
+		};
+
+		TrackedAllocator() = default;
+
+		template <typename U>
+		TrackedAllocator(const TrackedAllocator<U, TAG>&)
+		{
+		}
+
+		[[nodiscard]] T* allocate(std::size_t count)
+		{
+			T* memory = std::allocator<T>().allocate(count);
+			Track(TAG, static_cast<std::int64_t>(count * sizeof(T)));
+			return memory;
+		}
+
+		void deallocate(T* memory, std::size_t count)
+		{
+			Track(TAG, -static_cast<std::int64_t>(count * sizeof(T)));
+			std::allocator<T>().deallocate(memory, count);
+		}
+
+		template <typename U>
+		bool operator==(const TrackedAllocator<U, TAG>&) const
+		{
+			return true;
+		}
+	};
+
+	template <typename T, Tag TAG>
+	using TrackedVector = std::vector<T, TrackedAllocator<T, TAG>>;
+} // namespace Memory
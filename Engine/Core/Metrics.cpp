@@ -0,0 +1,317 @@
+﻿#include "Metrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Metrics
+{
+	namespace
+	{
+		constinit std::atomic<Metric*>	   firstMetric{nullptr};
+		constinit std::atomic<std::size_t> nextShard{0};
+
+		void StoreMax(std::atomic<std::uint64_t>& max, std::uint64_t value)
+		{
+			std::uint64_t current = max.load(std::memory_order_relaxed);
+			while (current < value && max.compare_exchange_weak(current, value, std::memory_order_relaxed) == false)
+			{
+			}
+		}
+
+		// Oldest first, the order they got registered in
+		std::vector<const Metric*> GetMetrics()
+		{
+			std::vector<const Metric*> metrics;
+			for (const Metric* metric = GetFirstMetric(); metric != nullptr; metric = metric->GetNext())
+			{
+				metrics.push_back(metric);
+			}
+			std::ranges::reverse(metrics);
+			return metrics;
+		}
+
+		std::uint64_t GetBucketUpperBound(std::size_t bucket)
+		{
+			if (bucket == Histogram::BUCKET_COUNT - 1)
+			{
+				return (std::numeric_limits<std::uint64_t>::max)();
+			}
+			return (std::uint64_t{1} << bucket) - 1;
+		}
+
+		double GetMean(const Histogram::Snapshot& snapshot)
+		{
+			return snapshot.count == 0 ? 0.0 : static_cast<double>(snapshot.sum) / static_cast<double>(snapshot.count);
+		}
+	} // namespace
+
+	std::size_t GetThreadShard()
+	{
+		thread_local const std::size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+		return shard;
+	}
+
+	Metric::Metric(const char* name, MetricType type) : name_(name), type_(type)
+	{
+		next_ = firstMetric.load(std::memory_order_relaxed);
+		while (firstMetric.compare_exchange_weak(next_, this, std::memory_order_release, std::memory_order_relaxed)
+			   == false)
+		{
+		}
+	}
+
+	std::uint64_t Counter::GetValue() const
+	{
+		std::uint64_t value = 0;
+		for (const Shard& shard : shards_)
+		{
+			value += shard.value.load(std::memory_order_relaxed);
+		}
+		return value;
+	}
+
+	void Gauge::Set(std::int64_t value)
+	{
+		value_.store(value, std::memory_order_relaxed);
+		UpdateMax(value);
+	}
+
+	void Gauge::Add(std::int64_t amount)
+	{
+		UpdateMax(value_.fetch_add(amount, std::memory_order_relaxed) + amount);
+	}
+
+	void Gauge::UpdateMax(std::int64_t value)
+	{
+		std::int64_t current = max_.load(std::memory_order_relaxed);
+		while (current < value && max_.compare_exchange_weak(current, value, std::memory_order_relaxed) == false)
+		{
+		}
+	}
+
+	void Histogram::Record(std::uint64_t value)
+	{
+		Shard& shard = shards_[GetThreadShard()];
+		shard.buckets[std::bit_width(value)].fetch_add(1, std::memory_order_relaxed);
+		shard.sum.fetch_add(value, std::memory_order_relaxed);
+		StoreMax(shard.max, value);
+	}
+
+	Histogram::Snapshot Histogram::GetSnapshot() const
+	{
+		// Not atomic as a whole, values recorded meanwhile may show up in some of the fields only
+		Snapshot snapshot;
+		for (const Shard& shard : shards_)
+		{
+			for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+			{
+				const std::uint64_t count  = shard.buckets[i].load(std::memory_order_relaxed);
+				snapshot.buckets[i]		  += count;
+				snapshot.count			  += count;
+			}
+			snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+			snapshot.max  = (std::max)(snapshot.max, shard.max.load(std::memory_order_relaxed));
+		}
+		return snapshot;
+	}
+
+	std::uint64_t Histogram::Snapshot::GetPercentile(double fraction) const
+	{
+		if (count == 0)
+		{
+			return 0;
+		}
+
+		const auto	  rank		 = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(count)));
+		std::uint64_t cumulative = 0;
+		for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+		{
+			cumulative += buckets[i];
+			if (cumulative >= (std::max)(rank, std::uint64_t{1}))
+			{
+				return (std::min)(GetBucketUpperBound(i), max);
+			}
+		}
+		return max;
+	}
+
+	const Metric* GetFirstMetric()
+	{
+		return firstMetric.load(std::memory_order_acquire);
+	}
+
+	bool WriteJson(const std::filesystem::path& path)
+	{
+		std::ofstream file(path, std::ios::trunc);
+		if (file.is_open() == false)
+		{
+			std::cerr << "Failed to open " << path << " for writing the metrics" << std::endl;
+			return false;
+		}
+
+		file << std::fixed << std::setprecision(3) << "{";
+		bool firstEntry = true;
+		for (const Metric* metric : GetMetrics())
+		{
+			file << (firstEntry ? "" : ",") << "\n\t\"" << metric->GetName() << "\": ";
+			firstEntry = false;
+
+			switch (metric->GetType())
+			{
+				case MetricType::Counter:
+				{
+					file << static_cast<const Counter*>(metric)->GetValue();
+					break;
+				}
+				case MetricType::Gauge:
+				{
+					const auto* gauge = static_cast<const Gauge*>(metric);
+					file << "{\"value\": " << gauge->GetValue() << ", \"max\": " << gauge->GetMax() << "}";
+					break;
+				}
+				case MetricType::Histogram:
+				{
+					const Histogram::Snapshot snapshot = static_cast<const Histogram*>(metric)->GetSnapshot();
+					file << "{\"count\": " << snapshot.count << ", \"sum\": " << snapshot.sum
+						 << ", \"mean\": " << GetMean(snapshot) << ", \"p50\": " << snapshot.GetPercentile(0.5)
+						 << ", \"p95\": " << snapshot.GetPercentile(0.95)
+						 << ", \"p99\": " << snapshot.GetPercentile(0.99) << ", \"max\": " << snapshot.max
+						 << ", \"buckets\": [";
+
+					// Only the buckets anything fell into, as [upper bound, count]
+					bool firstBucket = true;
+					for (std::size_t i = 0; i < Histogram::BUCKET_COUNT; ++i)
+					{
+						if (snapshot.buckets[i] != 0)
+						{
+							file << (firstBucket ? "" : ", ") << "[" << GetBucketUpperBound(i) << ", "
+								 << snapshot.buckets[i] << "]";
+							firstBucket = false;
+						}
+					}
+					file << "]}";
+					break;
+				}
+			}
+		}
+		file << "\n}\n";
+
+		if (file.good() == false)
+		{
+			std::cerr << "Failed to write the metrics to " << path << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool AppendCsv(const std::filesystem::path& path, double time)
+	{
+		std::error_code error;
+		const bool		writeHeader = std::filesystem::exists(path, error) == false
+								 || std::filesystem::file_size(path, error) == 0;
+
+		std::ofstream file(path, std::ios::app);
+		if (file.is_open() == false)
+		{
+			std::cerr << "Failed to open " << path << " for writing the metrics" << std::endl;
+			return false;
+		}
+
+		const std::vector<const Metric*> metrics = GetMetrics();
+		if (writeHeader)
+		{
+			file << "time";
+			for (const Metric* metric : metrics)
+			{
+				const char* name = metric->GetName();
+				switch (metric->GetType())
+				{
+					case MetricType::Counter:
+					{
+						file << "," << name;
+						break;
+					}
+					case MetricType::Gauge:
+					{
+						file << "," << name << "," << name << ".max";
+						break;
+					}
+					case MetricType::Histogram:
+					{
+						file << "," << name << ".count," << name << ".mean," << name << ".p50," << name << ".p95,"
+							 << name << ".p99," << name << ".max";
+						break;
+					}
+				}
+			}
+			file << "\n";
+		}
+
+		file << std::fixed << std::setprecision(3) << time;
+		for (const Metric* metric : metrics)
+		{
+			switch (metric->GetType())
+			{
+				case MetricType::Counter:
+				{
+					file << "," << static_cast<const Counter*>(metric)->GetValue();
+					break;
+				}
+				case MetricType::Gauge:
+				{
+					const auto* gauge = static_cast<const Gauge*>(metric);
+					file << "," << gauge->GetValue() << "," << gauge->GetMax();
+					break;
+				}
+				case MetricType::Histogram:
+				{
+					const Histogram::Snapshot snapshot = static_cast<const Histogram*>(metric)->GetSnapshot();
+					file << "," << snapshot.count << "," << GetMean(snapshot) << "," << snapshot.GetPercentile(0.5)
+						 << "," << snapshot.GetPercentile(0.95) << "," << snapshot.GetPercentile(0.99) << ","
+						 << snapshot.max;
+					break;
+				}
+			}
+		}
+		file << "\n";
+
+		if (file.good() == false)
+		{
+			std::cerr << "Failed to write the metrics to " << path << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	PeriodicDump::PeriodicDump(std::filesystem::path csvPath, std::filesystem::path jsonPath, double interval)
+		: csvPath_(std::move(csvPath)), jsonPath_(std::move(jsonPath)), interval_(interval)
+	{
+		// Rows of an earlier run would mix with this one's
+		std::error_code error;
+		std::filesystem::remove(csvPath_, error);
+	}
+
+	void PeriodicDump::Update(double deltaTime)
+	{
+		time_		   += deltaTime;
+		timeSinceDump_ += deltaTime;
+		if (timeSinceDump_ >= interval_)
+		{
+			timeSinceDump_ = 0.0;
+			Dump();
+		}
+	}
+
+	void PeriodicDump::Dump()
+	{
+		AppendCsv(csvPath_, time_);
+		WriteJson(jsonPath_);
+	}
+} // namespace Metrics
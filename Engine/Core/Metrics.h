@@ -0,0 +1,183 @@
+﻿#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+/**
+ * Engine wide counters, gauges and histograms, all of them lock-free. Metrics register themselves on construction and
+ * never unregister, so they have to be static, e.g. a namespace scope Metrics::Counter next to the code counting.
+ * Names go "Subsystem.What", like "World.MeshJobsQueued"
+ */
+namespace Metrics
+{
+	// Counters and histograms get a slice per group of threads, so threads counting at once don't fight over a cache
+	// line. Reading sums the slices up
+	constexpr std::size_t SHARD_COUNT	  = 16;
+	constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+	enum class MetricType : std::uint8_t
+	{
+		Counter,
+		Gauge,
+		Histogram
+	};
+
+	// The slice the calling thread writes into
+	[[nodiscard]] std::size_t GetThreadShard();
+
+	class Metric
+	{
+	public:
+		Metric(const Metric&)			 = delete;
+		Metric(Metric&&)				 = delete;
+		Metric& operator=(const Metric&) = delete;
+		Metric& operator=(Metric&&)		 = delete;
+
+	protected:
+		/**
+		 * @param name has to outlive the metric, like a string literal
+		 */
+		Metric(const char* name, MetricType type);
+		~Metric() = default;
+
+	private:
+		const char* name_;
+		MetricType	type_;
+		Metric*		next_ = nullptr; // the registry is a list of every metric, newest first
+
+	public:
+		// Getters
+		[[nodiscard]] const char*	GetName() const { return name_; }
+		[[nodiscard]] MetricType	GetType() const { return type_; }
+		[[nodiscard]] const Metric* GetNext() const { return next_; }
+	};
+
+	// Only ever goes up, like jobs done or nodes visited
+	class Counter : public Metric
+	{
+	public:
+		explicit Counter(const char* name) : Metric(name, MetricType::Counter) {}
+
+		void Add(std::uint64_t amount = 1)
+		{
+			shards_[GetThreadShard()].value.fetch_add(amount, std::memory_order_relaxed);
+		}
+
+	private:
+		struct alignas(CACHE_LINE_SIZE) Shard
+		{
+			std::atomic<std::uint64_t> value{0};
+		};
+
+		std::array<Shard, SHARD_COUNT> shards_;
+
+	public:
+		// Getters
+		[[nodiscard]] std::uint64_t GetValue() const;
+	};
+
+	// A level that goes both ways, like a queue's depth or bytes in use. Keeps its highest level as well
+	class Gauge : public Metric
+	{
+	public:
+		explicit Gauge(const char* name) : Metric(name, MetricType::Gauge) {}
+
+		void Set(std::int64_t value);
+		void Add(std::int64_t amount);
+
+	private:
+		void UpdateMax(std::int64_t value);
+
+		std::atomic<std::int64_t> value_{0};
+		std::atomic<std::int64_t> max_{0};
+
+	public:
+		// Getters
+		[[nodiscard]] std::int64_t GetValue() const { return value_.load(std::memory_order_relaxed); }
+		[[nodiscard]] std::int64_t GetMax() const { return max_.load(std::memory_order_relaxed); }
+	};
+
+	// Distribution of a value, like vertices per mesh, in power of two buckets
+	class Histogram : public Metric
+	{
+	public:
+		// Bucket 0 counts zeros, bucket i values in [2^(i-1), 2^i)
+		static constexpr std::size_t BUCKET_COUNT = 65;
+
+		struct Snapshot
+		{
+			std::array<std::uint64_t, BUCKET_COUNT> buckets{};
+			std::uint64_t							count = 0;
+			std::uint64_t							sum	  = 0;
+			std::uint64_t							max	  = 0;
+
+			/**
+			 * @param fraction in [0, 1], 0.99 for the 99th percentile
+			 * @return the upper bound of the bucket the percentile falls into, at most max
+			 */
+			[[nodiscard]] std::uint64_t GetPercentile(double fraction) const;
+		};
+
+		explicit Histogram(const char* name) : Metric(name, MetricType::Histogram) {}
+
+		void Record(std::uint64_t value);
+
+	private:
+		struct alignas(CACHE_LINE_SIZE) Shard
+		{
+			std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets{};
+			std::atomic<std::uint64_t>							 sum{0};
+			std::atomic<std::uint64_t>							 max{0};
+		};
+
+		std::array<Shard, SHARD_COUNT> shards_;
+
+	public:
+		// Getters
+		[[nodiscard]] Snapshot GetSnapshot() const;
+	};
+
+	// Every metric in the registry, null if there are none
+	[[nodiscard]] const Metric* GetFirstMetric();
+
+	/**
+	 * Overwrites the file with the current value of every metric
+	 * @return false if the file couldn't be written
+	 */
+	bool WriteJson(const std::filesystem::path& path);
+
+	/**
+	 * Appends a row with the current value of every metric, the header goes first if the file is new
+	 * @param time seconds since the run started, the first column
+	 * @return false if the file couldn't be written
+	 */
+	bool AppendCsv(const std::filesystem::path& path, double time);
+
+	// Dumps the metrics every interval, for watching how they develop over a run
+	class PeriodicDump
+	{
+	public:
+		/**
+		 * @param csvPath gets a row appended every interval, truncated first
+		 * @param jsonPath gets overwritten with the latest values every interval
+		 */
+		PeriodicDump(std::filesystem::path csvPath, std::filesystem::path jsonPath, double interval = 1.0);
+
+		/**
+		 * @param deltaTime seconds since the last update
+		 */
+		void Update(double deltaTime);
+
+		// Dumps right away, e.g. at the end of the run
+		void Dump();
+
+	private:
+		std::filesystem::path csvPath_;
+		std::filesystem::path jsonPath_;
+		double				  interval_;
+		double				  time_			 = 0.0;
+		double				  timeSinceDump_ = 0.0;
+	};
+} // namespace Metrics
@@ -0,0 +1,223 @@
+﻿#include "Profiler.h"
+
+#if defined(ENABLE_PROFILER)
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Profiler
+{
+	namespace
+	{
+		// Atomic so that exporting while the owning thread records isn't a data race, relaxed accesses compile to
+		// plain moves
+		struct Event
+		{
+			std::atomic<const char*>  name{nullptr};
+			std::atomic<std::int64_t> start{0};
+			std::atomic<std::int64_t> end{0};
+		};
+
+		struct Timeline
+		{
+			std::array<Event, RING_CAPACITY> events;
+			std::atomic<std::uint64_t>		 writeIndex{0}; // only the owning thread writes it
+
+			std::uint32_t id	= 0;
+			const char*	  name	= nullptr; // guarded by registryMutex
+			bool		  inUse = true;	   // guarded by registryMutex
+		};
+
+		const auto startTime = std::chrono::steady_clock::now();
+
+		std::mutex							   registryMutex;
+		std::vector<std::unique_ptr<Timeline>> timelines;
+
+		// Hands the thread's timeline back once the thread exits, so that threads coming and going reuse the
+		// timelines instead of piling them up
+		struct TimelineLease
+		{
+			~TimelineLease()
+			{
+				if (timeline != nullptr)
+				{
+					std::lock_guard<std::mutex> lock(registryMutex);
+					timeline->inUse = false;
+				}
+			}
+
+			Timeline* timeline = nullptr;
+		};
+
+		thread_local TimelineLease lease;
+
+		Timeline& GetThreadTimeline()
+		{
+			if (lease.timeline != nullptr) [[likely]]
+			{
+				return *lease.timeline;
+			}
+
+			std::lock_guard<std::mutex> lock(registryMutex);
+			for (const auto& timeline : timelines)
+			{
+				if (timeline->inUse == false)
+				{
+					// The zones of the previous thread would show up under the new one's name. Nobody reads the
+					// timeline while the lock is held
+					for (Event& event : timeline->events)
+					{
+						event.name.store(nullptr, std::memory_order_relaxed);
+						event.start.store(0, std::memory_order_relaxed);
+						event.end.store(0, std::memory_order_relaxed);
+					}
+					timeline->writeIndex.store(0, std::memory_order_relaxed);
+
+					timeline->inUse = true;
+					timeline->name	= nullptr;
+					lease.timeline	= timeline.get();
+					return *lease.timeline;
+				}
+			}
+
+			auto& timeline = timelines.emplace_back(std::make_unique<Timeline>());
+			timeline->id   = static_cast<std::uint32_t>(timelines.size());
+			lease.timeline = timeline.get();
+			return *lease.timeline;
+		}
+
+		void WriteString(std::ostream& out, const char* string)
+		{
+			out << '"';
+			for (; *string != '\0'; ++string)
+			{
+				if (*string == '"' || *string == '\\')
+				{
+					out << '\\';
+				}
+				out << *string;
+			}
+			out << '"';
+		}
+	} // namespace
+
+	Zone::~Zone()
+	{
+		const std::int64_t end = Now();
+
+		Timeline&			timeline = GetThreadTimeline();
+		const std::uint64_t index	 = timeline.writeIndex.load(std::memory_order_relaxed);
+
+		// Pairs with the fence in WriteChromeTrace, a reader that sees any of the writes below sees index too
+		std::atomic_thread_fence(std::memory_order_release);
+
+		Event& event = timeline.events[index % RING_CAPACITY];
+		event.name.store(name_, std::memory_order_relaxed);
+		event.start.store(start_, std::memory_order_relaxed);
+		event.end.store(end, std::memory_order_relaxed);
+
+		timeline.writeIndex.store(index + 1, std::memory_order_release);
+	}
+
+	std::int64_t Now()
+	{
+		const auto elapsed = std::chrono::steady_clock::now() - startTime;
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+	}
+
+	void SetThreadName(const char* name)
+	{
+		Timeline& timeline = GetThreadTimeline();
+
+		std::lock_guard<std::mutex> lock(registryMutex);
+		timeline.name = name;
+	}
+
+	bool WriteChromeTrace(const std::filesystem::path& path)
+	{
+		struct Record
+		{
+			const char*	 name;
+			std::int64_t start;
+			std::int64_t end;
+		};
+
+		std::ofstream file(path, std::ios::trunc);
+		if (file.is_open() == false)
+		{
+			std::cerr << "Failed to open " << path << " for writing the profiler trace" << std::endl;
+			return false;
+		}
+
+		// Trace times are in microseconds
+		file << std::fixed << std::setprecision(3);
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+		std::lock_guard<std::mutex> lock(registryMutex);
+
+		std::vector<Record> records;
+		bool				firstEvent = true;
+		std::size_t			zoneCount  = 0;
+		for (const auto& timeline : timelines)
+		{
+			const std::uint64_t writtenBefore = timeline->writeIndex.load(std::memory_order_acquire);
+			const std::uint64_t oldest		  = writtenBefore > RING_CAPACITY ? writtenBefore - RING_CAPACITY : 0;
+
+			records.clear();
+			for (std::uint64_t i = oldest; i < writtenBefore; ++i)
+			{
+				const Event& event = timeline->events[i % RING_CAPACITY];
+				records.push_back({event.name.load(std::memory_order_relaxed),
+								   event.start.load(std::memory_order_relaxed),
+								   event.end.load(std::memory_order_relaxed)});
+			}
+
+			// The owner kept recording meanwhile, whatever it wrapped around to, including the zone it may be in the
+			// middle of writing, is torn
+			std::atomic_thread_fence(std::memory_order_acquire);
+			const std::uint64_t writtenAfter = timeline->writeIndex.load(std::memory_order_relaxed);
+			const std::uint64_t firstIntact	 = writtenAfter + 1 > RING_CAPACITY ? writtenAfter + 1 - RING_CAPACITY : 0;
+
+			if (timeline->name != nullptr)
+			{
+				file << (firstEvent ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+					 << timeline->id << ",\"args\":{\"name\":";
+				WriteString(file, timeline->name);
+				file << "}}";
+				firstEvent = false;
+			}
+
+			for (std::uint64_t i = (std::max)(oldest, firstIntact); i < writtenBefore; ++i)
+			{
+				const Record& record = records[i - oldest];
+				file << (firstEvent ? "" : ",") << "\n{\"name\":";
+				WriteString(file, record.name);
+				file << ",\"ph\":\"X\",\"ts\":" << static_cast<double>(record.start) / 1000.0
+					 << ",\"dur\":" << static_cast<double>(record.end - record.start) / 1000.0
+					 << ",\"pid\":1,\"tid\":" << timeline->id << "}";
+				firstEvent = false;
+				++zoneCount;
+			}
+		}
+
+		file << "\n]}\n";
+		if (file.good() == false)
+		{
+			std::cerr << "Failed to write the profiler trace to " << path << std::endl;
+			return false;
+		}
+
+		std::cout << "Wrote " << zoneCount << " profiler zones to " << path << std::endl;
+		return true;
+	}
+} // namespace Profiler
+
+#endif
@@ -0,0 +1,70 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+/**
+ * Scoped zone profiler, every thread records the zones it closes into a ring buffer of its own, so recording never
+ * takes a lock. The rings keep the last RING_CAPACITY zones per thread and WriteChromeTrace exports them for
+ * chrome://tracing or ui.perfetto.dev, which nest the zones by their times. Only exists with ENABLE_PROFILER defined
+ * (the Debug and Profile configurations), otherwise the macros below expand to nothing
+ */
+#if defined(ENABLE_PROFILER)
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b)	  PROFILE_CONCAT_IMPL(a, b)
+
+// Profiles the rest of the enclosing scope. The name has to be a string literal
+#define PROFILE_ZONE(name)		  const Profiler::Zone PROFILE_CONCAT(profilerZone_, __LINE__)(name)
+#define PROFILE_FUNCTION()		  PROFILE_ZONE(__FUNCTION__)
+#define PROFILE_THREAD_NAME(name) Profiler::SetThreadName(name)
+
+namespace Profiler
+{
+	constexpr std::size_t RING_CAPACITY = 1 << 15;
+
+	/**
+	 * @return nanoseconds since the profiler's start
+	 */
+	[[nodiscard]] std::int64_t Now();
+
+	class Zone
+	{
+	public:
+		// Taking an array rather than a pointer keeps the names to literals, the rings only store the pointer
+		template <std::size_t N>
+		explicit Zone(const char (&name)[N]) : name_(name), start_(Now())
+		{
+		}
+		~Zone();
+
+		Zone(const Zone&)			 = delete;
+		Zone(Zone&&)				 = delete;
+		Zone& operator=(const Zone&) = delete;
+		Zone& operator=(Zone&&)		 = delete;
+
+	private:
+		const char*	 name_;
+		std::int64_t start_;
+	};
+
+	/**
+	 * Names the calling thread's timeline in the trace
+	 * @param name has to outlive the profiler, like a string literal
+	 */
+	void SetThreadName(const char* name);
+
+	/**
+	 * Safe to call while other threads keep recording, the zones they close meanwhile may or may not make it in
+	 * @return false if the file couldn't be written
+	 */
+	bool WriteChromeTrace(const std::filesystem::path& path);
+} // namespace Profiler
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD_NAME(name)
+
+#endif
@@ -1,14 +1,41 @@
 ﻿#include "Timer.h"
 
 #include <algorithm>
+#include <chrono>
+
+#if defined(TIMER_USE_RDTSC)
+#include <thread>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace
+{
+	// Cap delta time to a minimum of 30fps
+	constexpr double DELTA_CAP = 1.0 / 30.0;
 
-#include "Application.h"
+#if defined(TIMER_USE_RDTSC)
+	// Counts the TSC ticks over a short sleep measured by steady_clock
+	double CalibrateTimeStampCounter()
+	{
+		using namespace std::chrono;
+
+		const auto			clockStart = steady_clock::now();
+		const std::uint64_t countStart = __rdtsc();
+		std::this_thread::sleep_for(milliseconds(20));
+		const auto			clockEnd = steady_clock::now();
+		const std::uint64_t countEnd = __rdtsc();
 
-// Cap delta time to a minimum of 30fps
-constexpr double DELTA_CAP = 1.0 / 30.0;
+		return duration<double>(clockEnd - clockStart).count() / static_cast<double>(countEnd - countStart);
+	}
+#endif
+} // namespace
 
 Timer::Timer() :
-	secondsPerCount_(0.0),
+	secondsPerCount_(GetSecondsPerCount()),
 	deltaTime_(0.0),
 	baseTime_(0),
 	pausedTime_(0),
@@ -17,20 +44,25 @@ Timer::Timer() :
 	currentTime_(0),
 	isPaused_(false)
 {
-	LARGE_INTEGER countsPerSecond;
-	QueryPerformanceFrequency(&countsPerSecond);
-	secondsPerCount_ = 1.0l / static_cast<double>(countsPerSecond.QuadPart);
-
-#ifdef _DEBUG
-	// checking if the cast is good, just a learning experience
-
-	std::int64_t cStyleTester;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&cStyleTester);
+}
 
-	std::int64_t cppStyleTester;
-	QueryPerformanceFrequency(reinterpret_cast<LARGE_INTEGER*>(&cppStyleTester));
+std::int64_t Timer::GetCurrentCount()
+{
+#if defined(TIMER_USE_RDTSC)
+	return static_cast<std::int64_t>(__rdtsc());
+#else
+	return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
 
-	int breakpoint = 0;
+double Timer::GetSecondsPerCount()
+{
+#if defined(TIMER_USE_RDTSC)
+	static const double secondsPerCount = CalibrateTimeStampCounter();
+	return secondsPerCount;
+#else
+	using Period = std::chrono::steady_clock::period;
+	return static_cast<double>(Period::num) / static_cast<double>(Period::den);
 #endif
 }
 
@@ -53,11 +85,10 @@ float Timer::GetDeltaTime() const
 
 void Timer::Reset()
 {
-	LARGE_INTEGER currentTime;
-	QueryPerformanceCounter(&currentTime);
+	const std::int64_t currentTime = GetCurrentCount();
 
-	baseTime_ = currentTime.QuadPart;
-	prevTime_ = currentTime.QuadPart;
+	baseTime_ = currentTime;
+	prevTime_ = currentTime;
 	stopTime_ = 0;
 	isPaused_ = false;
 }
@@ -66,10 +97,9 @@ void Timer::Start()
 {
 	if (isPaused_)
 	{
-		LARGE_INTEGER startTime;
-		QueryPerformanceCounter(&startTime);
+		const std::int64_t startTime = GetCurrentCount();
 
-		pausedTime_ += (startTime.QuadPart - stopTime_);
+		pausedTime_ += (startTime - stopTime_);
 		stopTime_	 = 0;
 		isPaused_	 = false;
 	}
@@ -79,9 +109,7 @@ void Timer::Pause()
 {
 	if (!isPaused_)
 	{
-		LARGE_INTEGER currTime;
-		QueryPerformanceCounter(&currTime);
-		stopTime_ = currTime.QuadPart;
+		stopTime_ = GetCurrentCount();
 		isPaused_ = true;
 	}
 }
@@ -93,9 +121,7 @@ void Timer::Tick()
 		deltaTime_ = 0.0;
 		return;
 	}
-	LARGE_INTEGER currentTime;
-	QueryPerformanceCounter(&currentTime);
-	currentTime_ = currentTime.QuadPart;
+	currentTime_ = GetCurrentCount();
 
 	deltaTime_ = (currentTime_ - prevTime_) * secondsPerCount_;
 	prevTime_  = currentTime_;
@@ -111,9 +137,7 @@ void Timer::TickUncapped()
 		deltaTime_ = 0.0;
 		return;
 	}
-	LARGE_INTEGER currentTime;
-	QueryPerformanceCounter(&currentTime);
-	currentTime_ = currentTime.QuadPart;
+	currentTime_ = GetCurrentCount();
 
 	deltaTime_ = (currentTime_ - prevTime_) * secondsPerCount_;
 	prevTime_  = currentTime_;
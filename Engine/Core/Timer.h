@@ -1,11 +1,20 @@
 ﻿#pragma once
 #include <cstdint>
 
+/**
+ * Runs on std::chrono::steady_clock. With TIMER_USE_RDTSC defined it reads the CPU's time stamp counter instead, which
+ * is cheaper, calibrated against steady_clock the first time it's needed. Only use that on x86 CPUs with an invariant
+ * TSC, on older ones the counter's rate follows the clock speed
+ */
 class Timer
 {
 public:
 	Timer();
 
+	// In units of GetSecondsPerCount
+	[[nodiscard]] static std::int64_t GetCurrentCount();
+	[[nodiscard]] static double		  GetSecondsPerCount();
+
 	double GetTotalTime() const;
 	float  GetDeltaTime() const;
 
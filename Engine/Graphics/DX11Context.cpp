@@ -1,9 +1,53 @@
 ﻿#include "DX11Context.h"
 
+#include <algorithm>
 #include <iostream>
 #include <ostream>
 #include <vector>
 
+#include "../Core/Metrics.h"
+
+namespace
+{
+	Metrics::Gauge targetBytes("Renderer.TargetBytes"); // swap chain, depth, G-buffer, light, bloom and shadow targets
+
+	// Of the formats the targets get created in, all of them happen to be 32 bits
+	std::uint32_t GetBytesPerPixel(DXGI_FORMAT format)
+	{
+		switch (format)
+		{
+			case DXGI_FORMAT_R8G8B8A8_UNORM:
+			case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+			case DXGI_FORMAT_R10G10B10A2_UNORM:
+			case DXGI_FORMAT_R11G11B10_FLOAT:
+			case DXGI_FORMAT_R24G8_TYPELESS:
+			case DXGI_FORMAT_R32_TYPELESS:
+				return 4;
+			default:
+				return 0;
+		}
+	}
+
+	// The least the texture takes up, drivers add padding and compression metadata on top
+	std::int64_t EstimateTextureBytes(ID3D11Texture2D* texture)
+	{
+		if (texture == nullptr)
+		{
+			return 0;
+		}
+
+		D3D11_TEXTURE2D_DESC desc;
+		texture->GetDesc(&desc);
+
+		std::int64_t bytes = 0;
+		for (UINT mip = 0; mip < desc.MipLevels; ++mip)
+		{
+			bytes += std::int64_t{(std::max)(desc.Width >> mip, 1u)} * (std::max)(desc.Height >> mip, 1u);
+		}
+		return bytes * GetBytesPerPixel(desc.Format) * desc.ArraySize * desc.SampleDesc.Count;
+	}
+} // namespace
+
 bool DX11Context::Initialize(HWND handle, int windowWidth, int windowHeight, bool fullscreen, bool vSync)
 {
 	HRESULT result;
@@ -348,6 +392,8 @@ bool DX11Context::Initialize(HWND handle, int windowWidth, int windowHeight, boo
 		return false;
 	}
 	wireframeEnabled = false;
+
+	UpdateTargetBytes();
 	return true;
 }
 
@@ -669,6 +715,7 @@ void DX11Context::OnWindowResize(std::uint32_t width, std::uint32_t height)
 
 	CreateGBuffer();
 	InitPingPongBuffers();
+	UpdateTargetBytes();
 	DirectX::XMMATRIX temp = DirectX::XMMatrixOrthographicLH(static_cast<float>(windowWidth_),
 															 static_cast<float>(windowHeight_),
 															 screenNear_,
@@ -676,6 +723,31 @@ void DX11Context::OnWindowResize(std::uint32_t width, std::uint32_t height)
 	DirectX::XMStoreFloat4x4(&orthoMatrix_, temp);
 }
 
+void DX11Context::UpdateTargetBytes()
+{
+	DXGI_SWAP_CHAIN_DESC swapChainDesc;
+	swapChain_->GetDesc(&swapChainDesc);
+
+	std::int64_t bytes = std::int64_t{swapChainDesc.BufferCount}
+					   * swapChainDesc.BufferDesc.Width
+					   * swapChainDesc.BufferDesc.Height
+					   * GetBytesPerPixel(swapChainDesc.BufferDesc.Format);
+
+	bytes += EstimateTextureBytes(depthStencilBuffer_.Get());
+	for (const auto& texture : gBufferTextures_)
+	{
+		bytes += EstimateTextureBytes(texture.Get());
+	}
+	bytes += EstimateTextureBytes(lightAccumulationBuffer_.Get());
+	for (const auto& texture : pingPongBuffer_)
+	{
+		bytes += EstimateTextureBytes(texture.Get());
+	}
+	bytes += EstimateTextureBytes(sunShadowMap_.Get());
+
+	targetBytes.Set(bytes);
+}
+
 bool DX11Context::ResizeSwapChain()
 {
 	// Release any existing references
@@ -59,6 +59,9 @@ private:
 	bool InitShadowMaps();
 	bool InitPingPongBuffers();
 
+	// Sets the "Renderer.TargetBytes" gauge, whenever the targets got (re)created
+	void UpdateTargetBytes();
+
 	int			 windowWidth_;
 	int			 windowHeight_;
 	float		 screenDepth_;
@@ -0,0 +1,160 @@
+﻿#include "LightClusterBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Maps an NDC coordinate [-1, 1] to a tile index, clamped to the grid
+	std::uint32_t GetTileIndex(float ndc, std::uint32_t tileCount)
+	{
+		const float tile = std::floor((ndc * 0.5f + 0.5f) * static_cast<float>(tileCount));
+		return static_cast<std::uint32_t>(std::clamp(tile, 0.0f, static_cast<float>(tileCount - 1)));
+	}
+
+	/**
+	 * Conservative NDC extent of the view space interval [minCoord, maxCoord] across depths [minZ, maxZ]
+	 * @param tanHalfFov tangent of half the field of view on the given axis
+	 * @return false if the interval doesn't overlap the screen
+	 */
+	bool GetNDCExtent(float	 minCoord,
+					  float	 maxCoord,
+					  float	 minZ,
+					  float	 maxZ,
+					  float	 tanHalfFov,
+					  float& outMin,
+					  float& outMax)
+	{
+		// The closer the point, the further out it gets projected, so negative extents use the near depth and
+		// positive ones the far depth for the minimum, and the other way around for the maximum
+		outMin = minCoord / ((minCoord < 0.0f ? minZ : maxZ) * tanHalfFov);
+		outMax = maxCoord / ((maxCoord > 0.0f ? minZ : maxZ) * tanHalfFov);
+
+		return outMin <= 1.0f && outMax >= -1.0f;
+	}
+} // namespace
+
+LightClusterBuilder::LightClusterBuilder() :
+	clusters_(CLUSTER_COUNT),
+	writeCursors_(CLUSTER_COUNT),
+	constants_{CLUSTER_COUNT_X, CLUSTER_COUNT_Y, CLUSTER_COUNT_Z}
+{
+}
+
+void LightClusterBuilder::Build(std::span<const PointLightGPU> lights,
+								DirectX::FXMMATRIX			   view,
+								DirectX::CXMMATRIX			   projection,
+								float						   nearZ,
+								float						   farZ)
+{
+	using namespace DirectX;
+
+	const float logDepthRange = std::log(farZ / nearZ);
+	constants_.sliceScale	  = static_cast<float>(CLUSTER_COUNT_Z) / logDepthRange;
+	constants_.sliceBias	  = -static_cast<float>(CLUSTER_COUNT_Z) * std::log(nearZ) / logDepthRange;
+
+	const float tanHalfFovX = 1.0f / XMVectorGetX(projection.r[0]);
+	const float tanHalfFovY = 1.0f / XMVectorGetY(projection.r[1]);
+
+	// Light positions are strided inside PointLightGPU, transform them all in one SIMD pass
+	viewSpacePositions_.resize(lights.size());
+	if (lights.empty() == false)
+	{
+		XMVector3TransformCoordStream(viewSpacePositions_.data(),
+									  sizeof(XMFLOAT3),
+									  &lights.front().position,
+									  sizeof(PointLightGPU),
+									  lights.size(),
+									  view);
+	}
+
+	// Pass 1: find the cluster range for every light and count lights per cluster
+	std::ranges::fill(clusters_, LightCluster{0, 0});
+	lightRanges_.resize(lights.size());
+	for (std::size_t i = 0; i < lights.size(); ++i)
+	{
+		const XMFLOAT3& center = viewSpacePositions_[i];
+		const float		radius = lights[i].radius;
+		ClusterRange&	range  = lightRanges_[i];
+		range.minX			   = 1;
+		range.maxX			   = 0;
+
+		const float minZ = (std::max)(center.z - radius, nearZ);
+		const float maxZ = (std::min)(center.z + radius, farZ);
+		if (minZ > maxZ)
+		{
+			continue;
+		}
+
+		float minNdcX, maxNdcX, minNdcY, maxNdcY;
+		if (GetNDCExtent(center.x - radius, center.x + radius, minZ, maxZ, tanHalfFovX, minNdcX, maxNdcX) == false
+			|| GetNDCExtent(center.y - radius, center.y + radius, minZ, maxZ, tanHalfFovY, minNdcY, maxNdcY) == false)
+		{
+			continue;
+		}
+
+		range.minX = GetTileIndex(minNdcX, CLUSTER_COUNT_X);
+		range.maxX = GetTileIndex(maxNdcX, CLUSTER_COUNT_X);
+		// tiles go top to bottom, same as texture coordinates
+		range.minY = GetTileIndex(-maxNdcY, CLUSTER_COUNT_Y);
+		range.maxY = GetTileIndex(-minNdcY, CLUSTER_COUNT_Y);
+		range.minZ = GetDepthSlice(minZ);
+		range.maxZ = GetDepthSlice(maxZ);
+
+		for (std::uint32_t z = range.minZ; z <= range.maxZ; ++z)
+		{
+			for (std::uint32_t y = range.minY; y <= range.maxY; ++y)
+			{
+				for (std::uint32_t x = range.minX; x <= range.maxX; ++x)
+				{
+					++clusters_[GetClusterIndex(x, y, z)].count;
+				}
+			}
+		}
+	}
+
+	// Prefix sum, clusters that would overflow the index list get truncated
+	std::uint32_t totalIndices = 0;
+	for (LightCluster& cluster : clusters_)
+	{
+		cluster.offset = totalIndices;
+		cluster.count  = (std::min)(cluster.count, MAX_LIGHT_INDICES - totalIndices);
+		totalIndices  += cluster.count;
+	}
+
+	// Pass 2: scatter light indices
+	lightIndices_.resize(totalIndices);
+	std::ranges::fill(writeCursors_, 0);
+
+	for (std::uint32_t i = 0; i < lightRanges_.size(); ++i)
+	{
+		const ClusterRange& range = lightRanges_[i];
+		if (range.minX > range.maxX)
+		{
+			continue;
+		}
+
+		for (std::uint32_t z = range.minZ; z <= range.maxZ; ++z)
+		{
+			for (std::uint32_t y = range.minY; y <= range.maxY; ++y)
+			{
+				for (std::uint32_t x = range.minX; x <= range.maxX; ++x)
+				{
+					const std::uint32_t clusterIndex = GetClusterIndex(x, y, z);
+					const LightCluster& cluster		 = clusters_[clusterIndex];
+					std::uint32_t&		cursor		 = writeCursors_[clusterIndex];
+					if (cursor < cluster.count)
+					{
+						lightIndices_[cluster.offset + cursor++] = i;
+					}
+				}
+			}
+		}
+	}
+}
+
+std::uint32_t LightClusterBuilder::GetDepthSlice(float viewZ) const
+{
+	const float slice = std::floor(std::log(viewZ) * constants_.sliceScale + constants_.sliceBias);
+	return static_cast<std::uint32_t>(std::clamp(slice, 0.0f, static_cast<float>(CLUSTER_COUNT_Z - 1)));
+}
@@ -0,0 +1,85 @@
+﻿#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Light.h"
+
+// Per-cluster slice of the light index list
+struct LightCluster
+{
+	std::uint32_t offset;
+	std::uint32_t count;
+};
+
+struct ClusterConstants
+{
+	std::uint32_t clusterCountX;
+	std::uint32_t clusterCountY;
+	std::uint32_t clusterCountZ;
+
+	// depth slice = floor(log(viewZ) * sliceScale + sliceBias)
+	float sliceScale;
+	float sliceBias;
+
+	float padding[3];
+};
+
+/**
+ * Splits the view frustum into froxels (screen tiles x exponential depth slices) and builds a list of point lights
+ * touching each of them. Doesn't touch D3D at all, the output is meant to be uploaded into structured buffers
+ */
+class LightClusterBuilder
+{
+public:
+	static constexpr std::uint32_t CLUSTER_COUNT_X	 = 16;
+	static constexpr std::uint32_t CLUSTER_COUNT_Y	 = 9;
+	static constexpr std::uint32_t CLUSTER_COUNT_Z	 = 24;
+	static constexpr std::uint32_t CLUSTER_COUNT	 = CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z;
+	static constexpr std::uint32_t MAX_LIGHT_INDICES = CLUSTER_COUNT * 32;
+
+	LightClusterBuilder();
+
+	/**
+	 * @param lights visible lights, indices in the output refer to this span
+	 * @param view camera view matrix
+	 * @param projection camera projection matrix, only the FOV scale terms are used
+	 * @param nearZ camera near plane
+	 * @param farZ camera far plane
+	 */
+	void Build(std::span<const PointLightGPU> lights,
+			   DirectX::FXMMATRIX			  view,
+			   DirectX::CXMMATRIX			  projection,
+			   float						  nearZ,
+			   float						  farZ);
+
+private:
+	// Inclusive range of clusters a single light overlaps
+	struct ClusterRange
+	{
+		std::uint32_t minX, maxX;
+		std::uint32_t minY, maxY;
+		std::uint32_t minZ, maxZ;
+	};
+
+	[[nodiscard]] std::uint32_t GetDepthSlice(float viewZ) const;
+
+	std::vector<LightCluster>	   clusters_;
+	std::vector<std::uint32_t>	   lightIndices_;
+	std::vector<std::uint32_t>	   writeCursors_;
+	std::vector<DirectX::XMFLOAT3> viewSpacePositions_;
+	std::vector<ClusterRange>	   lightRanges_; // one per light, minX > maxX marks a culled light
+	ClusterConstants			   constants_;
+
+public:
+	// Getters
+	[[nodiscard]] std::span<const LightCluster>	 GetClusters() const { return clusters_; }
+	[[nodiscard]] std::span<const std::uint32_t> GetLightIndices() const { return lightIndices_; }
+	[[nodiscard]] const ClusterConstants&		 GetConstants() const { return constants_; }
+
+	[[nodiscard]] static constexpr std::uint32_t GetClusterIndex(std::uint32_t x, std::uint32_t y, std::uint32_t z)
+	{
+		return x + y * CLUSTER_COUNT_X + z * CLUSTER_COUNT_X * CLUSTER_COUNT_Y;
+	}
+};
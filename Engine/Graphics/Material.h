@@ -0,0 +1,23 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+
+struct MaterialCacheEntry
+{
+	std::uint32_t albedoIndex;
+	std::uint32_t normalIndex;
+	std::uint32_t ARMIndex;
+	std::uint32_t heightmapIndex;
+	std::uint32_t emissiveIndex;
+};
+
+enum class TextureType
+{
+	Albedo,
+	Normal,
+	ARM,
+	Heightmap,
+	Emissive,
+};
+
+static constexpr std::size_t TEXTURE_TYPE_COUNT = 5;
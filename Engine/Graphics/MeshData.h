@@ -3,6 +3,7 @@
 #include <vector>
 #include <wrl/client.h>
 
+#include "../World/Chunk.h"
 #include "Vertex.h"
 
 struct MeshCPUData
@@ -20,4 +21,10 @@ struct MeshGPUData
 	Microsoft::WRL::ComPtr<ID3D11Buffer> shadowProxyVertexBuffer = nullptr;
 	Microsoft::WRL::ComPtr<ID3D11Buffer> shadowProxyIndexBuffer	 = nullptr;
 	uint32_t							 shadowProxyIndexCount	 = 0;
+
+	// Of all four buffers, for keeping track of the mesh memory
+	uint32_t byteSize = 0;
+
+	// Blocks whose light ended up in the mesh, everything is assumed to be sampled if meshing failed
+	Chunk::LightSampleMask lightSampleMask = Chunk::LightSampleMask{}.set();
 };
@@ -1,12 +1,82 @@
 ﻿#include "Mesher.h"
 
-#include <limits>
-#include <optional>
+#include <emmintrin.h>
 
+
+#include "../Core/Metrics.h"
+#include "../Core/Profiler.h"
 #include "../World/BlockData.h"
 #include "../World/BlockDatabase.h"
 #include "../World/Chunk.h"
 
+namespace
+{
+	Metrics::Counter   meshedFaces("Mesher.Faces");
+	Metrics::Counter   meshedVertices("Mesher.Vertices");
+	Metrics::Counter   meshedShadowProxyFaces("Mesher.ShadowProxyFaces");
+	Metrics::Histogram verticesPerMesh("Mesher.VerticesPerMesh");
+
+	using PaddedOffset = std::array<std::int32_t, 3>;
+
+	// N S E W T B
+	constexpr PaddedOffset FACE_NORMALS[]{{0, 0, 1}, {0, 0, -1}, {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}};
+
+	// Corner directions of every face, in the order CreateFace emits vertices: top left, top right, bottom left,
+	// bottom right. Has to match the corner positions in CreateFace
+	constexpr PaddedOffset FACE_CORNERS[6][4]{
+		{{1, 1, 1}, {-1, 1, 1}, {1, -1, 1}, {-1, -1, 1}},		  // North
+		{{-1, 1, -1}, {1, 1, -1}, {-1, -1, -1}, {1, -1, -1}},	  // South
+		{{1, 1, -1}, {1, 1, 1}, {1, -1, -1}, {1, -1, 1}},		  // East
+		{{-1, 1, 1}, {-1, 1, -1}, {-1, -1, 1}, {-1, -1, -1}},	  // West
+		{{-1, 1, 1}, {1, 1, 1}, {-1, 1, -1}, {1, 1, -1}},		  // Top
+		{{-1, -1, -1}, {1, -1, -1}, {-1, -1, 1}, {1, -1, 1}}, // Bottom
+	};
+
+	constexpr std::int32_t GetPaddedDelta(const PaddedOffset& offset)
+	{
+		constexpr auto size = static_cast<std::int32_t>(Chunk::PADDED_CHUNK_SIZE);
+		return offset[0] + offset[1] * size + offset[2] * size * size;
+	}
+
+	// Padded index deltas, relative to the block in front of the face, of the blocks touching a corner
+	struct CornerSamples
+	{
+		std::int32_t side1;
+		std::int32_t side2;
+		std::int32_t corner;
+	};
+
+	constexpr auto CORNER_SAMPLES = []()
+	{
+		std::array<std::array<CornerSamples, 4>, 6> samples{};
+		for (std::size_t face = 0; face < 6; ++face)
+		{
+			for (std::size_t corner = 0; corner < 4; ++corner)
+			{
+				// the corner direction minus the normal gives the in-plane directions
+				PaddedOffset inPlane = FACE_CORNERS[face][corner];
+				PaddedOffset side1{};
+				PaddedOffset side2{};
+				bool		 firstAxis = true;
+				for (std::size_t axis = 0; axis < 3; ++axis)
+				{
+					if (FACE_NORMALS[face][axis] != 0)
+					{
+						inPlane[axis] = 0;
+						continue;
+					}
+
+					(firstAxis ? side1 : side2)[axis] = inPlane[axis];
+					firstAxis						  = false;
+				}
+
+				samples[face][corner] = {GetPaddedDelta(side1), GetPaddedDelta(side2), GetPaddedDelta(inPlane)};
+			}
+		}
+		return samples;
+	}();
+} // namespace
+
 Mesher::Mesher()
 {
 	// Worst-case scenario vectors
@@ -18,44 +88,66 @@ Mesher::Mesher()
 	vertexCache_.reserve(MAX_VERTS);
 	simpleVertexCache_.reserve(MAX_VERTS);
 	indexCache_.reserve(MAX_INDICES);
+
+	const BlockDatabase& database = BlockDatabase::GetDatabase();
+	for (std::size_t type = 0; type < isOccluderType_.size(); ++type)
+	{
+		const auto blockType  = static_cast<BlockType>(type);
+		isOccluderType_[type] = database.IsSolid(blockType) && database.IsOpaque(blockType);
+	}
 }
 
 MeshGPUData Mesher::CreateMesh(const ChunkContext& context, ID3D11Device* device)
 {
+	PROFILE_FUNCTION();
 	// reset cache data, keep size
 	vertexCache_.clear();
 	indexCache_.clear();
 
+	for (std::size_t i = 0; i < occluders_.size(); ++i)
+	{
+		assert(context.paddedBlocks[i].type != BlockType::INVALID_);
+		occluders_[i] = isOccluderType_[static_cast<std::size_t>(context.paddedBlocks[i].type)];
+	}
+
+	Chunk::LightSampleMask lightSampleMask;
+
 	// Run meshing;
-	BlockDatabase& database = BlockDatabase::GetDatabase();
-	auto&		   blocks	= context.mainChunk;
-	for (std::uint32_t z = 0, i = 0; z < Chunk::CHUNK_SIZE; ++z)
+	const BlockDatabase& database = BlockDatabase::GetDatabase();
+	for (std::uint32_t z = 0; z < Chunk::CHUNK_SIZE; ++z)
 	{
 		for (std::uint32_t y = 0; y < Chunk::CHUNK_SIZE; ++y)
 		{
-			for (std::uint32_t x = 0; x < Chunk::CHUNK_SIZE; ++x, ++i)
+			for (std::uint32_t x = 0; x < Chunk::CHUNK_SIZE; ++x)
 			{
-				assert(blocks[i].type != BlockType::INVALID_);
-				if (blocks[i].type == BlockType::Air)
+				const BlockType type = context.GetBlock(x, y, z).type;
+				assert(type != BlockType::INVALID_);
+				if (type == BlockType::Air)
 				{
 					continue;
 				}
 
 				for (auto face : ALL_BLOCKFACES)
 				{
-					auto		 materialIndices = database.GetBlockData(blocks[i].type)->textureIndices;
-					std::uint8_t lightLevel		 = 0;
-					if (IsFaceExposed(context, {x, y, z}, face, lightLevel))
+					if (IsFaceExposed({x, y, z}, face))
 					{
-						CreateFace({x, y, z}, face, materialIndices[static_cast<std::uint32_t>(face)], lightLevel);
+						CreateFace({x, y, z},
+								   face,
+								   database.GetFaceMaterial(type, face),
+								   GetFaceLighting(context, {x, y, z}, face, lightSampleMask));
 					}
 				}
 			}
 		}
 	}
 
+	meshedFaces.Add(indexCache_.size() / 6);
+	meshedVertices.Add(vertexCache_.size());
+	verticesPerMesh.Record(vertexCache_.size());
+
 	MeshGPUData mesh;
-	mesh.indexCount = static_cast<std::uint32_t>(indexCache_.size());
+	mesh.indexCount		 = static_cast<std::uint32_t>(indexCache_.size());
+	mesh.lightSampleMask = lightSampleMask;
 	//
 	D3D11_BUFFER_DESC vertexBufferDesc = {};
 	vertexBufferDesc.Usage			   = D3D11_USAGE_IMMUTABLE;
@@ -89,20 +181,20 @@ MeshGPUData Mesher::CreateMesh(const ChunkContext& context, ID3D11Device* device
 	simpleVertexCache_.clear();
 	indexCache_.clear();
 
-	for (std::uint32_t z = 0, i = 0; z < Chunk::CHUNK_SIZE; ++z)
+	for (std::uint32_t z = 0; z < Chunk::CHUNK_SIZE; ++z)
 	{
 		for (std::uint32_t y = 0; y < Chunk::CHUNK_SIZE; ++y)
 		{
-			for (std::uint32_t x = 0; x < Chunk::CHUNK_SIZE; ++x, ++i)
+			for (std::uint32_t x = 0; x < Chunk::CHUNK_SIZE; ++x)
 			{
-				if (blocks[i].type == BlockType::Air)
+				if (context.GetBlock(x, y, z).type == BlockType::Air)
 				{
 					continue;
 				}
 
 				for (auto face : ALL_BLOCKFACES)
 				{
-					if (IsFaceExposed(blocks, {x, y, z}, face))
+					if (IsProxyFaceExposed(context, {x, y, z}, face))
 					{
 						CreateSimpleFace({x, y, z}, face);
 					}
@@ -112,6 +204,7 @@ MeshGPUData Mesher::CreateMesh(const ChunkContext& context, ID3D11Device* device
 	}
 
 	mesh.shadowProxyIndexCount = static_cast<std::uint32_t>(indexCache_.size());
+	meshedShadowProxyFaces.Add(indexCache_.size() / 6);
 
 	D3D11_BUFFER_DESC shadowProxyVertexBufferDesc = {};
 	shadowProxyVertexBufferDesc.Usage			  = D3D11_USAGE_IMMUTABLE;
@@ -144,183 +237,158 @@ MeshGPUData Mesher::CreateMesh(const ChunkContext& context, ID3D11Device* device
 		return {};
 	}
 
+	mesh.byteSize = vertexBufferDesc.ByteWidth
+				  + indexBufferDesc.ByteWidth
+				  + shadowProxyVertexBufferDesc.ByteWidth
+				  + shadowProxyIndexBufferDesc.ByteWidth;
 	return mesh;
 }
 
-bool Mesher::IsFaceExposed(const ChunkContext& context,
-						   DirectX::XMUINT3	   block,
-						   BlockFace		   face,
-						   std::uint8_t&	   outLightLevel) const
+bool Mesher::IsFaceExposed(DirectX::XMUINT3 block, BlockFace face) const
 {
-	constexpr std::size_t strideX = 1;
-	constexpr std::size_t strideY = Chunk::CHUNK_SIZE;
-	constexpr std::size_t strideZ = Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE;
+	const PaddedOffset& normal = FACE_NORMALS[static_cast<std::uint8_t>(face)];
 
-	constexpr std::size_t strideU = 1;
-	constexpr std::size_t strideV = Chunk::CHUNK_SIZE;
-	outLightLevel				  = 0b11110000;
+	// Blocks outside the chunk come from the padding, missing neighbor chunks are filled with air
+	return occluders_[Chunk::GetPaddedIndex(static_cast<std::int32_t>(block.x) + normal[0],
+											static_cast<std::int32_t>(block.y) + normal[1],
+											static_cast<std::int32_t>(block.z) + normal[2])]
+		== false;
+}
 
-	// temporary, will be reassigned in the if-statement
-	BlockType neighborType = BlockType::INVALID_;
+bool Mesher::IsProxyFaceExposed(const ChunkContext& context, DirectX::XMUINT3 block, BlockFace face) const
+{
+	static constexpr auto chunkSize = static_cast<std::int32_t>(Chunk::CHUNK_SIZE);
 
-	// If block not on the edges, consider just the main chunk
-	auto neighborOpt = GetNeighborBlockPosition(block, face);
-	bool hasNeighbor = context.hasNeighbors[static_cast<std::uint8_t>(face)];
+	const PaddedOffset& normal = FACE_NORMALS[static_cast<std::uint8_t>(face)];
+	const std::int32_t	x	   = static_cast<std::int32_t>(block.x) + normal[0];
+	const std::int32_t	y	   = static_cast<std::int32_t>(block.y) + normal[1];
+	const std::int32_t	z	   = static_cast<std::int32_t>(block.z) + normal[2];
 
-	if (neighborOpt.has_value())
+	// The padding is ignored, as if the chunk were alone in the world
+	if (x < 0 || x >= chunkSize || y < 0 || y >= chunkSize || z < 0 || z >= chunkSize)
 	{
-		// Chunk*			 chunk	  = context.mainChunk;
-		const auto&				blocks	 = context.mainChunk;
-		const DirectX::XMUINT3& neighbor = neighborOpt.value();
-		// neighborType			  = chunk->GetBlock(neighbor);
-
-		auto x = neighbor.x * strideX;
-		auto y = neighbor.y * strideY;
-		auto z = neighbor.z * strideZ;
-
-		neighborType  = blocks[x + y + z].type;
-		outLightLevel = blocks[x + y + z].lightLevel;
+		return true;
 	}
-	else if (hasNeighbor) // chunk edge face, need to take neighboring chunks into account
-	{
-		// Chunk*			 neighborChunk = nullptr;
-		const ChunkContext::ChunkSlice* neighborChunkSlice = nullptr;
-		// DirectX::XMUINT3				neighbor		   = block;
-
-		std::size_t neighborU = 0;
-		std::size_t neighborV = 0;
-
-		switch (face)
-		{
-			case BlockFace::North:
-			{
-				neighborChunkSlice = &context.northNeighbor;
-				assert(block.z == Chunk::CHUNK_SIZE - 1);
 
-				neighborU = block.x;
-				neighborV = block.y;
-				break;
-			}
-			case BlockFace::South:
-			{
-				neighborChunkSlice = &context.southNeighbor;
-				assert(block.z == 0);
-				neighborU = block.x;
-				neighborV = block.y;
-				break;
-			}
-			case BlockFace::East:
-			{
-				neighborChunkSlice = &context.eastNeighbor;
-				assert(block.x == Chunk::CHUNK_SIZE - 1);
-				neighborU = block.z;
-				neighborV = block.y;
-
-				break;
-			}
-			case BlockFace::West:
-			{
-				neighborChunkSlice = &context.westNeighbor;
-				assert(block.x == 0);
-				neighborU = block.z;
-				neighborV = block.y;
-				break;
-			}
-			case BlockFace::Top:
-			{
-				neighborChunkSlice = &context.topNeighbor;
-				assert(block.y == Chunk::CHUNK_SIZE - 1);
-				neighborU = block.x;
-				neighborV = block.z;
-				break;
-			}
-			case BlockFace::Bottom:
-			{
-				neighborChunkSlice = &context.bottomNeighbor;
-				assert(block.y == 0);
-				neighborU = block.x;
-				neighborV = block.z;
-				break;
-			}
-		}
+	return context.GetBlock(x, y, z).type == BlockType::Air;
+}
 
-		if (neighborChunkSlice == nullptr)
+Mesher::FaceLighting Mesher::GetFaceLighting(const ChunkContext&		context,
+											 DirectX::XMUINT3			block,
+											 BlockFace					face,
+											 Chunk::LightSampleMask& outLightSampleMask) const
+{
+	const auto			faceIndex = static_cast<std::uint8_t>(face);
+	const PaddedOffset& normal	  = FACE_NORMALS[faceIndex];
+	const auto&			blocks	  = context.paddedBlocks;
+
+	const auto front = static_cast<std::int32_t>(Chunk::GetPaddedIndex(static_cast<std::int32_t>(block.x) + normal[0],
+																	   static_cast<std::int32_t>(block.y) + normal[1],
+																	   static_cast<std::int32_t>(block.z) + normal[2]));
+	outLightSampleMask.set(front);
+
+	// The four corners are worked out side by side, one per lane. Only the gathers are scalar
+	alignas(16) std::int32_t occluded[3][4];
+	alignas(16) std::int32_t lightLevels[3][4];
+	for (std::size_t corner = 0; corner < 4; ++corner)
+	{
+		const CornerSamples& samples		 = CORNER_SAMPLES[faceIndex][corner];
+		const std::int32_t	 sampleIndices[] = {front + samples.side1, front + samples.side2, front + samples.corner};
+		for (std::size_t i = 0; i < 3; ++i)
 		{
-			// No neighbor chunk, block exposed
-			// If chunk generation were to be implemented, might want to make an assert here, but for the static world
-			// for now it's fine
-			return true;
+			occluded[i][corner]	   = occluders_[sampleIndices[i]];
+			lightLevels[i][corner] = blocks[sampleIndices[i]].lightLevel;
 		}
-
-		neighborU *= strideU;
-		neighborV *= strideV;
-
-		neighborType  = (*neighborChunkSlice)[neighborU + neighborV].type;
-		outLightLevel = (*neighborChunkSlice)[neighborU + neighborV].lightLevel;
-	}
-	else
-	{
-		// No neighbor in the same chunk in that direction, neighbor chunk is empty
-		return true;
 	}
 
-	assert(neighborType != BlockType::INVALID_);
-	if (neighborType == BlockType::Air) // special case, block database doesn't have an entry for air
+	const __m128i zero		= _mm_setzero_si128();
+	const __m128i one		= _mm_set1_epi32(1);
+	const __m128i lowNibble = _mm_set1_epi32(0x0F);
+
+	const __m128i side1		= _mm_load_si128(reinterpret_cast<const __m128i*>(occluded[0]));
+	const __m128i side2		= _mm_load_si128(reinterpret_cast<const __m128i*>(occluded[1]));
+	const __m128i diagonal	= _mm_load_si128(reinterpret_cast<const __m128i*>(occluded[2]));
+	const __m128i bothSides = _mm_and_si128(side1, side2);
+
+	// All bits set where the sample contributes light. With both sides blocked the corner block can't be seen from
+	// the face, so it doesn't contribute
+	const __m128i isOpen[] = {_mm_cmpeq_epi32(side1, zero),
+							  _mm_cmpeq_epi32(side2, zero),
+							  _mm_cmpeq_epi32(_mm_or_si128(bothSides, diagonal), zero)};
+
+	// (side1 && side2) ? 0 : 3 - (side1 + side2 + diagonal)
+	const __m128i ao = _mm_andnot_si128(_mm_cmpeq_epi32(bothSides, one),
+										_mm_sub_epi32(_mm_set1_epi32(3),
+													  _mm_add_epi32(_mm_add_epi32(side1, side2), diagonal)));
+
+	const __m128i frontLight = _mm_set1_epi32(blocks[front].lightLevel);
+	__m128i		  skySum	 = _mm_srli_epi32(frontLight, 4);
+	__m128i		  blockSum	 = _mm_and_si128(frontLight, lowNibble);
+	__m128i		  count		 = one;
+	for (std::size_t i = 0; i < 3; ++i)
 	{
-		return true;
-	}
+		const __m128i levels = _mm_load_si128(reinterpret_cast<const __m128i*>(lightLevels[i]));
+		const __m128i light	 = _mm_and_si128(levels, isOpen[i]);
 
-	const BlockDatabase& database = BlockDatabase::GetDatabase();
-	const BlockData*	 data	  = database.GetBlockData(neighborType);
-	assert(data != nullptr);
-
-	if (data->isSolid == false || data->isTransparent == true)
-	{
-		return true;
+		skySum	 = _mm_add_epi32(skySum, _mm_srli_epi32(light, 4));
+		blockSum = _mm_add_epi32(blockSum, _mm_and_si128(light, lowNibble));
+		count	 = _mm_sub_epi32(count, isOpen[i]); // open lanes are -1
 	}
 
-	return false; // false by default, will make it visually clear something's wrong if there's suddenly a faceless
-				  // block
-}
-
-bool Mesher::IsFaceExposed(std::span<const Block> chunk, DirectX::XMUINT3 blockPos, BlockFace face)
-{
-	constexpr std::size_t strideX = 1;
-	constexpr std::size_t strideY = Chunk::CHUNK_SIZE;
-	constexpr std::size_t strideZ = Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE;
-
-	auto neighborOpt = GetNeighborBlockPosition(blockPos, face);
-	if (neighborOpt.has_value())
+	// Packs the corners into Vertex::lighting, light sums are averaged over the sample count with rounding. The sums
+	// stay below 2^10 and the inverse rounds up, so the truncated float division matches the integer one
+	const __m128i halfCount = _mm_srli_epi32(count, 1);
+	const __m128  inverse	= _mm_div_ps(_mm_set1_ps(1.0f), _mm_cvtepi32_ps(count));
+	auto		  ToAverage = [&](__m128i sum)
 	{
-		const DirectX::XMUINT3& neighbor = neighborOpt.value();
-
-		auto x = neighbor.x * strideX;
-		auto y = neighbor.y * strideY;
-		auto z = neighbor.z * strideZ;
-
-		assert((x + y + z) < chunk.size());
-
-		BlockType neighborType = chunk[x + y + z].type;
-		if (neighborType != BlockType::Air)
+		// nibble [0, 15] -> unorm [0, 255] is a multiplication by 17
+		const __m128i scaled = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(sum, 4), sum), halfCount);
+		return _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(scaled), inverse));
+	};
+	const __m128i sky	  = ToAverage(skySum);
+	const __m128i light	  = ToAverage(blockSum);
+	const __m128i aoUnorm = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(ao, 6), _mm_slli_epi32(ao, 4)),
+										  _mm_add_epi32(_mm_slli_epi32(ao, 2), ao)); // ao * 85
+
+	const __m128i alpha	 = _mm_slli_epi32(_mm_set1_epi32(0xFF), 24);
+	const __m128i packed = _mm_or_si128(_mm_or_si128(sky, _mm_slli_epi32(light, 8)),
+										_mm_or_si128(_mm_slli_epi32(aoUnorm, 16), alpha));
+
+	alignas(16) std::int32_t brightness[4];
+	_mm_store_si128(reinterpret_cast<__m128i*>(brightness), _mm_add_epi32(_mm_add_epi32(sky, light), aoUnorm));
+
+	FaceLighting lighting;
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lighting.corners.data()), packed);
+
+	// Split the quad along the diagonal with the brighter corners, otherwise a single dark corner
+	// gets smeared across the whole quad and the shading depends on the face orientation
+	lighting.flipQuad = brightness[0] + brightness[3] > brightness[1] + brightness[2];
+
+	// Bit per corner, set where the sample was used
+	const int openCorners[] = {_mm_movemask_ps(_mm_castsi128_ps(isOpen[0])),
+							   _mm_movemask_ps(_mm_castsi128_ps(isOpen[1])),
+							   _mm_movemask_ps(_mm_castsi128_ps(isOpen[2]))};
+	for (std::size_t corner = 0; corner < 4; ++corner)
+	{
+		const CornerSamples& samples = CORNER_SAMPLES[faceIndex][corner];
+		if (openCorners[0] & (1 << corner))
 		{
-			return false;
+			outLightSampleMask.set(front + samples.side1);
+		}
+		if (openCorners[1] & (1 << corner))
+		{
+			outLightSampleMask.set(front + samples.side2);
+		}
+		if (openCorners[2] & (1 << corner))
+		{
+			outLightSampleMask.set(front + samples.corner);
 		}
 	}
 
-	return true;
-}
-
-std::array<std::uint8_t, 6> Mesher::GetBlockMaterialIndices(BlockFace blockDirection) const
-{
-
-	return {};
+	return lighting;
 }
 
-void Mesher::CreateChunkBuffers(Chunk* chunk)
-{
-}
-
-void Mesher::CreateFace(DirectX::XMUINT3 block, BlockFace face, std::uint32_t materialIdx, std::uint8_t lightLevel)
+void Mesher::CreateFace(DirectX::XMUINT3 block, BlockFace face, std::uint32_t materialIdx, const FaceLighting& lighting)
 {
 	std::uint32_t baseIndex = vertexCache_.size();
 
@@ -433,22 +501,36 @@ void Mesher::CreateFace(DirectX::XMUINT3 block, BlockFace face, std::uint32_t ma
 	DirectX::XMStoreFloat3(&bottomLeft, bl);
 	DirectX::XMStoreFloat3(&topLeft, tl);
 
+	const auto& corners = lighting.corners;
 	vertexCache_
-		.emplace_back(topLeft, normal, tangent, bitangent, DirectX::XMFLOAT2{0.0f, 0.0f}, materialIdx, lightLevel);
+		.emplace_back(topLeft, normal, tangent, bitangent, DirectX::XMFLOAT2{0.0f, 0.0f}, materialIdx, corners[0]);
 	vertexCache_
-		.emplace_back(topRight, normal, tangent, bitangent, DirectX::XMFLOAT2{1.0f, 0.0f}, materialIdx, lightLevel);
+		.emplace_back(topRight, normal, tangent, bitangent, DirectX::XMFLOAT2{1.0f, 0.0f}, materialIdx, corners[1]);
 	vertexCache_
-		.emplace_back(bottomLeft, normal, tangent, bitangent, DirectX::XMFLOAT2{0.0f, 1.0f}, materialIdx, lightLevel);
+		.emplace_back(bottomLeft, normal, tangent, bitangent, DirectX::XMFLOAT2{0.0f, 1.0f}, materialIdx, corners[2]);
 	vertexCache_
-		.emplace_back(bottomRight, normal, tangent, bitangent, DirectX::XMFLOAT2{1.0f, 1.0f}, materialIdx, lightLevel);
+		.emplace_back(bottomRight, normal, tangent, bitangent, DirectX::XMFLOAT2{1.0f, 1.0f}, materialIdx, corners[3]);
 
-	indexCache_.push_back(baseIndex + 0);
-	indexCache_.push_back(baseIndex + 1);
-	indexCache_.push_back(baseIndex + 2);
+	if (lighting.flipQuad)
+	{
+		indexCache_.push_back(baseIndex + 0);
+		indexCache_.push_back(baseIndex + 1);
+		indexCache_.push_back(baseIndex + 3);
 
-	indexCache_.push_back(baseIndex + 1);
-	indexCache_.push_back(baseIndex + 3);
-	indexCache_.push_back(baseIndex + 2);
+		indexCache_.push_back(baseIndex + 0);
+		indexCache_.push_back(baseIndex + 3);
+		indexCache_.push_back(baseIndex + 2);
+	}
+	else
+	{
+		indexCache_.push_back(baseIndex + 0);
+		indexCache_.push_back(baseIndex + 1);
+		indexCache_.push_back(baseIndex + 2);
+
+		indexCache_.push_back(baseIndex + 1);
+		indexCache_.push_back(baseIndex + 3);
+		indexCache_.push_back(baseIndex + 2);
+	}
 }
 
 void Mesher::CreateSimpleFace(DirectX::XMUINT3 block, BlockFace face)
@@ -548,59 +630,3 @@ void Mesher::CreateSimpleFace(DirectX::XMUINT3 block, BlockFace face)
 	indexCache_.push_back(baseIndex + 3);
 	indexCache_.push_back(baseIndex + 2);
 }
-
-std::optional<DirectX::XMUINT3> Mesher::GetNeighborBlockPosition(DirectX::XMUINT3 block, BlockFace direction) const
-{
-	assert(Chunk::CHUNK_SIZE <= static_cast<std::size_t>((std::numeric_limits<std::int32_t>::max)()));
-	std::int32_t x = static_cast<std::int32_t>(block.x);
-	std::int32_t y = static_cast<std::int32_t>(block.y);
-	std::int32_t z = static_cast<std::int32_t>(block.z);
-
-	DirectX::XMUINT3 neighborBlock = block;
-	switch (direction)
-	{
-		case BlockFace::North:
-		{
-			z += 1;
-			break;
-		}
-		case BlockFace::South:
-		{
-			z -= 1;
-			break;
-		}
-		case BlockFace::East:
-		{
-			x += 1;
-			break;
-		}
-		case BlockFace::West:
-		{
-			x -= 1;
-			break;
-		}
-		case BlockFace::Top:
-		{
-			y += 1;
-			break;
-		}
-		case BlockFace::Bottom:
-		{
-			y -= 1;
-			break;
-		}
-	}
-
-	bool xOutsideChunk = x < 0 || x >= Chunk::CHUNK_SIZE;
-	bool yOutsideChunk = y < 0 || y >= Chunk::CHUNK_SIZE;
-	bool zOutsideChunk = z < 0 || z >= Chunk::CHUNK_SIZE;
-
-	if (xOutsideChunk || yOutsideChunk || zOutsideChunk)
-	{
-		return std::nullopt;
-	}
-
-	return DirectX::XMUINT3{static_cast<std::uint32_t>(x),
-							static_cast<std::uint32_t>(y),
-							static_cast<std::uint32_t>(z)};
-}
@@ -2,11 +2,10 @@
 #include <array>
 #include <cstdint>
 #include <d3d11.h>
-#include <optional>
-#include <span>
 #include <vector>
 #include <wrl/client.h>
 
+#include "../Core/MemoryTracking.h"
 #include "../World/BlockFace.h"
 #include "../World/ChunkContext.h"
 #include "MeshData.h"
@@ -21,34 +20,46 @@ public:
 	[[nodiscard]] MeshGPUData CreateMesh(const ChunkContext& context, ID3D11Device* device);
 
 private:
-	[[nodiscard]] bool IsFaceExposed(const ChunkContext& context,
-									 DirectX::XMUINT3	 block,
-									 BlockFace			 face,
-									 std::uint8_t&		 outLightLevel) const;
+	// Smooth light and ambient occlusion of a face's corners, in the order CreateFace emits vertices
+	struct FaceLighting
+	{
+		std::array<std::uint32_t, 4> corners;  // see Vertex::lighting
+		bool						 flipQuad; // split the quad along the top left - bottom right diagonal
+	};
 
-	// Doesn't take neighboring chunks into consideration, used for shadow proxies
-	[[nodiscard]] bool IsFaceExposed(std::span<const Block> chunk, DirectX::XMUINT3 blockPos, BlockFace face);
+	// Uses occluders_, which has to be filled for the context first
+	[[nodiscard]] bool IsFaceExposed(DirectX::XMUINT3 block, BlockFace face) const;
 
-	[[nodiscard]] std::array<std::uint8_t, 6> GetBlockMaterialIndices(
-		BlockFace blockDirection) const; // handles rotated blocks
+	/**
+	 * For the shadow proxy, which gets built as if the chunk were in a complete void (see Chunk). Faces on the chunk's
+	 * border are always exposed, inside it only air exposes a face
+	 */
+	[[nodiscard]] bool IsProxyFaceExposed(const ChunkContext& context, DirectX::XMUINT3 block, BlockFace face) const;
 
-	void CreateChunkBuffers(Chunk* chunk);
+	/**
+	 * Each corner averages the light of the block in front of the face and of its three neighbors touching the corner,
+	 * the neighbors also give the corner its ambient occlusion
+	 * @param outLightSampleMask gets the blocks whose light was used marked
+	 */
+	[[nodiscard]] FaceLighting GetFaceLighting(const ChunkContext&		context,
+											   DirectX::XMUINT3			block,
+											   BlockFace				face,
+											   Chunk::LightSampleMask& outLightSampleMask) const;
 
-	void CreateFace(DirectX::XMUINT3 block, BlockFace face, std::uint32_t materialIdx, std::uint8_t lightLevel);
+	void CreateFace(DirectX::XMUINT3 block, BlockFace face, std::uint32_t materialIdx, const FaceLighting& lighting);
 	void CreateSimpleFace(DirectX::XMUINT3 block, BlockFace face);
 
-	/**
-	 *
-	 * @param block the coordinates of the block we're looking for the neighbors of
-	 * @param direction the direction we're looking in
-	 * @return position of the neighbor in the desired direction or nullopt if the neighbor were be outside the current
-	 * block's chunk
-	 */
-	[[nodiscard]] std::optional<DirectX::XMUINT3> GetNeighborBlockPosition(DirectX::XMUINT3 block,
-																		   BlockFace		direction) const;
+	// Whether a block type hides faces behind it and occludes light
+	std::array<bool, static_cast<std::size_t>(BlockType::MAX_BLOCKS_)> isOccluderType_;
+
+	// isOccluderType_ for every block of the padded context currently being meshed
+	std::array<bool, Chunk::PADDED_CHUNK_SIZE * Chunk::PADDED_CHUNK_SIZE * Chunk::PADDED_CHUNK_SIZE> occluders_;
 
 	// Memory pools
-	std::vector<Vertex>		  vertexCache_;
-	std::vector<SimpleVertex> simpleVertexCache_;
-	std::vector<uint32_t>	  indexCache_;
+	template <typename T>
+	using Cache = Memory::TrackedVector<T, Memory::Tag::MesherCaches>;
+
+	Cache<Vertex>		vertexCache_;
+	Cache<SimpleVertex> simpleVertexCache_;
+	Cache<uint32_t>		indexCache_;
 };
@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include "../Core/Player.h"
+#include "../Core/Profiler.h"
 #include "../Utils/SkyColor.h"
 #include "../Utils/TestCube.h"
 #include "../Utils/ThirdParty/stb_truetype.h"
@@ -24,7 +25,8 @@ bool Renderer::Initialize(HWND handle, int windowWidth, int windowHeight, bool f
 
 	didInitSucceed = textureManager_.Initialize(dx11Context_.GetDevice(),
 												dx11Context_.GetDeviceContext(),
-												"./Resources/Textures/");
+												"./Resources/Textures/",
+												"./Resources/Textures.pack");
 	if (didInitSucceed == false)
 	{
 		return false;
@@ -53,7 +55,7 @@ bool Renderer::Initialize(HWND handle, int windowWidth, int windowHeight, bool f
 		{"BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
 		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
 		{"TEXCOORD", 1, DXGI_FORMAT_R32_UINT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"TEXCOORD", 2, DXGI_FORMAT_R8_UINT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"TEXCOORD", 2, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
 	};
 
 	layoutDesc	   = {{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0}};
@@ -117,7 +119,7 @@ bool Renderer::Initialize(HWND handle, int windowWidth, int windowHeight, bool f
 		{"BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
 		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
 		{"TEXCOORD", 1, DXGI_FORMAT_R32_UINT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"TEXCOORD", 2, DXGI_FORMAT_R8_UINT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"TEXCOORD", 2, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
 	};
 
 	didInitSucceed = CompileVertexShader(L"./Engine/Graphics/Shaders/GeometryPass.hlsl",
@@ -170,26 +172,11 @@ bool Renderer::Initialize(HWND handle, int windowWidth, int windowHeight, bool f
 		return false;
 	}
 
-	/*
-	 * Position        - per vertex
-	 * light center    - per instance
-	 * light radius    - per instance
-	 * light color     - per instance
-	 * light intensity - per instance
-	 */
-	layoutDesc = {
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"TEXCOORD", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1},
-		{"TEXCOORD", 1, DXGI_FORMAT_R32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
-		{"COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
-		{"TEXCOORD", 2, DXGI_FORMAT_R32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
-	};
-
 	didInitSucceed = CompileVertexShader(L"./Engine/Graphics/Shaders/PointLights.hlsl",
 										 "VS_Main",
 										 layoutDesc,
 										 pointLightVertexShader_,
-										 pointLightInputLayout_);
+										 placeholder);
 
 	if (didInitSucceed == false)
 	{
@@ -304,12 +291,7 @@ bool Renderer::Initialize(HWND handle, int windowWidth, int windowHeight, bool f
 		return false;
 	}
 
-	if (CreateSphereBuffers() == false)
-	{
-		return false;
-	}
-
-	if (CreatePointLightBuffer() == false)
+	if (CreateLightClusterBuffers() == false)
 	{
 		return false;
 	}
@@ -344,6 +326,7 @@ void Renderer::BeginScene()
 
 void Renderer::EndScene()
 {
+	PROFILE_FUNCTION();
 	dx11Context_.SwapBuffers();
 }
 
@@ -505,134 +488,103 @@ bool Renderer::CreateOutlineBuffers()
 	return true;
 }
 
-bool Renderer::CreateSphereBuffers()
+bool Renderer::CreateLightClusterBuffers()
 {
-	using namespace DirectX;
-	// Code HEAVILY inspired by: https://github.com/Erkaman/cute-deferred-shading
-	// (The "CreateSphere") method in main.cpp
-
-	static constexpr std::uint32_t stacks		= 20;
-	static constexpr std::uint32_t slices		= 20;
-	static constexpr std::uint32_t stride		= slices + 1;
-	static constexpr std::uint32_t NUM_VERTICES = (stacks + 1) * (slices + 1);
-	static constexpr std::uint32_t NUM_QUADS	= slices * stacks;
-
-	std::array<SimpleVertex, NUM_VERTICES>		vertices;
-	std::array<std::uint32_t, NUM_QUADS * 6ull> indices;
-
-	for (std::uint32_t stackIdx = 0; stackIdx <= stacks; stackIdx++)
-	{
-		const float V	= static_cast<float>(stackIdx) / static_cast<float>(stacks);
-		const float phi = V * XM_PI;
-
-		for (std::uint32_t sliceIdx = 0; sliceIdx <= slices; sliceIdx++)
-		{
-			const float U	  = static_cast<float>(sliceIdx) / static_cast<float>(slices);
-			const float theta = U * XM_2PI;
-
-			const float x = XMScalarCos(theta) * XMScalarSin(phi);
-			const float y = XMScalarCos(phi);
-			const float z = XMScalarSin(theta) * XMScalarSin(phi);
-
-			vertices[stackIdx * stride + sliceIdx].position = XMFLOAT3(x, y, z);
-		}
-	}
-
-	for (std::uint32_t k = 0, stackIdx = 0; stackIdx < stacks; ++stackIdx)
-	{
-		for (std::uint32_t sliceIdx = 0; sliceIdx < slices; ++sliceIdx)
-		{
-			// Quad indices
-			const std::uint32_t topLeft	 = stackIdx * stride + sliceIdx;
-			const std::uint32_t topRight = topLeft + 1;
-			const std::uint32_t botLeft	 = (stackIdx + 1) * stride + sliceIdx;
-			const std::uint32_t botRight = botLeft + 1;
-
-			// Tri 1
-			indices[k++] = topLeft;
-			indices[k++] = topRight;
-			indices[k++] = botRight;
-
-			// Tri 2
-			indices[k++] = botRight;
-			indices[k++] = botLeft;
-			indices[k++] = topLeft;
-		}
-	}
-
-	D3D11_BUFFER_DESC vertexBufferDesc = {};
-	vertexBufferDesc.Usage			   = D3D11_USAGE_IMMUTABLE;
-	vertexBufferDesc.ByteWidth		   = vertices.size() * sizeof(vertices[0]);
-	vertexBufferDesc.BindFlags		   = D3D11_BIND_VERTEX_BUFFER;
-
-	auto device = dx11Context_.GetDevice();
-
-	D3D11_SUBRESOURCE_DATA vertexBufferData = {};
-	vertexBufferData.pSysMem				= vertices.data();
-	HRESULT result = device->CreateBuffer(&vertexBufferDesc, &vertexBufferData, &sphereVertexBuffer_);
-	if (FAILED(result))
+	if (clusterConstantsBuffer_.Create(dx11Context_.GetDevice().Get()) == false)
 	{
 		return false;
 	}
 
-	D3D11_BUFFER_DESC indexBufferDesc = {};
-	indexBufferDesc.Usage			  = D3D11_USAGE_IMMUTABLE;
-	indexBufferDesc.ByteWidth		  = indices.size() * sizeof(indices[0]);
-	indexBufferDesc.BindFlags		  = D3D11_BIND_INDEX_BUFFER;
+	return CreateStructuredBuffer(sizeof(PointLightGPU), MAX_POINT_LIGHTS, clusterLightBuffer_, clusterLightSRV_)
+		&& CreateStructuredBuffer(sizeof(LightCluster),
+								  LightClusterBuilder::CLUSTER_COUNT,
+								  lightClusterBuffer_,
+								  lightClusterSRV_)
+		&& CreateStructuredBuffer(sizeof(std::uint32_t),
+								  LightClusterBuilder::MAX_LIGHT_INDICES,
+								  lightIndexBuffer_,
+								  lightIndexSRV_);
+}
 
-	D3D11_SUBRESOURCE_DATA indexBufferData = {};
-	indexBufferData.pSysMem				   = indices.data();
-	result = device->CreateBuffer(&indexBufferDesc, &indexBufferData, &sphereIndexBuffer_);
+bool Renderer::CreateStructuredBuffer(UINT												 elementSize,
+									  UINT												 elementCount,
+									  Microsoft::WRL::ComPtr<ID3D11Buffer>&				 outBuffer,
+									  Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& outSRV)
+{
+	D3D11_BUFFER_DESC desc	 = {};
+	desc.Usage				 = D3D11_USAGE_DYNAMIC;
+	desc.ByteWidth			 = elementSize * elementCount;
+	desc.BindFlags			 = D3D11_BIND_SHADER_RESOURCE;
+	desc.CPUAccessFlags		 = D3D11_CPU_ACCESS_WRITE;
+	desc.MiscFlags			 = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	desc.StructureByteStride = elementSize;
+
+	auto	device = dx11Context_.GetDevice();
+	HRESULT result = device->CreateBuffer(&desc, nullptr, &outBuffer);
 	if (FAILED(result))
 	{
 		return false;
 	}
 
-	sphereIndexCount_ = indices.size();
-	return true;
-}
-
-bool Renderer::CreatePointLightBuffer()
-{
-	D3D11_BUFFER_DESC pointLightBufferDesc = {};
-	pointLightBufferDesc.Usage			   = D3D11_USAGE_DYNAMIC;
-	pointLightBufferDesc.ByteWidth		   = sizeof(PointLightGPU) * MAX_POINT_LIGHTS;
-	pointLightBufferDesc.BindFlags		   = D3D11_BIND_VERTEX_BUFFER;
-	pointLightBufferDesc.CPUAccessFlags	   = D3D11_CPU_ACCESS_WRITE;
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format							= DXGI_FORMAT_UNKNOWN;
+	srvDesc.ViewDimension					= D3D11_SRV_DIMENSION_BUFFER;
+	srvDesc.Buffer.FirstElement				= 0;
+	srvDesc.Buffer.NumElements				= elementCount;
 
-	auto	device = dx11Context_.GetDevice();
-	HRESULT result = device->CreateBuffer(&pointLightBufferDesc, nullptr, &pointLightPerInstanceBuffer_);
+	result = device->CreateShaderResourceView(outBuffer.Get(), &srvDesc, &outSRV);
 
 	return (not FAILED(result));
 }
 
-void Renderer::UpdatePointLightBuffer(std::span<const PointLightGPU> pointLights)
+void Renderer::UpdateLightClusters(std::span<const PointLightGPU> pointLights, Camera& camera)
 {
+	PROFILE_FUNCTION();
+	assert(pointLights.size() <= MAX_POINT_LIGHTS);
+	lightClusterBuilder_.Build(pointLights, camera.GetViewMatrix(), camera.GetProjectionMatrix(), GetNearZ(), GetFarZ());
+
 	auto context = dx11Context_.GetDeviceContext();
 
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	HRESULT result = context->Map(pointLightPerInstanceBuffer_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	if (FAILED(result))
+	const auto upload = [&](ID3D11Buffer* buffer, const void* data, std::size_t size)
 	{
-		return;
-	}
+		D3D11_MAPPED_SUBRESOURCE mappedResource;
+		HRESULT result = context->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+		if (FAILED(result))
+		{
+			return;
+		}
 
-	// IMPROTANT
-	assert(pointLights.size() <= MAX_POINT_LIGHTS);
-	currentVisiblePointLights_ = pointLights.size();
+		std::memcpy(mappedResource.pData, data, size);
+		context->Unmap(buffer, 0);
+	};
 
-	PointLightGPU* buffer = static_cast<PointLightGPU*>(mappedResource.pData);
+	const auto clusters		= lightClusterBuilder_.GetClusters();
+	const auto lightIndices = lightClusterBuilder_.GetLightIndices();
+	upload(clusterLightBuffer_.Get(), pointLights.data(), pointLights.size_bytes());
+	upload(lightClusterBuffer_.Get(), clusters.data(), clusters.size_bytes());
+	upload(lightIndexBuffer_.Get(), lightIndices.data(), lightIndices.size_bytes());
 
-	context->Unmap(pointLightPerInstanceBuffer_.Get(), 0);
-	std::ranges::copy(pointLights, buffer);
+	clusterConstantsBuffer_.Update(context.Get(), lightClusterBuilder_.GetConstants());
+}
+
+void Renderer::BindLightClusters()
+{
+	auto context = dx11Context_.GetDeviceContext();
+
+	// Only the point light pass reads them
+	ID3D11ShaderResourceView* const SRVs[] = {clusterLightSRV_.Get(), lightClusterSRV_.Get(), lightIndexSRV_.Get()};
+	context->PSSetShaderResources(8, std::size(SRVs), SRVs);
+	clusterConstantsBuffer_.Bind(context.Get(), 3, BindTarget::PixelShader);
 }
 
 void Renderer::LightingPass()
 {
+	PROFILE_FUNCTION();
 	// disable wireframe for lighting
 	bool wireframeEnabled = dx11Context_.IsWireframeEnabled();
 	dx11Context_.ToggleWireframe(false);
 	dx11Context_.PrepareLightPass();
+	BindLightClusters();
 	AmbientLightPass();
 	DirectionalLightPass();
 	PointLightPass();
@@ -669,27 +621,15 @@ void Renderer::DirectionalLightPass()
 
 void Renderer::PointLightPass()
 {
-	dx11Context_.ToggleFrontCulling(true);
-	ID3D11Buffer* const	  vertexBuffers[] = {sphereVertexBuffer_.Get(), pointLightPerInstanceBuffer_.Get()};
-	static constexpr UINT strides[]		  = {sizeof(SimpleVertex), sizeof(PointLightGPU)};
-	static constexpr UINT offsets[]		  = {0, 0};
-
+	// Fullscreen, every pixel only goes through the lights of its own cluster
 	auto context = dx11Context_.GetDeviceContext();
-
-	BindShaders(pointLightVertexShader_.Get(), pointLightPixelShader_.Get(), pointLightInputLayout_.Get());
-	context->IASetVertexBuffers(0, 2, vertexBuffers, strides, offsets);
-	context->IASetIndexBuffer(sphereIndexBuffer_.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-	context->DrawIndexedInstanced(sphereIndexCount_, /*formatting*/
-								  currentVisiblePointLights_,
-								  0,
-								  0,
-								  0);
-	dx11Context_.ToggleFrontCulling(false);
+	BindShaders(pointLightVertexShader_.Get(), pointLightPixelShader_.Get(), simpleVertexInputLayout_.Get());
+	context->Draw(3, 0);
 }
 
 void Renderer::RenderBloom()
 {
+	PROFILE_FUNCTION();
 	bool isHorizontalPass = false;
 	dx11Context_.ToggleLightBlend(false);
 	dx11Context_.ToggleZBuffer(false);
@@ -721,6 +661,7 @@ void Renderer::RenderBloom()
 
 void Renderer::CompositePass()
 {
+	PROFILE_FUNCTION();
 	dx11Context_.SetBackBuffer(false);
 	dx11Context_.ToggleZBuffer(false);
 	dx11Context_.ToggleLightBlend(false);
@@ -764,6 +705,7 @@ void Renderer::CalculateLightSpaceMatrix(Camera& camera)
 
 void Renderer::DebugRender()
 {
+	PROFILE_FUNCTION();
 	auto context = dx11Context_.GetDeviceContext().Get();
 	dx11Context_.SetBackBuffer(false);
 	frameConstantsBufferNew_.Bind(context, 0, BindTarget::PixelShader);
@@ -788,6 +730,7 @@ void Renderer::DebugRender()
 
 void Renderer::RenderSky()
 {
+	PROFILE_FUNCTION();
 	auto context = dx11Context_.GetDeviceContext();
 
 	dx11Context_.SetLightAccumulationBuffer(true);
@@ -808,6 +751,7 @@ void Renderer::RenderSky()
 
 void Renderer::RenderWorld(const World& world, Camera& camera)
 {
+	PROFILE_FUNCTION();
 	using namespace DirectX;
 	auto		   context		= dx11Context_.GetDeviceContext();
 	constexpr UINT stride		= sizeof(Vertex);
@@ -830,39 +774,50 @@ void Renderer::RenderWorld(const World& world, Camera& camera)
 	const auto shadowChunkBuffers = world.GetShadowChunksInFrustum(sunFrustum_);
 
 	// SHADOW PASS
-	ShadowPass();
-	for (const auto& chunk : shadowChunkBuffers)
 	{
-		context->IASetVertexBuffers(0, 1, chunk->GetShadowProxyVertexBuffer().GetAddressOf(), &shadowStride, &offset);
-		context->IASetIndexBuffer(chunk->GetShadowProxyIndexBuffer().Get(), DXGI_FORMAT_R32_UINT, 0);
-		XMFLOAT4X4 shadowChunkWorldMatrix;
-		XMStoreFloat4x4(&shadowChunkWorldMatrix, XMMatrixTranspose(chunk->GetWorldMatrix()));
-		objectConstantsBufferNew_.Update(context.Get(), shadowChunkWorldMatrix);
-		// UpdateObjectConstants(chunk->GetWorldMatrix());
-
-
-		context->DrawIndexed(chunk->GetShadowProxyIndexCount(), 0, 0);
+		PROFILE_ZONE("Shadow pass");
+		ShadowPass();
+		for (const auto& chunk : shadowChunkBuffers)
+		{
+			context->IASetVertexBuffers(0,
+										1,
+										chunk->GetShadowProxyVertexBuffer().GetAddressOf(),
+										&shadowStride,
+										&offset);
+			context->IASetIndexBuffer(chunk->GetShadowProxyIndexBuffer().Get(), DXGI_FORMAT_R32_UINT, 0);
+			XMFLOAT4X4 shadowChunkWorldMatrix;
+			XMStoreFloat4x4(&shadowChunkWorldMatrix, XMMatrixTranspose(chunk->GetWorldMatrix()));
+			objectConstantsBufferNew_.Update(context.Get(), shadowChunkWorldMatrix);
+			// UpdateObjectConstants(chunk->GetWorldMatrix());
+
+
+			context->DrawIndexed(chunk->GetShadowProxyIndexCount(), 0, 0);
+		}
 	}
 
 	// REGULAR PASS
-	const auto chunkBuffers = world.GetChunksInFrustum(camera.GetFrustum());
-	dx11Context_.Deferred_ClearScreen(0, 0, 0, 1.0f);
-	BindShaders(geometryPassVertexShader_.Get(), geometryPassPixelShader_.Get(), gBufferInputLayout_.Get());
-	BindBlockSRVs();
-	for (const auto& chunk : chunkBuffers)
 	{
-		context->IASetVertexBuffers(0, 1, chunk->GetVertexBuffer().GetAddressOf(), &stride, &offset);
-		context->IASetIndexBuffer(chunk->GetIndexBuffer().Get(), DXGI_FORMAT_R32_UINT, 0);
-		XMFLOAT4X4 chunkWorldMatrix;
-		XMStoreFloat4x4(&chunkWorldMatrix, XMMatrixTranspose(chunk->GetWorldMatrix()));
-		objectConstantsBufferNew_.Update(context.Get(), chunkWorldMatrix);
-		// UpdateObjectConstants(chunk->GetWorldMatrix());
+		PROFILE_ZONE("Geometry pass");
+		const auto chunkBuffers = world.GetChunksInFrustum(camera.GetFrustum());
+		dx11Context_.Deferred_ClearScreen(0, 0, 0, 1.0f);
+		BindShaders(geometryPassVertexShader_.Get(), geometryPassPixelShader_.Get(), gBufferInputLayout_.Get());
+		BindBlockSRVs();
+		for (const auto& chunk : chunkBuffers)
+		{
+			context->IASetVertexBuffers(0, 1, chunk->GetVertexBuffer().GetAddressOf(), &stride, &offset);
+			context->IASetIndexBuffer(chunk->GetIndexBuffer().Get(), DXGI_FORMAT_R32_UINT, 0);
+			XMFLOAT4X4 chunkWorldMatrix;
+			XMStoreFloat4x4(&chunkWorldMatrix, XMMatrixTranspose(chunk->GetWorldMatrix()));
+			objectConstantsBufferNew_.Update(context.Get(), chunkWorldMatrix);
+			// UpdateObjectConstants(chunk->GetWorldMatrix());
 
 
-		context->DrawIndexed(chunk->GetIndexCount(), 0, 0);
+			context->DrawIndexed(chunk->GetIndexCount(), 0, 0);
+		}
 	}
 
-	UpdatePointLightBuffer(world.GetVoxelLightingEngine().GetLightsInFrustum(camera.GetFrustum()));
+	const auto visiblePointLights = world.GetVoxelLightingEngine().GetLightsInFrustum(camera.GetFrustum());
+	UpdateLightClusters(visiblePointLights, camera);
 	LightingPass();
 	if (currentDebugRenderMode_ != DebugRenderMode::NONE)
 	{
@@ -872,6 +827,7 @@ void Renderer::RenderWorld(const World& world, Camera& camera)
 
 void Renderer::RenderUI(Player& player)
 {
+	PROFILE_FUNCTION();
 	using namespace DirectX;
 
 	const auto& blockBar = player.GetBlockBar();
@@ -931,8 +887,7 @@ void Renderer::RenderUI(Player& player)
 		context->Draw(4, 0);
 
 		// Render the block
-		const BlockData* blockData = blockDatabase.GetBlockData(block);
-		if (blockData != nullptr)
+		if (blockDatabase.GetBlockData(block) != nullptr)
 		{
 			BindShaders(hotbarBlockVertexShader_.Get(), hotbarBlockPixelShader_.Get(), nullptr);
 			XMStoreFloat4x4(&matrix, XMMatrixTranspose(hotbarBlockScale * translation));
@@ -940,7 +895,7 @@ void Renderer::RenderUI(Player& player)
 			// UpdateObjectConstants(hotbarBlockScale * translation);
 
 			// idx 4 is "top" face of the block, usually the most distinct
-			UIMatIdBuffer_.Update(context, blockData->textureIndices[static_cast<std::size_t>(BlockFace::Top)]);
+			UIMatIdBuffer_.Update(context, blockDatabase.GetFaceMaterial(block, BlockFace::Top));
 
 			context->Draw(4, 0);
 		}
@@ -8,6 +8,7 @@
 #include "DX11Context.h"
 #include "DebugRenderMode.h"
 #include "FrameConstants.h"
+#include "LightClusterBuilder.h"
 #include "SkyBuffer.h"
 #include "TextureManager.h"
 #include "UIConstants.h"
@@ -51,15 +52,24 @@ public:
 	void BindBlockSRVs();
 	void SetSamplers();
 	void UpdateSkyConstants(const DirectX::XMVECTOR skyLightDirection, float timeOfDay);
-	void UpdatePointLightBuffer(std::span<const struct PointLightGPU> pointLights);
+
+	/**
+	 * Rebuilds the light clusters and uploads them into the buffers the point light pass reads
+	 * @param pointLights visible lights, at most MAX_POINT_LIGHTS
+	 */
+	void UpdateLightClusters(std::span<const struct PointLightGPU> pointLights, class Camera& camera);
 	void ToggleWireframe(bool enable) { dx11Context_.ToggleWireframe(enable); };
 	void OnWindowResize(std::uint32_t width, std::uint32_t height) { dx11Context_.OnWindowResize(width, height); };
 	void SetDebugRenderMode(DebugRenderMode mode);
 
 private:
 	bool CreateOutlineBuffers();
-	bool CreateSphereBuffers();
-	bool CreatePointLightBuffer();
+	bool CreateLightClusterBuffers();
+	bool CreateStructuredBuffer(UINT												  elementSize,
+								UINT												  elementCount,
+								Microsoft::WRL::ComPtr<ID3D11Buffer>&			  outBuffer,
+								Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& outSRV);
+	void BindLightClusters();
 	void LightingPass();
 	void ShadowPass();
 	void AmbientLightPass();
@@ -103,7 +113,6 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> chunkInputLayout_;
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> simpleVertexInputLayout_;
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> gBufferInputLayout_;
-	Microsoft::WRL::ComPtr<ID3D11InputLayout> pointLightInputLayout_;
 
 	// Shaders
 	Microsoft::WRL::ComPtr<ID3D11VertexShader> outlineVertexShader_;
@@ -145,13 +154,15 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11VertexShader> debugModeVertexShader_;
 	Microsoft::WRL::ComPtr<ID3D11PixelShader>  debugModePixelShader_;
 
-	// Used for the point light volume
-	Microsoft::WRL::ComPtr<ID3D11Buffer> sphereVertexBuffer_;
-	Microsoft::WRL::ComPtr<ID3D11Buffer> sphereIndexBuffer_;
-	UINT								 sphereIndexCount_ = 0;
-
-	Microsoft::WRL::ComPtr<ID3D11Buffer> pointLightPerInstanceBuffer_;
-	std::size_t							 currentVisiblePointLights_ = 0;
+	// Clustered light data, see ClusteredLights.hlsl
+	LightClusterBuilder								 lightClusterBuilder_;
+	CBuffer<ClusterConstants>						 clusterConstantsBuffer_;
+	Microsoft::WRL::ComPtr<ID3D11Buffer>			 clusterLightBuffer_;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> clusterLightSRV_;
+	Microsoft::WRL::ComPtr<ID3D11Buffer>			 lightClusterBuffer_;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> lightClusterSRV_;
+	Microsoft::WRL::ComPtr<ID3D11Buffer>			 lightIndexBuffer_;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> lightIndexSRV_;
 
 	DebugRenderMode currentDebugRenderMode_ = DebugRenderMode::NONE;
 
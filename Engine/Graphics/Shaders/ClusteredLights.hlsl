@@ -0,0 +1,34 @@
+#ifndef CLUSTERED_LIGHTS_HLSL
+#define CLUSTERED_LIGHTS_HLSL
+#include "PointLightGPU.hlsl"
+
+// Filled on the CPU every frame by LightClusterBuilder
+struct LightCluster
+{
+	uint offset;
+	uint count;
+};
+
+cbuffer ClusterConstants : register(b3)
+{
+	uint3 clusterCount;
+	float sliceScale;
+	float sliceBias;
+};
+
+StructuredBuffer<PointLightGPU> clusterLights : register(t8);
+StructuredBuffer<LightCluster>  lightClusters : register(t9);
+StructuredBuffer<uint>          lightIndices  : register(t10);
+
+// uv - screen uv, top left is (0, 0)
+// viewZ - linear view space depth
+uint GetClusterIndex(float2 uv, float viewZ)
+{
+	uint3 cluster;
+	cluster.xy = min(uint2(uv * clusterCount.xy), clusterCount.xy - 1);
+	cluster.z = clamp(floor(log(viewZ) * sliceScale + sliceBias), 0.0f, clusterCount.z - 1);
+	
+	return cluster.x + cluster.y * clusterCount.x + cluster.z * clusterCount.x * clusterCount.y;
+}
+
+#endif
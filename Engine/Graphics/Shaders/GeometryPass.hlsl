@@ -11,7 +11,7 @@ struct VS_Input
 	float3 bitangent  : BITANGENT;
 	float2 texcoord   : TEXCOORD0;
 	uint   materialID : TEXCOORD1;
-	uint   lightLevel : TEXCOORD2;
+	float4 lighting   : TEXCOORD2; // smooth sky light, smooth block light, ambient occlusion
 	
 };
 
@@ -26,7 +26,7 @@ struct PS_Input
 	nointerpolation uint materialID      : TEXCOORD1;
 	float3				 tangentViewDir  : TEXCOORD2;
 	float3				 tangentLightDir : TEXCOORD4;
-	uint				 lightLevel		 : TEXCOORD5;
+	float3				 lighting		 : TEXCOORD5;
 };
 
 struct PS_Output
@@ -85,7 +85,7 @@ PS_Input VS_Main(VS_Input input)
 	output.tangentViewDir = mul(TBN, worldViewDirection);
 	output.tangentLightDir = mul(TBN, -skyLightDirection.xyz);
 	
-	output.lightLevel = input.lightLevel;
+	output.lighting = input.lighting.xyz;
 
 	return output;
 }
@@ -109,6 +109,25 @@ float GetSelfShadow(
 	float shadowStrength    // How dark the shadows are (softness factor)
 );
 
+// The G-buffer only has a nibble for each light level, so the interpolated levels get dithered back into nibbles
+// to avoid visible banding
+float PackVoxelLight(float2 lighting, float2 pixelPosition)
+{
+	static const float bayer[4][4] =
+	{
+		{ 0.0f,  8.0f,  2.0f, 10.0f},
+		{12.0f,  4.0f, 14.0f,  6.0f},
+		{ 3.0f, 11.0f,  1.0f,  9.0f},
+		{15.0f,  7.0f, 13.0f,  5.0f}
+	};
+	
+	const uint2 pixel = uint2(pixelPosition) % 4;
+	const float threshold = (bayer[pixel.y][pixel.x] + 0.5f) / 16.0f;
+	const uint2 levels = min(uint2(lighting * 15.0f + threshold), 15);
+	
+	return float((levels.x << 4) | levels.y) / 255.0f;
+}
+
 PS_Output PS_Main(PS_Input input) : SV_TARGET
 {
 	// Parallax mapping
@@ -131,12 +150,13 @@ PS_Output PS_Main(PS_Input input) : SV_TARGET
 	uint emissiveIndex = materialBuffer[input.materialID].emissiveIdx;
 
     float4 albedo = albedoTextures.Sample(basicSampler, float3(texCoords, albedoIndex));
-    float4 sampledNormal = normalTextures.Sample(basicSampler, float3(texCoords, normalIndex));
+    float2 sampledNormal = normalTextures.Sample(basicSampler, float3(texCoords, normalIndex)).rg;
     float4 arm    = ARMTextures.Sample(basicSampler, float3(texCoords, ARMIndex));
 	float4 emissive = emissiveTextures.Sample(basicSampler, float3(texCoords, emissiveIndex));
 	
-	// convert normal from [0, 1] (texture range) to [-1, 1]
+	// convert normal from [0, 1] (texture range) to [-1, 1], the texture only stores x and y
 	sampledNormal = sampledNormal * 2.0f - 1.0f;
+	float3 tangentNormal = float3(sampledNormal, sqrt(saturate(1.0f - dot(sampledNormal, sampledNormal))));
 	
 
 	float3 T = normalize(input.tangent);
@@ -146,13 +166,15 @@ PS_Output PS_Main(PS_Input input) : SV_TARGET
 	float3x3 TBN = float3x3(T, B, N);
 	
 	// transform to view space
-	float3 worldNormal = mul(sampledNormal.xyz, TBN);
+	float3 worldNormal = mul(tangentNormal, TBN);
 	float3 normal = normalize(mul(worldNormal, (float3x3)view));
 	
 	PS_Output output;
 	output.albedo = float4(albedo.rgb, POMShadowFactor);
 	output.normal = normal * 0.5f + 0.5f;
-	output.ORMV = float4(arm.rgb, float(input.lightLevel)/ 255.0f);
+	// Voxel AO on top of the material's own
+	arm.r *= lerp(0.35f, 1.0f, input.lighting.z);
+	output.ORMV = float4(arm.rgb, PackVoxelLight(input.lighting.xy, input.position.xy));
 	output.emissive = emissive;
 	
 	return output;
@@ -256,7 +278,7 @@ float GetSelfShadow(
         if (currentHeight > 1.0) break;
 
         // Sample the height at this new location
-        float heightAtNewPoint = heightMapTextures.SampleLevel(basicSampler, float3(currentUV, textureIndex), 0).a;
+        float heightAtNewPoint = heightMapTextures.SampleLevel(basicSampler, float3(currentUV, textureIndex), 0).r;
 
         // If the texture height here is TALLER than our ray, we are blocked!
         if (heightAtNewPoint > currentHeight)
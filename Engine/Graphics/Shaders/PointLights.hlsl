@@ -2,43 +2,24 @@
 #define POINT_LIGHTS_HLSL
 #include "ShaderCommons.hlsl"
 #include "DeferredCommons.hlsl"
-
-struct VS_Input
-{
-	float3 position	  : POSITION;
-	
-	float3 lightCenter    : TEXCOORD0;
-	float  lightRadius    : TEXCOORD1;
-	float3 lightColor     : COLOR;
-	float  lightIntensity : TEXCOORD2;
-};
+#include "ClusteredLights.hlsl"
 
 struct PS_Input
 {
-	float4 position	: SV_POSITION;
-	
-	nointerpolation float3 lightCenter    : TEXCOORD0;
-	nointerpolation float  lightRadius    : TEXCOORD1;
-	nointerpolation float3 lightColor     : COLOR;
-	nointerpolation float  lightIntensity : TEXCOORD2;
+	float4 position	  : SV_POSITION;
+	float2 texcoord	  : TEXCOORD0;
 };
 
 
-PS_Input VS_Main(VS_Input input)
+PS_Input VS_Main(uint vIdx : SV_VertexID)
 {
+	PS_Input output;
+	float2 texcoord = float2((vIdx << 1) & 2, vIdx & 2);
+	output.position = float4(texcoord * float2(2, -2) + float2(-1, 1), 1.0, 1.0);
+	output.texcoord = texcoord;
 	
-	float3 scaledPos = input.position * input.lightRadius;
-	float3 worldPos = scaledPos + input.lightCenter;
-	
-	//final, projected position
-	PS_Input result;
-	result.position = mul(float4(worldPos, 1.0f), viewProjection);
-	result.lightCenter = input.lightCenter;
-	result.lightRadius = input.lightRadius;
-	result.lightColor = input.lightColor;
-	result.lightIntensity = input.lightIntensity;
 	
-	return result;
+	return output;
 }
 
 float GetAttenuation(float distance, float radius, float intensity);
@@ -46,28 +27,49 @@ float GetAttenuation(float distance, float radius, float intensity);
 // source: https://lisyarus.github.io/blog/posts/point-light-attenuation.html
 float AttenuateNoCusp(float distance, float radius, float intensity);
 
+float3 ShadePointLight(PointLightGPU light, float3 fragWorldPos, float3 N, float3 V, float3 basecolor, float4 ormv);
+
 float4 PS_Main(PS_Input input) : SV_TARGET
 {
-	uint2 dimensions;
-	albedo.GetDimensions(dimensions.x ,dimensions.y);
-	
-	float2 uv = input.position.xy / dimensions.xy;
-	const float4 basecolor = albedo.Sample(pointSampler, uv);
+	float2 uv = input.texcoord;
 	const float4 ormv = ORMV.Sample(pointSampler, uv);
 	
+	// Point lights are scaled by the block light, where there's none of it there's nothing to add
+	const uint voxelLighting = ormv.a * 255.0f;
+	const float blockLightLevel = (voxelLighting & 0x0F) / 15.0f;
+	
 	float Z = depth.Sample(pointSampler, uv);
-	if (Z >= 1.0f) // prevent Sky NaNs
+	if (Z >= 1.0f || blockLightLevel == 0.0f) // prevent Sky NaNs, and skip the unlit pixels
 	{
 		return float4(0.0f, 0.0f, 0.0f, 0.0f);
 	}
 	const float3 fragWorldPos = CalculateWorldPos(uv, Z, inverseViewProjection);
 	
+	const float4 basecolor = albedo.Sample(pointSampler, uv);
 	const float3 sampledNormal = normal.Sample(pointSampler, uv);
 	
 	float3 N = normalize(sampledNormal * 2.0f - 1.0f);
-	const float3 L = normalize(mul(input.lightCenter - fragWorldPos, (float3x3)view));
 	const float3 V = normalize(mul(cameraPosition.xyz - fragWorldPos, (float3x3)view));
-	const float3 R = reflect(-V, N);
+	
+	// Only the lights the CPU found overlapping this pixel's froxel
+	const float viewZ = mul(float4(fragWorldPos, 1.0f), view).z;
+	const LightCluster cluster = lightClusters[GetClusterIndex(uv, viewZ)];
+	
+	float3 directLight = 0.0f;
+	for (uint i = 0; i < cluster.count; ++i)
+	{
+		const PointLightGPU light = clusterLights[lightIndices[cluster.offset + i]];
+		directLight += ShadePointLight(light, fragWorldPos, N, V, basecolor.rgb, ormv);
+	}
+	
+	directLight *= blockLightLevel;
+	
+	return float4(directLight, 1.0f);
+}
+
+float3 ShadePointLight(PointLightGPU light, float3 fragWorldPos, float3 N, float3 V, float3 basecolor, float4 ormv)
+{
+	const float3 L = normalize(mul(light.position - fragWorldPos, (float3x3)view));
 	
 	const float3 H = normalize(L + V);
 	
@@ -134,20 +136,12 @@ float4 PS_Main(PS_Input input) : SV_TARGET
 	// Standard Lambertian diffuse
 	const float3 diffuse = kD * (basecolor.rgb / PI);
 	
-	float distance = length(input.lightCenter - fragWorldPos);
-	float attenuation = AttenuateNoCusp(distance, input.lightRadius, input.lightIntensity);
+	float distance = length(light.position - fragWorldPos);
+	float attenuation = AttenuateNoCusp(distance, light.radius, light.intensity);
 	
 	// Final composition
 	// We multiply by NdotL because light spreats out over the surface area
-	 float3 directLight = (diffuse + specular) * NdotL * attenuation * input.lightColor;
-	
-	const uint voxelLighting = ormv.a * 255.0f;
-	const float skyLightLevel = ((voxelLighting & 0xF0) >> 4) / 15.0f;
-	const float blockLightLevel = (voxelLighting & 0x0F) / 15.0f;
-	
-	directLight *= blockLightLevel;
-	
-	return float4(directLight, 1.0f);
+	return (diffuse + specular) * NdotL * attenuation * light.color;
 }
 
 float GetAttenuation(float distance, float radius, float intensity)
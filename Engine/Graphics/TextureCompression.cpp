@@ -0,0 +1,677 @@
+﻿#include "TextureCompression.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+#include <limits>
+
+namespace
+{
+	constexpr std::size_t blockTexels = 16;
+
+	// Rounds of fitting the endpoints to the indices picked with the previous ones
+	constexpr std::size_t refineIterations = 4;
+
+	using Color	  = std::array<float, 4>;
+	using Indices = std::array<std::uint8_t, blockTexels>;
+	using Weights = std::array<float, blockTexels>;
+
+	// Channels beyond the ones a format encodes stay at 0, in the block as well as in the palette
+	using Palette = std::array<Color, 16>;
+
+	// A 4x4 block channel after channel, so that 4 texels of a channel load into a register at once
+	struct Block
+	{
+		alignas(16) std::array<std::array<float, blockTexels>, 4> channels{};
+	};
+
+	/**
+	 * @param firstChannel the block's first channel is this one of the image
+	 */
+	Block LoadBlock(std::span<const std::uint8_t> rgba,
+					std::uint32_t				  width,
+					std::uint32_t				  height,
+					std::uint32_t				  blockX,
+					std::uint32_t				  blockY,
+					std::size_t					  firstChannel,
+					std::size_t					  channelCount)
+	{
+		Block block;
+		for (std::uint32_t y = 0; y < 4; ++y)
+		{
+			const std::uint32_t sourceY = (std::min)(blockY * 4 + y, height - 1);
+			for (std::uint32_t x = 0; x < 4; ++x)
+			{
+				const std::uint32_t sourceX = (std::min)(blockX * 4 + x, width - 1);
+				const std::uint8_t* texel	= rgba.data() + (std::size_t{sourceY} * width + sourceX) * 4;
+				for (std::size_t channel = 0; channel < channelCount; ++channel)
+				{
+					block.channels[channel][y * 4 + x] = texel[firstChannel + channel];
+				}
+			}
+		}
+		return block;
+	}
+
+	// Picks the closest palette entry for every texel, 4 texels at a time
+	// @return the squared error of the whole block
+	float SelectIndices(const Block&   block,
+						const Palette& palette,
+						std::size_t	   paletteSize,
+						std::size_t	   channelCount,
+						Indices&	   outIndices)
+	{
+		float error = 0.0f;
+		for (std::size_t group = 0; group < blockTexels; group += 4)
+		{
+			__m128 texels[4];
+			for (std::size_t channel = 0; channel < channelCount; ++channel)
+			{
+				texels[channel] = _mm_load_ps(block.channels[channel].data() + group);
+			}
+
+			__m128	bestDistance = _mm_set1_ps((std::numeric_limits<float>::max)());
+			__m128i bestIndex	 = _mm_setzero_si128();
+			for (std::size_t entry = 0; entry < paletteSize; ++entry)
+			{
+				__m128 distance = _mm_setzero_ps();
+				for (std::size_t channel = 0; channel < channelCount; ++channel)
+				{
+					const __m128 difference = _mm_sub_ps(texels[channel], _mm_set1_ps(palette[entry][channel]));
+					distance				= _mm_add_ps(distance, _mm_mul_ps(difference, difference));
+				}
+
+				// Ties keep the earlier entry
+				const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, bestDistance));
+				bestDistance		 = _mm_min_ps(distance, bestDistance);
+				bestIndex			 = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(static_cast<int>(entry))),
+												_mm_andnot_si128(closer, bestIndex));
+			}
+
+			alignas(16) std::array<std::int32_t, 4> indices;
+			alignas(16) std::array<float, 4>		distances;
+			_mm_store_si128(reinterpret_cast<__m128i*>(indices.data()), bestIndex);
+			_mm_store_ps(distances.data(), bestDistance);
+			for (std::size_t i = 0; i < 4; ++i)
+			{
+				outIndices[group + i] = static_cast<std::uint8_t>(indices[i]);
+				error += distances[i];
+			}
+		}
+		return error;
+	}
+
+	// The line through the texels along their principal axis, from the outermost texel on one side to the other
+	void FitPrincipalAxis(const Block& block, std::size_t channelCount, Color& outStart, Color& outEnd)
+	{
+		Color mean{};
+		for (std::size_t channel = 0; channel < channelCount; ++channel)
+		{
+			for (const float value : block.channels[channel])
+			{
+				mean[channel] += value;
+			}
+			mean[channel] /= blockTexels;
+		}
+
+		std::array<Color, 4> covariance{};
+		for (std::size_t texel = 0; texel < blockTexels; ++texel)
+		{
+			for (std::size_t a = 0; a < channelCount; ++a)
+			{
+				for (std::size_t b = 0; b < channelCount; ++b)
+				{
+					covariance[a][b] += (block.channels[a][texel] - mean[a]) * (block.channels[b][texel] - mean[b]);
+				}
+			}
+		}
+
+		// Power iteration, starting from the channel that varies the most so the start can't be perpendicular to it
+		std::size_t widestChannel = 0;
+		for (std::size_t channel = 1; channel < channelCount; ++channel)
+		{
+			if (covariance[channel][channel] > covariance[widestChannel][widestChannel])
+			{
+				widestChannel = channel;
+			}
+		}
+
+		outStart = mean;
+		outEnd	 = mean;
+		if (covariance[widestChannel][widestChannel] <= 0.0f)
+		{
+			return;
+		}
+
+		Color axis = covariance[widestChannel];
+		for (std::size_t iteration = 0; iteration < 8; ++iteration)
+		{
+			Color next{};
+			float largest = 0.0f;
+			for (std::size_t a = 0; a < channelCount; ++a)
+			{
+				for (std::size_t b = 0; b < channelCount; ++b)
+				{
+					next[a] += covariance[a][b] * axis[b];
+				}
+				largest = (std::max)(largest, std::abs(next[a]));
+			}
+
+			if (largest <= 0.0f)
+			{
+				break;
+			}
+			for (std::size_t channel = 0; channel < channelCount; ++channel)
+			{
+				axis[channel] = next[channel] / largest;
+			}
+		}
+
+		float length = 0.0f;
+		for (std::size_t channel = 0; channel < channelCount; ++channel)
+		{
+			length += axis[channel] * axis[channel];
+		}
+		length = std::sqrt(length);
+
+		float minProjection = 0.0f;
+		float maxProjection = 0.0f;
+		for (std::size_t texel = 0; texel < blockTexels; ++texel)
+		{
+			float projection = 0.0f;
+			for (std::size_t channel = 0; channel < channelCount; ++channel)
+			{
+				projection += (block.channels[channel][texel] - mean[channel]) * axis[channel] / length;
+			}
+			minProjection = (std::min)(minProjection, projection);
+			maxProjection = (std::max)(maxProjection, projection);
+		}
+
+		for (std::size_t channel = 0; channel < channelCount; ++channel)
+		{
+			outStart[channel] = std::clamp(mean[channel] + axis[channel] / length * minProjection, 0.0f, 255.0f);
+			outEnd[channel]	  = std::clamp(mean[channel] + axis[channel] / length * maxProjection, 0.0f, 255.0f);
+		}
+	}
+
+	/**
+	 * Least squares fit of the endpoints to where the indices put the texels
+	 * @param weights of the end for every texel, the start's is the rest
+	 * @return false if the weights don't pin down both endpoints
+	 */
+	bool RefineEndpoints(const Block&	block,
+						 std::size_t	channelCount,
+						 const Weights& weights,
+						 Color&			outStart,
+						 Color&			outEnd)
+	{
+		float startStart = 0.0f;
+		float startEnd	 = 0.0f;
+		float endEnd	 = 0.0f;
+		Color startSum{};
+		Color endSum{};
+		for (std::size_t texel = 0; texel < blockTexels; ++texel)
+		{
+			const float endWeight	= weights[texel];
+			const float startWeight = 1.0f - endWeight;
+
+			startStart += startWeight * startWeight;
+			startEnd += startWeight * endWeight;
+			endEnd += endWeight * endWeight;
+			for (std::size_t channel = 0; channel < channelCount; ++channel)
+			{
+				startSum[channel] += startWeight * block.channels[channel][texel];
+				endSum[channel] += endWeight * block.channels[channel][texel];
+			}
+		}
+
+		const float determinant = startStart * endEnd - startEnd * startEnd;
+		if (std::abs(determinant) < 1e-6f)
+		{
+			return false;
+		}
+
+		for (std::size_t channel = 0; channel < channelCount; ++channel)
+		{
+			const float start = (startSum[channel] * endEnd - endSum[channel] * startEnd) / determinant;
+			const float end	  = (endSum[channel] * startStart - startSum[channel] * startEnd) / determinant;
+			outStart[channel] = std::clamp(start, 0.0f, 255.0f);
+			outEnd[channel]	  = std::clamp(end, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	// @param value 0 to 255
+	std::uint32_t Quantize(float value, std::uint32_t maxValue)
+	{
+		return static_cast<std::uint32_t>(std::lround(std::clamp(value, 0.0f, 255.0f) * maxValue / 255.0f));
+	}
+
+	std::uint16_t ToRGB565(const Color& color)
+	{
+		return static_cast<std::uint16_t>(Quantize(color[0], 31) << 11 | Quantize(color[1], 63) << 5
+										  | Quantize(color[2], 31));
+	}
+
+	Color FromRGB565(std::uint16_t color)
+	{
+		const std::uint32_t red	  = color >> 11;
+		const std::uint32_t green = color >> 5 & 63;
+		const std::uint32_t blue  = color & 31;
+		return {static_cast<float>(red << 3 | red >> 2),
+				static_cast<float>(green << 2 | green >> 4),
+				static_cast<float>(blue << 3 | blue >> 2),
+				0.0f};
+	}
+
+	void EncodeBC1(const Block& block, std::uint8_t* outBlock)
+	{
+		// Weight of the second color by index
+		static constexpr std::array<float, 4> weightsByIndex = {0.0f, 1.0f, 1.0f / 3, 2.0f / 3};
+
+		Color start, end;
+		FitPrincipalAxis(block, 3, start, end);
+
+		std::array<std::uint16_t, 2> bestColors{};
+		Indices						 bestIndices{};
+		float						 bestError = (std::numeric_limits<float>::max)();
+		for (std::size_t iteration = 0; iteration < refineIterations; ++iteration)
+		{
+			const std::array<std::uint16_t, 2> colors = {ToRGB565(start), ToRGB565(end)};
+			const Color						   color0 = FromRGB565(colors[0]);
+			const Color						   color1 = FromRGB565(colors[1]);
+
+			Palette palette{};
+			for (std::size_t channel = 0; channel < 3; ++channel)
+			{
+				palette[0][channel] = color0[channel];
+				palette[1][channel] = color1[channel];
+				palette[2][channel] = (2.0f * color0[channel] + color1[channel]) / 3.0f;
+				palette[3][channel] = (color0[channel] + 2.0f * color1[channel]) / 3.0f;
+			}
+
+			Indices		indices;
+			const float error = SelectIndices(block, palette, 4, 3, indices);
+			if (error < bestError)
+			{
+				bestColors	= colors;
+				bestIndices = indices;
+				bestError	= error;
+			}
+
+			Weights weights;
+			for (std::size_t texel = 0; texel < blockTexels; ++texel)
+			{
+				weights[texel] = weightsByIndex[indices[texel]];
+			}
+			if (error == 0.0f || RefineEndpoints(block, 3, weights, start, end) == false)
+			{
+				break;
+			}
+		}
+
+		// The first color has to be the larger one, the other order is the mode with a transparent index 3
+		if (bestColors[0] < bestColors[1])
+		{
+			std::swap(bestColors[0], bestColors[1]);
+			for (std::uint8_t& index : bestIndices)
+			{
+				index ^= 1;
+			}
+		}
+		else if (bestColors[0] == bestColors[1])
+		{
+			bestIndices.fill(0);
+		}
+
+		std::uint32_t packedIndices = 0;
+		for (std::size_t texel = 0; texel < blockTexels; ++texel)
+		{
+			packedIndices |= static_cast<std::uint32_t>(bestIndices[texel]) << (texel * 2);
+		}
+
+		std::memcpy(outBlock, bestColors.data(), sizeof(bestColors));
+		std::memcpy(outBlock + 4, &packedIndices, sizeof(packedIndices));
+	}
+
+	// Encodes the block's first channel
+	void EncodeBC4(const Block& block, std::uint8_t* outBlock)
+	{
+		// Weight of the second value by index, in the mode with 6 interpolated values
+		static constexpr std::array<float, 8> weightsByIndex = {
+			0.0f, 1.0f, 1.0f / 7, 2.0f / 7, 3.0f / 7, 4.0f / 7, 5.0f / 7, 6.0f / 7};
+
+		const auto [min, max] = std::ranges::minmax(block.channels[0]);
+		Color start{max};
+		Color end{min};
+
+		std::array<std::uint8_t, 2> bestValues{};
+		Indices						bestIndices{};
+		float						bestError = (std::numeric_limits<float>::max)();
+		for (std::size_t iteration = 0; iteration < refineIterations; ++iteration)
+		{
+			// The first value has to be the larger one for that mode, equal ones make every index the first value
+			std::array<std::uint8_t, 2> values = {static_cast<std::uint8_t>(Quantize(start[0], 255)),
+												  static_cast<std::uint8_t>(Quantize(end[0], 255))};
+			if (values[0] < values[1])
+			{
+				std::swap(values[0], values[1]);
+				std::swap(start, end);
+			}
+
+			Palette palette{};
+			palette[0][0] = values[0];
+			palette[1][0] = values[1];
+			for (std::size_t index = 2; index < 8; ++index)
+			{
+				palette[index][0] = ((8.0f - index) * values[0] + (index - 1.0f) * values[1]) / 7.0f;
+			}
+
+			Indices		indices;
+			const float error = SelectIndices(block, palette, values[0] == values[1] ? 1 : 8, 1, indices);
+			if (error < bestError)
+			{
+				bestValues	= values;
+				bestIndices = indices;
+				bestError	= error;
+			}
+
+			Weights weights;
+			for (std::size_t texel = 0; texel < blockTexels; ++texel)
+			{
+				weights[texel] = weightsByIndex[indices[texel]];
+			}
+			if (error == 0.0f || values[0] == values[1] || RefineEndpoints(block, 1, weights, start, end) == false)
+			{
+				break;
+			}
+		}
+
+		std::uint64_t packedIndices = 0;
+		for (std::size_t texel = 0; texel < blockTexels; ++texel)
+		{
+			packedIndices |= static_cast<std::uint64_t>(bestIndices[texel]) << (texel * 3);
+		}
+
+		outBlock[0] = bestValues[0];
+		outBlock[1] = bestValues[1];
+		for (std::size_t byte = 0; byte < 6; ++byte)
+		{
+			outBlock[2 + byte] = static_cast<std::uint8_t>(packedIndices >> (byte * 8));
+		}
+	}
+
+	// Fills a block from its least significant bit up
+	class BitWriter
+	{
+	public:
+		explicit BitWriter(std::uint8_t* outBlock, std::size_t size) : outBlock_(outBlock)
+		{
+			std::memset(outBlock_, 0, size);
+		}
+
+		void Write(std::uint32_t value, std::uint32_t bitCount)
+		{
+			for (std::uint32_t bit = 0; bit < bitCount; ++bit, ++position_)
+			{
+				outBlock_[position_ / 8] |= static_cast<std::uint8_t>((value >> bit & 1) << (position_ % 8));
+			}
+		}
+
+	private:
+		std::uint8_t* outBlock_;
+		std::uint32_t position_ = 0;
+	};
+
+	struct BC7Endpoints
+	{
+		std::array<std::array<std::uint32_t, 4>, 2> quantized{};
+		std::array<std::uint32_t, 2>				pBits{};
+	};
+
+	/**
+	 * Fits the endpoints of a BC7 index set to the first channelCount channels of the block
+	 * @param endpointBits per channel, without the p-bit
+	 * @param weights of the second endpoint by index, out of 64
+	 * @return the squared error
+	 */
+	float FitBC7Endpoints(const Block&					  block,
+						  std::size_t					  channelCount,
+						  std::uint32_t					  endpointBits,
+						  bool							  hasPBits,
+						  std::span<const std::uint32_t> weights,
+						  BC7Endpoints&					  outEndpoints,
+						  Indices&						  outIndices)
+	{
+		const std::uint32_t bits	 = endpointBits + (hasPBits ? 1 : 0);
+		const auto			maxValue = static_cast<float>((1u << bits) - 1);
+
+		Color start, end;
+		FitPrincipalAxis(block, channelCount, start, end);
+
+		float bestError = (std::numeric_limits<float>::max)();
+		for (std::size_t iteration = 0; iteration < refineIterations; ++iteration)
+		{
+			// The p-bits are the endpoints' shared least significant bit, every combination gets a try
+			Indices iterationIndices{};
+			float	iterationError = (std::numeric_limits<float>::max)();
+			for (std::uint32_t pBits = 0; pBits < (hasPBits ? 4u : 1u); ++pBits)
+			{
+				BC7Endpoints endpoints;
+				endpoints.pBits = {pBits & 1, pBits >> 1};
+
+				std::array<Color, 2> decoded{};
+				for (std::size_t endpoint = 0; endpoint < 2; ++endpoint)
+				{
+					const Color&		color = endpoint == 0 ? start : end;
+					const std::uint32_t pBit  = endpoints.pBits[endpoint];
+					for (std::size_t channel = 0; channel < channelCount; ++channel)
+					{
+						const float scaled = color[channel] * maxValue / 255.0f - static_cast<float>(pBit);
+						const auto	quantized =
+							std::clamp(std::lround(hasPBits ? scaled / 2.0f : scaled), 0l, (1l << endpointBits) - 1);
+
+						// Decoders expand to 8 bits by repeating the top bits
+						const std::uint32_t value = static_cast<std::uint32_t>(quantized) << (hasPBits ? 1 : 0) | pBit;
+						endpoints.quantized[endpoint][channel] = static_cast<std::uint32_t>(quantized);
+						decoded[endpoint][channel] = static_cast<float>(value << (8 - bits) | value >> (2 * bits - 8));
+					}
+				}
+
+				Palette palette{};
+				for (std::size_t index = 0; index < weights.size(); ++index)
+				{
+					for (std::size_t channel = 0; channel < channelCount; ++channel)
+					{
+						const auto value0 = static_cast<std::uint32_t>(decoded[0][channel]);
+						const auto value1 = static_cast<std::uint32_t>(decoded[1][channel]);
+						palette[index][channel] =
+							static_cast<float>(((64 - weights[index]) * value0 + weights[index] * value1 + 32) >> 6);
+					}
+				}
+
+				Indices		indices;
+				const float error = SelectIndices(block, palette, weights.size(), channelCount, indices);
+				if (error < iterationError)
+				{
+					iterationIndices = indices;
+					iterationError	 = error;
+				}
+				if (error < bestError)
+				{
+					outEndpoints = endpoints;
+					outIndices	 = indices;
+					bestError	 = error;
+				}
+			}
+
+			Weights texelWeights;
+			for (std::size_t texel = 0; texel < blockTexels; ++texel)
+			{
+				texelWeights[texel] = static_cast<float>(weights[iterationIndices[texel]]) / 64.0f;
+			}
+			if (iterationError == 0.0f || RefineEndpoints(block, channelCount, texelWeights, start, end) == false)
+			{
+				break;
+			}
+		}
+
+		// The first texel's index is stored without its top bit, which has to be 0
+		if (outIndices[0] >= weights.size() / 2)
+		{
+			std::swap(outEndpoints.quantized[0], outEndpoints.quantized[1]);
+			std::swap(outEndpoints.pBits[0], outEndpoints.pBits[1]);
+			for (std::uint8_t& index : outIndices)
+			{
+				index = static_cast<std::uint8_t>(weights.size() - 1 - index);
+			}
+		}
+		return bestError;
+	}
+
+	/**
+	 * Mode 6 for blocks whose channels change together, a single index set for RGBA with 16 palette entries. Mode 5
+	 * for the ones with a channel that does its own thing, like the separate maps of ARM textures. That one gets
+	 * rotated into alpha, which has an index set of its own, the rest get 4 palette entries
+	 */
+	void EncodeBC7(const Block& block, std::uint8_t* outBlock)
+	{
+		static constexpr std::array<std::uint32_t, 4>  weights2 = {0, 21, 43, 64};
+		static constexpr std::array<std::uint32_t, 16> weights4 = {
+			0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+		BC7Endpoints endpoints;
+		Indices		 indices;
+		const float	 error = FitBC7Endpoints(block, 4, 7, true, weights4, endpoints, indices);
+
+		BC7Endpoints bestColorEndpoints, bestAlphaEndpoints;
+		Indices		 bestColorIndices, bestAlphaIndices;
+		float		 bestRotatedError = error;
+		std::size_t	 bestRotation	  = 0;
+		for (std::size_t rotation = 0; rotation < 4 && error > 0.0f; ++rotation)
+		{
+			// Rotation n swaps alpha with the channel before n, once decoded
+			Block rotated = block;
+			if (rotation > 0)
+			{
+				std::swap(rotated.channels[3], rotated.channels[rotation - 1]);
+			}
+
+			Block alpha;
+			alpha.channels[0] = rotated.channels[3];
+
+			BC7Endpoints colorEndpoints, alphaEndpoints;
+			Indices		 colorIndices, alphaIndices;
+			const float	 rotatedError = FitBC7Endpoints(rotated, 3, 7, false, weights2, colorEndpoints, colorIndices)
+									 + FitBC7Endpoints(alpha, 1, 8, false, weights2, alphaEndpoints, alphaIndices);
+			if (rotatedError < bestRotatedError)
+			{
+				bestColorEndpoints = colorEndpoints;
+				bestAlphaEndpoints = alphaEndpoints;
+				bestColorIndices   = colorIndices;
+				bestAlphaIndices   = alphaIndices;
+				bestRotatedError   = rotatedError;
+				bestRotation	   = rotation + 1;
+			}
+		}
+
+		BitWriter writer(outBlock, 16);
+		if (bestRotation == 0)
+		{
+			writer.Write(1 << 6, 7);
+			for (std::size_t channel = 0; channel < 4; ++channel)
+			{
+				writer.Write(endpoints.quantized[0][channel], 7);
+				writer.Write(endpoints.quantized[1][channel], 7);
+			}
+			writer.Write(endpoints.pBits[0], 1);
+			writer.Write(endpoints.pBits[1], 1);
+			for (std::size_t texel = 0; texel < blockTexels; ++texel)
+			{
+				writer.Write(indices[texel], texel == 0 ? 3 : 4);
+			}
+			return;
+		}
+
+		writer.Write(1 << 5, 6);
+		writer.Write(static_cast<std::uint32_t>(bestRotation - 1), 2);
+		for (std::size_t channel = 0; channel < 3; ++channel)
+		{
+			writer.Write(bestColorEndpoints.quantized[0][channel], 7);
+			writer.Write(bestColorEndpoints.quantized[1][channel], 7);
+		}
+		writer.Write(bestAlphaEndpoints.quantized[0][0], 8);
+		writer.Write(bestAlphaEndpoints.quantized[1][0], 8);
+		for (const Indices& indexSet : {bestColorIndices, bestAlphaIndices})
+		{
+			for (std::size_t texel = 0; texel < blockTexels; ++texel)
+			{
+				writer.Write(indexSet[texel], texel == 0 ? 1 : 2);
+			}
+		}
+	}
+} // namespace
+
+std::size_t TextureCompression::GetBlockSize(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+		case DXGI_FORMAT_BC4_UNORM:
+			return 8;
+		case DXGI_FORMAT_BC5_UNORM:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+void TextureCompression::Compress(DXGI_FORMAT					format,
+								  std::span<const std::uint8_t> rgba,
+								  std::uint32_t					width,
+								  std::uint32_t					height,
+								  std::vector<std::uint8_t>&	outData)
+{
+	const std::size_t blockSize = GetBlockSize(format);
+	assert(blockSize != 0 && width > 0 && height > 0 && rgba.size() == std::size_t{width} * height * 4);
+
+	const std::uint32_t blocksX = (width + 3) / 4;
+	const std::uint32_t blocksY = (height + 3) / 4;
+
+	std::size_t offset = outData.size();
+	outData.resize(offset + std::size_t{blocksX} * blocksY * blockSize);
+
+	for (std::uint32_t blockY = 0; blockY < blocksY; ++blockY)
+	{
+		for (std::uint32_t blockX = 0; blockX < blocksX; ++blockX, offset += blockSize)
+		{
+			std::uint8_t* outBlock = outData.data() + offset;
+			switch (format)
+			{
+				case DXGI_FORMAT_BC1_UNORM:
+				case DXGI_FORMAT_BC1_UNORM_SRGB:
+					EncodeBC1(LoadBlock(rgba, width, height, blockX, blockY, 0, 3), outBlock);
+					break;
+				case DXGI_FORMAT_BC4_UNORM:
+					EncodeBC4(LoadBlock(rgba, width, height, blockX, blockY, 0, 1), outBlock);
+					break;
+				case DXGI_FORMAT_BC5_UNORM:
+					EncodeBC4(LoadBlock(rgba, width, height, blockX, blockY, 0, 1), outBlock);
+					EncodeBC4(LoadBlock(rgba, width, height, blockX, blockY, 1, 1), outBlock + 8);
+					break;
+				case DXGI_FORMAT_BC7_UNORM:
+				case DXGI_FORMAT_BC7_UNORM_SRGB:
+					EncodeBC7(LoadBlock(rgba, width, height, blockX, blockY, 0, 4), outBlock);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+}
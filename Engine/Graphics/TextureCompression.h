@@ -0,0 +1,30 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <d3d11.h>
+#include <span>
+#include <vector>
+
+/**
+ * CPU encoders for the block compressed formats the texture pack stores its textures in. BC1 for RGB, BC4 for a
+ * single channel, BC5 for two and BC7 for RGBA, the latter only in the single subset modes 5 and 6. The sRGB variants
+ * get encoded in sRGB space, the same way their blocks get decoded
+ */
+namespace TextureCompression
+{
+	/**
+	 * @return bytes of a single 4x4 block, 0 if the format isn't one Compress handles
+	 */
+	[[nodiscard]] std::size_t GetBlockSize(DXGI_FORMAT format);
+
+	/**
+	 * Images that don't fill their last blocks, like the smallest mips, get their edge texels repeated
+	 * @param rgba width * height texels, 4 channels each. BC1 ignores alpha, BC4 only keeps red and BC5 red and green
+	 * @param outData gets the blocks appended, row by row
+	 */
+	void Compress(DXGI_FORMAT					format,
+				  std::span<const std::uint8_t> rgba,
+				  std::uint32_t					width,
+				  std::uint32_t					height,
+				  std::vector<std::uint8_t>&	outData);
+} // namespace TextureCompression
@@ -1,21 +1,33 @@
-﻿#define STB_IMAGE_IMPLEMENTATION
-#include "TextureManager.h"
+﻿#include "TextureManager.h"
 
+#include <algorithm>
 #include <array>
 #include <iostream>
-#include <unordered_set>
+#include <thread>
 
-#include "../Utils/ThirdParty/stb_image.h"
-#include "../World/BlockData.h"
+#include "../Core/Metrics.h"
+#include "../Core/Timer.h"
 #include "../World/BlockDatabase.h"
+#include "TexturePacker.h"
+
+namespace
+{
+	Metrics::Counter packRebuilds("Textures.PackRebuilds");
+	Metrics::Gauge	 textureLayers("Textures.Layers");
+	Metrics::Gauge	 textureBytes("Textures.Bytes"); // of every texture array, mips included
+	Metrics::Gauge	 materialCount("Textures.Materials");
+	Metrics::Gauge	 loadMicroseconds("Textures.LoadMicroseconds"); // pack rebuild included, if there was one
+} // namespace
 
 bool TextureManager::Initialize(Microsoft::WRL::ComPtr<ID3D11Device>		device,
 								Microsoft::WRL::ComPtr<ID3D11DeviceContext> context,
-								const std::filesystem::path&				baseAssetPath)
+								const std::filesystem::path&				baseAssetPath,
+								const std::filesystem::path&				packPath)
 {
 	device_		   = device;
 	context_	   = context;
 	baseAssetPath_ = baseAssetPath;
+	packPath_	   = packPath;
 
 #ifdef _DEBUG
 	// print current working dir
@@ -25,6 +37,41 @@ bool TextureManager::Initialize(Microsoft::WRL::ComPtr<ID3D11Device>		device,
 	return PopulateTextureArrays();
 }
 
+bool TextureManager::BuildTexturePack(const std::filesystem::path& baseAssetPath, const std::filesystem::path& packPath)
+{
+	const std::uint32_t maxThreadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+	// Packs once per thread count up to all of them to show how loading the textures scales, the last one gets written
+	TexturePack::Contents contents;
+	for (std::uint32_t threadCount = 1;; threadCount = (std::min)(threadCount * 2, maxThreadCount))
+	{
+		Timer perfCounter;
+		perfCounter.Reset();
+
+		TexturePacker packer(baseAssetPath, threadCount);
+		contents = packer.Pack(BlockDatabase::GetDatabase());
+
+		perfCounter.TickUncapped();
+		std::cout << "Loading textures on " << threadCount << " threads took: " << perfCounter.GetDeltaTime() * 1000.0f
+				  << " ms" << std::endl;
+
+		if (threadCount == maxThreadCount)
+		{
+			break;
+		}
+	}
+
+	std::vector<std::uint8_t> packData;
+	TexturePack::Serialize(contents, packData);
+
+	if (TexturePack::Write(packPath, packData) == false)
+	{
+		std::cerr << "Failed to write texture pack " << packPath.string() << "!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
 ID3D11Texture2D* TextureManager::GetTextureArray(TextureType usage)
 {
 	switch (usage)
@@ -65,297 +112,134 @@ ID3D11ShaderResourceView* TextureManager::GetTextureSRV(TextureType usage)
 
 bool TextureManager::PopulateTextureArrays()
 {
-	namespace fs = std::filesystem;
-
-	// Ensure the texture buffers are clear
-	albedoRawTextures_.clear();
-	normalRawTextures_.clear();
-	ARMRawTextures_.clear();
-	heightRawTextures_.clear();
-	emissiveRawTextures_.clear();
-
-	albedoPathToIndex_.clear();
-	normalPathToIndex_.clear();
-	ARMPathToIndex_.clear();
-	heightPathToIndex_.clear();
-	emissivePathToIndex_.clear();
-
-	// Create and add the default textures
-	albedoRawTextures_.push_back(GenerateDefaultAlbedo());
-	normalRawTextures_.push_back(GenerateDefaultNormal());
-	ARMRawTextures_.push_back(GenerateDefaultARM());
-	heightRawTextures_.push_back(GenerateDefaultHeightmap());
-	emissiveRawTextures_.push_back(GenerateDefaultEmissive());
-
-	static constexpr auto default_albedo	= "DEFAULT_ALBEDO";
-	static constexpr auto default_normal	= "DEFAULT_NORMAL";
-	static constexpr auto default_ARM		= "DEFAULT_ARM";
-	static constexpr auto default_heightmap = "DEFAULT_HEIGHTMAP";
-	static constexpr auto default_emissive	= "DEFAULT_EMISSIVE";
-
-	// clang-format off
-	albedoPathToIndex_[default_albedo]	  = 0;
-	normalPathToIndex_[default_normal]	  = 0;
-	ARMPathToIndex_[default_ARM]		      = 0;
-	heightPathToIndex_[default_heightmap]  = 0;
-	emissivePathToIndex_[default_emissive] = 0;
-	// clang-format on
-
-	auto ResolvePath = [&](const std::string& blockName,
-						   const std::string& suffix,
-						   const std::string& faceInfo,
-						   const fs::path&	  fallback) -> fs::path
+	BlockDatabase&		blockDatabase = BlockDatabase::GetDatabase();
+	const std::uint64_t sourceStamp	  = TexturePacker::GetSourceStamp(baseAssetPath_, blockDatabase);
+
+	// Only holds anything if the pack had to be rebuilt, the pack's views point into it then
+	std::vector<std::uint8_t> packData;
+
+	Timer loadTimer;
+	loadTimer.Reset();
+
+	TexturePack pack;
+	if (pack.Open(packPath_, sourceStamp) == false)
 	{
-		// Trying specific path first
-		fs::path specific = baseAssetPath_ / (blockName + "_" + faceInfo + "_" + suffix + ".png");
-		if (fs::exists(specific))
-		{
-			return specific;
-		}
+		std::cout << "Texture pack " << packPath_.string() << " is missing or out of date, rebuilding it" << std::endl;
 
-		// Try generic side
-		if (faceInfo == "north" || faceInfo == "south" || faceInfo == "west" || faceInfo == "east")
-		{
-			fs::path genericSide = baseAssetPath_ / (blockName + "_side_" + suffix + ".png");
-			if (fs::exists(genericSide))
-			{
-				return genericSide;
-			}
-		}
+		packRebuilds.Add();
 
-		// Try generic
-		fs::path generic = baseAssetPath_ / (blockName + "_" + suffix + ".png");
-		if (fs::exists(generic))
-		{
-			return generic;
-		}
+		Timer perfCounter;
+		perfCounter.Reset();
 
-		// If all else fails, return fallback (most likely a "missing texture" kind of texture
-		return fallback;
-	};
+		TexturePacker packer(baseAssetPath_);
+		TexturePack::Serialize(packer.Pack(blockDatabase), packData);
 
-	std::array faceNames	 = {"north", "south", "west", "east", "top", "bottom"};
-	auto&	   blockDatabase = BlockDatabase::GetDatabase();
+		perfCounter.TickUncapped();
+		std::cout << "Loading textures took: " << perfCounter.GetDeltaTime() * 1000.0f << " ms" << std::endl;
 
-	for (std::size_t idx = static_cast<std::size_t>(BlockType::Dirt);
-		 idx < static_cast<std::size_t>(BlockType::MAX_BLOCKS_);
-		 ++idx)
-	{
-		BlockType  blockType = static_cast<BlockType>(idx);
-		BlockData* blockData = blockDatabase.GetMutableBlockData(blockType);
-		assert(blockData != nullptr);
+		// Only costs the next startup a rebuild
+		if (TexturePack::Write(packPath_, packData) == false)
+		{
+			std::cerr << "Failed to write texture pack " << packPath_.string() << "!" << std::endl;
+		}
 
-		for (std::uint8_t faceIdx = 0; faceIdx < 6; ++faceIdx)
+		if (pack.Read(packData, sourceStamp) == false)
 		{
-			fs::path albedoPath = ResolvePath(blockData->blockName, "basecolor", faceNames[faceIdx], default_albedo);
-
-			fs::path normalPath = ResolvePath(blockData->blockName, "normal", faceNames[faceIdx], default_normal);
-
-			fs::path ARMPath = ResolvePath(blockData->blockName, "ARM", faceNames[faceIdx], default_ARM);
-
-			fs::path heightPath = ResolvePath(blockData->blockName, "heightmap", faceNames[faceIdx], default_heightmap);
-			fs::path emissivePath = ResolvePath(blockData->blockName, "emissive", faceNames[faceIdx], default_emissive);
-
-			std::size_t albedoIndex	   = GetOrLoadTexture(albedoPath, TextureType::Albedo);
-			std::size_t normalIndex	   = GetOrLoadTexture(normalPath, TextureType::Normal);
-			std::size_t ARMIndex	   = GetOrLoadTexture(ARMPath, TextureType::ARM);
-			std::size_t heightmapIndex = GetOrLoadTexture(heightPath, TextureType::Heightmap);
-			std::size_t emissiveIndex  = GetOrLoadTexture(emissivePath, TextureType::Emissive);
-
-			std::string matKey = std::to_string(albedoIndex)
-							   + "|"
-							   + std::to_string(normalIndex)
-							   + "|"
-							   + std::to_string(ARMIndex)
-							   + "|"
-							   + std::to_string(heightmapIndex)
-							   + "|"
-							   + std::to_string(emissiveIndex);
-
-			std::size_t matID = 0;
-			if (materialCombinationCache_.contains(matKey))
-			{
-				// material with such specification already exists
-				matID = materialCombinationCache_[matKey];
-			}
-			else
-			{
-				matID = materialCacheEntries_.size();
-				materialCacheEntries_.emplace_back(static_cast<std::uint32_t>(albedoIndex),
-												   static_cast<std::uint32_t>(normalIndex),
-												   static_cast<std::uint32_t>(ARMIndex),
-												   static_cast<std::uint32_t>(heightmapIndex),
-												   static_cast<std::uint32_t>(emissiveIndex));
-
-				materialCombinationCache_[matKey] = matID;
-			}
-
-			blockData->textureIndices[faceIdx] = matID;
+			return false;
 		}
 	}
 
-	// now fill the buffers
-	bool didInitSucceed = CreateTextureArray(albedoRawTextures_,
-											 DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,
-											 albedoArray_,
-											 albedoSRV_);
+	bool didInitSucceed = CreateTextureArray(pack.GetTextureArray(TextureType::Albedo), albedoArray_, albedoSRV_);
 	if (didInitSucceed == false)
 	{
 		return false;
 	}
 
-	didInitSucceed = CreateTextureArray(normalRawTextures_, DXGI_FORMAT_R8G8B8A8_UNORM, normalArray_, normalSRV_);
+	didInitSucceed = CreateTextureArray(pack.GetTextureArray(TextureType::Normal), normalArray_, normalSRV_);
 	if (didInitSucceed == false)
 	{
 		return false;
 	}
 
-	didInitSucceed = CreateTextureArray(ARMRawTextures_, DXGI_FORMAT_R8G8B8A8_UNORM, ARMArray_, ARMSRV_);
+	didInitSucceed = CreateTextureArray(pack.GetTextureArray(TextureType::ARM), ARMArray_, ARMSRV_);
 	if (didInitSucceed == false)
 	{
 		return false;
 	}
 
-	didInitSucceed = CreateTextureArray(heightRawTextures_, DXGI_FORMAT_R8G8B8A8_UNORM, heightArray_, heightSRV_);
+	didInitSucceed = CreateTextureArray(pack.GetTextureArray(TextureType::Heightmap), heightArray_, heightSRV_);
 	if (didInitSucceed == false)
 	{
 		return false;
 	}
 
-	didInitSucceed = CreateTextureArray(emissiveRawTextures_,
-										DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,
-										emissiveArray_,
-										emissiveSRV_);
+	didInitSucceed = CreateTextureArray(pack.GetTextureArray(TextureType::Emissive), emissiveArray_, emissiveSRV_);
 	if (didInitSucceed == false)
 	{
 		return false;
 	}
 
-	didInitSucceed = CreateMaterialBuffer(materialCacheEntries_);
+	didInitSucceed = CreateMaterialBuffer(pack.GetMaterials());
 	if (didInitSucceed == false)
 	{
 		return false;
 	}
-	return true;
-}
-
-std::size_t TextureManager::GetOrLoadTexture(const std::filesystem::path& texturePath, TextureType type)
-{
-	namespace fs = std::filesystem;
 
-	// Quick lambda to make sure the stbi_load image is freed
-	auto StbiLoadWrapper = [](const std::filesystem::path& path) -> RawTexture
+	for (const TexturePack::BlockMaterials& block : pack.GetBlocks())
 	{
-		int		   width, height, channels;
-		const auto data = stbi_load(path.string().c_str(), &width, &height, &channels, TEXTURE_COLOR_CHANNELS);
-		if (!data)
-		{
-			std::cerr << "Couldn't load texture from file: " << path << "\n" << "Reason: " << stbi_failure_reason();
-
-			return RawTexture{};
-		}
-
-		if (width != TEXTURE_RESOLUTION || height != TEXTURE_RESOLUTION)
+		for (const BlockFace face : ALL_BLOCKFACES)
 		{
-			std::cerr << "Texture " << path << " does not meet the requirements\n" << "Reason: ";
-			if (width != TEXTURE_RESOLUTION || height != TEXTURE_RESOLUTION)
-			{
-				std::cerr << " Invalid texture resolution";
-			}
-			std::cerr << std::endl;
-			return RawTexture{};
+			blockDatabase.SetFaceMaterial(block.type, face, block.faceMaterials[static_cast<std::size_t>(face)]);
 		}
-
-		std::vector<uint8_t> textureData(data, data + width * height * 4);
-		stbi_image_free(data);
-
-		return {std::move(textureData), width, height, channels};
-	};
-
-	// check if the texture even exists as a file
-	if (fs::exists(texturePath) == false)
-	{
-		return DEFAULT_TEXTURE_INDEX; // returns the default texture
-	}
-
-
-	std::vector<RawTexture>*				   rawTextureBuffer = nullptr;
-	std::unordered_map<fs::path, std::size_t>* pathToTextureMap = nullptr;
-
-	switch (type)
-	{
-		case TextureType::Albedo:
-			rawTextureBuffer = &albedoRawTextures_;
-			pathToTextureMap = &albedoPathToIndex_;
-			break;
-		case TextureType::Normal:
-			rawTextureBuffer = &normalRawTextures_;
-			pathToTextureMap = &normalPathToIndex_;
-			break;
-		case TextureType::ARM:
-			rawTextureBuffer = &ARMRawTextures_;
-			pathToTextureMap = &ARMPathToIndex_;
-			break;
-		case TextureType::Heightmap:
-			rawTextureBuffer = &heightRawTextures_;
-			pathToTextureMap = &heightPathToIndex_;
-			break;
-		case TextureType::Emissive:
-			rawTextureBuffer = &emissiveRawTextures_;
-			pathToTextureMap = &emissivePathToIndex_;
-			break;
-
-		default:
-			assert(false); // shouldn't ever happen
-	}
-
-
-	// check if the texture is already loaded
-	if (pathToTextureMap->contains(texturePath))
-	{
-		return pathToTextureMap->at(texturePath);
 	}
 
-	// Add new texture since it's not been loaded yet
-	RawTexture texture = StbiLoadWrapper(texturePath);
-
-	// If the texture failed to load for some reason/is invalid, return the index of the default texture
-	// Reasons will be printed in the console
-	if (texture.width == -1 || texture.height == -1 || texture.channels == -1 || texture.data.empty())
-	{
-		return DEFAULT_TEXTURE_INDEX;
-	}
-
-	std::size_t textureIndex = rawTextureBuffer->size();
-	rawTextureBuffer->push_back(std::move(texture));
-	pathToTextureMap->emplace(texturePath, textureIndex);
-
-	return textureIndex;
+	materialCount.Set(static_cast<std::int64_t>(pack.GetMaterials().size()));
+	loadTimer.TickUncapped();
+	loadMicroseconds.Set(static_cast<std::int64_t>(loadTimer.GetDeltaTime() * 1'000'000.0f));
+	return true;
 }
 
-bool TextureManager::CreateTextureArray(std::span<const RawTexture>						  textureData,
-										DXGI_FORMAT										  format,
+bool TextureManager::CreateTextureArray(const TexturePack::TextureArray&				  textures,
 										Microsoft::WRL::ComPtr<ID3D11Texture2D>&		  outTextureArray,
 										Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& outTextureSRV)
 {
 	D3D11_TEXTURE2D_DESC desc = {};
-	desc.Width				  = TEXTURE_RESOLUTION;
-	desc.Height				  = TEXTURE_RESOLUTION;
-	desc.MipLevels			  = 0;
-	desc.ArraySize			  = textureData.size();
-	desc.Format				  = format;
+	desc.Width				  = TexturePack::TEXTURE_RESOLUTION;
+	desc.Height				  = TexturePack::TEXTURE_RESOLUTION;
+	desc.MipLevels			  = TexturePack::MIP_COUNT;
+	desc.ArraySize			  = textures.layerCount;
+	desc.Format				  = textures.format;
 	desc.SampleDesc.Count	  = 1;
 	desc.SampleDesc.Quality	  = 0;
-	desc.Usage				  = D3D11_USAGE_DEFAULT;
-	desc.BindFlags			  = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	desc.Usage				  = D3D11_USAGE_IMMUTABLE;
+	desc.BindFlags			  = D3D11_BIND_SHADER_RESOURCE;
 	desc.CPUAccessFlags		  = 0;
-	desc.MiscFlags			  = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+	desc.MiscFlags			  = 0;
+
+	// Straight out of the pack, every layer's mips come one after another
+	std::vector<D3D11_SUBRESOURCE_DATA> initData(std::size_t{textures.layerCount} * TexturePack::MIP_COUNT);
+	std::size_t							offset = 0;
+	for (std::uint32_t layer = 0; layer < textures.layerCount; ++layer)
+	{
+		for (std::uint32_t mip = 0; mip < TexturePack::MIP_COUNT; ++mip)
+		{
+			D3D11_SUBRESOURCE_DATA& subresource = initData[D3D11CalcSubresource(mip, layer, TexturePack::MIP_COUNT)];
+			subresource.pSysMem					= textures.data.data() + offset;
+			subresource.SysMemPitch				= TexturePack::GetRowPitch(textures.format, mip);
+			subresource.SysMemSlicePitch		= 0;
+
+			offset += TexturePack::GetMipSize(textures.format, mip);
+		}
+	}
+	assert(offset == textures.data.size());
 
-	HRESULT result = device_->CreateTexture2D(&desc, nullptr, &outTextureArray);
+	HRESULT result = device_->CreateTexture2D(&desc, initData.data(), &outTextureArray);
 	if (FAILED(result))
 	{
 		return false;
 	}
+	textureLayers.Add(textures.layerCount);
+	textureBytes.Add(static_cast<std::int64_t>(textures.data.size()));
 
 	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 	srvDesc.Format							= desc.Format;
@@ -371,26 +255,6 @@ bool TextureManager::CreateTextureArray(std::span<const RawTexture>						  textu
 		return false;
 	}
 
-
-	// Check how many mips D3D is actually creating
-	outTextureArray->GetDesc(&desc);
-	const UINT mipsPerSlice = desc.MipLevels;
-
-	const UINT rowPitch = TEXTURE_COLOR_CHANNELS * TEXTURE_RESOLUTION;
-	for (std::size_t textureIdx = 0; textureIdx < textureData.size(); textureIdx++)
-	{
-		UINT subresourceIdx = D3D11CalcSubresource(0, textureIdx, mipsPerSlice);
-
-		context_->UpdateSubresource(outTextureArray.Get(),
-									subresourceIdx,
-									nullptr,
-									textureData[textureIdx].data.data(),
-									rowPitch,
-									0);
-	}
-
-	context_->GenerateMips(outTextureSRV.Get());
-
 	return true;
 }
 
@@ -427,124 +291,3 @@ bool TextureManager::CreateMaterialBuffer(std::span<const MaterialCacheEntry> ma
 
 	return true;
 }
-
-TextureManager::RawTexture TextureManager::GenerateDefaultTexture(const TextureType type)
-{
-	switch (type)
-	{
-		case TextureType::Albedo:
-			return GenerateDefaultAlbedo();
-		case TextureType::Normal:
-			return GenerateDefaultNormal();
-		case TextureType::ARM:
-			return GenerateDefaultARM();
-		case TextureType::Heightmap:
-			return GenerateDefaultHeightmap();
-		case TextureType::Emissive:
-			return GenerateDefaultEmissive();
-	}
-
-	// this will never happen but clang doesn't understand this for some reason
-	return {};
-}
-
-TextureManager::RawTexture TextureManager::GenerateDefaultAlbedo()
-{
-	std::vector<uint8_t> data(TEXTURE_COLOR_CHANNELS * TEXTURE_RESOLUTION * TEXTURE_RESOLUTION);
-	for (std::size_t idx = 0; idx < data.size(); idx += 4)
-	{
-		std::size_t pixelIdx = idx / TEXTURE_COLOR_CHANNELS;
-		std::size_t x		 = pixelIdx % TEXTURE_RESOLUTION;
-		std::size_t y		 = pixelIdx / TEXTURE_RESOLUTION;
-
-		// Checkerboard logic
-
-		const std::size_t denominator = 2;
-
-		bool isBlack = ((x / (TEXTURE_RESOLUTION / denominator)) + (y / (TEXTURE_RESOLUTION / denominator))) % 2 == 0;
-
-		if (isBlack)
-		{
-			data[idx]	  = 0;
-			data[idx + 1] = 0;
-			data[idx + 2] = 0;
-			data[idx + 3] = 255; // alpha always max
-		}
-		else
-		{
-			// Magenta
-			data[idx]	  = 255;
-			data[idx + 1] = 0;
-			data[idx + 2] = 255;
-			data[idx + 3] = 255;
-		}
-	}
-
-	return {.data	  = std::move(data),
-			.width	  = TEXTURE_RESOLUTION,
-			.height	  = TEXTURE_RESOLUTION,
-			.channels = TEXTURE_COLOR_CHANNELS};
-}
-
-TextureManager::RawTexture TextureManager::GenerateDefaultNormal()
-{
-	std::vector<uint8_t> data(TEXTURE_COLOR_CHANNELS * TEXTURE_RESOLUTION * TEXTURE_RESOLUTION);
-	for (std::size_t idx = 0; idx < data.size(); idx += 4)
-	{
-		// flat normal map
-		data[idx]	  = 128;
-		data[idx + 1] = 128;
-		data[idx + 2] = 255;
-		data[idx + 3] = 255;
-	}
-
-	return {.data	  = std::move(data),
-			.width	  = TEXTURE_RESOLUTION,
-			.height	  = TEXTURE_RESOLUTION,
-			.channels = TEXTURE_COLOR_CHANNELS};
-}
-
-TextureManager::RawTexture TextureManager::GenerateDefaultARM()
-{
-	std::vector<uint8_t> data(TEXTURE_COLOR_CHANNELS * TEXTURE_RESOLUTION * TEXTURE_RESOLUTION);
-	for (std::size_t idx = 0; idx < data.size(); idx += 4)
-	{
-		data[idx]	  = 255; // No AO
-		data[idx + 1] = 255; // Rough
-		data[idx + 2] = 0;	 // Non-metallic
-		data[idx + 3] = 255; // for now alpha is not really used
-	}
-
-	return {.data	  = std::move(data),
-			.width	  = TEXTURE_RESOLUTION,
-			.height	  = TEXTURE_RESOLUTION,
-			.channels = TEXTURE_COLOR_CHANNELS};
-}
-
-TextureManager::RawTexture TextureManager::GenerateDefaultHeightmap()
-{
-	std::vector<uint8_t> data(TEXTURE_COLOR_CHANNELS * TEXTURE_RESOLUTION * TEXTURE_RESOLUTION);
-	std::ranges::fill(data, 255);
-
-	return {.data	  = std::move(data),
-			.width	  = TEXTURE_RESOLUTION,
-			.height	  = TEXTURE_RESOLUTION,
-			.channels = TEXTURE_COLOR_CHANNELS};
-}
-TextureManager::RawTexture TextureManager::GenerateDefaultEmissive()
-{
-	std::vector<uint8_t> data(TEXTURE_COLOR_CHANNELS * TEXTURE_RESOLUTION * TEXTURE_RESOLUTION);
-	for (std::size_t idx = 0; idx < data.size(); idx += 4)
-	{
-		// default: non-emissive
-		data[idx]	  = 0;
-		data[idx + 1] = 0;
-		data[idx + 2] = 0;
-		data[idx + 3] = 255;
-	}
-
-	return {.data	  = std::move(data),
-			.width	  = TEXTURE_RESOLUTION,
-			.height	  = TEXTURE_RESOLUTION,
-			.channels = TEXTURE_COLOR_CHANNELS};
-}
@@ -2,45 +2,13 @@
 #include <d3d11.h>
 #include <filesystem>
 #include <span>
-#include <unordered_map>
 #include <wrl/client.h>
 
-#include "../World/BlockType.h"
-
-struct MaterialCacheEntry
-{
-	std::uint32_t albedoIndex;
-	std::uint32_t normalIndex;
-	std::uint32_t ARMIndex;
-	std::uint32_t heightmapIndex;
-	std::uint32_t emissiveIndex;
-};
-
-enum class TextureType
-{
-	Albedo,
-	Normal,
-	ARM,
-	Heightmap,
-	Emissive,
-};
+#include "Material.h"
+#include "TexturePack.h"
 
 class TextureManager
 {
-public:
-	static constexpr std::size_t  TEXTURE_RESOLUTION	 = 32;
-	static constexpr std::uint8_t TEXTURE_COLOR_CHANNELS = 4;
-	static constexpr std::size_t  DEFAULT_TEXTURE_INDEX	 = 0;
-
-private:
-	struct RawTexture
-	{
-		std::vector<std::uint8_t> data;
-		int						  width	   = -1;
-		int						  height   = -1;
-		int						  channels = -1;
-	};
-
 public:
 	TextureManager() = default;
 
@@ -49,9 +17,21 @@ public:
 	TextureManager& operator=(const TextureManager&) = delete;
 	TextureManager& operator=(TextureManager&&)		 = delete;
 
+	/**
+	 * Loads the textures of the blocks in BlockDatabase out of the texture pack, rebuilds the pack first if it's
+	 * missing or out of date with the textures
+	 * @param baseAssetPath directory of the source textures
+	 */
 	bool Initialize(Microsoft::WRL::ComPtr<ID3D11Device>		device,
 					Microsoft::WRL::ComPtr<ID3D11DeviceContext> context,
-					const std::filesystem::path&				baseAssetPath);
+					const std::filesystem::path&				baseAssetPath,
+					const std::filesystem::path&				packPath);
+
+	/**
+	 * What Initialize does when the pack is stale, without needing a device. For building the pack offline, the
+	 * blocks have to be loaded already
+	 */
+	static bool BuildTexturePack(const std::filesystem::path& baseAssetPath, const std::filesystem::path& packPath);
 
 	ID3D11Texture2D*		  GetTextureArray(TextureType usage);
 	ID3D11ShaderResourceView* GetTextureSRV(TextureType usage);
@@ -59,29 +39,12 @@ public:
 private:
 	bool PopulateTextureArrays();
 
-	/**
-	 *
-	 * @param texturePath the path to the texture
-	 * @param type the type of the texture (currently supported: Albedo, Normal and ARM)
-	 * @return the index of the texture in the raw textures vector (up to the programmer to determine which one that is,
-	 * based on the "type" paramter provided)
-	 */
-	std::size_t GetOrLoadTexture(const std::filesystem::path& texturePath, TextureType type);
-
-	bool CreateTextureArray(std::span<const RawTexture>						  textureData,
-							DXGI_FORMAT										  format,
+	bool CreateTextureArray(const TexturePack::TextureArray&				  textures,
 							Microsoft::WRL::ComPtr<ID3D11Texture2D>&		  outTextureArray,
 							Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& outTextureSRV);
 
 	bool CreateMaterialBuffer(std::span<const MaterialCacheEntry> materialList);
 
-	static RawTexture GenerateDefaultTexture(TextureType type);
-	static RawTexture GenerateDefaultAlbedo();
-	static RawTexture GenerateDefaultNormal();
-	static RawTexture GenerateDefaultARM();
-	static RawTexture GenerateDefaultHeightmap();
-	static RawTexture GenerateDefaultEmissive();
-
 	Microsoft::WRL::ComPtr<ID3D11Device>		device_;
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context_;
 
@@ -100,24 +63,8 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11Buffer>			 materialBuffer_;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> materialBufferSRV_;
 
-	std::vector<RawTexture> albedoRawTextures_;
-	std::vector<RawTexture> normalRawTextures_;
-	std::vector<RawTexture> ARMRawTextures_;
-	std::vector<RawTexture> heightRawTextures_;
-	std::vector<RawTexture> emissiveRawTextures_;
-
-	std::unordered_map<std::filesystem::path, std::size_t> albedoPathToIndex_;
-	std::unordered_map<std::filesystem::path, std::size_t> normalPathToIndex_;
-	std::unordered_map<std::filesystem::path, std::size_t> ARMPathToIndex_;
-	std::unordered_map<std::filesystem::path, std::size_t> heightPathToIndex_;
-	std::unordered_map<std::filesystem::path, std::size_t> emissivePathToIndex_;
-
-	// for debug lookup
-	std::vector<MaterialCacheEntry>				 materialCacheEntries_;
-	std::unordered_map<std::string, std::size_t> materialCombinationCache_;
-
-	std::filesystem::path					   baseAssetPath_;
-	std::unordered_map<BlockType, std::size_t> textureZs;
+	std::filesystem::path baseAssetPath_;
+	std::filesystem::path packPath_;
 
 public:
 	ID3D11ShaderResourceView* GetMaterialBufferSRV() const { return materialBufferSRV_.Get(); }
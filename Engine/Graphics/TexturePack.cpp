@@ -0,0 +1,306 @@
+﻿#include "TexturePack.h"
+
+#include <algorithm>
+#include <cassert>
+#include <system_error>
+
+#include "TextureCompression.h"
+
+namespace
+{
+	namespace fs = std::filesystem;
+
+	constexpr std::uint32_t packMagic	= 0x4b505854; // "TXPK"
+	constexpr std::uint32_t packVersion = 2;
+
+	// magic, version, source stamp, resolution, mip count, material count, block count, formats, layer counts
+	constexpr std::size_t headerSize = 4 + 4 + 8 + 4 + 4 + 4 + 4 + 4 * TEXTURE_TYPE_COUNT + 4 * TEXTURE_TYPE_COUNT;
+	// albedo, normal, ARM, heightmap, emissive
+	constexpr std::size_t materialSize = 4 * 5;
+	// type, face materials
+	constexpr std::size_t blockSize = 4 + 4 * 6;
+
+	// Sections start on this, so the texture data is aligned for whatever the upload copies it with
+	constexpr std::size_t sectionAlignment = 16;
+
+	// Stored little-endian regardless of the platform
+	template <typename T>
+	void Store(std::vector<std::uint8_t>& out, T value)
+	{
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+		{
+			out.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+		}
+	}
+
+	template <typename T>
+	T Load(const std::uint8_t* data)
+	{
+		T value = 0;
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+		{
+			value |= static_cast<T>(data[i]) << (i * 8);
+		}
+		return value;
+	}
+
+	std::size_t Align(std::size_t offset)
+	{
+		return (offset + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+	}
+
+	struct Layout
+	{
+		std::array<std::size_t, TEXTURE_TYPE_COUNT> textureOffsets;
+		std::size_t									materialOffset;
+		std::size_t									blockOffset;
+		std::size_t									size;
+	};
+
+	Layout GetLayout(std::span<const DXGI_FORMAT, TEXTURE_TYPE_COUNT>	formats,
+					 std::span<const std::uint32_t, TEXTURE_TYPE_COUNT> layerCounts,
+					 std::size_t										materialCount,
+					 std::size_t										blockCount)
+	{
+		Layout		layout;
+		std::size_t offset = headerSize;
+		for (std::size_t type = 0; type < TEXTURE_TYPE_COUNT; ++type)
+		{
+			layout.textureOffsets[type] = Align(offset);
+			offset = layout.textureOffsets[type] + TexturePack::GetLayerSize(formats[type]) * layerCounts[type];
+		}
+
+		layout.materialOffset = Align(offset);
+		layout.blockOffset	  = layout.materialOffset + materialCount * materialSize;
+		layout.size			  = layout.blockOffset + blockCount * blockSize;
+		return layout;
+	}
+} // namespace
+
+std::size_t TexturePack::GetMipSize(DXGI_FORMAT format, std::uint32_t mip)
+{
+	const std::uint32_t size = (std::max)(TEXTURE_RESOLUTION >> mip, 1u);
+	switch (format)
+	{
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+			return std::size_t{size} * size * 4;
+		default:
+		{
+			// Mips smaller than a block still take up a whole one
+			const std::size_t blocks = (size + 3) / 4;
+			return blocks * blocks * TextureCompression::GetBlockSize(format);
+		}
+	}
+}
+
+std::uint32_t TexturePack::GetRowPitch(DXGI_FORMAT format, std::uint32_t mip)
+{
+	// A row of blocks for the block compressed formats
+	const std::uint32_t size = (std::max)(TEXTURE_RESOLUTION >> mip, 1u);
+	const std::size_t	rows = TextureCompression::GetBlockSize(format) != 0 ? (size + 3) / 4 : size;
+	return static_cast<std::uint32_t>(GetMipSize(format, mip) / rows);
+}
+
+std::size_t TexturePack::GetLayerSize(DXGI_FORMAT format)
+{
+	std::size_t size = 0;
+	for (std::uint32_t mip = 0; mip < MIP_COUNT; ++mip)
+	{
+		size += GetMipSize(format, mip);
+	}
+	return size;
+}
+
+void TexturePack::Serialize(const Contents& contents, std::vector<std::uint8_t>& outData)
+{
+	const Layout layout = GetLayout(contents.formats,
+									contents.layerCounts,
+									contents.materials.size(),
+									contents.blocks.size());
+
+	const std::size_t start = outData.size();
+	outData.reserve(start + layout.size);
+
+	Store(outData, packMagic);
+	Store(outData, packVersion);
+	Store(outData, contents.sourceStamp);
+	Store(outData, TEXTURE_RESOLUTION);
+	Store(outData, MIP_COUNT);
+	Store(outData, static_cast<std::uint32_t>(contents.materials.size()));
+	Store(outData, static_cast<std::uint32_t>(contents.blocks.size()));
+	for (const DXGI_FORMAT format : contents.formats)
+	{
+		Store(outData, static_cast<std::uint32_t>(format));
+	}
+	for (const std::uint32_t layerCount : contents.layerCounts)
+	{
+		Store(outData, layerCount);
+	}
+
+	for (std::size_t type = 0; type < TEXTURE_TYPE_COUNT; ++type)
+	{
+		assert(contents.textures[type].size() == GetLayerSize(contents.formats[type]) * contents.layerCounts[type]);
+		outData.resize(start + layout.textureOffsets[type]);
+		outData.insert(outData.end(), contents.textures[type].begin(), contents.textures[type].end());
+	}
+
+	outData.resize(start + layout.materialOffset);
+	for (const MaterialCacheEntry& material : contents.materials)
+	{
+		Store(outData, material.albedoIndex);
+		Store(outData, material.normalIndex);
+		Store(outData, material.ARMIndex);
+		Store(outData, material.heightmapIndex);
+		Store(outData, material.emissiveIndex);
+	}
+
+	for (const BlockMaterials& block : contents.blocks)
+	{
+		Store(outData, static_cast<std::uint32_t>(block.type));
+		for (const std::uint32_t material : block.faceMaterials)
+		{
+			Store(outData, material);
+		}
+	}
+}
+
+bool TexturePack::Write(const std::filesystem::path& path, std::span<const std::uint8_t> data)
+{
+	// Written next to the pack first, so a crash halfway through can't leave a torn pack behind
+	fs::path		temporaryPath = path;
+	std::error_code error;
+	temporaryPath += ".tmp";
+	fs::remove(temporaryPath, error);
+	{
+		MappedFile file;
+		if (file.Open(temporaryPath) == false || file.Write(0, data) == false || file.Flush() == false)
+		{
+			return false;
+		}
+	}
+
+	fs::rename(temporaryPath, path, error);
+	return !error;
+}
+
+bool TexturePack::Open(const std::filesystem::path& path, std::uint64_t sourceStamp)
+{
+	Close();
+
+	// Opening the file would create it
+	std::error_code error;
+	if (fs::exists(path, error) == false || file_.Open(path) == false)
+	{
+		return false;
+	}
+
+	if (Read(file_.Map(), sourceStamp) == false)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+bool TexturePack::Read(std::span<const std::uint8_t> data, std::uint64_t sourceStamp)
+{
+	textureArrays_ = {};
+	materials_.clear();
+	blocks_.clear();
+
+	if (data.size() < headerSize)
+	{
+		return false;
+	}
+
+	const std::uint8_t* header		  = data.data();
+	const auto			materialCount = Load<std::uint32_t>(header + 24);
+	const auto			blockCount	  = Load<std::uint32_t>(header + 28);
+	if (Load<std::uint32_t>(header) != packMagic
+		|| Load<std::uint32_t>(header + 4) != packVersion
+		|| Load<std::uint64_t>(header + 8) != sourceStamp
+		|| Load<std::uint32_t>(header + 16) != TEXTURE_RESOLUTION
+		|| Load<std::uint32_t>(header + 20) != MIP_COUNT
+		|| blockCount >= static_cast<std::uint32_t>(BlockType::MAX_BLOCKS_))
+	{
+		return false;
+	}
+
+	std::array<DXGI_FORMAT, TEXTURE_TYPE_COUNT>	  formats;
+	std::array<std::uint32_t, TEXTURE_TYPE_COUNT> layerCounts;
+	for (std::size_t type = 0; type < TEXTURE_TYPE_COUNT; ++type)
+	{
+		formats[type]	  = static_cast<DXGI_FORMAT>(Load<std::uint32_t>(header + 32 + type * 4));
+		layerCounts[type] = Load<std::uint32_t>(header + 32 + TEXTURE_TYPE_COUNT * 4 + type * 4);
+		if (GetLayerSize(formats[type]) == 0 || layerCounts[type] == 0 || layerCounts[type] > UINT16_MAX)
+		{
+			return false;
+		}
+	}
+
+	const Layout layout = GetLayout(formats, layerCounts, materialCount, blockCount);
+	if (data.size() != layout.size)
+	{
+		return false;
+	}
+
+	materials_.resize(materialCount);
+	for (std::size_t i = 0; i < materialCount; ++i)
+	{
+		const std::uint8_t* entry	 = data.data() + layout.materialOffset + i * materialSize;
+		MaterialCacheEntry& material = materials_[i];
+		material					 = {Load<std::uint32_t>(entry),
+										Load<std::uint32_t>(entry + 4),
+										Load<std::uint32_t>(entry + 8),
+										Load<std::uint32_t>(entry + 12),
+										Load<std::uint32_t>(entry + 16)};
+
+		if (material.albedoIndex >= layerCounts[static_cast<std::size_t>(TextureType::Albedo)]
+			|| material.normalIndex >= layerCounts[static_cast<std::size_t>(TextureType::Normal)]
+			|| material.ARMIndex >= layerCounts[static_cast<std::size_t>(TextureType::ARM)]
+			|| material.heightmapIndex >= layerCounts[static_cast<std::size_t>(TextureType::Heightmap)]
+			|| material.emissiveIndex >= layerCounts[static_cast<std::size_t>(TextureType::Emissive)])
+		{
+			return false;
+		}
+	}
+
+	blocks_.resize(blockCount);
+	for (std::size_t i = 0; i < blockCount; ++i)
+	{
+		const std::uint8_t* entry = data.data() + layout.blockOffset + i * blockSize;
+		BlockMaterials&		block = blocks_[i];
+
+		const auto type = Load<std::uint32_t>(entry);
+		if (type == 0 || type >= static_cast<std::uint32_t>(BlockType::MAX_BLOCKS_))
+		{
+			return false;
+		}
+
+		block.type = static_cast<BlockType>(type);
+		for (std::size_t face = 0; face < 6; ++face)
+		{
+			block.faceMaterials[face] = Load<std::uint32_t>(entry + 4 + face * 4);
+			if (block.faceMaterials[face] >= materialCount)
+			{
+				return false;
+			}
+		}
+	}
+
+	for (std::size_t type = 0; type < TEXTURE_TYPE_COUNT; ++type)
+	{
+		const std::size_t size = GetLayerSize(formats[type]) * layerCounts[type];
+		textureArrays_[type]   = {formats[type], layerCounts[type], data.subspan(layout.textureOffsets[type], size)};
+	}
+	return true;
+}
+
+void TexturePack::Close()
+{
+	textureArrays_ = {};
+	materials_.clear();
+	blocks_.clear();
+	file_.Close();
+}
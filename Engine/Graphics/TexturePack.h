@@ -0,0 +1,107 @@
+﻿#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <d3d11.h>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "../Utils/MappedFile.h"
+#include "../World/BlockType.h"
+#include "Material.h"
+
+/**
+ * Every block texture along with its whole mip chain, the material table and the material of every block face, laid
+ * out the way the GPU takes them so loading is a single mapping plus the upload. TexturePacker builds it from the
+ * source PNGs, it's stale once those or the blocks' textures change
+ */
+class TexturePack
+{
+public:
+	static constexpr std::uint32_t TEXTURE_RESOLUTION = 32;
+	static constexpr std::uint32_t MIP_COUNT		  = std::bit_width(TEXTURE_RESOLUTION);
+
+	struct BlockMaterials
+	{
+		BlockType					 type;
+		std::array<std::uint32_t, 6> faceMaterials; // by BlockFace, indices into the material table
+	};
+
+	// What TexturePacker fills in and Serialize lays out
+	struct Contents
+	{
+		std::uint64_t sourceStamp = 0; // see TexturePacker::GetSourceStamp
+
+		// Per TextureType. Layer after layer, each with its mips from the largest down
+		std::array<DXGI_FORMAT, TEXTURE_TYPE_COUNT>				  formats{};
+		std::array<std::uint32_t, TEXTURE_TYPE_COUNT>			  layerCounts{};
+		std::array<std::vector<std::uint8_t>, TEXTURE_TYPE_COUNT> textures;
+
+		std::vector<MaterialCacheEntry> materials;
+		std::vector<BlockMaterials>		blocks;
+	};
+
+	struct TextureArray
+	{
+		DXGI_FORMAT					  format	 = DXGI_FORMAT_UNKNOWN;
+		std::uint32_t				  layerCount = 0;
+		std::span<const std::uint8_t> data; // layer after layer, each with its mips from the largest down
+	};
+
+	TexturePack() = default;
+
+	TexturePack(const TexturePack&)			   = delete;
+	TexturePack(TexturePack&&)				   = delete;
+	TexturePack& operator=(const TexturePack&) = delete;
+	TexturePack& operator=(TexturePack&&)	   = delete;
+
+	/**
+	 * @return bytes of a single mip level of a single layer, 0 for formats packs can't hold, which is all but RGBA8
+	 * and the ones TextureCompression encodes
+	 */
+	[[nodiscard]] static std::size_t GetMipSize(DXGI_FORMAT format, std::uint32_t mip);
+
+	// What D3D11_SUBRESOURCE_DATA::SysMemPitch expects for the mip level
+	[[nodiscard]] static std::uint32_t GetRowPitch(DXGI_FORMAT format, std::uint32_t mip);
+
+	[[nodiscard]] static std::size_t GetLayerSize(DXGI_FORMAT format);
+
+	static void Serialize(const Contents& contents, std::vector<std::uint8_t>& outData);
+
+	/**
+	 * Replaces the pack as a whole, a failed write leaves the previous one in place
+	 * @param data as laid out by Serialize
+	 */
+	static bool Write(const std::filesystem::path& path, std::span<const std::uint8_t> data);
+
+	/**
+	 * Maps the pack, the texture data gets read straight from the mapping
+	 * @param sourceStamp what the pack has to have been built from
+	 * @return false if it doesn't exist, is stale or corrupt
+	 */
+	bool Open(const std::filesystem::path& path, std::uint64_t sourceStamp);
+
+	/**
+	 * @param data as laid out by Serialize, has to outlive the pack's texture arrays
+	 */
+	bool Read(std::span<const std::uint8_t> data, std::uint64_t sourceStamp);
+
+	void Close();
+
+private:
+	MappedFile file_;
+
+	std::array<TextureArray, TEXTURE_TYPE_COUNT> textureArrays_;
+	std::vector<MaterialCacheEntry>				 materials_;
+	std::vector<BlockMaterials>					 blocks_;
+
+public:
+	// Getters
+	[[nodiscard]] const TextureArray& GetTextureArray(TextureType type) const
+	{
+		return textureArrays_[static_cast<std::size_t>(type)];
+	}
+	[[nodiscard]] const std::vector<MaterialCacheEntry>& GetMaterials() const { return materials_; }
+	[[nodiscard]] const std::vector<BlockMaterials>&	 GetBlocks() const { return blocks_; }
+};
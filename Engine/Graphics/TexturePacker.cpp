@@ -0,0 +1,581 @@
+﻿#define STB_IMAGE_IMPLEMENTATION
+#include "TexturePacker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+#include "../Utils/ThirdParty/stb_image.h"
+#include "TextureCompression.h"
+
+namespace
+{
+	namespace fs = std::filesystem;
+
+	// FNV-1a
+	void Hash(std::uint64_t& hash, const void* data, std::size_t size)
+	{
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			hash ^= static_cast<const std::uint8_t*>(data)[i];
+			hash *= 0x100000001b3;
+		}
+	}
+
+	template <typename T>
+	void Hash(std::uint64_t& hash, const T& value)
+	{
+		Hash(hash, &value, sizeof(T));
+	}
+
+	// Encoded sRGB to linear, and linear quantized to 12 bits back to sRGB, which is still exact to the byte
+	struct SRGBTables
+	{
+		std::array<float, 256>		   toLinear;
+		std::array<std::uint8_t, 4096> fromLinear;
+	};
+
+	const SRGBTables& GetSRGBTables()
+	{
+		static const SRGBTables tables = []
+		{
+			SRGBTables result;
+			for (std::size_t i = 0; i < result.toLinear.size(); ++i)
+			{
+				const float encoded = static_cast<float>(i) / 255.0f;
+				result.toLinear[i]	= encoded <= 0.04045f ? encoded / 12.92f
+													  : std::pow((encoded + 0.055f) / 1.055f, 2.4f);
+			}
+			for (std::size_t i = 0; i < result.fromLinear.size(); ++i)
+			{
+				const float linear	 = static_cast<float>(i) / 4095.0f;
+				const float encoded	 = linear <= 0.0031308f ? linear * 12.92f
+															: 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+				result.fromLinear[i] = static_cast<std::uint8_t>(encoded * 255.0f + 0.5f);
+			}
+			return result;
+		}();
+		return tables;
+	}
+
+	// Sum of the 2x2 texels of the source level that make up the destination texel, per channel
+	__m128i SumQuad(const std::uint8_t* top, const std::uint8_t* bottom)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		// Two texels of each row, 16 bits per channel
+		const __m128i topTexels	   = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(top)), zero);
+		const __m128i bottomTexels = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bottom)), zero);
+
+		const __m128i columns = _mm_add_epi16(topTexels, bottomTexels);
+		return _mm_unpacklo_epi16(_mm_add_epi16(columns, _mm_srli_si128(columns, 8)), zero);
+	}
+
+	std::uint32_t PackTexel(__m128i channels)
+	{
+		const __m128i packed = _mm_packs_epi32(channels, channels);
+		return static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(packed, packed)));
+	}
+
+	// Averages every channel as is, for data that's linear already
+	std::uint32_t FilterLinear(const std::uint8_t* top, const std::uint8_t* bottom)
+	{
+		return PackTexel(_mm_srli_epi32(_mm_add_epi32(SumQuad(top, bottom), _mm_set1_epi32(2)), 2));
+	}
+
+	// Averages the color in linear space, alpha is linear already
+	std::uint32_t FilterSRGB(const std::uint8_t* top, const std::uint8_t* bottom)
+	{
+		const SRGBTables& tables = GetSRGBTables();
+
+		__m128 sum = _mm_setzero_ps();
+		for (const std::uint8_t* texel : {top, top + 4, bottom, bottom + 4})
+		{
+			const __m128 linear = _mm_setr_ps(tables.toLinear[texel[0]],
+											  tables.toLinear[texel[1]],
+											  tables.toLinear[texel[2]],
+											  static_cast<float>(texel[3]) / 255.0f);
+			sum					= _mm_add_ps(sum, linear);
+		}
+
+		alignas(16) std::array<std::int32_t, 4> quantized;
+		const __m128							scale = _mm_setr_ps(4095.0f / 4, 4095.0f / 4, 4095.0f / 4, 255.0f / 4);
+		_mm_store_si128(reinterpret_cast<__m128i*>(quantized.data()), _mm_cvtps_epi32(_mm_mul_ps(sum, scale)));
+
+		return static_cast<std::uint32_t>(tables.fromLinear[quantized[0]])
+			 | static_cast<std::uint32_t>(tables.fromLinear[quantized[1]]) << 8
+			 | static_cast<std::uint32_t>(tables.fromLinear[quantized[2]]) << 16
+			 | static_cast<std::uint32_t>(quantized[3]) << 24;
+	}
+
+	// Averages the normals and brings them back to unit length, alpha gets averaged as is
+	std::uint32_t FilterNormal(const std::uint8_t* top, const std::uint8_t* bottom)
+	{
+		const __m128i sum	 = SumQuad(top, bottom);
+		const __m128  normal = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), _mm_set1_ps(2.0f / (255.0f * 4))),
+										  _mm_set1_ps(1.0f));
+
+		// Length of xyz in every lane, w doesn't count
+		const __m128 xyz	   = _mm_and_ps(normal, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+		__m128		 squared   = _mm_mul_ps(xyz, xyz);
+		squared				   = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 3, 0, 1)));
+		squared				   = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(1, 0, 3, 2)));
+		const __m128 length	   = _mm_max_ps(_mm_sqrt_ps(squared), _mm_set1_ps(1e-6f));
+		const __m128 unit	   = _mm_div_ps(xyz, length);
+		const __m128 encoded   = _mm_add_ps(_mm_mul_ps(unit, _mm_set1_ps(127.5f)), _mm_set1_ps(127.5f));
+		const __m128i channels = _mm_cvtps_epi32(encoded);
+
+		const auto alpha = static_cast<std::uint32_t>((_mm_cvtsi128_si32(_mm_srli_si128(sum, 12)) + 2) / 4);
+		return (PackTexel(channels) & 0x00ffffff) | alpha << 24;
+	}
+} // namespace
+
+TexturePacker::TexturePacker(std::filesystem::path texturesPath, std::uint32_t threadCount) :
+	texturesPath_(std::move(texturesPath)),
+	threadCount_((std::max)(threadCount, 1u))
+{
+}
+
+std::uint64_t TexturePacker::GetSourceStamp(const std::filesystem::path& texturesPath, const BlockDatabase& database)
+{
+	struct SourceFile
+	{
+		std::string	  name;
+		std::uint64_t size;
+		std::int64_t  writeTime;
+	};
+
+	// The listing comes in no particular order
+	std::vector<SourceFile> files;
+	std::error_code			error;
+	for (const fs::directory_entry& entry : fs::directory_iterator(texturesPath, error))
+	{
+		if (entry.path().extension() == ".png")
+		{
+			const auto writeTime = static_cast<std::int64_t>(entry.last_write_time(error).time_since_epoch().count());
+			files.emplace_back(entry.path().filename().string(), entry.file_size(error), writeTime);
+		}
+	}
+	std::ranges::sort(files, {}, &SourceFile::name);
+
+	std::uint64_t hash = 0xcbf29ce484222325;
+	Hash(hash, TEXTURE_RESOLUTION);
+	for (const SourceFile& file : files)
+	{
+		Hash(hash, file.name.data(), file.name.size() + 1);
+		Hash(hash, file.size);
+		Hash(hash, file.writeTime);
+	}
+
+	for (const BlockType type : database.GetBlockTypes())
+	{
+		Hash(hash, type);
+		for (const BlockFace face : ALL_BLOCKFACES)
+		{
+			const std::string& texture = database.GetFaceTexture(type, face);
+			Hash(hash, texture.data(), texture.size() + 1);
+		}
+	}
+	return hash;
+}
+
+TexturePack::Contents TexturePacker::Pack(const BlockDatabase& database)
+{
+	TexturePack::Contents contents;
+	contents.sourceStamp = GetSourceStamp(texturesPath_, database);
+
+	// Every distinct map per type, in the order their layers get handed out
+	std::array<std::vector<fs::path>, TEXTURE_TYPE_COUNT>                    sources;
+	std::array<std::unordered_map<fs::path, std::size_t>, TEXTURE_TYPE_COUNT> sourceIndices;
+
+	// Per face of every block, which of the sources it uses
+	const std::vector<BlockType>&							 blockTypes = database.GetBlockTypes();
+	std::vector<std::array<std::size_t, TEXTURE_TYPE_COUNT>> faceSources(blockTypes.size() * ALL_BLOCKFACES.size());
+
+	static constexpr std::array<const char*, TEXTURE_TYPE_COUNT> suffixes = {"basecolor",
+																			 "normal",
+																			 "ARM",
+																			 "heightmap",
+																			 "emissive"};
+	for (std::size_t block = 0; block < blockTypes.size(); ++block)
+	{
+		for (const BlockFace face : ALL_BLOCKFACES)
+		{
+			const std::string& textureName = database.GetFaceTexture(blockTypes[block], face);
+			for (std::size_t type = 0; type < TEXTURE_TYPE_COUNT; ++type)
+			{
+				fs::path path = texturesPath_ / (textureName + "_" + suffixes[type] + ".png");
+
+				const auto [it, inserted] = sourceIndices[type].try_emplace(path, sources[type].size());
+				if (inserted)
+				{
+					sources[type].push_back(std::move(path));
+				}
+				faceSources[block * ALL_BLOCKFACES.size() + static_cast<std::size_t>(face)][type] = it->second;
+			}
+		}
+	}
+
+	// Decoding and filtering is where the time goes, every source is independent of the others
+	struct Job
+	{
+		TextureType type;
+		std::size_t source;
+	};
+
+	std::vector<Job> jobs;
+	for (std::size_t type = 0; type < TEXTURE_TYPE_COUNT; ++type)
+	{
+		for (std::size_t source = 0; source < sources[type].size(); ++source)
+		{
+			jobs.emplace_back(static_cast<TextureType>(type), source);
+		}
+	}
+
+	std::vector<LoadedTexture> loadedTextures(jobs.size());
+	std::atomic<std::size_t>   nextJob = 0;
+
+	auto Worker = [&]()
+	{
+		std::size_t idx;
+		while ((idx = nextJob.fetch_add(1, std::memory_order_relaxed)) < jobs.size())
+		{
+			const Job& job		= jobs[idx];
+			loadedTextures[idx] = LoadTexture(sources[static_cast<std::size_t>(job.type)][job.source], job.type);
+		}
+	};
+
+	const std::size_t		 threadCount = (std::min)(std::size_t{threadCount_}, jobs.size());
+	std::vector<std::thread> workers;
+	workers.reserve(threadCount > 0 ? threadCount - 1 : 0);
+	for (std::size_t i = 1; i < threadCount; ++i)
+	{
+		workers.emplace_back(Worker);
+	}
+	Worker();
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	// Layers go to the sources that loaded in the order the sources were found, so the same textures always end up
+	// in the same layers no matter which thread finished first
+	std::array<std::vector<std::uint32_t>, TEXTURE_TYPE_COUNT> sourceLayers;
+	for (std::size_t type = 0, job = 0; type < TEXTURE_TYPE_COUNT; ++type)
+	{
+		const auto textureType = static_cast<TextureType>(type);
+
+		contents.formats[type] = GetFormat(textureType);
+		contents.textures[type].reserve(TexturePack::GetLayerSize(contents.formats[type]) * (sources[type].size() + 1));
+
+		// The default texture goes first, see DEFAULT_TEXTURE_INDEX
+		AppendMipChain(GenerateDefaultTexture(textureType), textureType, contents.textures[type]);
+		std::uint32_t layerCount = 1;
+
+		sourceLayers[type].resize(sources[type].size(), DEFAULT_TEXTURE_INDEX);
+		for (std::size_t source = 0; source < sources[type].size(); ++source, ++job)
+		{
+			LoadedTexture& loaded = loadedTextures[job];
+			if (loaded.error.empty() == false)
+			{
+				std::cerr << loaded.error << std::endl;
+			}
+			if (loaded.mipChain.empty())
+			{
+				continue;
+			}
+
+			contents.textures[type].insert(contents.textures[type].end(),
+										   loaded.mipChain.begin(),
+										   loaded.mipChain.end());
+			loaded.mipChain			   = {};
+			sourceLayers[type][source] = layerCount++;
+		}
+		contents.layerCounts[type] = layerCount;
+	}
+
+	std::unordered_map<std::string, std::size_t> materialCombinationCache;
+	for (std::size_t block = 0; block < blockTypes.size(); ++block)
+	{
+		TexturePack::BlockMaterials& blockMaterials = contents.blocks.emplace_back(blockTypes[block]);
+		for (const BlockFace face : ALL_BLOCKFACES)
+		{
+			const auto& faceSource = faceSources[block * ALL_BLOCKFACES.size() + static_cast<std::size_t>(face)];
+
+			std::array<std::uint32_t, TEXTURE_TYPE_COUNT> layers;
+			for (std::size_t type = 0; type < TEXTURE_TYPE_COUNT; ++type)
+			{
+				layers[type] = sourceLayers[type][faceSource[type]];
+			}
+
+			std::string matKey = std::to_string(layers[0])
+							   + "|"
+							   + std::to_string(layers[1])
+							   + "|"
+							   + std::to_string(layers[2])
+							   + "|"
+							   + std::to_string(layers[3])
+							   + "|"
+							   + std::to_string(layers[4]);
+
+			std::size_t matID = 0;
+			if (materialCombinationCache.contains(matKey))
+			{
+				// material with such specification already exists
+				matID = materialCombinationCache[matKey];
+			}
+			else
+			{
+				matID = contents.materials.size();
+				contents.materials.emplace_back(layers[static_cast<std::size_t>(TextureType::Albedo)],
+												layers[static_cast<std::size_t>(TextureType::Normal)],
+												layers[static_cast<std::size_t>(TextureType::ARM)],
+												layers[static_cast<std::size_t>(TextureType::Heightmap)],
+												layers[static_cast<std::size_t>(TextureType::Emissive)]);
+
+				materialCombinationCache[matKey] = matID;
+			}
+
+			blockMaterials.faceMaterials[static_cast<std::size_t>(face)] = static_cast<std::uint32_t>(matID);
+		}
+	}
+
+	return contents;
+}
+
+TexturePacker::LoadedTexture TexturePacker::LoadTexture(const std::filesystem::path& texturePath, TextureType type)
+{
+	// Missing maps are expected, they stay at the default texture
+	std::error_code error;
+	if (fs::exists(texturePath, error) == false)
+	{
+		return {};
+	}
+
+	int		   width, height, channels;
+	const auto data = stbi_load(texturePath.string().c_str(), &width, &height, &channels, TEXTURE_COLOR_CHANNELS);
+	if (!data)
+	{
+		return {{}, "Couldn't load texture from file: " + texturePath.string() + "\nReason: " + stbi_failure_reason()};
+	}
+
+	if (width != TEXTURE_RESOLUTION || height != TEXTURE_RESOLUTION)
+	{
+		stbi_image_free(data);
+		return {{},
+				"Texture " + texturePath.string()
+					+ " does not meet the requirements\nReason: Invalid texture resolution"};
+	}
+
+	RawTexture texture{std::vector<std::uint8_t>(data, data + width * height * TEXTURE_COLOR_CHANNELS),
+					   width,
+					   height,
+					   channels};
+	stbi_image_free(data);
+
+	LoadedTexture loaded;
+	loaded.mipChain.reserve(TexturePack::GetLayerSize(GetFormat(type)));
+	AppendMipChain(texture, type, loaded.mipChain);
+	return loaded;
+}
+
+void TexturePacker::AppendMipChain(const RawTexture& texture, TextureType type, std::vector<std::uint8_t>& outData)
+{
+	assert(texture.width == TEXTURE_RESOLUTION && texture.height == TEXTURE_RESOLUTION);
+
+	std::uint32_t (*filter)(const std::uint8_t*, const std::uint8_t*) = FilterLinear;
+	if (type == TextureType::Albedo || type == TextureType::Emissive)
+	{
+		filter = FilterSRGB;
+	}
+	else if (type == TextureType::Normal)
+	{
+		filter = FilterNormal;
+	}
+
+	// Every mip gets filtered from the uncompressed one above it
+	std::vector<std::uint8_t> levels(texture.data);
+	std::size_t				  sourceOffset = 0;
+
+	for (std::uint32_t size = TEXTURE_RESOLUTION / 2; size > 0; size /= 2)
+	{
+		const std::size_t sourcePitch = std::size_t{size} * 2 * TEXTURE_COLOR_CHANNELS;
+		const std::size_t offset	  = levels.size();
+		levels.resize(offset + std::size_t{size} * size * TEXTURE_COLOR_CHANNELS);
+
+		for (std::uint32_t y = 0; y < size; ++y)
+		{
+			const std::uint8_t* top	   = levels.data() + sourceOffset + y * 2 * sourcePitch;
+			std::uint8_t*		output = levels.data() + offset + y * size * TEXTURE_COLOR_CHANNELS;
+			for (std::uint32_t x = 0; x < size; ++x)
+			{
+				const std::uint8_t* texels = top + x * 2 * TEXTURE_COLOR_CHANNELS;
+				const std::uint32_t texel  = filter(texels, texels + sourcePitch);
+				std::memcpy(output + x * TEXTURE_COLOR_CHANNELS, &texel, sizeof(texel));
+			}
+		}
+
+		sourceOffset = offset;
+	}
+
+	const DXGI_FORMAT format = GetFormat(type);
+	if (TextureCompression::GetBlockSize(format) == 0)
+	{
+		outData.insert(outData.end(), levels.begin(), levels.end());
+		return;
+	}
+
+	std::size_t offset = 0;
+	for (std::uint32_t size = TEXTURE_RESOLUTION; size > 0; size /= 2)
+	{
+		const std::size_t levelSize = std::size_t{size} * size * TEXTURE_COLOR_CHANNELS;
+		TextureCompression::Compress(format, std::span(levels).subspan(offset, levelSize), size, size, outData);
+		offset += levelSize;
+	}
+}
+
+DXGI_FORMAT TexturePacker::GetFormat(TextureType type)
+{
+	switch (type)
+	{
+		case TextureType::Albedo:
+			return DXGI_FORMAT_BC7_UNORM_SRGB;
+		case TextureType::Normal:
+			return DXGI_FORMAT_BC5_UNORM;
+		case TextureType::ARM:
+			return DXGI_FORMAT_BC7_UNORM;
+		case TextureType::Heightmap:
+			return DXGI_FORMAT_BC4_UNORM;
+		case TextureType::Emissive:
+			return DXGI_FORMAT_BC1_UNORM_SRGB;
+	}
+
+	return DXGI_FORMAT_UNKNOWN;
+}
+
+TexturePacker::RawTexture TexturePacker::GenerateDefaultTexture(const TextureType type)
+{
+	switch (type)
+	{
+		case TextureType::Albedo:
+			return GenerateDefaultAlbedo();
+		case TextureType::Normal:
+			return GenerateDefaultNormal();
+		case TextureType::ARM:
+			return GenerateDefaultARM();
+		case TextureType::Heightmap:
+			return GenerateDefaultHeightmap();
+		case TextureType::Emissive:
+			return GenerateDefaultEmissive();
+	}
+
+	// this will never happen but clang doesn't understand this for some reason
+	return {};
+}
+
+TexturePacker::RawTexture TexturePacker::GenerateDefaultAlbedo()
+{
+	std::vector<uint8_t> data(TEXTURE_COLOR_CHANNELS * TEXTURE_RESOLUTION * TEXTURE_RESOLUTION);
+	for (std::size_t idx = 0; idx < data.size(); idx += 4)
+	{
+		std::size_t pixelIdx = idx / TEXTURE_COLOR_CHANNELS;
+		std::size_t x		 = pixelIdx % TEXTURE_RESOLUTION;
+		std::size_t y		 = pixelIdx / TEXTURE_RESOLUTION;
+
+		// Checkerboard logic
+
+		const std::size_t denominator = 2;
+
+		bool isBlack = ((x / (TEXTURE_RESOLUTION / denominator)) + (y / (TEXTURE_RESOLUTION / denominator))) % 2 == 0;
+
+		if (isBlack)
+		{
+			data[idx]	  = 0;
+			data[idx + 1] = 0;
+			data[idx + 2] = 0;
+			data[idx + 3] = 255; // alpha always max
+		}
+		else
+		{
+			// Magenta
+			data[idx]	  = 255;
+			data[idx + 1] = 0;
+			data[idx + 2] = 255;
+			data[idx + 3] = 255;
+		}
+	}
+
+	return {.data	  = std::move(data),
+			.width	  = TEXTURE_RESOLUTION,
+			.height	  = TEXTURE_RESOLUTION,
+			.channels = TEXTURE_COLOR_CHANNELS};
+}
+
+TexturePacker::RawTexture TexturePacker::GenerateDefaultNormal()
+{
+	std::vector<uint8_t> data(TEXTURE_COLOR_CHANNELS * TEXTURE_RESOLUTION * TEXTURE_RESOLUTION);
+	for (std::size_t idx = 0; idx < data.size(); idx += 4)
+	{
+		// flat normal map
+		data[idx]	  = 128;
+		data[idx + 1] = 128;
+		data[idx + 2] = 255;
+		data[idx + 3] = 255;
+	}
+
+	return {.data	  = std::move(data),
+			.width	  = TEXTURE_RESOLUTION,
+			.height	  = TEXTURE_RESOLUTION,
+			.channels = TEXTURE_COLOR_CHANNELS};
+}
+
+TexturePacker::RawTexture TexturePacker::GenerateDefaultARM()
+{
+	std::vector<uint8_t> data(TEXTURE_COLOR_CHANNELS * TEXTURE_RESOLUTION * TEXTURE_RESOLUTION);
+	for (std::size_t idx = 0; idx < data.size(); idx += 4)
+	{
+		data[idx]	  = 255; // No AO
+		data[idx + 1] = 255; // Rough
+		data[idx + 2] = 0;	 // Non-metallic
+		data[idx + 3] = 255; // for now alpha is not really used
+	}
+
+	return {.data	  = std::move(data),
+			.width	  = TEXTURE_RESOLUTION,
+			.height	  = TEXTURE_RESOLUTION,
+			.channels = TEXTURE_COLOR_CHANNELS};
+}
+
+TexturePacker::RawTexture TexturePacker::GenerateDefaultHeightmap()
+{
+	std::vector<uint8_t> data(TEXTURE_COLOR_CHANNELS * TEXTURE_RESOLUTION * TEXTURE_RESOLUTION);
+	std::ranges::fill(data, 255);
+
+	return {.data	  = std::move(data),
+			.width	  = TEXTURE_RESOLUTION,
+			.height	  = TEXTURE_RESOLUTION,
+			.channels = TEXTURE_COLOR_CHANNELS};
+}
+TexturePacker::RawTexture TexturePacker::GenerateDefaultEmissive()
+{
+	std::vector<uint8_t> data(TEXTURE_COLOR_CHANNELS * TEXTURE_RESOLUTION * TEXTURE_RESOLUTION);
+	for (std::size_t idx = 0; idx < data.size(); idx += 4)
+	{
+		// default: non-emissive
+		data[idx]	  = 0;
+		data[idx + 1] = 0;
+		data[idx + 2] = 0;
+		data[idx + 3] = 255;
+	}
+
+	return {.data	  = std::move(data),
+			.width	  = TEXTURE_RESOLUTION,
+			.height	  = TEXTURE_RESOLUTION,
+			.channels = TEXTURE_COLOR_CHANNELS};
+}
@@ -0,0 +1,93 @@
+﻿#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../World/BlockDatabase.h"
+#include "Material.h"
+#include "TexturePack.h"
+
+/**
+ * Builds the texture pack out of the PNGs in the texture directory. A block face's maps are named after the face's
+ * texture in the block definitions, e.g. grass_side_normal.png, the ones that don't exist fall back to built-in
+ * defaults. Runs offline through "Bloczki --pack-textures", and at startup whenever the pack is missing or stale
+ */
+class TexturePacker
+{
+public:
+	static constexpr std::uint32_t TEXTURE_RESOLUTION	  = TexturePack::TEXTURE_RESOLUTION;
+	static constexpr std::uint8_t  TEXTURE_COLOR_CHANNELS = 4;
+	static constexpr std::size_t   DEFAULT_TEXTURE_INDEX  = 0;
+
+private:
+	struct RawTexture
+	{
+		std::vector<std::uint8_t> data;
+		int						  width	   = -1;
+		int						  height   = -1;
+		int						  channels = -1;
+	};
+
+	struct LoadedTexture
+	{
+		std::vector<std::uint8_t> mipChain; // empty if the texture doesn't exist or is invalid
+		std::string				  error;	// printed once the workers are done, so that the log stays in order
+	};
+
+public:
+	/**
+	 * @param threadCount how many threads decode the textures and generate their mips, the calling one included
+	 */
+	explicit TexturePacker(std::filesystem::path texturesPath,
+						   std::uint32_t		 threadCount = (std::max)(std::thread::hardware_concurrency(), 1u));
+
+	TexturePacker(const TexturePacker&)			   = delete;
+	TexturePacker(TexturePacker&&)				   = delete;
+	TexturePacker& operator=(const TexturePacker&) = delete;
+	TexturePacker& operator=(TexturePacker&&)	   = delete;
+
+	/**
+	 * Goes by the texture directory's listing rather than the files' contents, so it's cheap enough for every startup
+	 * @return changes whenever a texture file or a block's textures do
+	 */
+	[[nodiscard]] static std::uint64_t GetSourceStamp(const std::filesystem::path& texturesPath,
+													  const BlockDatabase&		   database);
+
+	/**
+	 * Decodes the textures on threadCount threads, the layers they end up in only depend on the block database
+	 * @return the textures, mip chains and materials of every block in the database
+	 */
+	[[nodiscard]] TexturePack::Contents Pack(const BlockDatabase& database);
+
+private:
+	/**
+	 * Thread safe
+	 * @param texturePath the path to the texture
+	 * @param type the type of the texture, decides how its mips get filtered
+	 */
+	[[nodiscard]] static LoadedTexture LoadTexture(const std::filesystem::path& texturePath, TextureType type);
+
+	/**
+	 * Box filters every mip level out of the one above it, in linear space for the sRGB types and renormalized for
+	 * normal maps. Compression comes after, so errors don't add up down the chain
+	 * @param outData gets the texture followed by its mips appended, in GetFormat(type)
+	 */
+	static void AppendMipChain(const RawTexture& texture, TextureType type, std::vector<std::uint8_t>& outData);
+
+	// Normal maps only keep x and y, the shaders reconstruct z. Heightmaps only keep red
+	[[nodiscard]] static DXGI_FORMAT GetFormat(TextureType type);
+
+	static RawTexture GenerateDefaultTexture(TextureType type);
+	static RawTexture GenerateDefaultAlbedo();
+	static RawTexture GenerateDefaultNormal();
+	static RawTexture GenerateDefaultARM();
+	static RawTexture GenerateDefaultHeightmap();
+	static RawTexture GenerateDefaultEmissive();
+
+	std::filesystem::path texturesPath_;
+	std::uint32_t		  threadCount_;
+};
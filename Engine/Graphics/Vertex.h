@@ -10,7 +10,7 @@ struct Vertex
 	DirectX::XMFLOAT3 bitangent;
 	DirectX::XMFLOAT2 uv;
 	std::uint32_t	  materialID;
-	std::uint8_t	  lightLevel;
+	std::uint32_t	  lighting; // R8G8B8A8_UNORM, smooth sky light, smooth block light, ambient occlusion, unused
 };
 
 struct SimpleVertex
@@ -1,5 +1,7 @@
 #include "Core/Application.h"
 
+#include <string_view>
+
 #ifdef _DEBUG
 #include <cstdio>
 #endif
@@ -18,9 +20,39 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR pScmdline,
 		printf("Debug Console Initialized.\n");
 	}
 
+	// Only builds the texture pack, for packing the textures offline
+	if (std::string_view(pScmdline).find("--pack-textures") != std::string_view::npos)
+	{
+		return Application::PackTextures() ? 0 : 1;
+	}
+
+	if (std::string_view(pScmdline).find("--run-tests") != std::string_view::npos)
+	{
+		return Application::RunTests() ? 0 : 1;
+	}
+
 	Application application;
 	bool		result;
 
+	if (std::string_view(pScmdline).find("--metrics") != std::string_view::npos)
+	{
+		application.EnableMetricsDump();
+	}
+
+	// Plays Input.rec back without a window, for comparing the performance of builds on the same session
+	if (std::string_view(pScmdline).find("--replay-input") != std::string_view::npos)
+	{
+		return application.ReplayInput() ? 0 : 1;
+	}
+
+	if (std::string_view(pScmdline).find("--record-input") != std::string_view::npos)
+	{
+		if (application.EnableInputRecording() == false)
+		{
+			return 1;
+		}
+	}
+
 	// Initialize and run the system object.
 	result = application.Init();
 	if (result)
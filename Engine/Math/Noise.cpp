@@ -0,0 +1,373 @@
+﻿#include "Noise.h"
+
+#include <cassert>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace
+{
+	using namespace Math::Noise;
+
+	// Sticks to shifts, adds and xors, SSE2 has no 32-bit multiply
+	std::uint32_t Mix(std::uint32_t h)
+	{
+		h += h << 10;
+		h ^= h >> 6;
+		h += h << 3;
+		h ^= h >> 11;
+		h += h << 15;
+		return h;
+	}
+
+	__m128i Mix(__m128i h)
+	{
+		h = _mm_add_epi32(h, _mm_slli_epi32(h, 10));
+		h = _mm_xor_si128(h, _mm_srli_epi32(h, 6));
+		h = _mm_add_epi32(h, _mm_slli_epi32(h, 3));
+		h = _mm_xor_si128(h, _mm_srli_epi32(h, 11));
+		h = _mm_add_epi32(h, _mm_slli_epi32(h, 15));
+		return h;
+	}
+
+	// x gets hashed last, so a row along x shares everything before it
+	std::uint32_t HashPrefix(std::uint32_t seed, std::int32_t coordinate)
+	{
+		return Mix(seed ^ static_cast<std::uint32_t>(coordinate));
+	}
+
+	// Picks one of the 16 gradient slots for the lattice point
+	std::uint32_t GetGradient(std::uint32_t prefix, std::int32_t x)
+	{
+		return Mix(prefix ^ static_cast<std::uint32_t>(x)) >> 28;
+	}
+
+	__m128i GetGradient(std::uint32_t prefix, __m128i x)
+	{
+		return _mm_srli_epi32(Mix(_mm_xor_si128(_mm_set1_epi32(static_cast<std::int32_t>(prefix)), x)), 28);
+	}
+
+	float Fade(float t)
+	{
+		return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+	}
+
+	__m128 Fade(__m128 t)
+	{
+		const __m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))),
+										_mm_set1_ps(10.0f));
+		return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+	}
+
+	float Lerp(float a, float b, float t)
+	{
+		return a + t * (b - a);
+	}
+
+	__m128 Lerp(__m128 a, __m128 b, __m128 t)
+	{
+		return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+	}
+
+	__m128 Lerp(__m128 a, __m128 b, float t)
+	{
+		return Lerp(a, b, _mm_set1_ps(t));
+	}
+
+	// Dot product with one of the 12 cube edge gradients, same table as improved Perlin noise
+	float Grad(std::uint32_t gradient, float x, float y, float z)
+	{
+		const float u = gradient < 8 ? x : y;
+		const float v = gradient < 4 ? y : (gradient == 12 || gradient == 14 ? x : z);
+		return ((gradient & 1) ? -u : u) + ((gradient & 2) ? -v : v);
+	}
+
+	__m128 Select(__m128i mask, __m128 a, __m128 b)
+	{
+		const __m128 maskPs = _mm_castsi128_ps(mask);
+		return _mm_or_ps(_mm_and_ps(maskPs, a), _mm_andnot_ps(maskPs, b));
+	}
+
+	__m128 Grad(__m128i gradient, __m128 x, __m128 y, __m128 z)
+	{
+		const __m128i useXForV = _mm_or_si128(_mm_cmpeq_epi32(gradient, _mm_set1_epi32(12)),
+											  _mm_cmpeq_epi32(gradient, _mm_set1_epi32(14)));
+
+		__m128 u = Select(_mm_cmplt_epi32(gradient, _mm_set1_epi32(8)), x, y);
+		__m128 v = Select(_mm_cmplt_epi32(gradient, _mm_set1_epi32(4)), y, Select(useXForV, x, z));
+
+		// Negating only flips the sign bit, same as the scalar version
+		u = _mm_xor_ps(u, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(gradient, _mm_set1_epi32(1)), 31)));
+		v = _mm_xor_ps(v, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(gradient, _mm_set1_epi32(2)), 30)));
+		return _mm_add_ps(u, v);
+	}
+
+	// SSE2 has no floor, truncate and step down where that rounded up
+	__m128 Floor(__m128 x)
+	{
+		const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+		return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f)));
+	}
+
+	// Lattice cell and position inside it along one axis
+	struct Axis
+	{
+		std::int32_t cell;
+		float		 t;
+		float		 fade;
+	};
+
+	Axis GetAxis(float coordinate)
+	{
+		const float floored = std::floor(coordinate);
+		const float t		= coordinate - floored;
+		return {static_cast<std::int32_t>(floored), t, Fade(t)};
+	}
+
+	__m128 Gradient2x4(__m128 x, float z, std::uint32_t seed)
+	{
+		const Axis az = GetAxis(z);
+
+		const std::uint32_t prefix0 = HashPrefix(seed, az.cell);
+		const std::uint32_t prefix1 = HashPrefix(seed, az.cell + 1);
+
+		const __m128  floored = Floor(x);
+		const __m128i cell	  = _mm_cvttps_epi32(floored);
+		const __m128i cell1	  = _mm_add_epi32(cell, _mm_set1_epi32(1));
+		const __m128  tx	  = _mm_sub_ps(x, floored);
+		const __m128  tx1	  = _mm_sub_ps(tx, _mm_set1_ps(1.0f));
+		const __m128  fade	  = Fade(tx);
+
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 tz	  = _mm_set1_ps(az.t);
+		const __m128 tz1  = _mm_set1_ps(az.t - 1.0f);
+
+		const __m128 n00 = Grad(GetGradient(prefix0, cell), tx, tz, zero);
+		const __m128 n10 = Grad(GetGradient(prefix0, cell1), tx1, tz, zero);
+		const __m128 n01 = Grad(GetGradient(prefix1, cell), tx, tz1, zero);
+		const __m128 n11 = Grad(GetGradient(prefix1, cell1), tx1, tz1, zero);
+
+		return Lerp(Lerp(n00, n10, fade), Lerp(n01, n11, fade), az.fade);
+	}
+
+	__m128 Gradient3x4(__m128 x, float y, float z, std::uint32_t seed)
+	{
+		const Axis ay = GetAxis(y);
+		const Axis az = GetAxis(z);
+
+		const std::uint32_t prefixZ0 = HashPrefix(seed, az.cell);
+		const std::uint32_t prefixZ1 = HashPrefix(seed, az.cell + 1);
+		const std::uint32_t prefix00 = HashPrefix(prefixZ0, ay.cell);
+		const std::uint32_t prefix10 = HashPrefix(prefixZ0, ay.cell + 1);
+		const std::uint32_t prefix01 = HashPrefix(prefixZ1, ay.cell);
+		const std::uint32_t prefix11 = HashPrefix(prefixZ1, ay.cell + 1);
+
+		const __m128  floored = Floor(x);
+		const __m128i cell	  = _mm_cvttps_epi32(floored);
+		const __m128i cell1	  = _mm_add_epi32(cell, _mm_set1_epi32(1));
+		const __m128  tx	  = _mm_sub_ps(x, floored);
+		const __m128  tx1	  = _mm_sub_ps(tx, _mm_set1_ps(1.0f));
+		const __m128  fade	  = Fade(tx);
+
+		const __m128 ty	 = _mm_set1_ps(ay.t);
+		const __m128 ty1 = _mm_set1_ps(ay.t - 1.0f);
+		const __m128 tz	 = _mm_set1_ps(az.t);
+		const __m128 tz1 = _mm_set1_ps(az.t - 1.0f);
+
+		const __m128 x00 = Lerp(Grad(GetGradient(prefix00, cell), tx, ty, tz),
+								Grad(GetGradient(prefix00, cell1), tx1, ty, tz),
+								fade);
+		const __m128 x10 = Lerp(Grad(GetGradient(prefix10, cell), tx, ty1, tz),
+								Grad(GetGradient(prefix10, cell1), tx1, ty1, tz),
+								fade);
+		const __m128 x01 = Lerp(Grad(GetGradient(prefix01, cell), tx, ty, tz1),
+								Grad(GetGradient(prefix01, cell1), tx1, ty, tz1),
+								fade);
+		const __m128 x11 = Lerp(Grad(GetGradient(prefix11, cell), tx, ty1, tz1),
+								Grad(GetGradient(prefix11, cell1), tx1, ty1, tz1),
+								fade);
+
+		return Lerp(Lerp(x00, x10, ay.fade), Lerp(x01, x11, ay.fade), az.fade);
+	}
+
+	float GetTotalAmplitude(const FractalSettings& settings)
+	{
+		float total		= 0.0f;
+		float amplitude = 1.0f;
+		for (std::uint32_t octave = 0; octave < settings.octaves; ++octave)
+		{
+			total	  += amplitude;
+			amplitude *= settings.gain;
+		}
+
+		return total;
+	}
+
+	/**
+	 * Shared by both row functions, sample(x, frequency, seed) evaluates 4 lanes of a single octave
+	 * @param scalar fallback for the tail, gets the float x coordinate
+	 */
+	template <typename SampleX4, typename Scalar>
+	void FractalRow(std::int32_t		   x,
+					const FractalSettings& settings,
+					std::span<float>	   out,
+					SampleX4&&			   sample,
+					Scalar&&			   scalar)
+	{
+		assert(settings.octaves > 0);
+
+		const std::size_t vectorCount = out.size() / 4;
+		const __m128i	  laneOffsets = _mm_setr_epi32(0, 1, 2, 3);
+
+		for (std::size_t i = 0; i < vectorCount; ++i)
+		{
+			_mm_storeu_ps(&out[i * 4], _mm_setzero_ps());
+		}
+
+		float amplitude = 1.0f;
+		float frequency = settings.frequency;
+		for (std::uint32_t octave = 0; octave < settings.octaves; ++octave)
+		{
+			const __m128 amplitudes	 = _mm_set1_ps(amplitude);
+			const __m128 frequencies = _mm_set1_ps(frequency);
+			for (std::size_t i = 0; i < vectorCount; ++i)
+			{
+				const std::int32_t firstX = x + static_cast<std::int32_t>(i * 4);
+				const __m128	   xs	  = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(firstX), laneOffsets));
+				const __m128	   noise  = sample(_mm_mul_ps(xs, frequencies), frequency, settings.seed + octave);
+
+				float* sum = &out[i * 4];
+				_mm_storeu_ps(sum, _mm_add_ps(_mm_loadu_ps(sum), _mm_mul_ps(amplitudes, noise)));
+			}
+
+			amplitude *= settings.gain;
+			frequency *= settings.lacunarity;
+		}
+
+		const __m128 total = _mm_set1_ps(GetTotalAmplitude(settings));
+		for (std::size_t i = 0; i < vectorCount; ++i)
+		{
+			_mm_storeu_ps(&out[i * 4], _mm_div_ps(_mm_loadu_ps(&out[i * 4]), total));
+		}
+
+		for (std::size_t i = vectorCount * 4; i < out.size(); ++i)
+		{
+			out[i] = scalar(static_cast<float>(x + static_cast<std::int32_t>(i)));
+		}
+	}
+} // namespace
+
+std::uint32_t Math::Noise::Hash(std::int32_t x, std::int32_t y, std::int32_t z, std::uint32_t seed)
+{
+	return Mix(HashPrefix(HashPrefix(seed, z), y) ^ static_cast<std::uint32_t>(x));
+}
+
+float Math::Noise::Gradient2(float x, float z, std::uint32_t seed)
+{
+	const Axis ax = GetAxis(x);
+	const Axis az = GetAxis(z);
+
+	const std::uint32_t prefix0 = HashPrefix(seed, az.cell);
+	const std::uint32_t prefix1 = HashPrefix(seed, az.cell + 1);
+
+	const float n00 = Grad(GetGradient(prefix0, ax.cell), ax.t, az.t, 0.0f);
+	const float n10 = Grad(GetGradient(prefix0, ax.cell + 1), ax.t - 1.0f, az.t, 0.0f);
+	const float n01 = Grad(GetGradient(prefix1, ax.cell), ax.t, az.t - 1.0f, 0.0f);
+	const float n11 = Grad(GetGradient(prefix1, ax.cell + 1), ax.t - 1.0f, az.t - 1.0f, 0.0f);
+
+	return Lerp(Lerp(n00, n10, ax.fade), Lerp(n01, n11, ax.fade), az.fade);
+}
+
+float Math::Noise::Gradient3(float x, float y, float z, std::uint32_t seed)
+{
+	const Axis ax = GetAxis(x);
+	const Axis ay = GetAxis(y);
+	const Axis az = GetAxis(z);
+
+	const std::uint32_t prefixZ0 = HashPrefix(seed, az.cell);
+	const std::uint32_t prefixZ1 = HashPrefix(seed, az.cell + 1);
+	const std::uint32_t prefix00 = HashPrefix(prefixZ0, ay.cell);
+	const std::uint32_t prefix10 = HashPrefix(prefixZ0, ay.cell + 1);
+	const std::uint32_t prefix01 = HashPrefix(prefixZ1, ay.cell);
+	const std::uint32_t prefix11 = HashPrefix(prefixZ1, ay.cell + 1);
+
+	const float tx1 = ax.t - 1.0f;
+	const float ty1 = ay.t - 1.0f;
+	const float tz1 = az.t - 1.0f;
+
+	const float x00 = Lerp(Grad(GetGradient(prefix00, ax.cell), ax.t, ay.t, az.t),
+						   Grad(GetGradient(prefix00, ax.cell + 1), tx1, ay.t, az.t),
+						   ax.fade);
+	const float x10 = Lerp(Grad(GetGradient(prefix10, ax.cell), ax.t, ty1, az.t),
+						   Grad(GetGradient(prefix10, ax.cell + 1), tx1, ty1, az.t),
+						   ax.fade);
+	const float x01 = Lerp(Grad(GetGradient(prefix01, ax.cell), ax.t, ay.t, tz1),
+						   Grad(GetGradient(prefix01, ax.cell + 1), tx1, ay.t, tz1),
+						   ax.fade);
+	const float x11 = Lerp(Grad(GetGradient(prefix11, ax.cell), ax.t, ty1, tz1),
+						   Grad(GetGradient(prefix11, ax.cell + 1), tx1, ty1, tz1),
+						   ax.fade);
+
+	return Lerp(Lerp(x00, x10, ay.fade), Lerp(x01, x11, ay.fade), az.fade);
+}
+
+float Math::Noise::Fractal2(float x, float z, const FractalSettings& settings)
+{
+	assert(settings.octaves > 0);
+
+	float sum		= 0.0f;
+	float amplitude = 1.0f;
+	float frequency = settings.frequency;
+	for (std::uint32_t octave = 0; octave < settings.octaves; ++octave)
+	{
+		sum		  += amplitude * Gradient2(x * frequency, z * frequency, settings.seed + octave);
+		amplitude *= settings.gain;
+		frequency *= settings.lacunarity;
+	}
+
+	return sum / GetTotalAmplitude(settings);
+}
+
+float Math::Noise::Fractal3(float x, float y, float z, const FractalSettings& settings)
+{
+	assert(settings.octaves > 0);
+
+	float sum		= 0.0f;
+	float amplitude = 1.0f;
+	float frequency = settings.frequency;
+	for (std::uint32_t octave = 0; octave < settings.octaves; ++octave)
+	{
+		sum		  += amplitude * Gradient3(x * frequency, y * frequency, z * frequency, settings.seed + octave);
+		amplitude *= settings.gain;
+		frequency *= settings.lacunarity;
+	}
+
+	return sum / GetTotalAmplitude(settings);
+}
+
+void Math::Noise::Fractal2Row(std::int32_t x, std::int32_t z, const FractalSettings& settings, std::span<float> out)
+{
+	const auto zf = static_cast<float>(z);
+	FractalRow(
+		x,
+		settings,
+		out,
+		[zf](__m128 xs, float frequency, std::uint32_t seed) { return Gradient2x4(xs, zf * frequency, seed); },
+		[&](float xf) { return Fractal2(xf, zf, settings); });
+}
+
+void Math::Noise::Fractal3Row(std::int32_t			 x,
+							  std::int32_t			 y,
+							  std::int32_t			 z,
+							  const FractalSettings& settings,
+							  std::span<float>		 out)
+{
+	const auto yf = static_cast<float>(y);
+	const auto zf = static_cast<float>(z);
+	FractalRow(
+		x,
+		settings,
+		out,
+		[yf, zf](__m128 xs, float frequency, std::uint32_t seed)
+		{ return Gradient3x4(xs, yf * frequency, zf * frequency, seed); },
+		[&](float xf) { return Fractal3(xf, yf, zf, settings); });
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <cstdint>
+#include <span>
+
+/**
+ * Seeded gradient noise. Same seed and coordinates give the same value on every machine and thread, the row functions
+ * evaluate 4 samples at a time with SSE2 and match the scalar ones bit for bit
+ */
+namespace Math::Noise
+{
+	struct FractalSettings
+	{
+		std::uint32_t seed		 = 0;
+		float		  frequency	 = 1.0f / 64.0f; // of the first octave, in samples per block
+		std::uint32_t octaves	 = 4;
+		float		  lacunarity = 2.0f; // frequency multiplier between octaves
+		float		  gain		 = 0.5f; // amplitude multiplier between octaves
+	};
+
+	// Uniformly distributed bits, for placing things at random
+	[[nodiscard]] std::uint32_t Hash(std::int32_t x, std::int32_t y, std::int32_t z, std::uint32_t seed);
+
+	// Both roughly in [-1, 1]
+	[[nodiscard]] float Gradient2(float x, float z, std::uint32_t seed);
+	[[nodiscard]] float Gradient3(float x, float y, float z, std::uint32_t seed);
+
+	// Sum of the octaves, normalized back into roughly [-1, 1]
+	[[nodiscard]] float Fractal2(float x, float z, const FractalSettings& settings);
+	[[nodiscard]] float Fractal3(float x, float y, float z, const FractalSettings& settings);
+
+	/**
+	 * Samples a row of consecutive x coordinates, out[i] = Fractal2(x + i, z, settings)
+	 * @param out any length, the tail that doesn't fill a whole SIMD register goes through the scalar path
+	 */
+	void Fractal2Row(std::int32_t x, std::int32_t z, const FractalSettings& settings, std::span<float> out);
+
+	/**
+	 * Samples a row of consecutive x coordinates, out[i] = Fractal3(x + i, y, z, settings)
+	 * @param out any length, the tail that doesn't fill a whole SIMD register goes through the scalar path
+	 */
+	void Fractal3Row(std::int32_t			 x,
+					 std::int32_t			 y,
+					 std::int32_t			 z,
+					 const FractalSettings& settings,
+					 std::span<float>		 out);
+} // namespace Math::Noise
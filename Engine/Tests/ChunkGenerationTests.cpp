@@ -0,0 +1,164 @@
+﻿#include "ChunkGenerationTests.h"
+
+#include <DirectXMath.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../Math/DirectXMathOperators.h"
+#include "../Utils/ChunkUtils.h"
+#include "../World/Chunk.h"
+#include "../World/ChunkGenerationPipeline.h"
+#include "../World/ChunkGenerators/ChunkDecorator.h"
+#include "../World/ChunkGenerators/NoiseGenerator.h"
+
+namespace
+{
+	// Requested columns per axis, and the chunks of every column, tall enough to reach over the highest surface
+	constexpr std::int32_t areaColumns = 4;
+	constexpr std::int32_t minChunkY   = 0;
+	constexpr std::int32_t maxChunkY   = 9;
+
+	using ColumnHashes = std::unordered_map<DirectX::XMINT2, std::uint64_t, Math::XMINT2Hash>;
+
+	// FNV-1a over the block types only, the pipeline lights its columns and the serial generation doesn't
+	void Hash(std::uint64_t& hash, const Chunk& chunk)
+	{
+		for (const Block& block : chunk.GetBlocks())
+		{
+			hash ^= static_cast<std::uint8_t>(block.type);
+			hash *= 0x100000001b3;
+		}
+	}
+
+	std::vector<DirectX::XMINT2> GetRequestedColumns()
+	{
+		std::vector<DirectX::XMINT2> columns;
+		for (std::int32_t z = -areaColumns / 2; z < areaColumns / 2; ++z)
+		{
+			for (std::int32_t x = -areaColumns / 2; x < areaColumns / 2; ++x)
+			{
+				columns.push_back({x, z});
+			}
+		}
+		return columns;
+	}
+
+	// Every chunk decorated first, every edit applied after, features reach one column further than the area
+	ColumnHashes GenerateSerially(std::uint32_t seed)
+	{
+		using namespace DirectX;
+		using Utils::Coordinates::GetChunkCoordinate;
+
+		NoiseGenerator generator(nullptr, seed, NoiseGenerator::Settings());
+
+		std::unordered_map<XMINT3, std::unique_ptr<Chunk>, Math::XMINT3Hash> chunks;
+		std::vector<BlockEdit>												 pendingEdits;
+		for (std::int32_t z = -areaColumns / 2 - 1; z <= areaColumns / 2; ++z)
+		{
+			for (std::int32_t x = -areaColumns / 2 - 1; x <= areaColumns / 2; ++x)
+			{
+				for (std::int32_t y = minChunkY; y <= maxChunkY; ++y)
+				{
+					auto chunk = std::make_unique<Chunk>(XMINT3{x, y, z});
+					generator.FillChunk(chunk.get());
+
+					ChunkDecorator decorator(chunk.get(), pendingEdits);
+					generator.DecorateChunk(decorator);
+					chunks.emplace(XMINT3{x, y, z}, std::move(chunk));
+				}
+			}
+		}
+
+		for (const BlockEdit& edit : pendingEdits)
+		{
+			const XMINT3 chunkCoordinates = {GetChunkCoordinate<Chunk::CHUNK_SIZE>(edit.position.x),
+											 GetChunkCoordinate<Chunk::CHUNK_SIZE>(edit.position.y),
+											 GetChunkCoordinate<Chunk::CHUNK_SIZE>(edit.position.z)};
+			if (auto it = chunks.find(chunkCoordinates); it != chunks.end())
+			{
+				ChunkDecorator::ApplyEdit(it->second.get(), edit);
+			}
+		}
+
+		ColumnHashes hashes;
+		for (XMINT2 columnCoordinates : GetRequestedColumns())
+		{
+			std::uint64_t hash = 0xcbf29ce484222325;
+			for (std::int32_t y = minChunkY; y <= maxChunkY; ++y)
+			{
+				Hash(hash, *chunks.at(XMINT3{columnCoordinates.x, y, columnCoordinates.y}));
+			}
+			hashes.emplace(columnCoordinates, hash);
+		}
+		return hashes;
+	}
+
+	ColumnHashes GenerateInPipeline(std::uint32_t seed, std::uint32_t threadCount)
+	{
+		NoiseGenerator			generator(nullptr, seed, NoiseGenerator::Settings());
+		ChunkGenerationPipeline pipeline(&generator, minChunkY, maxChunkY, threadCount);
+
+		const std::vector<DirectX::XMINT2> requestedColumns = GetRequestedColumns();
+		for (DirectX::XMINT2 columnCoordinates : requestedColumns)
+		{
+			pipeline.Request(columnCoordinates);
+		}
+
+		ColumnHashes										 hashes;
+		std::vector<ChunkGenerationPipeline::FinishedColumn> finishedColumns;
+		while (hashes.size() < requestedColumns.size())
+		{
+			pipeline.Update(finishedColumns);
+			for (const ChunkGenerationPipeline::FinishedColumn& column : finishedColumns)
+			{
+				std::uint64_t hash = 0xcbf29ce484222325;
+				for (const auto& chunk : column.chunks)
+				{
+					Hash(hash, *chunk);
+				}
+				hashes.emplace(column.columnCoordinates, hash);
+			}
+
+			finishedColumns.clear();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return hashes;
+	}
+} // namespace
+
+bool ChunkGenerationTests::Run()
+{
+	bool passed = true;
+	for (std::uint32_t seed : {1u, 2u, 3u})
+	{
+		passed = TestPipelineMatchesSerial(seed) && passed;
+	}
+	return passed;
+}
+
+bool ChunkGenerationTests::TestPipelineMatchesSerial(std::uint32_t seed)
+{
+	const ColumnHashes expectedHashes = GenerateSerially(seed);
+	for (std::uint32_t threadCount : {1u, 4u})
+	{
+		const ColumnHashes hashes = GenerateInPipeline(seed, threadCount);
+		for (const auto& [columnCoordinates, expectedHash] : expectedHashes)
+		{
+			if (hashes.at(columnCoordinates) != expectedHash)
+			{
+				std::cerr << "Generation test " << seed << ": column (" << columnCoordinates.x << ", "
+						  << columnCoordinates.y << ") out of the pipeline with " << threadCount
+						  << " worker threads differs from the serial one" << std::endl;
+				return false;
+			}
+		}
+	}
+
+	std::cout << "Generation test " << seed << ": " << expectedHashes.size()
+			  << " columns came out of the pipeline on 1 and 4 threads the same as serially" << std::endl;
+	return true;
+}
@@ -0,0 +1,19 @@
+﻿#pragma once
+#include <cstdint>
+
+/**
+ * Runs noise terrain through the generation pipeline on one and on several threads and checks it against the same
+ * area generated serially, decorating every chunk first and applying all the features' edits after. The blocks have
+ * to come out the same, no matter how the jobs and the edit exchange between columns got interleaved
+ */
+class ChunkGenerationTests
+{
+public:
+	/**
+	 * @return false if any of the tests failed, what went wrong gets printed
+	 */
+	[[nodiscard]] static bool Run();
+
+private:
+	[[nodiscard]] static bool TestPipelineMatchesSerial(std::uint32_t seed);
+};
@@ -0,0 +1,169 @@
+﻿#include "LightClusterTests.h"
+
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../Graphics/LightClusterBuilder.h"
+
+namespace
+{
+	constexpr float nearZ		= 0.1f;
+	constexpr float farZ		= 1000.0f;
+	constexpr float aspectRatio = 16.0f / 9.0f;
+
+	// The camera sits at the origin looking down +z, view space is world space
+	DirectX::XMMATRIX GetProjection()
+	{
+		return DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(90.0f), aspectRatio, nearZ, farZ);
+	}
+
+	/**
+	 * Same lookup as GetClusterIndex in ClusteredLights.hlsl
+	 * @return false if the point isn't on screen
+	 */
+	bool GetClusterIndex(const ClusterConstants& constants, DirectX::XMFLOAT3 viewPosition, std::uint32_t& outIndex)
+	{
+		const float tanHalfFovY = std::tan(DirectX::XMConvertToRadians(45.0f));
+		const float tanHalfFovX = tanHalfFovY * aspectRatio;
+		if (viewPosition.z < nearZ || viewPosition.z > farZ)
+		{
+			return false;
+		}
+
+		const float ndcX = viewPosition.x / (viewPosition.z * tanHalfFovX);
+		const float ndcY = viewPosition.y / (viewPosition.z * tanHalfFovY);
+		if (std::abs(ndcX) > 1.0f || std::abs(ndcY) > 1.0f)
+		{
+			return false;
+		}
+
+		const float u	  = ndcX * 0.5f + 0.5f;
+		const float v	  = 0.5f - ndcY * 0.5f;
+		const float slice = std::floor(std::log(viewPosition.z) * constants.sliceScale + constants.sliceBias);
+
+		const float maxSlice = static_cast<float>(constants.clusterCountZ - 1);
+
+		const auto x = (std::min)(static_cast<std::uint32_t>(u * constants.clusterCountX), constants.clusterCountX - 1);
+		const auto y = (std::min)(static_cast<std::uint32_t>(v * constants.clusterCountY), constants.clusterCountY - 1);
+		const auto z = static_cast<std::uint32_t>(std::clamp(slice, 0.0f, maxSlice));
+
+		outIndex = LightClusterBuilder::GetClusterIndex(x, y, z);
+		return true;
+	}
+
+	bool IsListed(const LightClusterBuilder& builder, std::uint32_t clusterIndex, std::uint32_t lightIndex)
+	{
+		const LightCluster& cluster = builder.GetClusters()[clusterIndex];
+		const auto			indices = builder.GetLightIndices().subspan(cluster.offset, cluster.count);
+		return std::ranges::find(indices, lightIndex) != indices.end();
+	}
+} // namespace
+
+bool LightClusterTests::Run()
+{
+	const bool visibleLightsPassed = TestVisibleLightsAreListed();
+	const bool hiddenLightsPassed  = TestHiddenLightsAreSkipped();
+	return visibleLightsPassed && hiddenLightsPassed;
+}
+
+bool LightClusterTests::TestVisibleLightsAreListed()
+{
+	std::mt19937						  random(1);
+	std::uniform_real_distribution<float> sideDistribution(-40.0f, 40.0f);
+	std::uniform_real_distribution<float> depthDistribution(1.0f, 120.0f);
+	std::uniform_real_distribution<float> radiusDistribution(1.0f, 15.0f);
+
+	std::vector<PointLightGPU> lights(256);
+	for (PointLightGPU& light : lights)
+	{
+		light.position	= {sideDistribution(random), sideDistribution(random), depthDistribution(random)};
+		light.radius	= radiusDistribution(random);
+		light.color		= {1.0f, 1.0f, 1.0f};
+		light.intensity = 1.0f;
+	}
+
+	LightClusterBuilder builder;
+	builder.Build(lights, DirectX::XMMatrixIdentity(), GetProjection(), nearZ, farZ);
+
+	// A grid of points through every light's sphere, each of them has to be lit by the light
+	static constexpr int gridSteps = 8;
+	std::size_t			 checkedPoints = 0;
+	std::size_t			 missingPoints = 0;
+	for (std::uint32_t lightIndex = 0; lightIndex < lights.size(); ++lightIndex)
+	{
+		const PointLightGPU& light = lights[lightIndex];
+		for (int k = 0; k <= gridSteps; ++k)
+		{
+			for (int j = 0; j <= gridSteps; ++j)
+			{
+				for (int i = 0; i <= gridSteps; ++i)
+				{
+					const float dx = (2.0f * i / gridSteps - 1.0f) * light.radius;
+					const float dy = (2.0f * j / gridSteps - 1.0f) * light.radius;
+					const float dz = (2.0f * k / gridSteps - 1.0f) * light.radius;
+					if (dx * dx + dy * dy + dz * dz > light.radius * light.radius)
+					{
+						continue;
+					}
+
+					const DirectX::XMFLOAT3 point = {light.position.x + dx,
+													 light.position.y + dy,
+													 light.position.z + dz};
+					std::uint32_t			clusterIndex;
+					if (GetClusterIndex(builder.GetConstants(), point, clusterIndex) == false)
+					{
+						continue;
+					}
+
+					++checkedPoints;
+					if (IsListed(builder, clusterIndex, lightIndex) == false && missingPoints++ == 0)
+					{
+						std::cerr << "Cluster test: light " << lightIndex << " isn't listed in cluster " << clusterIndex
+								  << ", which contains (" << point.x << ", " << point.y << ", " << point.z << ")"
+								  << std::endl;
+					}
+				}
+			}
+		}
+	}
+
+	if (missingPoints > 0)
+	{
+		std::cerr << "Cluster test: " << missingPoints << " of " << checkedPoints << " points miss their light"
+				  << std::endl;
+		return false;
+	}
+
+	std::cout << "Cluster test: " << checkedPoints << " points of " << lights.size()
+			  << " lights all found in their clusters, " << builder.GetLightIndices().size() << " indices in total"
+			  << std::endl;
+	return true;
+}
+
+bool LightClusterTests::TestHiddenLightsAreSkipped()
+{
+	const std::vector<PointLightGPU> lights = {
+		{{0.0f, 0.0f, -20.0f}, 5.0f, {1.0f, 1.0f, 1.0f}, 1.0f},	  // behind the camera
+		{{-500.0f, 0.0f, 10.0f}, 5.0f, {1.0f, 1.0f, 1.0f}, 1.0f}, // far off to the left
+		{{0.0f, 300.0f, 10.0f}, 5.0f, {1.0f, 1.0f, 1.0f}, 1.0f},  // far above
+		{{0.0f, 0.0f, 1200.0f}, 5.0f, {1.0f, 1.0f, 1.0f}, 1.0f},  // past the far plane
+	};
+
+	LightClusterBuilder builder;
+	builder.Build(lights, DirectX::XMMatrixIdentity(), GetProjection(), nearZ, farZ);
+
+	if (builder.GetLightIndices().empty() == false)
+	{
+		std::cerr << "Cluster test: " << builder.GetLightIndices().size()
+				  << " cluster entries for lights that can't be seen, light " << builder.GetLightIndices().front()
+				  << " among them" << std::endl;
+		return false;
+	}
+
+	std::cout << "Cluster test: lights out of view are in no cluster" << std::endl;
+	return true;
+}
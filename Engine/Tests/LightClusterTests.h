@@ -0,0 +1,21 @@
+﻿#pragma once
+
+/**
+ * Builds clusters for synthetic lights in front of a fixed camera and checks which froxels each light ended up in.
+ * Doesn't touch D3D, same as LightClusterBuilder itself
+ */
+class LightClusterTests
+{
+public:
+	/**
+	 * @return false if any of the tests failed, what went wrong gets printed
+	 */
+	[[nodiscard]] static bool Run();
+
+private:
+	// Every point of a visible light has to find the light in its pixel's cluster, the way the point light pass looks
+	[[nodiscard]] static bool TestVisibleLightsAreListed();
+
+	// Lights behind the camera or off to the side can't show up in any cluster
+	[[nodiscard]] static bool TestHiddenLightsAreSkipped();
+};
@@ -0,0 +1,392 @@
+﻿#include "LightingTests.h"
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../Core/Metrics.h"
+#include "../World/BlockData.h"
+#include "../World/BlockDatabase.h"
+#include "../World/Chunk.h"
+#include "../World/EditBatch.h"
+#include "../World/World.h"
+
+namespace
+{
+	// Chunks per axis, small enough for the seeds to stay below the parallel threshold
+	constexpr std::int32_t worldChunks = 3;
+	constexpr std::int32_t worldBlocks = worldChunks * static_cast<std::int32_t>(Chunk::CHUNK_SIZE);
+} // namespace
+
+bool LightingTests::Run()
+{
+	bool passed = true;
+	for (std::uint32_t seed : {1u, 2u, 3u})
+	{
+		passed = TestParallelMatchesSerial(seed) && passed;
+		passed = TestEditsMatchSerial(seed) && passed;
+		passed = TestLightCells(seed) && passed;
+	}
+	return passed;
+}
+
+bool LightingTests::TestParallelMatchesSerial(std::uint32_t seed)
+{
+	using namespace DirectX;
+	const BlockDatabase& database = BlockDatabase::GetDatabase();
+
+	World serialWorld;
+	World parallelWorld;
+	FillWorld(serialWorld, seed);
+	FillWorld(parallelWorld, seed);
+
+	// Every light source and the top of the sky, written into both worlds the same way
+	std::vector<LightNode> blockLightSeeds;
+	std::vector<LightNode> skyLightSeeds;
+	for (std::int32_t z = 0; z < worldBlocks; ++z)
+	{
+		for (std::int32_t y = 0; y < worldBlocks; ++y)
+		{
+			for (std::int32_t x = 0; x < worldBlocks; ++x)
+			{
+				const XMINT3	   position		 = {x, y, z};
+				const BlockType	   type			 = serialWorld.GetBlock(position).type;
+				const std::uint8_t lightEmission = database.GetLightEmission(type);
+				if (lightEmission > 0)
+				{
+					parallelWorld.SetBlockLightLevel(position, lightEmission);
+					blockLightSeeds.emplace_back(position, lightEmission);
+				}
+
+				if (y == worldBlocks - 1 && database.IsOpaque(type) == false)
+				{
+					parallelWorld.SetSkyLightLevel(position, 15);
+					skyLightSeeds.emplace_back(position, 15);
+				}
+			}
+		}
+	}
+
+	// The serial propagation would hand bigger batches over to the parallel one
+	if (blockLightSeeds.size() >= VoxelLightingEngine::PARALLEL_PROPAGATION_THRESHOLD
+		|| skyLightSeeds.size() >= VoxelLightingEngine::PARALLEL_PROPAGATION_THRESHOLD)
+	{
+		std::cerr << "Light test " << seed << ": too many seeds to propagate serially" << std::endl;
+		return false;
+	}
+
+	LightSerially(serialWorld);
+
+	// Twice in a row, so the second one runs on workers the first one left behind
+	parallelWorld.lightEngine_.PropagateLightParallel(blockLightSeeds, true);
+	parallelWorld.lightEngine_.PropagateLightParallel(skyLightSeeds, false);
+
+	const std::size_t mismatches = CompareLight(serialWorld, parallelWorld, "Light test");
+	if (mismatches > 0)
+	{
+		std::cerr << "Light test " << seed << ": " << mismatches << " blocks differ" << std::endl;
+		return false;
+	}
+
+	std::cout << "Light test " << seed << ": " << blockLightSeeds.size() << " block light and "
+			  << skyLightSeeds.size() << " sky light seeds propagated the same" << std::endl;
+	return true;
+}
+
+bool LightingTests::TestEditsMatchSerial(std::uint32_t seed)
+{
+	using namespace DirectX;
+
+	// A box of this many blocks at the top of the world gets broken every step, its sky light alone is enough seeds
+	// for the batch to go parallel. The scattered edits hit the darkness and the relighting everywhere else
+	constexpr std::int32_t boxSize		   = 24;
+	constexpr std::int32_t boxHeight	   = 3;
+	constexpr std::size_t  scatteredEdits  = 1500;
+	constexpr std::size_t  steps		   = 4;
+	const Metrics::Metric* parallelCounter = nullptr;
+	for (const Metrics::Metric* metric = Metrics::GetFirstMetric(); metric != nullptr; metric = metric->GetNext())
+	{
+		if (std::string_view(metric->GetName()) == "Lighting.ParallelPropagations")
+		{
+			parallelCounter = metric;
+		}
+	}
+	assert(parallelCounter != nullptr && parallelCounter->GetType() == Metrics::MetricType::Counter);
+	auto GetParallelPropagations = [&]()
+	{
+		return static_cast<const Metrics::Counter*>(parallelCounter)->GetValue();
+	};
+
+	World serialWorld;
+	World batchedWorld;
+	FillWorld(serialWorld, seed);
+	FillWorld(batchedWorld, seed);
+	LightSerially(serialWorld);
+	LightSerially(batchedWorld);
+
+	std::mt19937					   random(seed * 7919);
+	std::uniform_int_distribution<int> coordinate(0, worldBlocks - 1);
+	std::uniform_int_distribution<int> boxCorner(0, worldBlocks - boxSize);
+	std::uniform_int_distribution<int> typeRoll(0, 99);
+
+	std::uint64_t parallelBatches = 0;
+	for (std::size_t step = 0; step < steps; ++step)
+	{
+		// In order, a later edit of the same position overrides an earlier one in both worlds
+		std::vector<std::pair<XMINT3, BlockType>> edits;
+		const std::int32_t						  boxX = boxCorner(random);
+		const std::int32_t						  boxZ = boxCorner(random);
+		for (std::int32_t z = boxZ; z < boxZ + boxSize; ++z)
+		{
+			for (std::int32_t y = worldBlocks - boxHeight; y < worldBlocks; ++y)
+			{
+				for (std::int32_t x = boxX; x < boxX + boxSize; ++x)
+				{
+					edits.emplace_back(XMINT3{x, y, z}, BlockType::Air);
+				}
+			}
+		}
+		for (std::size_t i = 0; i < scatteredEdits; ++i)
+		{
+			const int		roll = typeRoll(random);
+			const BlockType type = roll < 45 ? BlockType::Air : roll < 90 ? BlockType::Stone : BlockType::Glowstone;
+			edits.emplace_back(XMINT3{coordinate(random), coordinate(random), coordinate(random)}, type);
+		}
+
+		// One at a time, the way World::SetBlock does it
+		for (const auto& [position, type] : edits)
+		{
+			Chunk*			   chunk	= serialWorld.GetChunkFromBlock(position);
+			const std::int32_t x		= position.x & (static_cast<std::int32_t>(Chunk::CHUNK_SIZE) - 1);
+			const std::int32_t y		= position.y & (static_cast<std::int32_t>(Chunk::CHUNK_SIZE) - 1);
+			const std::int32_t z		= position.z & (static_cast<std::int32_t>(Chunk::CHUNK_SIZE) - 1);
+			const BlockType	   oldType	= chunk->GetBlock(x, y, z).type;
+			if (oldType == type)
+			{
+				continue;
+			}
+
+			chunk->SetBlockType(x, y, z, type);
+			serialWorld.lightEngine_.UpdateSkyLight(position);
+			serialWorld.lightEngine_.UpdateBlockLight(position, oldType, type);
+		}
+
+		EditBatch batch;
+		for (const auto& [position, type] : edits)
+		{
+			batch.SetBlock(position, type);
+		}
+		const std::uint64_t parallelBefore = GetParallelPropagations();
+		batchedWorld.ApplyEditBatch(batch);
+		parallelBatches += GetParallelPropagations() > parallelBefore ? 1 : 0;
+
+		const std::size_t mismatches = CompareLight(serialWorld, batchedWorld, "Edit test");
+		if (mismatches > 0)
+		{
+			std::cerr << "Edit test " << seed << ": " << mismatches << " blocks differ after step " << step
+					  << std::endl;
+			return false;
+		}
+	}
+
+	if (parallelBatches == 0)
+	{
+		std::cerr << "Edit test " << seed << ": none of the batches got propagated in parallel" << std::endl;
+		return false;
+	}
+
+	std::cout << "Edit test " << seed << ": " << steps << " steps of edits lit the same one at a time and batched, "
+			  << parallelBatches << " of the batches in parallel" << std::endl;
+	return true;
+}
+
+bool LightingTests::TestLightCells(std::uint32_t seed)
+{
+	using namespace DirectX;
+
+	constexpr std::size_t operations = 4000;
+	constexpr float		  halfSize	 = static_cast<float>(Chunk::CHUNK_SIZE) / 2.0f;
+
+	World				 world;
+	VoxelLightingEngine& engine = world.lightEngine_;
+	BlockData			 blockData = *BlockDatabase::GetDatabase().GetBlockData(BlockType::Glowstone);
+
+	// Radius of the light expected at every position. Only a corner of 4x4x4 blocks of each of 2x2x2 cells gets used,
+	// so the same positions keep getting lights added, replaced and removed
+	std::unordered_map<XMINT3, float, Math::XMINT3Hash> expected;
+	std::mt19937										random(seed * 104729);
+	std::uniform_int_distribution<int>					coordinate(0, 7);
+	std::uniform_int_distribution<int>					emission(1, 15);
+	std::uniform_int_distribution<int>					roll(0, 99);
+	auto												RandomCoordinate = [&]()
+	{
+		const int value = coordinate(random);
+		return value < 4 ? value : static_cast<int>(Chunk::CHUNK_SIZE) + value - 4;
+	};
+	for (std::size_t i = 0; i < operations; ++i)
+	{
+		const XMINT3 position = {RandomCoordinate(), RandomCoordinate(), RandomCoordinate()};
+		if (roll(random) < 70)
+		{
+			blockData.lightEmissionLevel = static_cast<std::uint8_t>(emission(random));
+			engine.AddBlockLight(position, blockData);
+			expected[position] = blockData.lightEmissionLevel;
+		}
+		else
+		{
+			engine.RemoveBlockLight(position);
+			expected.erase(position);
+		}
+	}
+
+	std::size_t lightCount = 0;
+	for (const auto& [cellCoordinates, cell] : engine.lightCells_)
+	{
+		if (cell.positions.size() != cell.lights.size() || cell.positions.size() != cell.indices.size())
+		{
+			std::cerr << "Light cell test " << seed << ": cell (" << cellCoordinates.x << ", " << cellCoordinates.y
+					  << ", " << cellCoordinates.z << ") has " << cell.positions.size() << " positions, "
+					  << cell.lights.size() << " lights and " << cell.indices.size() << " indices" << std::endl;
+			return false;
+		}
+
+		for (std::uint32_t i = 0; i < cell.positions.size(); ++i)
+		{
+			const XMINT3 position = cell.positions[i];
+			const auto	 indexIt  = cell.indices.find(VoxelLightingEngine::GetLightCellIndex(position));
+			const auto	 lightIt  = expected.find(position);
+			if (indexIt == cell.indices.end() || indexIt->second != i || lightIt == expected.end()
+				|| lightIt->second != cell.lights[i].bounds.Radius)
+			{
+				std::cerr << "Light cell test " << seed << ": light at (" << position.x << ", " << position.y << ", "
+						  << position.z << ") isn't the one that was added last" << std::endl;
+				return false;
+			}
+
+			if (cell.bounds.Extents.x < halfSize + lightIt->second)
+			{
+				std::cerr << "Light cell test " << seed << ": light at (" << position.x << ", " << position.y << ", "
+						  << position.z << ") sticks out of its cell's bounds" << std::endl;
+				return false;
+			}
+		}
+		lightCount += cell.lights.size();
+	}
+
+	if (lightCount != expected.size())
+	{
+		std::cerr << "Light cell test " << seed << ": " << lightCount << " lights in the cells, " << expected.size()
+				  << " expected" << std::endl;
+		return false;
+	}
+
+	std::cout << "Light cell test " << seed << ": " << lightCount << " lights left after " << operations
+			  << " random additions and removals" << std::endl;
+	return true;
+}
+
+void LightingTests::LightSerially(World& world)
+{
+	using namespace DirectX;
+	const BlockDatabase& database = BlockDatabase::GetDatabase();
+	VoxelLightingEngine& engine	  = world.lightEngine_;
+
+	for (std::int32_t z = 0; z < worldBlocks; ++z)
+	{
+		for (std::int32_t y = 0; y < worldBlocks; ++y)
+		{
+			for (std::int32_t x = 0; x < worldBlocks; ++x)
+			{
+				const XMINT3	   position		 = {x, y, z};
+				const std::uint8_t lightEmission = database.GetLightEmission(world.GetBlock(position).type);
+				if (lightEmission > 0)
+				{
+					world.SetBlockLightLevel(position, lightEmission);
+					engine.propagationQueue.emplace(position, lightEmission);
+				}
+			}
+		}
+	}
+	engine.PropagateBlockLight();
+
+	for (std::int32_t z = 0; z < worldBlocks; ++z)
+	{
+		for (std::int32_t x = 0; x < worldBlocks; ++x)
+		{
+			const XMINT3 position = {x, worldBlocks - 1, z};
+			if (database.IsOpaque(world.GetBlock(position).type) == false)
+			{
+				world.SetSkyLightLevel(position, 15);
+				engine.propagationQueue.emplace(position, 15);
+			}
+		}
+	}
+	engine.PropagateSkyLight();
+}
+
+std::size_t LightingTests::CompareLight(World& expected, World& actual, const char* testName)
+{
+	using namespace DirectX;
+
+	std::size_t mismatches = 0;
+	for (std::int32_t z = 0; z < worldBlocks; ++z)
+	{
+		for (std::int32_t y = 0; y < worldBlocks; ++y)
+		{
+			for (std::int32_t x = 0; x < worldBlocks; ++x)
+			{
+				const Block expectedBlock = expected.GetBlock(XMINT3{x, y, z});
+				const Block actualBlock	  = actual.GetBlock(XMINT3{x, y, z});
+				if (expectedBlock.GetBlockLightLevel() == actualBlock.GetBlockLightLevel()
+					&& expectedBlock.GetSkyLightLevel() == actualBlock.GetSkyLightLevel())
+				{
+					continue;
+				}
+
+				if (mismatches++ == 0)
+				{
+					std::cerr << testName << ": block (" << x << ", " << y << ", " << z << ") has block light "
+							  << +expectedBlock.GetBlockLightLevel() << " and sky light "
+							  << +expectedBlock.GetSkyLightLevel() << " in one world, but "
+							  << +actualBlock.GetBlockLightLevel() << " and " << +actualBlock.GetSkyLightLevel()
+							  << " in the other" << std::endl;
+				}
+			}
+		}
+	}
+	return mismatches;
+}
+
+void LightingTests::FillWorld(World& world, std::uint32_t seed)
+{
+	std::mt19937					   random(seed);
+	std::uniform_int_distribution<int> distribution(0, 999);
+
+	// Light levels start out at 0, the seeds are the only light there is
+	auto blocks = std::make_unique<Chunk::BlockArray>();
+	for (std::int32_t cz = 0; cz < worldChunks; ++cz)
+	{
+		for (std::int32_t cy = 0; cy < worldChunks; ++cy)
+		{
+			for (std::int32_t cx = 0; cx < worldChunks; ++cx)
+			{
+				// Mostly air with walls in between, light has to find its way around them
+				for (Block& block : *blocks)
+				{
+					const int roll = distribution(random);
+					block.type	   = roll < 350 ? BlockType::Stone : roll < 354 ? BlockType::Glowstone : BlockType::Air;
+					block.lightLevel = 0;
+				}
+
+				auto chunk = std::make_unique<Chunk>(DirectX::XMINT3{cx, cy, cz});
+				chunk->SetBlocks(*blocks);
+				world.AddChunk(std::move(chunk));
+			}
+		}
+	}
+}
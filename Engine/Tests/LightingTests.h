@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+
+class World;
+
+/**
+ * Runs the parallel light propagation against the serial one on the same blocks, both have to end up with the same
+ * light levels everywhere. First for the initial flood, then for random edits applied one at a time in one world and
+ * as batches big enough to go parallel in the other. Only needs the block database, no device or window
+ */
+class LightingTests
+{
+public:
+	/**
+	 * @return false if any of the tests failed, what went wrong gets printed
+	 */
+	[[nodiscard]] static bool Run();
+
+private:
+	[[nodiscard]] static bool TestParallelMatchesSerial(std::uint32_t seed);
+	[[nodiscard]] static bool TestEditsMatchSerial(std::uint32_t seed);
+	// Point lights added, replaced and removed at random have to stay findable, and inside their cell's bounds
+	[[nodiscard]] static bool TestLightCells(std::uint32_t seed);
+
+	// Floods the light of every light source and of the sky, on the calling thread
+	static void LightSerially(World& world);
+
+	/**
+	 * @return number of blocks whose light levels differ, the first one gets printed
+	 */
+	[[nodiscard]] static std::size_t CompareLight(World& expected, World& actual, const char* testName);
+
+	// Scatters stone, glowstone and air over a few chunks, the same way for the same seed
+	static void FillWorld(World& world, std::uint32_t seed);
+};
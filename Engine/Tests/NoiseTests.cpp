@@ -0,0 +1,154 @@
+﻿#include "NoiseTests.h"
+
+#include <DirectXMath.h>
+#include <bit>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../Math/Noise.h"
+#include "../World/Chunk.h"
+#include "../World/ChunkGenerators/NoiseGenerator.h"
+
+namespace
+{
+	// Columns per axis and chunks per column, tall enough to reach over the highest surface
+	constexpr std::int32_t areaColumns	= 4;
+	constexpr std::int32_t columnChunks = 10;
+
+	// FNV-1a
+	void Hash(std::uint64_t& hash, const void* data, std::size_t size)
+	{
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			hash ^= static_cast<const std::uint8_t*>(data)[i];
+			hash *= 0x100000001b3;
+		}
+	}
+
+	std::uint64_t HashChunk(const Chunk& chunk)
+	{
+		std::uint64_t hash = 0xcbf29ce484222325;
+		Hash(hash, chunk.GetBlocks().data(), sizeof(Chunk::BlockArray));
+		return hash;
+	}
+} // namespace
+
+bool NoiseTests::Run()
+{
+	bool passed = true;
+	for (std::uint32_t seed : {1u, 2u, 3u})
+	{
+		passed = TestRowsMatchScalar(seed) && passed;
+		passed = TestChunksIgnoreOrder(seed) && passed;
+	}
+	return passed;
+}
+
+bool NoiseTests::TestRowsMatchScalar(std::uint32_t seed)
+{
+	using namespace Math::Noise;
+
+	constexpr std::size_t rows = 4000;
+
+	std::mt19937								 random(seed);
+	std::uniform_int_distribution<int>			 coordinate(-100000, 100000);
+	std::uniform_int_distribution<int>			 length(1, 37); // whole SSE2 registers and every tail length
+	std::uniform_int_distribution<int>			 octaves(1, 6);
+	std::uniform_real_distribution<float>		 frequency(1.0f / 256.0f, 1.0f / 4.0f);
+	std::uniform_int_distribution<std::uint32_t> noiseSeed;
+
+	std::vector<float> row;
+	std::size_t		   samples = 0;
+	for (std::size_t i = 0; i < rows; ++i)
+	{
+		FractalSettings settings;
+		settings.seed	   = noiseSeed(random);
+		settings.frequency = frequency(random);
+		settings.octaves   = static_cast<std::uint32_t>(octaves(random));
+
+		const std::int32_t x = coordinate(random);
+		const std::int32_t y = coordinate(random);
+		const std::int32_t z = coordinate(random);
+		row.resize(static_cast<std::size_t>(length(random)));
+
+		const bool threeDimensional = i % 2 == 1;
+		if (threeDimensional)
+		{
+			Fractal3Row(x, y, z, settings, row);
+		}
+		else
+		{
+			Fractal2Row(x, z, settings, row);
+		}
+
+		for (std::size_t j = 0; j < row.size(); ++j)
+		{
+			const float sampleX = static_cast<float>(x + static_cast<std::int32_t>(j));
+			const float expected =
+				threeDimensional ? Fractal3(sampleX, static_cast<float>(y), static_cast<float>(z), settings)
+								 : Fractal2(sampleX, static_cast<float>(z), settings);
+			if (std::bit_cast<std::uint32_t>(expected) != std::bit_cast<std::uint32_t>(row[j]))
+			{
+				std::cerr << "Noise row test " << seed << ": Fractal" << (threeDimensional ? 3 : 2) << " at ("
+						  << sampleX << ", " << y << ", " << z << ") is " << expected << " scalar, but " << row[j]
+						  << " in a row of " << row.size() << std::endl;
+				return false;
+			}
+		}
+		samples += row.size();
+	}
+
+	std::cout << "Noise row test " << seed << ": " << samples << " samples in " << rows
+			  << " rows match the scalar noise bit for bit" << std::endl;
+	return true;
+}
+
+bool NoiseTests::TestChunksIgnoreOrder(std::uint32_t seed)
+{
+	using namespace DirectX;
+
+	NoiseGenerator::Settings uncachedSettings;
+	uncachedSettings.columnCacheSize = 0;
+
+	// The generator doesn't look at the world, only the decoration goes through it
+	NoiseGenerator cachedGenerator(nullptr, seed, NoiseGenerator::Settings());
+	NoiseGenerator uncachedGenerator(nullptr, seed, uncachedSettings);
+
+	std::vector<XMINT3> positions;
+	for (std::int32_t z = -areaColumns / 2; z < areaColumns / 2; ++z)
+	{
+		for (std::int32_t x = -areaColumns / 2; x < areaColumns / 2; ++x)
+		{
+			for (std::int32_t y = 0; y < columnChunks; ++y)
+			{
+				positions.push_back({x, y, z});
+			}
+		}
+	}
+
+	std::vector<std::uint64_t> expectedHashes;
+	for (const XMINT3& position : positions)
+	{
+		Chunk chunk(position);
+		cachedGenerator.FillChunk(&chunk);
+		expectedHashes.push_back(HashChunk(chunk));
+	}
+
+	for (std::size_t i = positions.size(); i-- > 0;)
+	{
+		Chunk chunk(positions[i]);
+		uncachedGenerator.FillChunk(&chunk);
+		if (HashChunk(chunk) != expectedHashes[i])
+		{
+			std::cerr << "Noise chunk test " << seed << ": chunk (" << positions[i].x << ", " << positions[i].y << ", "
+					  << positions[i].z << ") changes with the generation order" << std::endl;
+			return false;
+		}
+	}
+
+	std::cout << "Noise chunk test " << seed << ": " << positions.size()
+			  << " chunks hash the same generated backwards without the column cache" << std::endl;
+	return true;
+}
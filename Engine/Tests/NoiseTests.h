@@ -0,0 +1,22 @@
+﻿#pragma once
+#include <cstdint>
+
+/**
+ * Checks that the SSE2 noise rows give the same bits as the scalar reference, and that noise terrain comes out the same
+ * no matter in which order its chunks get generated. Needs nothing but the noise and the chunks
+ */
+class NoiseTests
+{
+public:
+	/**
+	 * @return false if any of the tests failed, what went wrong gets printed
+	 */
+	[[nodiscard]] static bool Run();
+
+private:
+	// Random rows of random lengths and settings, every sample has to be bit-identical to Fractal2/Fractal3
+	[[nodiscard]] static bool TestRowsMatchScalar(std::uint32_t seed);
+
+	// Chunks generated forwards with the column cache and backwards without it have to hash the same
+	[[nodiscard]] static bool TestChunksIgnoreOrder(std::uint32_t seed);
+};
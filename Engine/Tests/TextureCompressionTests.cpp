@@ -0,0 +1,374 @@
+﻿#include "TextureCompressionTests.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Graphics/TextureCompression.h"
+
+namespace
+{
+	// Not a multiple of 4, so the repeated edge texels of the last blocks get encoded too
+	constexpr std::uint32_t imageSize  = 62;
+	constexpr std::uint32_t blockCount = (imageSize + 3) / 4;
+
+	// Weights of the second endpoint by index, out of 64, for 2, 3 and 4 bit indices
+	constexpr std::array<std::uint32_t, 4>	bc7Weights2 = {0, 21, 43, 64};
+	constexpr std::array<std::uint32_t, 8>	bc7Weights3 = {0, 9, 18, 27, 37, 46, 55, 64};
+	constexpr std::array<std::uint32_t, 16> bc7Weights4 = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+	// Reads a block from its least significant bit up
+	class BitReader
+	{
+	public:
+		explicit BitReader(const std::uint8_t* block) : block_(block) {}
+
+		std::uint32_t Read(std::uint32_t bitCount)
+		{
+			std::uint32_t value = 0;
+			for (std::uint32_t bit = 0; bit < bitCount; ++bit, ++position_)
+			{
+				value |= static_cast<std::uint32_t>(block_[position_ / 8] >> (position_ % 8) & 1) << bit;
+			}
+			return value;
+		}
+
+	private:
+		const std::uint8_t* block_;
+		std::uint32_t		position_ = 0;
+	};
+
+	using BlockTexels = std::array<std::array<std::uint8_t, 4>, 16>;
+
+	std::uint8_t Interpolate(std::uint32_t first, std::uint32_t second, std::uint32_t weight)
+	{
+		return static_cast<std::uint8_t>(((64 - weight) * first + weight * second + 32) >> 6);
+	}
+
+	void DecodeBC1(const std::uint8_t* block, BlockTexels& outTexels)
+	{
+		std::array<std::array<std::uint32_t, 4>, 4> palette{};
+		for (std::size_t endpoint = 0; endpoint < 2; ++endpoint)
+		{
+			const std::uint32_t color = block[endpoint * 2] | block[endpoint * 2 + 1] << 8;
+			const std::uint32_t red	  = color >> 11;
+			const std::uint32_t green = color >> 5 & 0x3f;
+			const std::uint32_t blue  = color & 0x1f;
+			palette[endpoint] = {red << 3 | red >> 2, green << 2 | green >> 4, blue << 3 | blue >> 2, 255};
+		}
+
+		const bool fourColors = (block[0] | block[1] << 8) > (block[2] | block[3] << 8);
+		for (std::size_t channel = 0; channel < 3; ++channel)
+		{
+			const std::uint32_t first  = palette[0][channel];
+			const std::uint32_t second = palette[1][channel];
+			palette[2][channel] = fourColors ? (2 * first + second + 1) / 3 : (first + second + 1) / 2;
+			palette[3][channel] = fourColors ? (first + 2 * second + 1) / 3 : 0;
+		}
+		palette[2][3] = 255;
+		palette[3][3] = fourColors ? 255 : 0;
+
+		const std::uint32_t indices =
+			block[4] | block[5] << 8 | block[6] << 16 | static_cast<std::uint32_t>(block[7]) << 24;
+		for (std::size_t texel = 0; texel < 16; ++texel)
+		{
+			const auto& color = palette[indices >> (texel * 2) & 3];
+			for (std::size_t channel = 0; channel < 4; ++channel)
+			{
+				outTexels[texel][channel] = static_cast<std::uint8_t>(color[channel]);
+			}
+		}
+	}
+
+	void DecodeBC4(const std::uint8_t* block, std::size_t channel, BlockTexels& outTexels)
+	{
+		const std::uint32_t first  = block[0];
+		const std::uint32_t second = block[1];
+
+		std::array<std::uint32_t, 8> palette = {first, second};
+		for (std::uint32_t i = 1; i < 7; ++i)
+		{
+			if (first > second)
+			{
+				palette[i + 1] = ((7 - i) * first + i * second + 3) / 7;
+			}
+			else if (i < 5)
+			{
+				palette[i + 1] = ((5 - i) * first + i * second + 2) / 5;
+			}
+		}
+		if (first <= second)
+		{
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		std::uint64_t indices = 0;
+		for (std::size_t byte = 0; byte < 6; ++byte)
+		{
+			indices |= static_cast<std::uint64_t>(block[2 + byte]) << (byte * 8);
+		}
+		for (std::size_t texel = 0; texel < 16; ++texel)
+		{
+			outTexels[texel][channel] = static_cast<std::uint8_t>(palette[indices >> (texel * 3) & 7]);
+		}
+	}
+
+	// Only the single subset modes 5 and 6, the encoder doesn't use the others
+	bool DecodeBC7(const std::uint8_t* block, BlockTexels& outTexels)
+	{
+		BitReader reader(block);
+		if ((block[0] & 0x7f) == 1 << 6)
+		{
+			reader.Read(7);
+
+			std::array<std::array<std::uint32_t, 4>, 2> endpoints{};
+			for (std::size_t channel = 0; channel < 4; ++channel)
+			{
+				endpoints[0][channel] = reader.Read(7) << 1;
+				endpoints[1][channel] = reader.Read(7) << 1;
+			}
+			for (auto& endpoint : endpoints)
+			{
+				const std::uint32_t pBit = reader.Read(1);
+				for (std::uint32_t& value : endpoint)
+				{
+					value |= pBit;
+				}
+			}
+
+			for (std::size_t texel = 0; texel < 16; ++texel)
+			{
+				const std::uint32_t weight = bc7Weights4[reader.Read(texel == 0 ? 3 : 4)];
+				for (std::size_t channel = 0; channel < 4; ++channel)
+				{
+					outTexels[texel][channel] = Interpolate(endpoints[0][channel], endpoints[1][channel], weight);
+				}
+			}
+			return true;
+		}
+
+		if ((block[0] & 0x3f) != 1 << 5)
+		{
+			return false;
+		}
+
+		reader.Read(6);
+		const std::uint32_t rotation = reader.Read(2);
+
+		std::array<std::array<std::uint32_t, 4>, 2> endpoints{};
+		for (std::size_t channel = 0; channel < 3; ++channel)
+		{
+			for (auto& endpoint : endpoints)
+			{
+				const std::uint32_t value = reader.Read(7);
+				endpoint[channel]		  = value << 1 | value >> 6;
+			}
+		}
+		endpoints[0][3] = reader.Read(8);
+		endpoints[1][3] = reader.Read(8);
+
+		for (std::size_t texel = 0; texel < 16; ++texel)
+		{
+			const std::uint32_t weight = bc7Weights2[reader.Read(texel == 0 ? 1 : 2)];
+			for (std::size_t channel = 0; channel < 3; ++channel)
+			{
+				outTexels[texel][channel] = Interpolate(endpoints[0][channel], endpoints[1][channel], weight);
+			}
+		}
+		for (std::size_t texel = 0; texel < 16; ++texel)
+		{
+			const std::uint32_t weight = bc7Weights2[reader.Read(texel == 0 ? 1 : 2)];
+			outTexels[texel][3]		   = Interpolate(endpoints[0][3], endpoints[1][3], weight);
+			if (rotation > 0)
+			{
+				std::swap(outTexels[texel][3], outTexels[texel][rotation - 1]);
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @param outRgba gets imageSize * imageSize texels, 4 channels each
+	 * @return false for block data that doesn't fit the image, or BC7 modes the decoder doesn't know
+	 */
+	bool Decompress(DXGI_FORMAT format, const std::vector<std::uint8_t>& blocks, std::vector<std::uint8_t>& outRgba)
+	{
+		const std::size_t blockSize = TextureCompression::GetBlockSize(format);
+		if (blocks.size() != blockCount * blockCount * blockSize)
+		{
+			return false;
+		}
+
+		outRgba.assign(imageSize * imageSize * 4, 0);
+		for (std::uint32_t blockY = 0; blockY < blockCount; ++blockY)
+		{
+			for (std::uint32_t blockX = 0; blockX < blockCount; ++blockX)
+			{
+				const std::uint8_t* block = blocks.data() + (blockY * blockCount + blockX) * blockSize;
+
+				BlockTexels texels{};
+				switch (format)
+				{
+				case DXGI_FORMAT_BC1_UNORM:
+				case DXGI_FORMAT_BC1_UNORM_SRGB:
+					DecodeBC1(block, texels);
+					break;
+				case DXGI_FORMAT_BC4_UNORM:
+					DecodeBC4(block, 0, texels);
+					break;
+				case DXGI_FORMAT_BC5_UNORM:
+					DecodeBC4(block, 0, texels);
+					DecodeBC4(block + 8, 1, texels);
+					break;
+				case DXGI_FORMAT_BC7_UNORM:
+				case DXGI_FORMAT_BC7_UNORM_SRGB:
+					if (DecodeBC7(block, texels) == false)
+					{
+						return false;
+					}
+					break;
+				default:
+					return false;
+				}
+
+				for (std::uint32_t texel = 0; texel < 16; ++texel)
+				{
+					const std::uint32_t x = blockX * 4 + texel % 4;
+					const std::uint32_t y = blockY * 4 + texel / 4;
+					if (x < imageSize && y < imageSize)
+					{
+						std::ranges::copy(texels[texel], outRgba.begin() + (y * imageSize + x) * 4);
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	// Every channel ramps along a different direction, alpha against the green one
+	std::vector<std::uint8_t> MakeGradient()
+	{
+		std::vector<std::uint8_t> rgba(imageSize * imageSize * 4);
+		for (std::uint32_t y = 0; y < imageSize; ++y)
+		{
+			for (std::uint32_t x = 0; x < imageSize; ++x)
+			{
+				std::uint8_t* texel = &rgba[(y * imageSize + x) * 4];
+				texel[0]			= static_cast<std::uint8_t>(x * 255 / (imageSize - 1));
+				texel[1]			= static_cast<std::uint8_t>(y * 255 / (imageSize - 1));
+				texel[2]			= static_cast<std::uint8_t>((x + y) * 255 / (2 * imageSize - 2));
+				texel[3]			= static_cast<std::uint8_t>(255 - texel[1]);
+			}
+		}
+		return rgba;
+	}
+
+	// Something like a block texture, a shade of color with grain on top. Alpha gets grain of its own, like the
+	// channels of an ARM map that have nothing to do with each other
+	std::vector<std::uint8_t> MakeNoise(std::uint32_t seed)
+	{
+		std::mt19937					   random(seed);
+		std::uniform_int_distribution<int> luminance(-24, 24);
+		std::uniform_int_distribution<int> tint(-6, 6);
+
+		std::vector<std::uint8_t> rgba(imageSize * imageSize * 4);
+		for (std::uint32_t y = 0; y < imageSize; ++y)
+		{
+			for (std::uint32_t x = 0; x < imageSize; ++x)
+			{
+				const int shade = luminance(random);
+				const int base	= static_cast<int>((x + y) * 64 / (2 * imageSize - 2));
+
+				std::uint8_t* texel = &rgba[(y * imageSize + x) * 4];
+				texel[0]			= static_cast<std::uint8_t>(std::clamp(120 + base + shade + tint(random), 0, 255));
+				texel[1]			= static_cast<std::uint8_t>(std::clamp(100 + base + shade + tint(random), 0, 255));
+				texel[2]			= static_cast<std::uint8_t>(std::clamp(70 + base + shade + tint(random), 0, 255));
+				texel[3]			= static_cast<std::uint8_t>(std::clamp(128 + luminance(random), 0, 255));
+			}
+		}
+		return rgba;
+	}
+} // namespace
+
+bool TextureCompressionTests::Run()
+{
+	struct RoundTrip
+	{
+		DXGI_FORMAT	  format;
+		const char*	  name;
+		std::uint32_t channelCount;
+		double		  gradientFloor;
+		double		  noiseFloor;
+	};
+
+	// The noise floors sit a little under the PSNR the encoder reached on the bundled textures (BC7 ARM 35.2, BC5
+	// normal 36.3, BC4 height 36.9, BC1 emissive 25.6 dB). Gradients are easy, they get floors 1.5 dB under today's
+	constexpr std::array<RoundTrip, 4> roundTrips = {{
+		{DXGI_FORMAT_BC7_UNORM_SRGB, "BC7", 4, 44.5, 34.5},
+		{DXGI_FORMAT_BC5_UNORM, "BC5", 2, 51.5, 35.5},
+		{DXGI_FORMAT_BC4_UNORM, "BC4", 1, 51.5, 36.0},
+		{DXGI_FORMAT_BC1_UNORM_SRGB, "BC1", 3, 36.5, 25.0},
+	}};
+
+	const std::vector<std::uint8_t> gradient = MakeGradient();
+	const std::vector<std::uint8_t> noise	 = MakeNoise(1);
+
+	bool passed = true;
+	for (const RoundTrip& roundTrip : roundTrips)
+	{
+		const std::string name = roundTrip.name;
+		passed = TestRoundTrip(roundTrip.format, (name + " gradient").c_str(), gradient, roundTrip.channelCount,
+							   roundTrip.gradientFloor)
+			  && passed;
+		passed = TestRoundTrip(roundTrip.format, (name + " noise").c_str(), noise, roundTrip.channelCount,
+							   roundTrip.noiseFloor)
+			  && passed;
+	}
+	return passed;
+}
+
+bool TextureCompressionTests::TestRoundTrip(DXGI_FORMAT					  format,
+											const char*					  testName,
+											std::span<const std::uint8_t> rgba,
+											std::uint32_t				  channelCount,
+											double						  minPsnr)
+{
+	std::vector<std::uint8_t> blocks;
+	TextureCompression::Compress(format, rgba, imageSize, imageSize, blocks);
+
+	std::vector<std::uint8_t> decoded;
+	if (Decompress(format, blocks, decoded) == false)
+	{
+		std::cerr << "Compression test " << testName << ": the blocks can't be decoded" << std::endl;
+		return false;
+	}
+
+	double squaredError = 0.0;
+	for (std::size_t texel = 0; texel < imageSize * imageSize; ++texel)
+	{
+		for (std::size_t channel = 0; channel < channelCount; ++channel)
+		{
+			const double difference = static_cast<double>(rgba[texel * 4 + channel]) - decoded[texel * 4 + channel];
+			squaredError += difference * difference;
+		}
+	}
+
+	const double meanSquaredError = squaredError / (imageSize * imageSize * channelCount);
+	const double psnr = meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+	if (psnr < minPsnr)
+	{
+		std::cerr << "Compression test " << testName << ": " << std::fixed << std::setprecision(1) << psnr
+				  << " dB, below the floor of " << minPsnr << " dB" << std::endl;
+		return false;
+	}
+
+	std::cout << "Compression test " << testName << ": " << std::fixed << std::setprecision(1) << psnr
+			  << " dB, the floor is " << minPsnr << " dB" << std::endl;
+	return true;
+}
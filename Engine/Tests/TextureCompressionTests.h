@@ -0,0 +1,31 @@
+﻿#pragma once
+#include <cstdint>
+#include <d3d11.h>
+#include <span>
+
+/**
+ * Compresses synthetic images into every format of the texture pack and decodes the blocks again with a decoder
+ * written after the format specs, separate from the encoder's own palette code. The PSNR of every format has to stay
+ * above its floor. Runs on the CPU only, no device needed
+ */
+class TextureCompressionTests
+{
+public:
+	/**
+	 * @return false if any of the tests failed, what went wrong gets printed
+	 */
+	[[nodiscard]] static bool Run();
+
+private:
+	/**
+	 * @param testName what the messages call the format and image
+	 * @param rgba imageSize * imageSize texels, 4 channels each
+	 * @param channelCount the first this many channels count towards the PSNR, the format doesn't store the others
+	 * @param minPsnr in dB
+	 */
+	[[nodiscard]] static bool TestRoundTrip(DXGI_FORMAT					  format,
+											const char*					  testName,
+											std::span<const std::uint8_t> rgba,
+											std::uint32_t				  channelCount,
+											double						  minPsnr);
+};
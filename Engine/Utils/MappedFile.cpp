@@ -0,0 +1,243 @@
+﻿#include "MappedFile.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	HANDLE file = CreateFileW(path.c_str(),
+							  GENERIC_READ | GENERIC_WRITE,
+							  FILE_SHARE_READ,
+							  nullptr,
+							  OPEN_ALWAYS,
+							  FILE_ATTRIBUTE_NORMAL,
+							  nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file, &size) == FALSE)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	file_ = file;
+	size_ = static_cast<std::uint64_t>(size.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	Unmap();
+	if (file_ != nullptr)
+	{
+		CloseHandle(file_);
+		file_ = nullptr;
+	}
+
+	size_ = 0;
+}
+
+bool MappedFile::Write(std::uint64_t offset, std::span<const std::uint8_t> data)
+{
+	while (data.empty() == false)
+	{
+		const DWORD chunkSize = static_cast<DWORD>((std::min)(data.size(), std::size_t{1} << 30));
+
+		OVERLAPPED overlapped{};
+		overlapped.Offset	  = static_cast<DWORD>(offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+		DWORD written = 0;
+		if (WriteFile(file_, data.data(), chunkSize, &written, &overlapped) == FALSE || written == 0)
+		{
+			return false;
+		}
+
+		offset += written;
+		size_	= (std::max)(size_, offset);
+		data	= data.subspan(written);
+	}
+
+	return true;
+}
+
+bool MappedFile::Flush()
+{
+	return FlushFileBuffers(file_) != FALSE;
+}
+
+std::span<const std::uint8_t> MappedFile::Map()
+{
+	if (view_ != nullptr && viewSize_ == size_)
+	{
+		return {view_, static_cast<std::size_t>(viewSize_)};
+	}
+
+	Unmap();
+	if (size_ == 0)
+	{
+		return {};
+	}
+
+	mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_ == nullptr)
+	{
+		return {};
+	}
+
+	view_ = static_cast<const std::uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+	if (view_ == nullptr)
+	{
+		Unmap();
+		return {};
+	}
+
+	viewSize_ = size_;
+	return {view_, static_cast<std::size_t>(viewSize_)};
+}
+
+void MappedFile::Unmap()
+{
+	if (view_ != nullptr)
+	{
+		UnmapViewOfFile(view_);
+		view_ = nullptr;
+	}
+
+	if (mapping_ != nullptr)
+	{
+		CloseHandle(mapping_);
+		mapping_ = nullptr;
+	}
+
+	viewSize_ = 0;
+}
+
+bool MappedFile::IsOpen() const
+{
+	return file_ != nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	const int file = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		return false;
+	}
+
+	file_ = file;
+	size_ = static_cast<std::uint64_t>(status.st_size);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	Unmap();
+	if (file_ >= 0)
+	{
+		close(file_);
+		file_ = -1;
+	}
+
+	size_ = 0;
+}
+
+bool MappedFile::Write(std::uint64_t offset, std::span<const std::uint8_t> data)
+{
+	while (data.empty() == false)
+	{
+		const ssize_t written = pwrite(file_, data.data(), data.size(), static_cast<off_t>(offset));
+		if (written <= 0)
+		{
+			return false;
+		}
+
+		offset += static_cast<std::uint64_t>(written);
+		size_	= (std::max)(size_, offset);
+		data	= data.subspan(static_cast<std::size_t>(written));
+	}
+
+	return true;
+}
+
+bool MappedFile::Flush()
+{
+	return fsync(file_) == 0;
+}
+
+std::span<const std::uint8_t> MappedFile::Map()
+{
+	if (view_ != nullptr && viewSize_ == size_)
+	{
+		return {view_, static_cast<std::size_t>(viewSize_)};
+	}
+
+	Unmap();
+	if (size_ == 0)
+	{
+		return {};
+	}
+
+	void* view = mmap(nullptr, static_cast<std::size_t>(size_), PROT_READ, MAP_SHARED, file_, 0);
+	if (view == MAP_FAILED)
+	{
+		return {};
+	}
+
+	view_	  = static_cast<const std::uint8_t*>(view);
+	viewSize_ = size_;
+	return {view_, static_cast<std::size_t>(viewSize_)};
+}
+
+void MappedFile::Unmap()
+{
+	if (view_ != nullptr)
+	{
+		munmap(const_cast<std::uint8_t*>(view_), static_cast<std::size_t>(viewSize_));
+		view_ = nullptr;
+	}
+
+	viewSize_ = 0;
+}
+
+bool MappedFile::IsOpen() const
+{
+	return file_ >= 0;
+}
+
+#endif
@@ -0,0 +1,62 @@
+﻿#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+/**
+ * File that gets read through a memory mapping and written through regular writes. Meant for append-mostly files:
+ * the mapping only covers what the file held when it got mapped, Map() remaps once writes have grown the file.
+ * Bytes that get overwritten in place shouldn't be read back through the mapping, writes and mapped views aren't
+ * guaranteed to be coherent on every platform
+ */
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&)			 = delete;
+	MappedFile(MappedFile&&)				 = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile& operator=(MappedFile&&)		 = delete;
+
+	/**
+	 * Opens the file for reading and writing, creates it if it doesn't exist
+	 * @return false if the file couldn't be opened
+	 */
+	bool Open(const std::filesystem::path& path);
+	void Close();
+
+	/**
+	 * @param offset can lie past the end of the file, the file grows to fit the data
+	 */
+	bool Write(std::uint64_t offset, std::span<const std::uint8_t> data);
+
+	// Waits until everything written so far is on the disk
+	bool Flush();
+
+	/**
+	 * @return the whole file, empty if it's empty or the mapping failed. Stays valid until the next Map(), Unmap() or
+	 * Close()
+	 */
+	[[nodiscard]] std::span<const std::uint8_t> Map();
+
+	// Drops the mapping, the file can't be renamed or truncated while it's mapped on some platforms
+	void Unmap();
+
+private:
+#ifdef _WIN32
+	void* file_	   = nullptr; // HANDLE
+	void* mapping_ = nullptr; // HANDLE
+#else
+	int file_ = -1;
+#endif
+	const std::uint8_t* view_	  = nullptr;
+	std::uint64_t		viewSize_ = 0;
+	std::uint64_t		size_	  = 0;
+
+public:
+	// Getters
+	[[nodiscard]] bool			IsOpen() const;
+	[[nodiscard]] std::uint64_t GetSize() const { return size_; }
+};
@@ -0,0 +1,235 @@
+﻿#include "SlabPool.h"
+
+#include <cassert>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	std::size_t RoundUp(std::size_t value, std::size_t multiple)
+	{
+		return (value + multiple - 1) / multiple * multiple;
+	}
+
+#ifdef _WIN32
+
+	std::size_t GetPageSize()
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return info.dwPageSize;
+	}
+
+	// Large pages need the "Lock pages in memory" right, which is disabled by default even for accounts that have it
+	std::size_t GetHugePageSize()
+	{
+		static const std::size_t hugePageSize = []() -> std::size_t
+		{
+			HANDLE token;
+			if (OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token) == FALSE)
+			{
+				return 0;
+			}
+
+			TOKEN_PRIVILEGES privileges{};
+			privileges.PrivilegeCount			= 1;
+			privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+			// AdjustTokenPrivileges succeeds even if the account doesn't have the right, only the last error tells
+			bool enabled = LookupPrivilegeValueW(nullptr, L"SeLockMemoryPrivilege", &privileges.Privileges[0].Luid);
+			enabled		 = enabled && AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr);
+			enabled		 = enabled && GetLastError() == ERROR_SUCCESS;
+			CloseHandle(token);
+			return enabled ? GetLargePageMinimum() : 0;
+		}();
+		return hugePageSize;
+	}
+
+	void* AllocatePages(std::size_t size, bool hugePages)
+	{
+		const DWORD type = MEM_RESERVE | MEM_COMMIT | (hugePages ? MEM_LARGE_PAGES : 0);
+		return VirtualAlloc(nullptr, size, type, PAGE_READWRITE);
+	}
+
+	void FreePages(void* pages, std::size_t)
+	{
+		VirtualFree(pages, 0, MEM_RELEASE);
+	}
+
+	void DecommitPages(void* pages, std::size_t size)
+	{
+		VirtualFree(pages, size, MEM_DECOMMIT);
+	}
+
+	bool RecommitPages(void* pages, std::size_t size)
+	{
+		return VirtualAlloc(pages, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+	}
+
+#else
+
+	std::size_t GetPageSize()
+	{
+		return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	}
+
+	std::size_t GetHugePageSize()
+	{
+		return 2 << 20;
+	}
+
+	void* AllocatePages(std::size_t size, bool hugePages)
+	{
+		const int flags = MAP_PRIVATE | MAP_ANONYMOUS | (hugePages ? MAP_HUGETLB : 0);
+		void*	  pages = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+		return pages == MAP_FAILED ? nullptr : pages;
+	}
+
+	void FreePages(void* pages, std::size_t size)
+	{
+		munmap(pages, size);
+	}
+
+	// The pages come back zeroed on the next access
+	void DecommitPages(void* pages, std::size_t size)
+	{
+		madvise(pages, size, MADV_DONTNEED);
+	}
+
+	bool RecommitPages(void*, std::size_t)
+	{
+		return true;
+	}
+
+#endif
+} // namespace
+
+SlabPool::SlabPool(const Settings& settings) : settings_(settings)
+{
+	assert(settings_.slotSize > 0);
+	assert(settings_.slotAlignment > 0 && (settings_.slotAlignment & (settings_.slotAlignment - 1)) == 0);
+
+	const std::size_t pageSize = GetPageSize();
+	assert(settings_.slotAlignment <= pageSize);
+
+	slotStride_	 = RoundUp(settings_.slotSize, settings_.slotAlignment);
+	slabSize_	 = RoundUp(RoundUp(settings_.slabSize, slotStride_), pageSize);
+	canDecommit_ = settings_.useHugePages == false && slotStride_ % pageSize == 0;
+}
+
+SlabPool::~SlabPool()
+{
+	for (const Slab& slab : slabs_)
+	{
+		FreePages(slab.memory, slab.size);
+	}
+}
+
+void* SlabPool::Allocate()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (freeSlots_.empty() && decommittedSlots_.empty() && AddSlab() == false)
+	{
+		return nullptr;
+	}
+
+	void* slot;
+	if (freeSlots_.empty() == false)
+	{
+		slot = freeSlots_.back();
+		freeSlots_.pop_back();
+	}
+	else
+	{
+		slot = decommittedSlots_.back();
+		if (RecommitPages(slot, slotStride_) == false)
+		{
+			return nullptr;
+		}
+		decommittedSlots_.pop_back();
+	}
+
+	++stats_.allocations;
+	++stats_.liveSlots;
+	return slot;
+}
+
+void SlabPool::Free(void* slot)
+{
+	if (slot == nullptr)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	assert(stats_.liveSlots > 0);
+
+	if (canDecommit_ && freeSlots_.size() >= settings_.maxCommittedFreeSlots)
+	{
+		DecommitPages(slot, slotStride_);
+		decommittedSlots_.push_back(slot);
+	}
+	else
+	{
+		freeSlots_.push_back(slot);
+	}
+
+	++stats_.frees;
+	--stats_.liveSlots;
+}
+
+SlabPool::Stats SlabPool::GetStats()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	Stats stats			   = stats_;
+	stats.freeSlots		   = freeSlots_.size() + decommittedSlots_.size();
+	stats.decommittedSlots = decommittedSlots_.size();
+	return stats;
+}
+
+bool SlabPool::AddSlab()
+{
+	Slab slab{nullptr, slabSize_, false};
+	if (settings_.useHugePages)
+	{
+		const std::size_t hugePageSize = GetHugePageSize();
+		if (hugePageSize != 0)
+		{
+			slab.size	   = RoundUp(slabSize_, hugePageSize);
+			slab.memory	   = AllocatePages(slab.size, true);
+			slab.hugePages = slab.memory != nullptr;
+		}
+	}
+
+	if (slab.memory == nullptr)
+	{
+		slab.size	= slabSize_;
+		slab.memory = AllocatePages(slab.size, false);
+		if (slab.memory == nullptr)
+		{
+			return false;
+		}
+	}
+
+	// Handed out front to back, the free list gets popped from the back
+	auto* memory = static_cast<std::uint8_t*>(slab.memory);
+	for (std::size_t offset = slab.size / slotStride_ * slotStride_; offset > 0; offset -= slotStride_)
+	{
+		freeSlots_.push_back(memory + offset - slotStride_);
+	}
+
+	slabs_.push_back(slab);
+	++stats_.slabAllocations;
+	stats_.hugePageSlabs += slab.hugePages ? 1 : 0;
+	stats_.reservedBytes += slab.size;
+	return true;
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * Fixed-size slots carved out of large slabs that come straight from the OS, page-aligned. Freed slots get handed out
+ * again before any new slab gets allocated, slabs only go back to the OS once the pool is destroyed. Thread safe
+ */
+class SlabPool
+{
+public:
+	struct Settings
+	{
+		std::size_t slotSize	  = 64;
+		std::size_t slotAlignment = 64;		 // power of two, at most the page size
+		std::size_t slabSize	  = 1 << 20; // rounded up to whole slots and pages
+		bool		useHugePages  = false;	 // falls back to regular pages whenever the OS doesn't hand them out
+
+		// Free slots past this many give their memory back to the OS until they're reused. Only works for slots made of
+		// whole pages, and not at all with huge pages
+		std::size_t maxCommittedFreeSlots = SIZE_MAX;
+	};
+
+	struct Stats
+	{
+		std::uint64_t allocations	   = 0; // total since creation
+		std::uint64_t frees			   = 0; // total since creation
+		std::uint64_t slabAllocations  = 0; // total since creation, the only allocations that reach the OS
+		std::size_t	  liveSlots		   = 0;
+		std::size_t	  freeSlots		   = 0; // including the decommitted ones
+		std::size_t	  decommittedSlots = 0;
+		std::size_t	  hugePageSlabs	   = 0;
+		std::size_t	  reservedBytes	   = 0; // every slab, whether its slots are in use or not
+	};
+
+	SlabPool() = delete;
+	explicit SlabPool(const Settings& settings);
+
+	// Releases every slab, slots that are still allocated included
+	~SlabPool();
+
+	SlabPool(const SlabPool&)			 = delete;
+	SlabPool(SlabPool&&)				 = delete;
+	SlabPool& operator=(const SlabPool&) = delete;
+	SlabPool& operator=(SlabPool&&)		 = delete;
+
+	/**
+	 * @return uninitialized slot of GetSlotSize() bytes, null if the OS is out of memory
+	 */
+	[[nodiscard]] void* Allocate();
+
+	/**
+	 * @param slot has to come from this pool's Allocate
+	 */
+	void Free(void* slot);
+
+	[[nodiscard]] Stats GetStats();
+
+private:
+	struct Slab
+	{
+		void*		memory;
+		std::size_t size;
+		bool		hugePages;
+	};
+
+	// Called with mutex_ held
+	bool AddSlab();
+
+	Settings	settings_;
+	std::size_t slotStride_;
+	std::size_t slabSize_;
+	bool		canDecommit_;
+
+	std::mutex		   mutex_;
+	std::vector<Slab>  slabs_;
+	std::vector<void*> freeSlots_;		  // most recently freed last, so the next allocation is likely still cached
+	std::vector<void*> decommittedSlots_; // only get used once freeSlots_ runs dry
+	Stats			   stats_;
+
+public:
+	// Getters
+	[[nodiscard]] std::size_t GetSlotSize() const { return settings_.slotSize; }
+};
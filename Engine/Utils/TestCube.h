@@ -47,21 +47,18 @@ namespace Utils::Test
 		float s = 0.5f;
 
 		// FRONT Face (Normal -Z)
-		BlockDatabase&	 blockDatabase = BlockDatabase::GetDatabase();
-		const BlockData* data		   = blockDatabase.GetBlockData(blockType);
-		if (data == nullptr)
+		BlockDatabase& blockDatabase = BlockDatabase::GetDatabase();
+		if (blockDatabase.GetBlockData(blockType) == nullptr)
 		{
 			return {};
 		}
 
-		auto matID = data->textureIndices[0]; // cobblestone should have same index for all faces;
-
-		auto northMatID	 = data->textureIndices[static_cast<uint8_t>(BlockFace::North)];
-		auto southMatID	 = data->textureIndices[static_cast<uint8_t>(BlockFace::South)];
-		auto westMatID	 = data->textureIndices[static_cast<uint8_t>(BlockFace::West)];
-		auto eastMatID	 = data->textureIndices[static_cast<uint8_t>(BlockFace::East)];
-		auto topMatID	 = data->textureIndices[static_cast<uint8_t>(BlockFace::Top)];
-		auto bottomMatID = data->textureIndices[static_cast<uint8_t>(BlockFace::Bottom)];
+		auto northMatID	 = blockDatabase.GetFaceMaterial(blockType, BlockFace::North);
+		auto southMatID	 = blockDatabase.GetFaceMaterial(blockType, BlockFace::South);
+		auto westMatID	 = blockDatabase.GetFaceMaterial(blockType, BlockFace::West);
+		auto eastMatID	 = blockDatabase.GetFaceMaterial(blockType, BlockFace::East);
+		auto topMatID	 = blockDatabase.GetFaceMaterial(blockType, BlockFace::Top);
+		auto bottomMatID = blockDatabase.GetFaceMaterial(blockType, BlockFace::Bottom);
 
 		// --------------------------------------------------------
 		// TANGENT/BITANGENT LOGIC
@@ -1,6 +1,7 @@
 ﻿#include "BlockDatabase.h"
 
 #include <assert.h>
+#include <iostream>
 
 BlockDatabase& BlockDatabase::GetDatabase()
 {
@@ -10,47 +11,55 @@ BlockDatabase& BlockDatabase::GetDatabase()
 
 const BlockData* BlockDatabase::GetBlockData(BlockType type) const
 {
-	if (database_.contains(type))
+	const std::size_t index = GetIndex(type);
+	return index < TYPE_COUNT && registered_[index] ? &blockData_[index] : nullptr;
+}
+
+bool BlockDatabase::Load(const std::filesystem::path& definitionsPath, const std::filesystem::path& cachePath)
+{
+	std::vector<BlockDefinitions::Definition> definitions;
+	if (BlockDefinitions::ReadCache(cachePath, definitionsPath, definitions) == false)
 	{
-		return &database_.at(type);
+		definitions.clear();
+		if (BlockDefinitions::Parse(definitionsPath, definitions) == false)
+		{
+			return false;
+		}
+
+		// Only costs the next startup a parse
+		if (BlockDefinitions::WriteCache(cachePath, definitionsPath, definitions) == false)
+		{
+			std::cerr << "Failed to write block cache " << cachePath.string() << "!" << std::endl;
+		}
 	}
-	else
+
+	BlockDatabase& database = GetDatabase();
+	assert(database.registered_.none());
+
+	for (const BlockDefinitions::Definition& definition : definitions)
 	{
-		return nullptr;
+		database.Register(definition);
 	}
+	return true;
 }
 
-BlockDatabase::BlockDatabase()
+void BlockDatabase::Register(const BlockDefinitions::Definition& definition)
 {
-	database_.reserve(static_cast<std::size_t>(BlockType::MAX_BLOCKS_));
-	Initialize();
-}
+	const std::size_t index = GetIndex(definition.type);
+	assert(index < static_cast<std::size_t>(BlockType::MAX_BLOCKS_) && registered_[index] == false);
 
-BlockData* BlockDatabase::GetMutableBlockData(BlockType type)
-{
-	if (database_.contains(type))
-	{
-		return &database_[type];
-	}
-	else
-	{
-		return nullptr;
-	}
+	const BlockData& data = definition.data;
+	blockData_[index]	  = data;
+	faceTextures_[index]  = definition.faceTextures;
+	registered_.set(index);
+	types_.push_back(definition.type);
+
+	opaque_[index]		  = data.isTransparent == false;
+	solid_[index]		  = data.isSolid;
+	lightEmission_[index] = data.lightEmissionLevel;
 }
 
-void BlockDatabase::Initialize()
+void BlockDatabase::SetFaceMaterial(BlockType type, BlockFace face, std::uint32_t materialIndex)
 {
-	database_[BlockType::Dirt]		  = {"dirt", false, true};
-	database_[BlockType::Grass]		  = {"grass", false, true};
-	database_[BlockType::Stone]		  = {"stone", false, true};
-	database_[BlockType::Cobblestone] = {"cobblestone", false, true};
-	database_[BlockType::Glass]		  = {"glass", true, true};
-	database_[BlockType::Log]		  = {"log", false, true};
-	database_[BlockType::Glowstone] =
-		{"glowstone", false, true, 14, {249.0f / 255.0f, 221.f / 255.0f, 160.0f / 255.0f}, 5.0f};
-	database_[BlockType::DiamondBlock] = {"diamondblock", false, true};
-	database_[BlockType::IronBlock]	   = {"ironblock", false, true};
-
-	// ensure no block types are omitted
-	assert(database_.size() == static_cast<std::size_t>(BlockType::MAX_BLOCKS_) - 1);
+	faceMaterials_[GetIndex(type)][static_cast<std::size_t>(face)] = materialIndex;
 }
@@ -1,14 +1,30 @@
 ﻿#pragma once
-#include <unordered_map>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
 
 #include "BlockData.h"
+#include "BlockDefinitions.h"
+#include "BlockFace.h"
 #include "BlockType.h"
 
+/**
+ * Dense tables indexed by BlockType, filled from the block definitions by Load. The properties inner loops (meshing,
+ * light propagation, collisions) ask for are kept apart from BlockData in small tables of their own, so each of them
+ * costs a single indexed load. Read-only once TextureManager has assigned the materials, any thread can read it from
+ * then on
+ */
 class BlockDatabase
 {
 	friend class TextureManager;
 
 public:
+	// INVALID_ gets an entry as well, so none of the lookups need a range check
+	static constexpr std::size_t TYPE_COUNT = static_cast<std::size_t>(BlockType::INVALID_) + 1;
+
 	BlockDatabase(const BlockDatabase&)			   = delete;
 	BlockDatabase& operator=(const BlockDatabase&) = delete;
 
@@ -16,14 +32,66 @@ public:
 	BlockDatabase& operator=(BlockDatabase&&) = delete;
 
 	[[nodiscard]] static BlockDatabase& GetDatabase();
-	[[nodiscard]] const BlockData*		GetBlockData(BlockType) const;
+
+	/**
+	 * Fills the database, once at startup before anything reads it. Goes through the compiled cache if it's up to date
+	 * with the definitions, otherwise parses them and writes a new cache
+	 * @param definitionsPath see BlockDefinitions for the format
+	 * @return false if the definitions are missing or invalid
+	 */
+	static bool Load(const std::filesystem::path& definitionsPath, const std::filesystem::path& cachePath);
+
+	/**
+	 * @return null for air and INVALID_
+	 */
+	[[nodiscard]] const BlockData* GetBlockData(BlockType type) const;
+
+	// Hot properties. Air and INVALID_ are transparent, not solid and don't emit any light
+
+	// Stops sky light, and block light too unless the block emits some itself
+	[[nodiscard]] bool		   IsOpaque(BlockType type) const { return opaque_[GetIndex(type)]; }
+	[[nodiscard]] bool		   IsSolid(BlockType type) const { return solid_[GetIndex(type)]; }
+	[[nodiscard]] std::uint8_t GetLightEmission(BlockType type) const { return lightEmission_[GetIndex(type)]; }
+
+	/**
+	 * @return index into TextureManager's materials, 0 until TextureManager has loaded them
+	 */
+	[[nodiscard]] std::uint32_t GetFaceMaterial(BlockType type, BlockFace face) const
+	{
+		return faceMaterials_[GetIndex(type)][static_cast<std::size_t>(face)];
+	}
+
+	/**
+	 * @return name of the face's textures without the map suffix, empty for air and INVALID_
+	 */
+	[[nodiscard]] const std::string& GetFaceTexture(BlockType type, BlockFace face) const
+	{
+		return faceTextures_[GetIndex(type)][static_cast<std::size_t>(face)];
+	}
 
 private:
-	BlockDatabase();
+	BlockDatabase() = default;
+
+	static constexpr std::size_t GetIndex(BlockType type) { return static_cast<std::size_t>(type); }
+
+	void Register(const BlockDefinitions::Definition& definition);
 
-	// Mainly for TextureManager to fill the texture array coordinates
-	[[nodiscard]] BlockData* GetMutableBlockData(BlockType);
-	void					 Initialize();
+	// For TextureManager, once it knows which material every face ends up with
+	void SetFaceMaterial(BlockType type, BlockFace face, std::uint32_t materialIndex);
 
-	std::unordered_map<BlockType, BlockData> database_;
+	// Cold data
+	std::array<BlockData, TYPE_COUNT>					blockData_;
+	std::array<std::array<std::string, 6>, TYPE_COUNT>	faceTextures_;
+	std::bitset<TYPE_COUNT>								registered_;
+	std::vector<BlockType>								types_; // registered ones, by ID
+
+	// Hot data
+	std::bitset<TYPE_COUNT>								 opaque_;
+	std::bitset<TYPE_COUNT>								 solid_;
+	std::array<std::uint8_t, TYPE_COUNT>				 lightEmission_{};
+	std::array<std::array<std::uint32_t, 6>, TYPE_COUNT> faceMaterials_{};
+
+public:
+	// Getters
+	[[nodiscard]] const std::vector<BlockType>& GetBlockTypes() const { return types_; }
 };
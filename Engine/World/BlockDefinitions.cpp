@@ -0,0 +1,587 @@
+﻿#include "BlockDefinitions.h"
+
+#include <algorithm>
+#include <bit>
+#include <bitset>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+#include "../Utils/MappedFile.h"
+#include "BlockFace.h"
+
+namespace
+{
+	namespace fs = std::filesystem;
+
+	constexpr std::uint32_t cacheMagic	 = 0x434b4c42; // "BLKC"
+	constexpr std::uint32_t cacheVersion = 1;
+
+	// magic, version, source size, source write time, max blocks, block count, string bytes, checksum
+	constexpr std::size_t cacheHeaderSize = 4 + 4 + 8 + 8 + 4 + 4 + 4 + 8;
+	// type, flags, emission, color, intensity, name, face textures
+	constexpr std::size_t recordSize = 4 + 4 + 4 + 4 * 3 + 4 + 4 + 4 * 6;
+
+	constexpr std::uint32_t transparentFlag = 1 << 0;
+	constexpr std::uint32_t solidFlag		= 1 << 1;
+
+	constexpr std::size_t maxBlocks = static_cast<std::size_t>(BlockType::MAX_BLOCKS_);
+
+	// Stored little-endian regardless of the platform
+	template <typename T>
+	void Store(std::vector<std::uint8_t>& out, T value)
+	{
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+		{
+			out.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+		}
+	}
+
+	template <typename T>
+	T Load(const std::uint8_t* data)
+	{
+		T value = 0;
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+		{
+			value |= static_cast<T>(data[i]) << (i * 8);
+		}
+		return value;
+	}
+
+	// FNV-1a, catches caches that got cut short or damaged
+	std::uint64_t GetChecksum(std::span<const std::uint8_t> data)
+	{
+		std::uint64_t hash = 0xcbf29ce484222325;
+		for (const std::uint8_t byte : data)
+		{
+			hash ^= byte;
+			hash *= 0x100000001b3;
+		}
+		return hash;
+	}
+
+	// What the cache remembers of the definitions file, good enough to tell that it has been edited
+	struct SourceStamp
+	{
+		std::uint64_t size		= 0;
+		std::int64_t  writeTime = 0;
+	};
+
+	bool GetSourceStamp(const fs::path& path, SourceStamp& outStamp)
+	{
+		std::error_code error;
+		outStamp.size = fs::file_size(path, error);
+		if (error)
+		{
+			return false;
+		}
+
+		const fs::file_time_type writeTime = fs::last_write_time(path, error);
+		outStamp.writeTime				   = static_cast<std::int64_t>(writeTime.time_since_epoch().count());
+		return !error;
+	}
+
+	std::string_view Trim(std::string_view text)
+	{
+		const std::size_t first = text.find_first_not_of(" \t\r");
+		if (first == std::string_view::npos)
+		{
+			return {};
+		}
+		return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+	}
+
+	// Names end up in texture file names and the world's ID manifest
+	bool IsValidName(std::string_view name)
+	{
+		return name.empty() == false
+			&& std::ranges::all_of(name,
+								   [](char c) { return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_'; });
+	}
+
+	template <typename T>
+	bool ParseNumber(std::string_view text, T& outValue)
+	{
+		const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), outValue);
+		return error == std::errc() && end == text.data() + text.size();
+	}
+
+	bool ParseBool(std::string_view text, bool& outValue)
+	{
+		if (text == "true" || text == "false")
+		{
+			outValue = text == "true";
+			return true;
+		}
+		return false;
+	}
+
+	bool ParseColor(std::string_view text, DirectX::XMFLOAT3& outColor)
+	{
+		std::array<float, 3> channels{};
+		for (float& channel : channels)
+		{
+			text					= Trim(text);
+			const std::size_t end	= text.find_first_of(" \t");
+			std::uint32_t	  value = 0;
+			if (ParseNumber(text.substr(0, end), value) == false || value > 255)
+			{
+				return false;
+			}
+
+			channel = static_cast<float>(value) / 255.0f;
+			text	= end == std::string_view::npos ? std::string_view() : text.substr(end);
+		}
+
+		outColor = {channels[0], channels[1], channels[2]};
+		return Trim(text).empty();
+	}
+
+	/**
+	 * Checks what the engine relies on, for the parsed file as well as the cache
+	 * @param definitions sorted by ID
+	 */
+	bool Validate(std::span<const BlockDefinitions::Definition> definitions, const fs::path& path)
+	{
+		std::bitset<maxBlocks> defined;
+		for (std::size_t i = 0; i < definitions.size(); ++i)
+		{
+			const BlockDefinitions::Definition& definition = definitions[i];
+			const auto							index	   = static_cast<std::size_t>(definition.type);
+			const std::string&					name	   = definition.data.blockName;
+
+			if (index == 0 || index >= maxBlocks)
+			{
+				std::cerr << path.string() << ": " << name << " has ID " << index << ", IDs go from 1 to "
+						  << maxBlocks - 1 << std::endl;
+				return false;
+			}
+			if (defined[index])
+			{
+				std::cerr << path.string() << ": " << name << " reuses ID " << index << std::endl;
+				return false;
+			}
+			if (IsValidName(name) == false)
+			{
+				std::cerr << path.string() << ": Block " << index << " is called \"" << name
+						  << "\", names can only have lowercase letters, digits and underscores" << std::endl;
+				return false;
+			}
+			if (std::any_of(definitions.begin(), definitions.begin() + i,
+							[&](const BlockDefinitions::Definition& other) { return other.data.blockName == name; }))
+			{
+				std::cerr << path.string() << ": " << name << " is defined twice" << std::endl;
+				return false;
+			}
+			if (index < BUILT_IN_BLOCK_NAMES.size() && name != BUILT_IN_BLOCK_NAMES[index])
+			{
+				std::cerr << path.string() << ": ID " << index << " belongs to the built-in block "
+						  << BUILT_IN_BLOCK_NAMES[index] << ", not " << name << std::endl;
+				return false;
+			}
+			if (definition.data.lightEmissionLevel > 15)
+			{
+				std::cerr << path.string() << ": " << name << " emits more than 15 light" << std::endl;
+				return false;
+			}
+
+			defined.set(index);
+		}
+
+		// The engine refers to these by name, so they have to be there
+		for (std::size_t index = 1; index < BUILT_IN_BLOCK_NAMES.size(); ++index)
+		{
+			if (defined[index] == false)
+			{
+				std::cerr << path.string() << ": Built-in block " << BUILT_IN_BLOCK_NAMES[index] << " is missing"
+						  << std::endl;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Texture names take the most specific key given, no matter the order they come in
+	enum class TextureKey : std::uint8_t
+	{
+		None,
+		All,
+		Side,
+		Face,
+	};
+
+	// Definition that's still being parsed
+	struct Section
+	{
+		BlockDefinitions::Definition definition;
+		std::array<TextureKey, 6>	 textureKeys{};
+		std::size_t					 line  = 0;
+		bool						 hasId = false;
+	};
+
+	void SetTexture(Section& section, BlockFace face, TextureKey key, std::string_view texture)
+	{
+		const auto faceIndex = static_cast<std::size_t>(face);
+		if (section.textureKeys[faceIndex] <= key)
+		{
+			section.definition.faceTextures[faceIndex] = texture;
+			section.textureKeys[faceIndex]			   = key;
+		}
+	}
+
+	bool FinishSection(Section&									  section,
+					   const fs::path&							  path,
+					   std::vector<BlockDefinitions::Definition>& outDefinitions)
+	{
+		if (section.hasId == false)
+		{
+			std::cerr << path.string() << ":" << section.line << ": " << section.definition.data.blockName
+					  << " has no id" << std::endl;
+			return false;
+		}
+
+		for (std::string& texture : section.definition.faceTextures)
+		{
+			if (texture.empty())
+			{
+				texture = section.definition.data.blockName;
+			}
+		}
+
+		outDefinitions.push_back(std::move(section.definition));
+		return true;
+	}
+
+	// Sets whatever the key stands for, false if the key or the value aren't valid
+	bool ParseProperty(Section& section, std::string_view key, std::string_view value)
+	{
+		static constexpr std::array<std::pair<std::string_view, BlockFace>, 6> faceKeys = {{
+			{"texture.north", BlockFace::North},
+			{"texture.south", BlockFace::South},
+			{"texture.east", BlockFace::East},
+			{"texture.west", BlockFace::West},
+			{"texture.top", BlockFace::Top},
+			{"texture.bottom", BlockFace::Bottom},
+		}};
+
+		BlockData& data = section.definition.data;
+		if (key == "id")
+		{
+			std::size_t id = 0;
+			section.hasId  = ParseNumber(value, id);
+			section.definition.type = static_cast<BlockType>(id);
+			return section.hasId;
+		}
+		if (key == "transparent")
+		{
+			return ParseBool(value, data.isTransparent);
+		}
+		if (key == "solid")
+		{
+			return ParseBool(value, data.isSolid);
+		}
+		if (key == "emission")
+		{
+			return ParseNumber(value, data.lightEmissionLevel);
+		}
+		if (key == "color")
+		{
+			return ParseColor(value, data.lightColor);
+		}
+		if (key == "intensity")
+		{
+			return ParseNumber(value, data.lightIntensity) && data.lightIntensity >= 0.0f;
+		}
+
+		if (key.starts_with("texture") == false || IsValidName(value) == false)
+		{
+			return false;
+		}
+		if (key == "texture")
+		{
+			for (const BlockFace face : ALL_BLOCKFACES)
+			{
+				SetTexture(section, face, TextureKey::All, value);
+			}
+			return true;
+		}
+		if (key == "texture.side")
+		{
+			for (const BlockFace face : {BlockFace::North, BlockFace::South, BlockFace::East, BlockFace::West})
+			{
+				SetTexture(section, face, TextureKey::Side, value);
+			}
+			return true;
+		}
+
+		const auto faceKey = std::ranges::find(faceKeys, key, &std::pair<std::string_view, BlockFace>::first);
+		if (faceKey == faceKeys.end())
+		{
+			return false;
+		}
+		SetTexture(section, faceKey->second, TextureKey::Face, value);
+		return true;
+	}
+
+	// @return offset of the string in the string table
+	std::uint32_t AddString(std::vector<std::uint8_t>& strings, std::string_view string)
+	{
+		const auto offset = static_cast<std::uint32_t>(strings.size());
+		strings.insert(strings.end(), string.begin(), string.end());
+		strings.push_back('\0');
+		return offset;
+	}
+
+	// False if the offset doesn't point at a terminated string inside the table
+	bool ReadString(std::span<const std::uint8_t> strings, std::uint32_t offset, std::string& outString)
+	{
+		if (offset >= strings.size())
+		{
+			return false;
+		}
+
+		const std::span<const std::uint8_t> string = strings.subspan(offset);
+		const auto							end	   = std::ranges::find(string, std::uint8_t{0});
+		if (end == string.end())
+		{
+			return false;
+		}
+
+		outString.assign(string.begin(), end);
+		return true;
+	}
+} // namespace
+
+bool BlockDefinitions::Parse(const std::filesystem::path& path, std::vector<Definition>& outDefinitions)
+{
+	std::ifstream file(path);
+	if (file.is_open() == false)
+	{
+		std::cerr << "Failed to open block definitions " << path.string() << "!" << std::endl;
+		return false;
+	}
+
+	std::vector<Definition> definitions;
+	std::optional<Section>	section;
+
+	std::string line;
+	for (std::size_t lineNumber = 1; std::getline(file, line); ++lineNumber)
+	{
+		const std::string_view text = Trim(line);
+		if (text.empty() || text.front() == '#')
+		{
+			continue;
+		}
+
+		if (text.front() == '[')
+		{
+			if (section.has_value() && FinishSection(*section, path, definitions) == false)
+			{
+				return false;
+			}
+
+			const std::string_view name = text.back() == ']' ? Trim(text.substr(1, text.size() - 2)) : "";
+			if (IsValidName(name) == false)
+			{
+				std::cerr << path.string() << ":" << lineNumber << ": Expected [name], names can only have lowercase "
+						  << "letters, digits and underscores" << std::endl;
+				return false;
+			}
+
+			section.emplace();
+			section->definition.data.blockName = name;
+			section->line					   = lineNumber;
+			continue;
+		}
+
+		const std::size_t separator = text.find('=');
+		if (section.has_value() == false || separator == std::string_view::npos)
+		{
+			std::cerr << path.string() << ":" << lineNumber << ": Expected key = value inside a [name] section"
+					  << std::endl;
+			return false;
+		}
+
+		const std::string_view key	 = Trim(text.substr(0, separator));
+		const std::string_view value = Trim(text.substr(separator + 1));
+		if (ParseProperty(*section, key, value) == false)
+		{
+			std::cerr << path.string() << ":" << lineNumber << ": Invalid " << key << " \"" << value << "\""
+					  << std::endl;
+			return false;
+		}
+	}
+
+	if (section.has_value() && FinishSection(*section, path, definitions) == false)
+	{
+		return false;
+	}
+
+	std::ranges::sort(definitions, {}, &Definition::type);
+	if (Validate(definitions, path) == false)
+	{
+		return false;
+	}
+
+	outDefinitions.insert(outDefinitions.end(),
+						  std::make_move_iterator(definitions.begin()),
+						  std::make_move_iterator(definitions.end()));
+	return true;
+}
+
+bool BlockDefinitions::ReadCache(const std::filesystem::path& cachePath,
+								 const std::filesystem::path& sourcePath,
+								 std::vector<Definition>&	  outDefinitions)
+{
+	// Opening the file would create it
+	std::error_code error;
+	if (fs::exists(cachePath, error) == false)
+	{
+		return false;
+	}
+
+	SourceStamp stamp;
+	MappedFile	file;
+	if (GetSourceStamp(sourcePath, stamp) == false || file.Open(cachePath) == false)
+	{
+		return false;
+	}
+
+	const std::span<const std::uint8_t> data = file.Map();
+	if (data.size() < cacheHeaderSize)
+	{
+		return false;
+	}
+
+	const std::uint8_t* header = data.data();
+	const auto			blockCount	= Load<std::uint32_t>(header + 28);
+	const auto			stringBytes = Load<std::uint32_t>(header + 32);
+
+	// The checksum covers everything after the header
+	const bool isCurrent = Load<std::uint32_t>(header) == cacheMagic
+						&& Load<std::uint32_t>(header + 4) == cacheVersion
+						&& Load<std::uint64_t>(header + 8) == stamp.size
+						&& Load<std::int64_t>(header + 16) == stamp.writeTime
+						&& Load<std::uint32_t>(header + 24) == maxBlocks;
+	if (isCurrent == false
+		|| blockCount >= maxBlocks
+		|| data.size() != cacheHeaderSize + blockCount * recordSize + stringBytes
+		|| Load<std::uint64_t>(header + 36) != GetChecksum(data.subspan(cacheHeaderSize)))
+	{
+		return false;
+	}
+
+	const std::span<const std::uint8_t> strings = data.subspan(cacheHeaderSize + blockCount * recordSize);
+
+	std::vector<Definition> definitions(blockCount);
+	for (std::size_t i = 0; i < blockCount; ++i)
+	{
+		const std::uint8_t* record	   = data.data() + cacheHeaderSize + i * recordSize;
+		Definition&			definition = definitions[i];
+		BlockData&			blockData  = definition.data;
+
+		definition.type				 = static_cast<BlockType>(Load<std::uint32_t>(record));
+		const auto flags			 = Load<std::uint32_t>(record + 4);
+		blockData.isTransparent		 = (flags & transparentFlag) != 0;
+		blockData.isSolid			 = (flags & solidFlag) != 0;
+		blockData.lightEmissionLevel = static_cast<std::uint8_t>((std::min)(Load<std::uint32_t>(record + 8), 255u));
+		blockData.lightColor		 = {std::bit_cast<float>(Load<std::uint32_t>(record + 12)),
+										std::bit_cast<float>(Load<std::uint32_t>(record + 16)),
+										std::bit_cast<float>(Load<std::uint32_t>(record + 20))};
+		blockData.lightIntensity	 = std::bit_cast<float>(Load<std::uint32_t>(record + 24));
+
+		if (ReadString(strings, Load<std::uint32_t>(record + 28), blockData.blockName) == false)
+		{
+			return false;
+		}
+		for (std::size_t face = 0; face < 6; ++face)
+		{
+			const auto offset = Load<std::uint32_t>(record + 32 + face * 4);
+			if (ReadString(strings, offset, definition.faceTextures[face]) == false)
+			{
+				return false;
+			}
+		}
+	}
+
+	if (std::ranges::is_sorted(definitions, {}, &Definition::type) == false
+		|| Validate(definitions, cachePath) == false)
+	{
+		return false;
+	}
+
+	outDefinitions.insert(outDefinitions.end(),
+						  std::make_move_iterator(definitions.begin()),
+						  std::make_move_iterator(definitions.end()));
+	return true;
+}
+
+bool BlockDefinitions::WriteCache(const std::filesystem::path& cachePath,
+								  const std::filesystem::path& sourcePath,
+								  std::span<const Definition>  definitions)
+{
+	SourceStamp stamp;
+	if (GetSourceStamp(sourcePath, stamp) == false)
+	{
+		return false;
+	}
+
+	std::vector<std::uint8_t> records;
+	std::vector<std::uint8_t> strings;
+	records.reserve(definitions.size() * recordSize);
+	for (const Definition& definition : definitions)
+	{
+		const BlockData& blockData = definition.data;
+
+		Store(records, static_cast<std::uint32_t>(definition.type));
+		Store(records, (blockData.isTransparent ? transparentFlag : 0) | (blockData.isSolid ? solidFlag : 0));
+		Store(records, static_cast<std::uint32_t>(blockData.lightEmissionLevel));
+		Store(records, std::bit_cast<std::uint32_t>(blockData.lightColor.x));
+		Store(records, std::bit_cast<std::uint32_t>(blockData.lightColor.y));
+		Store(records, std::bit_cast<std::uint32_t>(blockData.lightColor.z));
+		Store(records, std::bit_cast<std::uint32_t>(blockData.lightIntensity));
+		Store(records, AddString(strings, blockData.blockName));
+		for (const std::string& texture : definition.faceTextures)
+		{
+			Store(records, AddString(strings, texture));
+		}
+	}
+
+	std::vector<std::uint8_t> data;
+	data.reserve(cacheHeaderSize + records.size() + strings.size());
+	Store(data, cacheMagic);
+	Store(data, cacheVersion);
+	Store(data, stamp.size);
+	Store(data, stamp.writeTime);
+	Store(data, static_cast<std::uint32_t>(maxBlocks));
+	Store(data, static_cast<std::uint32_t>(definitions.size()));
+	Store(data, static_cast<std::uint32_t>(strings.size()));
+	data.resize(cacheHeaderSize);
+	data.insert(data.end(), records.begin(), records.end());
+	data.insert(data.end(), strings.begin(), strings.end());
+
+	const std::uint64_t checksum = GetChecksum(std::span(data).subspan(cacheHeaderSize));
+	for (std::size_t i = 0; i < 8; ++i)
+	{
+		data[36 + i] = static_cast<std::uint8_t>(checksum >> (i * 8));
+	}
+
+	// Written next to the cache first, so a crash halfway through can't leave a torn cache behind
+	fs::path		temporaryPath = cachePath;
+	std::error_code error;
+	temporaryPath += ".tmp";
+	fs::remove(temporaryPath, error);
+	{
+		MappedFile file;
+		if (file.Open(temporaryPath) == false || file.Write(0, data) == false || file.Flush() == false)
+		{
+			return false;
+		}
+	}
+
+	fs::rename(temporaryPath, cachePath, error);
+	return !error;
+}
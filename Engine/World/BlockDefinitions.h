@@ -0,0 +1,57 @@
+﻿#pragma once
+#include <array>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "BlockData.h"
+#include "BlockType.h"
+
+/**
+ * Block definitions as written in Resources/Blocks.txt, and the binary cache they get compiled into so later startups
+ * only have to map a file. The text format is a list of sections, one per block:
+ *
+ *   [glowstone]            name, also what the textures are called by default
+ *   id = 7                 stored in saved chunks, has to stay the same once a world uses it
+ *   transparent = false
+ *   solid = true
+ *   emission = 14          0-15
+ *   color = 249 221 160    light color, 0-255 per channel
+ *   intensity = 5
+ *   texture = glowstone    every face, texture.side for the four sides, texture.top etc. for a single face
+ *
+ * Everything but id is optional, lines starting with # are comments
+ */
+namespace BlockDefinitions
+{
+	struct Definition
+	{
+		BlockType				   type = BlockType::INVALID_;
+		BlockData				   data; // blockName is the definition's name
+		std::array<std::string, 6> faceTextures; // by BlockFace, without the map suffix, e.g. "grass_side"
+	};
+
+	/**
+	 * @param outDefinitions gets the definitions appended, sorted by ID
+	 * @return false if the file can't be read or isn't valid, errors go to std::cerr
+	 */
+	bool Parse(const std::filesystem::path& path, std::vector<Definition>& outDefinitions);
+
+	/**
+	 * @param sourcePath the definitions the cache was compiled from, the cache is stale once they change
+	 * @param outDefinitions gets the definitions appended, sorted by ID
+	 * @return false if the cache doesn't exist, is stale or corrupt
+	 */
+	bool ReadCache(const std::filesystem::path& cachePath,
+				   const std::filesystem::path& sourcePath,
+				   std::vector<Definition>&		outDefinitions);
+
+	/**
+	 * Replaces the cache as a whole, a failed write leaves the previous one in place
+	 * @param definitions as returned by Parse
+	 */
+	bool WriteCache(const std::filesystem::path& cachePath,
+					const std::filesystem::path& sourcePath,
+					std::span<const Definition>	 definitions);
+} // namespace BlockDefinitions
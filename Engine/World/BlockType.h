@@ -1,6 +1,10 @@
 ﻿#pragma once
+#include <array>
 #include <cstddef>
+#include <string_view>
 
+// Block ID, stored as is in saved chunks. The named ones are built into the engine, Resources/Blocks.txt defines
+// them along with any other block
 enum class BlockType : std::size_t
 {
 	Air,
@@ -14,7 +18,13 @@ enum class BlockType : std::size_t
 	DiamondBlock,
 	IronBlock,
 
+	BUILT_IN_COUNT_,
 
-	MAX_BLOCKS_,
+	MAX_BLOCKS_ = 64, // every ID lies below this, built-in or not
 	INVALID_
 };
+
+// What the built-in types are called in the block definitions, indexed by BlockType
+inline constexpr std::array<std::string_view, static_cast<std::size_t>(BlockType::BUILT_IN_COUNT_)>
+	BUILT_IN_BLOCK_NAMES = {"air", "dirt", "grass", "stone", "cobblestone", "glass", "log", "glowstone", "diamondblock",
+							"ironblock"};
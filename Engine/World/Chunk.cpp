@@ -1,13 +1,21 @@
 ﻿#include "Chunk.h"
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
 #include <filesystem>
+#include <new>
+
+#include "../Core/MemoryTracking.h"
+#include "ChunkAllocator.h"
+#include "ChunkSerialization.h"
 
 Chunk::Chunk(DirectX::XMINT3 chunkWorldPos)
 {
 	using namespace DirectX;
 	chunkWorldPos_ = chunkWorldPos;
-	blocks_.fill({BlockType::Air, 0b11110000});
-	dirty_ = true;
+	blocks_		   = ChunkAllocator::GetAllocator().AllocateBlocks(Block{BlockType::Air, 0b11110000});
+	dirty_		   = true;
 
 	// calculate the world matrix
 	float x = static_cast<float>(chunkWorldPos.x) * static_cast<float>(CHUNK_SIZE);
@@ -24,6 +32,27 @@ Chunk::Chunk(DirectX::XMINT3 chunkWorldPos)
 	BoundingBox::CreateFromPoints(chunkBounds_, pt1, pt2);
 }
 
+Chunk::~Chunk()
+{
+	Memory::Track(Memory::Tag::ChunkBlocks, -static_cast<std::int64_t>(compressedBlocks_.capacity()));
+}
+
+void* Chunk::operator new(std::size_t size)
+{
+	assert(size == sizeof(Chunk));
+	void* chunk = ChunkAllocator::GetAllocator().AllocateChunk();
+	if (chunk == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return chunk;
+}
+
+void Chunk::operator delete(void* chunk)
+{
+	ChunkAllocator::GetAllocator().FreeChunk(chunk);
+}
+
 Block Chunk::GetBlock(DirectX::XMUINT3 block) const
 {
 	return GetBlock(block.x, block.y, block.z);
@@ -37,7 +66,7 @@ Block Chunk::GetBlock(std::size_t x, std::size_t y, std::size_t z) const
 	}
 
 	std::size_t index = x + (y * CHUNK_SIZE) + (z * CHUNK_SIZE * CHUNK_SIZE);
-	return blocks_[index];
+	return GetReadableBlocks()[index];
 }
 
 bool Chunk::SetBlockType(DirectX::XMUINT3 block, BlockType blockType)
@@ -62,7 +91,7 @@ bool Chunk::SetSkyLightLevel(std::size_t x, std::size_t y, std::size_t z, std::u
 	}
 
 	std::size_t index = x + (y * CHUNK_SIZE) + (z * CHUNK_SIZE * CHUNK_SIZE);
-	blocks_[index].SetSkyLightLevel(lightLevel);
+	GetWritableBlocks()[index].SetSkyLightLevel(lightLevel);
 	dirty_ = true;
 	return true;
 }
@@ -75,87 +104,203 @@ bool Chunk::SetBlockLightLevel(std::size_t x, std::size_t y, std::size_t z, std:
 	}
 
 	std::size_t index = x + (y * CHUNK_SIZE) + (z * CHUNK_SIZE * CHUNK_SIZE);
-	blocks_[index].SetBlockLightLevel(lightLevel);
+	GetWritableBlocks()[index].SetBlockLightLevel(lightLevel);
 	dirty_ = true;
 	return true;
 }
 
-void Chunk::GetBorderSlice(std::array<Block, CHUNK_SIZE * CHUNK_SIZE>& outBlocks, BlockFace direction) const
+bool Chunk::FillBox(DirectX::XMUINT3 min, DirectX::XMUINT3 max, Block block)
 {
-	constexpr std::size_t strideX = 1;
+	max.x = (std::min)(max.x, static_cast<std::uint32_t>(CHUNK_SIZE));
+	max.y = (std::min)(max.y, static_cast<std::uint32_t>(CHUNK_SIZE));
+	max.z = (std::min)(max.z, static_cast<std::uint32_t>(CHUNK_SIZE));
+	if (min.x >= max.x || min.y >= max.y || min.z >= max.z)
+	{
+		return false;
+	}
+
 	constexpr std::size_t strideY = CHUNK_SIZE;
 	constexpr std::size_t strideZ = CHUNK_SIZE * CHUNK_SIZE;
 
-	std::size_t startIndex = 0;
-	std::size_t strideU	   = 0;
-	std::size_t strideV	   = 0;
+	// Merge rows into the longest contiguous runs possible, fill_n over those turns into plain wide stores
+	const std::size_t rowLength = max.x - min.x;
+	const bool		  fullRows	= rowLength == CHUNK_SIZE;
+	const bool		  fullSlice = fullRows && min.y == 0 && max.y == CHUNK_SIZE;
+	BlockArray&		  blocks	= GetWritableBlocks();
 
-	switch (direction)
+	if (fullSlice)
 	{
-		case BlockFace::North:
-		{
-			std::size_t targetZ = CHUNK_SIZE - 1;
-			startIndex			= targetZ * strideZ;
-			strideU				= strideX;
-			strideV				= strideY;
-			break;
-		}
-		case BlockFace::South:
-		{
-			std::size_t targetZ = 0;
-			startIndex			= targetZ * strideZ;
-			strideU				= strideX;
-			strideV				= strideY;
-			break;
-		}
-		case BlockFace::West:
-		{
-			std::size_t targetX = 0;
-			startIndex			= targetX * strideX;
-			strideU				= strideZ;
-			strideV				= strideY;
-			break;
-		}
-		case BlockFace::East:
-		{
-			std::size_t targetX = CHUNK_SIZE - 1;
-			startIndex			= targetX * strideX;
-			strideU				= strideZ;
-			strideV				= strideY;
-			break;
-		}
-		case BlockFace::Top:
+		std::fill_n(blocks.begin() + min.z * strideZ, (max.z - min.z) * strideZ, block);
+	}
+	else if (fullRows)
+	{
+		for (std::size_t z = min.z; z < max.z; ++z)
 		{
-			std::size_t targetY = CHUNK_SIZE - 1;
-			startIndex			= targetY * strideY;
-			strideU				= strideX;
-			strideV				= strideZ;
-			break;
+			std::fill_n(blocks.begin() + min.y * strideY + z * strideZ, (max.y - min.y) * strideY, block);
 		}
-		case BlockFace::Bottom:
+	}
+	else
+	{
+		for (std::size_t z = min.z; z < max.z; ++z)
 		{
-			std::size_t targetY = 0;
-			startIndex			= targetY * strideY;
-			strideU				= strideX;
-			strideV				= strideZ;
-			break;
+			for (std::size_t y = min.y; y < max.y; ++y)
+			{
+				std::fill_n(blocks.begin() + min.x + y * strideY + z * strideZ, rowLength, block);
+			}
 		}
 	}
 
-	std::size_t readPtr	 = startIndex;
-	std::size_t writePtr = 0;
-	for (std::size_t v = 0; v < CHUNK_SIZE; v++)
+	dirty_ = true;
+	return true;
+}
+
+bool Chunk::FillLayer(std::size_t y, Block block)
+{
+	const auto layerY = static_cast<std::uint32_t>(y);
+	return FillBox({0, layerY, 0}, {CHUNK_SIZE, layerY + 1, CHUNK_SIZE}, block);
+}
+
+bool Chunk::SetColumn(std::size_t x, std::size_t z, std::span<const Block, CHUNK_SIZE> column)
+{
+	if (x >= CHUNK_SIZE || z >= CHUNK_SIZE)
 	{
-		std::size_t rowStart = readPtr;
-		for (std::size_t u = 0; u < CHUNK_SIZE; u++)
-		{
-			outBlocks[writePtr]	 = blocks_[readPtr];
-			readPtr				+= strideU;
-			++writePtr;
-		}
-		readPtr = rowStart + strideV;
+		return false;
+	}
+
+	BlockArray& blocks = GetWritableBlocks();
+	std::size_t index  = x + (z * CHUNK_SIZE * CHUNK_SIZE);
+	for (const Block& block : column)
+	{
+		blocks[index]  = block;
+		index		  += CHUNK_SIZE;
 	}
+
+	dirty_ = true;
+	return true;
 }
+
+void Chunk::SetBlocks(std::span<const Block, CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE> blocks)
+{
+	std::ranges::copy(blocks, GetWritableBlocks().begin());
+	dirty_ = true;
+}
+
+std::shared_ptr<const Chunk::BlockArray> Chunk::GetBlocksSnapshot() const
+{
+	// Not an access, saving a column shouldn't keep its chunks from getting compressed again
+	if (blocks_ == nullptr)
+	{
+		Decompress();
+	}
+	return blocks_;
+}
+
+void Chunk::DetachBlocksSnapshot()
+{
+	if (blocks_ == nullptr)
+	{
+		Decompress();
+	}
+	else if (blocks_.use_count() > 1)
+	{
+		blocks_ = ChunkAllocator::GetAllocator().AllocateBlocks(*blocks_);
+	}
+}
+
+bool Chunk::Compress()
+{
+	if (blocks_ == nullptr)
+	{
+		return false;
+	}
+
+	ChunkSerialization::Serialize(*blocks_, compressedBlocks_);
+	compressedBlocks_.shrink_to_fit();
+	Memory::Track(Memory::Tag::ChunkBlocks, static_cast<std::int64_t>(compressedBlocks_.capacity()));
+	blocks_.reset();
+	return true;
+}
+
+Chunk::CompressionActivity Chunk::UpdateCompressionActivity(float elapsedTime)
+{
+	CompressionActivity activity;
+	activity.accessed		 = accessed_.exchange(false, std::memory_order_relaxed);
+	activity.decompressions	 = decompressions_;
+	activity.decompressNanos = decompressNanos_;
+
+	idleTime_		  = activity.accessed ? 0.0f : idleTime_ + elapsedTime;
+	activity.idleTime = idleTime_;
+
+	decompressions_	 = 0;
+	decompressNanos_ = 0;
+	return activity;
+}
+
+const Chunk::BlockArray& Chunk::GetReadableBlocks() const
+{
+	// Only the main thread ever finds the blocks compressed, see DetachBlocksSnapshot
+	if (blocks_ == nullptr)
+	{
+		Decompress();
+	}
+
+	// Checked first, readers on other threads would keep taking the cache line from each other otherwise
+	if (accessed_.load(std::memory_order_relaxed) == false)
+	{
+		accessed_.store(true, std::memory_order_relaxed);
+	}
+	return *blocks_;
+}
+
+Chunk::BlockArray& Chunk::GetWritableBlocks()
+{
+	// Snapshots only get taken on the main thread, nothing can start sharing the blocks while this runs. A snapshot
+	// getting dropped on another thread at the same time only costs a copy that wasn't needed
+	DetachBlocksSnapshot();
+	accessed_.store(true, std::memory_order_relaxed);
+	++version_;
+	return *blocks_;
+}
+
+void Chunk::Decompress() const
+{
+	using namespace std::chrono;
+
+	const auto start  = steady_clock::now();
+	auto	   blocks = ChunkAllocator::GetAllocator().AllocateBlocks(Block{});
+
+	// Never left memory, so it can't be corrupt
+	const std::size_t size = ChunkSerialization::Deserialize(compressedBlocks_, *blocks);
+	assert(size == compressedBlocks_.size());
+	(void)size;
+
+	blocks_ = std::move(blocks);
+	Memory::Track(Memory::Tag::ChunkBlocks, -static_cast<std::int64_t>(compressedBlocks_.capacity()));
+	compressedBlocks_.clear();
+	compressedBlocks_.shrink_to_fit();
+
+	++decompressions_;
+	decompressNanos_ += duration_cast<nanoseconds>(steady_clock::now() - start).count();
+}
+
+bool Chunk::IsLightSampled(std::int32_t x, std::int32_t y, std::int32_t z) const
+{
+	if (hasMesh_ == false || pendingMeshes_ > 0)
+	{
+		return true;
+	}
+
+	return lightSampleMask_.test(GetPaddedIndex(x, y, z));
+}
+
+void Chunk::OnMeshUploaded(const LightSampleMask& lightSampleMask)
+{
+	assert(pendingMeshes_ > 0);
+	--pendingMeshes_;
+	lightSampleMask_ = lightSampleMask;
+	hasMesh_		 = true;
+}
+
 std::vector<BlockFace> Chunk::IsBlockOnBorder(DirectX::XMINT3 block)
 {
 	return IsBlockOnBorder(block.x, block.y, block.z);
@@ -204,7 +349,7 @@ std::vector<BlockFace> Chunk::IsBlockOnBorder(std::size_t x, std::size_t y, std:
 
 bool Chunk::SetBlockType(std::size_t x, std::size_t y, std::size_t z, BlockType blockType)
 {
-	if (blockType == BlockType::MAX_BLOCKS_ || blockType == BlockType::INVALID_)
+	if (blockType >= BlockType::MAX_BLOCKS_)
 	{
 		return false;
 	}
@@ -216,8 +361,8 @@ bool Chunk::SetBlockType(std::size_t x, std::size_t y, std::size_t z, BlockType
 
 	std::size_t index = x + (y * CHUNK_SIZE) + (z * CHUNK_SIZE * CHUNK_SIZE);
 
-	blocks_[index].type = blockType;
-	dirty_				= true;
+	GetWritableBlocks()[index].type = blockType;
+	dirty_							= true;
 
 	return true;
 }
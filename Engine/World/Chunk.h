@@ -2,6 +2,11 @@
 #include <DirectXCollision.h>
 #include <DirectXMath.h>
 #include <array>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <span>
 #include <d3d11.h>
 #include <vector>
 #include <wrl/client.h>
@@ -14,9 +19,31 @@ class Chunk
 {
 public:
 	friend class World;
-	static constexpr std::size_t CHUNK_SIZE = 16;
-	Chunk()									= delete;
+	static constexpr std::size_t CHUNK_SIZE		   = 16;
+	static constexpr std::size_t PADDED_CHUNK_SIZE = CHUNK_SIZE + 2; // chunk plus a one block shell around it
+
+	// One bit per block of the padded chunk, set for blocks whose light level is baked into the mesh
+	using LightSampleMask = std::bitset<PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE>;
+
+	// Every block of the chunk, x + y * CHUNK_SIZE + z * CHUNK_SIZE²
+	using BlockArray = std::array<Block, CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE>;
+
+	// What happened to the chunk in between two UpdateCompressionActivity calls
+	struct CompressionActivity
+	{
+		bool		  accessed		  = false;
+		float		  idleTime		  = 0.0f; // seconds since the blocks were last read or written
+		std::uint32_t decompressions  = 0;
+		std::uint64_t decompressNanos = 0;
+	};
+
+	Chunk() = delete;
 	Chunk(DirectX::XMINT3 chunkWorldPos);
+	~Chunk();
+
+	// Chunks come from a pool, see ChunkAllocator
+	[[nodiscard]] static void* operator new(std::size_t size);
+	static void				   operator delete(void* chunk);
 
 	[[nodiscard]] Block GetBlock(DirectX::XMUINT3 block) const;							 // Chunk-space coordinates
 	[[nodiscard]] Block GetBlock(std::size_t x, std::size_t y, std::size_t z) const;	 // Chunk-space coordinates
@@ -29,14 +56,85 @@ public:
 	bool SetBlockLightLevel(std::size_t x, std::size_t y, std::size_t z, std::uint8_t lightLevel);
 	void ClearDirtyState() { dirty_ = false; }
 
+	// Bulk operations, meant for generators. They write whole blocks, type and light levels alike
+
+	/**
+	 * @param min chunk-space corner of the box, inclusive
+	 * @param max chunk-space corner of the box, exclusive. The box gets clipped to the chunk
+	 * @return false if the box doesn't overlap the chunk
+	 */
+	bool FillBox(DirectX::XMUINT3 min, DirectX::XMUINT3 max, Block block);
+
+	/**
+	 * @param y chunk-space y of the horizontal layer
+	 */
+	bool FillLayer(std::size_t y, Block block);
+
+	/**
+	 * @param x chunk-space x of the column
+	 * @param z chunk-space z of the column
+	 * @param column blocks from the bottom of the chunk up
+	 */
+	bool SetColumn(std::size_t x, std::size_t z, std::span<const Block, CHUNK_SIZE> column);
+
+	/**
+	 * @param blocks every block of the chunk, same layout as the chunk itself (x + y * CHUNK_SIZE + z * CHUNK_SIZE²)
+	 */
+	void SetBlocks(std::span<const Block, CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE> blocks);
+
 	/**
 	 *
-	 * @param outBlocks array to copy the slice into
-	 * @param direction the face of the chunk that will be turned into a slice. IMPORTANT: the direction is considered
-	 * from the point of view of the chunk that this method gets called on. E.g. if we want to get a slice of a chunk's
-	 * northern neighbor, then from the perspective of the neighbor, the neighbor returns its southern slice
+	 * @param x chunk-space x, can lie one block outside the chunk (-1 or CHUNK_SIZE)
+	 * @param y chunk-space y, can lie one block outside the chunk (-1 or CHUNK_SIZE)
+	 * @param z chunk-space z, can lie one block outside the chunk (-1 or CHUNK_SIZE)
+	 * @return whether changing the block's light level affects the chunk's mesh. Always true while there's no up to
+	 * date mesh to check against
+	 */
+	[[nodiscard]] bool IsLightSampled(std::int32_t x, std::int32_t y, std::int32_t z) const;
+
+	/**
+	 * Blocks as they are right now, without copying them. The chunk keeps sharing them until its next write, which
+	 * copies them first, so the snapshot never changes and can be read from any thread. Main thread only
 	 */
-	void GetBorderSlice(std::array<Block, CHUNK_SIZE * CHUNK_SIZE>& outBlocks, BlockFace direction) const;
+	[[nodiscard]] std::shared_ptr<const BlockArray> GetBlocksSnapshot() const;
+
+	/**
+	 * Decompresses the blocks and copies them right away if a snapshot still shares them, so that the next reads and
+	 * writes don't have to. Has to happen before other threads access the chunk
+	 */
+	void DetachBlocksSnapshot();
+
+	/**
+	 * Drops the blocks in favor of their serialized form, see ChunkSerialization. The next read or write
+	 * decompresses them again, transparently. Main thread only
+	 * @return false if the chunk is compressed already
+	 */
+	bool Compress();
+
+	/**
+	 * Main thread only, meant to get called periodically
+	 * @param elapsedTime seconds since the previous call
+	 */
+	CompressionActivity UpdateCompressionActivity(float elapsedTime);
+
+	// Save bookkeeping, every write counts as a change, even one that puts back the same block
+	[[nodiscard]] bool HasUnsavedChanges() const { return version_ != savedVersion_; }
+	void			   MarkSaved() { savedVersion_ = version_; }
+
+	void OnMeshRequested() { ++pendingMeshes_; }
+	[[nodiscard]] bool IsMeshPending() const { return pendingMeshes_ > 0; }
+	[[nodiscard]] bool HasMesh() const { return hasMesh_; }
+
+	// Bookkeeping for chunk streaming, a chunk isn't worth meshing until the chunks around it are there
+	void						OnNeighborLoaded() { ++loadedNeighbors_; }
+	void						OnNeighborUnloaded() { --loadedNeighbors_; }
+	[[nodiscard]] std::uint32_t GetLoadedNeighborCount() const { return loadedNeighbors_; }
+	void OnMeshUploaded(const LightSampleMask& lightSampleMask);
+
+	[[nodiscard]] static constexpr std::size_t GetPaddedIndex(std::int32_t x, std::int32_t y, std::int32_t z)
+	{
+		return (x + 1) + (y + 1) * PADDED_CHUNK_SIZE + (z + 1) * PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE;
+	}
 
 	/**
 	 *
@@ -57,13 +155,37 @@ public:
 	static std::vector<BlockFace> IsBlockOnBorder(std::size_t x, std::size_t y, std::size_t z);
 
 private:
-	std::array<Block, CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE> blocks_;
+	// Decompresses the blocks if needed, every read goes through here
+	const BlockArray& GetReadableBlocks() const;
+
+	// Decompresses the blocks and unshares them if a snapshot holds on to them, every write goes through here
+	BlockArray& GetWritableBlocks();
+
+	void Decompress() const;
+
+	// Null while compressed, shared with snapshots until the next write
+	mutable std::shared_ptr<BlockArray> blocks_;
+	mutable std::vector<std::uint8_t>	compressedBlocks_; // empty unless compressed
+	std::uint64_t						version_	  = 0;	   // bumped by every write
+	std::uint64_t						savedVersion_ = 0; // version the last save got taken at
+
+	// Compression bookkeeping, see UpdateCompressionActivity. Reads on other threads only ever set the flag
+	mutable std::atomic<bool> accessed_		   = false;
+	mutable std::uint32_t	  decompressions_  = 0;
+	mutable std::uint64_t	  decompressNanos_ = 0;
+	float					  idleTime_		   = 0.0f;
 
 	bool				 dirty_;
 	DirectX::XMINT3		 chunkWorldPos_;
 	DirectX::XMFLOAT4X4	 chunkWorldMatrix_;
 	DirectX::BoundingBox chunkBounds_;
 
+	// Main thread only, used to skip remeshing when a light change isn't visible
+	LightSampleMask lightSampleMask_;
+	std::uint32_t	pendingMeshes_	 = 0; // requested meshes that haven't been uploaded yet
+	bool			hasMesh_		 = false;
+	std::uint32_t	loadedNeighbors_ = 0; // out of 26
+
 	Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer_;
 	Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer_;
 	std::uint32_t						 indexCount_;
@@ -80,6 +202,8 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11Buffer> shadowProxyIndexBuffer_;
 	std::uint32_t						 shadowProxyIndexCount_;
 
+	std::uint32_t meshByteSize_ = 0; // of the four buffers above
+
 public:
 	// Getters
 	[[nodiscard]] Microsoft::WRL::ComPtr<ID3D11Buffer> GetVertexBuffer() const { return vertexBuffer_; }
@@ -94,13 +218,16 @@ public:
 		return shadowProxyIndexBuffer_.Get();
 	}
 
-	// Copy-getter, use only when necessary
-	[[nodiscard]] std::array<Block, CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE> GetBlocks() const { return blocks_; }
-	[[nodiscard]] std::uint32_t											  GetIndexCount() const { return indexCount_; };
+	// Same layout as SetBlocks
+	[[nodiscard]] const BlockArray&	   GetBlocks() const { return GetReadableBlocks(); }
+	[[nodiscard]] std::uint32_t		   GetIndexCount() const { return indexCount_; };
 	[[nodiscard]] std::uint32_t		   GetShadowProxyIndexCount() const { return shadowProxyIndexCount_; };
+	[[nodiscard]] std::uint32_t		   GetMeshByteSize() const { return meshByteSize_; }
 	[[nodiscard]] DirectX::XMINT3	   GetChunkWorldPos() const { return chunkWorldPos_; }
 	[[nodiscard]] DirectX::XMMATRIX	   GetWorldMatrix() const { return DirectX::XMLoadFloat4x4(&chunkWorldMatrix_); }
 	[[nodiscard]] DirectX::BoundingBox GetChunkBounds() const { return chunkBounds_; }
+	[[nodiscard]] bool				   IsCompressed() const { return blocks_ == nullptr; }
+	[[nodiscard]] std::size_t		   GetCompressedSize() const { return compressedBlocks_.capacity(); }
 
 
 	void SetVertexBuffer(const Microsoft::WRL::ComPtr<ID3D11Buffer>& vertexBuffer) { vertexBuffer_ = vertexBuffer; }
@@ -116,4 +243,5 @@ public:
 		shadowProxyIndexBuffer_ = indexBuffer;
 	}
 	void SetShadowProxyIndexCount(std::uint32_t indexCount) { shadowProxyIndexCount_ = indexCount; };
+	void SetMeshByteSize(std::uint32_t byteSize) { meshByteSize_ = byteSize; }
 };
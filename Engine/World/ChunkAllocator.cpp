@@ -0,0 +1,151 @@
+﻿#include "ChunkAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+#include <type_traits>
+
+#include "../Core/MemoryTracking.h"
+
+namespace
+{
+	constexpr std::size_t cacheLineSize = 64;
+
+	// What the allocator gets created with, Configure can only change it up until then
+	ChunkAllocator::Settings allocatorSettings;
+	bool					 isAllocatorCreated = false;
+
+	// Puts the reference counts of shared block arrays into a pool too, they're allocated along with every array
+	template <typename T>
+	class SharedStateAllocator
+	{
+	public:
+		using value_type = T;
+
+		explicit SharedStateAllocator(SlabPool* pool) : pool_(pool) {}
+
+		template <typename U>
+		SharedStateAllocator(const SharedStateAllocator<U>& other) : pool_(other.GetPool())
+		{
+		}
+
+		T* allocate(std::size_t count)
+		{
+			static_assert(sizeof(T) <= cacheLineSize && alignof(T) <= cacheLineSize);
+			assert(count == 1);
+
+			void* state = pool_->Allocate();
+			if (state == nullptr)
+			{
+				throw std::bad_alloc();
+			}
+			Memory::Track(Memory::Tag::ChunkBlocks, static_cast<std::int64_t>(pool_->GetSlotSize()));
+			return static_cast<T*>(state);
+		}
+
+		void deallocate(T* state, std::size_t)
+		{
+			Memory::Track(Memory::Tag::ChunkBlocks, -static_cast<std::int64_t>(pool_->GetSlotSize()));
+			pool_->Free(state);
+		}
+
+		template <typename U>
+		bool operator==(const SharedStateAllocator<U>& other) const
+		{
+			return pool_ == other.GetPool();
+		}
+
+		[[nodiscard]] SlabPool* GetPool() const { return pool_; }
+
+	private:
+		SlabPool* pool_;
+	};
+} // namespace
+
+ChunkAllocator::ChunkAllocator(const Settings& settings) :
+	chunkPool_({sizeof(Chunk), (std::max)(alignof(Chunk), cacheLineSize), 256 << 10, settings.useHugePages}),
+	blockPool_({sizeof(Chunk::BlockArray), 4096, 2 << 20, settings.useHugePages, settings.maxCommittedFreeBlocks}),
+	sharedStatePool_({cacheLineSize, cacheLineSize, 64 << 10, settings.useHugePages})
+{
+	isAllocatorCreated = true;
+}
+
+bool ChunkAllocator::Configure(const Settings& settings)
+{
+	if (isAllocatorCreated)
+	{
+		return false;
+	}
+
+	allocatorSettings = settings;
+	return true;
+}
+
+ChunkAllocator& ChunkAllocator::GetAllocator()
+{
+	static ChunkAllocator instance(allocatorSettings);
+	return instance;
+}
+
+void* ChunkAllocator::AllocateChunk()
+{
+	void* chunk = chunkPool_.Allocate();
+	if (chunk != nullptr)
+	{
+		Memory::Track(Memory::Tag::Chunks, static_cast<std::int64_t>(chunkPool_.GetSlotSize()));
+	}
+	return chunk;
+}
+
+void ChunkAllocator::FreeChunk(void* chunk)
+{
+	Memory::Track(Memory::Tag::Chunks, -static_cast<std::int64_t>(chunkPool_.GetSlotSize()));
+	chunkPool_.Free(chunk);
+}
+
+std::shared_ptr<Chunk::BlockArray> ChunkAllocator::AllocateBlocks(Block fill)
+{
+	void* slot = blockPool_.Allocate();
+	if (slot == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	Memory::Track(Memory::Tag::ChunkBlocks, static_cast<std::int64_t>(blockPool_.GetSlotSize()));
+
+	// Constructing the array first would write every block twice
+	std::uninitialized_fill_n(static_cast<Block*>(slot), std::tuple_size_v<Chunk::BlockArray>, fill);
+	return ShareBlocks(std::launder(static_cast<Chunk::BlockArray*>(slot)));
+}
+
+std::shared_ptr<Chunk::BlockArray> ChunkAllocator::AllocateBlocks(const Chunk::BlockArray& source)
+{
+	void* slot = blockPool_.Allocate();
+	if (slot == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	Memory::Track(Memory::Tag::ChunkBlocks, static_cast<std::int64_t>(blockPool_.GetSlotSize()));
+	return ShareBlocks(new (slot) Chunk::BlockArray(source));
+}
+
+ChunkAllocator::Stats ChunkAllocator::GetStats()
+{
+	return {chunkPool_.GetStats(), blockPool_.GetStats(), sharedStatePool_.GetStats()};
+}
+
+std::shared_ptr<Chunk::BlockArray> ChunkAllocator::ShareBlocks(Chunk::BlockArray* blocks)
+{
+	static_assert(std::is_trivially_destructible_v<Chunk::BlockArray>);
+
+	// Also takes care of the array if allocating the shared state throws
+	return std::shared_ptr<Chunk::BlockArray>(blocks,
+											  [this](Chunk::BlockArray* released)
+											  {
+												  Memory::Track(Memory::Tag::ChunkBlocks,
+																-static_cast<std::int64_t>(blockPool_.GetSlotSize()));
+												  blockPool_.Free(released);
+											  },
+											  SharedStateAllocator<Chunk::BlockArray>(&sharedStatePool_));
+}
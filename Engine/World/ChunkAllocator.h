@@ -0,0 +1,63 @@
+﻿#pragma once
+#include <memory>
+
+#include "../Utils/SlabPool.h"
+#include "Block.h"
+#include "Chunk.h"
+
+/**
+ * Pools for chunks and their blocks, so that streaming chunks in and out never goes through the general-purpose heap.
+ * Every block array gets a page-aligned slot of its own, the ones that pile up unused give their memory back to the
+ * OS. Thread safe, chunks get created on the generation workers and blocks released wherever their last snapshot goes
+ */
+class ChunkAllocator
+{
+public:
+	struct Settings
+	{
+		bool		useHugePages		   = false; // needs the "Lock pages in memory" right on Windows
+		std::size_t maxCommittedFreeBlocks = 256;	// unused block arrays kept ready, the rest go back to the OS
+	};
+
+	struct Stats
+	{
+		SlabPool::Stats chunks;
+		SlabPool::Stats blocks;
+		SlabPool::Stats sharedStates; // reference counts of the shared block arrays
+	};
+
+	ChunkAllocator(const ChunkAllocator&)			 = delete;
+	ChunkAllocator(ChunkAllocator&&)				 = delete;
+	ChunkAllocator& operator=(const ChunkAllocator&) = delete;
+	ChunkAllocator& operator=(ChunkAllocator&&)		 = delete;
+
+	/**
+	 * Has to happen before the first chunk gets created, on the main thread
+	 * @return false if the pools exist already
+	 */
+	static bool Configure(const Settings& settings);
+
+	[[nodiscard]] static ChunkAllocator& GetAllocator();
+
+	// Chunk's operator new and delete go through these
+	[[nodiscard]] void* AllocateChunk();
+	void				FreeChunk(void* chunk);
+
+	/**
+	 * @param fill every block of the array starts out as this
+	 */
+	[[nodiscard]] std::shared_ptr<Chunk::BlockArray> AllocateBlocks(Block fill);
+	[[nodiscard]] std::shared_ptr<Chunk::BlockArray> AllocateBlocks(const Chunk::BlockArray& source);
+
+	[[nodiscard]] Stats GetStats();
+
+private:
+	explicit ChunkAllocator(const Settings& settings);
+
+	// Wraps a slot of blockPool_, its reference count goes into sharedStatePool_
+	[[nodiscard]] std::shared_ptr<Chunk::BlockArray> ShareBlocks(Chunk::BlockArray* blocks);
+
+	SlabPool chunkPool_;
+	SlabPool blockPool_;
+	SlabPool sharedStatePool_;
+};
@@ -1,22 +1,40 @@
 ﻿#pragma once
+#include <new>
+
+#include "../Core/MemoryTracking.h"
 #include "Block.h"
 #include "Chunk.h"
 
 class Chunk;
 struct ChunkContext
 {
-	using ChunkSlice = std::array<Block, Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE>;
+	// The chunk with a one block border taken from all 26 neighbors, indexed with Chunk::GetPaddedIndex
+	// Blocks of missing neighbors are air with full sky light
+	std::array<Block, Chunk::PADDED_CHUNK_SIZE * Chunk::PADDED_CHUNK_SIZE * Chunk::PADDED_CHUNK_SIZE> paddedBlocks;
 
-	std::array<Block, Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE> mainChunk;
+	DirectX::XMINT3 mainChunkCoordinates;
 
-	ChunkSlice northNeighbor;
-	ChunkSlice southNeighbor;
-	ChunkSlice westNeighbor;
-	ChunkSlice eastNeighbor;
-	ChunkSlice topNeighbor;
-	ChunkSlice bottomNeighbor;
+	/**
+	 * @param x chunk-space x, can lie one block outside the chunk (-1 or CHUNK_SIZE)
+	 * @param y chunk-space y, can lie one block outside the chunk (-1 or CHUNK_SIZE)
+	 * @param z chunk-space z, can lie one block outside the chunk (-1 or CHUNK_SIZE)
+	 */
+	[[nodiscard]] const Block& GetBlock(std::int32_t x, std::int32_t y, std::int32_t z) const
+	{
+		return paddedBlocks[Chunk::GetPaddedIndex(x, y, z)];
+	}
 
-	std::array<bool, 6> hasNeighbors;
+	// Counted against Memory::Tag::ChunkContexts, every job carries about 80 KB of blocks
+	[[nodiscard]] static void* operator new(std::size_t size)
+	{
+		void* context = ::operator new(size);
+		Memory::Track(Memory::Tag::ChunkContexts, static_cast<std::int64_t>(size));
+		return context;
+	}
 
-	DirectX::XMINT3 mainChunkCoordinates;
+	static void operator delete(void* context, std::size_t size)
+	{
+		Memory::Track(Memory::Tag::ChunkContexts, -static_cast<std::int64_t>(size));
+		::operator delete(context);
+	}
 };
@@ -0,0 +1,402 @@
+﻿#include "ChunkGenerationPipeline.h"
+
+#include <algorithm>
+#include <cassert>
+#include <ranges>
+
+#include "../Core/Profiler.h"
+#include "../Utils/ChunkUtils.h"
+#include "BlockDatabase.h"
+#include "Chunk.h"
+
+ChunkGenerationPipeline::ChunkGenerationPipeline(IChunkGenerator* generator,
+												 std::int32_t	  minChunkY,
+												 std::int32_t	  maxChunkY,
+												 std::uint32_t	  threadCount) :
+	generator_(generator),
+	minChunkY_(minChunkY),
+	maxChunkY_(maxChunkY),
+	runningJobCount_(0),
+	chunkCount_(0),
+	shuttingDown_(false)
+{
+	assert(generator_ != nullptr);
+	assert(minChunkY_ <= maxChunkY_);
+
+	threadCount = (std::max)(threadCount, 1u);
+	for (std::uint32_t i = 0; i < threadCount; ++i)
+	{
+		workers_.emplace_back(&ChunkGenerationPipeline::WorkerLoop, this);
+	}
+}
+
+ChunkGenerationPipeline::~ChunkGenerationPipeline()
+{
+	{
+		std::unique_lock<std::mutex> lock(jobQueueMutex_);
+		shuttingDown_ = true;
+	}
+
+	jobQueueCondition_.notify_all();
+
+	for (auto& worker : workers_)
+	{
+		worker.join();
+	}
+}
+
+void ChunkGenerationPipeline::Request(DirectX::XMINT2 columnCoordinates)
+{
+	Column& column = GetOrCreateColumn(columnCoordinates);
+	if (column.requested)
+	{
+		return;
+	}
+
+	column.requested = true;
+	if (column.stage == ColumnStage::Decorated)
+	{
+		waitingForLight_.push_back(columnCoordinates);
+	}
+
+	// Get the dependencies going right away instead of waiting for the column to be decorated first
+	for (std::int32_t dz = -1; dz <= 1; ++dz)
+	{
+		for (std::int32_t dx = -1; dx <= 1; ++dx)
+		{
+			GetOrCreateColumn(DirectX::XMINT2{columnCoordinates.x + dx, columnCoordinates.y + dz});
+		}
+	}
+}
+
+void ChunkGenerationPipeline::Update(std::vector<FinishedColumn>& outFinished)
+{
+	std::vector<JobResult> results;
+	{
+		std::lock_guard<std::mutex> lock(resultsMutex_);
+		results.swap(results_);
+	}
+
+	for (JobResult& result : results)
+	{
+		--runningJobCount_;
+
+		auto it = columns_.find(result.columnCoordinates);
+		assert(it != columns_.end());
+		Column& column = it->second;
+		column.outgoingEdits.insert(column.outgoingEdits.end(),
+									result.pendingEdits.begin(),
+									result.pendingEdits.end());
+
+		assert(column.runningJobs > 0);
+		if (--column.runningJobs > 0)
+		{
+			continue;
+		}
+
+		if (column.stage == ColumnStage::Terrain)
+		{
+			column.stage = ColumnStage::Decorated;
+			ExchangeEdits(result.columnCoordinates);
+			if (column.requested)
+			{
+				waitingForLight_.push_back(result.columnCoordinates);
+			}
+		}
+		else if (column.stage == ColumnStage::Lighting)
+		{
+			column.stage  = ColumnStage::Finished;
+			chunkCount_	 -= column.chunks.size();
+			outFinished.push_back({result.columnCoordinates,
+								   std::move(column.chunks),
+								   std::move(result.blockLightSeeds),
+								   std::move(result.skyLightSeeds)});
+			column.chunks.clear();
+		}
+	}
+
+	// Checking the neighbors might create columns, so collect the ones that are ready first
+	std::vector<DirectX::XMINT2> readyColumns;
+	std::erase_if(waitingForLight_,
+				  [&](DirectX::XMINT2 columnCoordinates)
+				  {
+					  if (AreNeighborsDecorated(columnCoordinates) == false)
+					  {
+						  return false;
+					  }
+
+					  readyColumns.push_back(columnCoordinates);
+					  return true;
+				  });
+
+	for (DirectX::XMINT2 columnCoordinates : readyColumns)
+	{
+		Column& column = columns_.at(columnCoordinates);
+		column.stage   = ColumnStage::Lighting;
+		++column.runningJobs;
+
+		Job job{columnCoordinates, ColumnStage::Lighting, {}};
+		job.chunks.reserve(column.chunks.size());
+		for (const auto& chunk : column.chunks)
+		{
+			job.chunks.push_back(chunk.get());
+		}
+
+		PushJob(std::move(job));
+	}
+}
+
+bool ChunkGenerationPipeline::Discard(DirectX::XMINT2 columnCoordinates)
+{
+	auto it = columns_.find(columnCoordinates);
+	if (it == columns_.end())
+	{
+		return true;
+	}
+
+	if (it->second.runningJobs > 0)
+	{
+		return false;
+	}
+
+	chunkCount_ -= it->second.chunks.size();
+	std::erase(waitingForLight_, columnCoordinates);
+	columns_.erase(it);
+	return true;
+}
+
+bool ChunkGenerationPipeline::Contains(DirectX::XMINT2 columnCoordinates) const
+{
+	return columns_.contains(columnCoordinates);
+}
+
+bool ChunkGenerationPipeline::IsRequested(DirectX::XMINT2 columnCoordinates) const
+{
+	auto it = columns_.find(columnCoordinates);
+	return it != columns_.end() && it->second.requested;
+}
+
+std::vector<DirectX::XMINT2> ChunkGenerationPipeline::GetColumns() const
+{
+	std::vector<DirectX::XMINT2> columns;
+	columns.reserve(columns_.size());
+	for (const auto& columnCoordinates : columns_ | std::views::keys)
+	{
+		columns.push_back(columnCoordinates);
+	}
+
+	return columns;
+}
+
+ChunkGenerationPipeline::Column& ChunkGenerationPipeline::GetOrCreateColumn(DirectX::XMINT2 columnCoordinates)
+{
+	auto [it, inserted] = columns_.try_emplace(columnCoordinates);
+	Column& column		= it->second;
+	if (inserted == false)
+	{
+		return column;
+	}
+
+	// Every chunk of the column is a separate terrain job
+	for (std::int32_t y = minChunkY_; y <= maxChunkY_; ++y)
+	{
+		column.chunks.push_back(std::make_unique<Chunk>(DirectX::XMINT3{columnCoordinates.x, y, columnCoordinates.y}));
+		++column.runningJobs;
+		PushJob({columnCoordinates, ColumnStage::Terrain, {column.chunks.back().get()}});
+	}
+
+	chunkCount_ += column.chunks.size();
+	return column;
+}
+
+bool ChunkGenerationPipeline::AreNeighborsDecorated(DirectX::XMINT2 columnCoordinates)
+{
+	bool decorated = true;
+	for (std::int32_t dz = -1; dz <= 1; ++dz)
+	{
+		for (std::int32_t dx = -1; dx <= 1; ++dx)
+		{
+			// A neighbor could have been discarded in the meantime, it'll just get generated again
+			const Column& neighbor = GetOrCreateColumn(DirectX::XMINT2{columnCoordinates.x + dx, columnCoordinates.y + dz});
+			decorated			   = decorated && neighbor.stage != ColumnStage::Terrain;
+		}
+	}
+
+	return decorated;
+}
+
+void ChunkGenerationPipeline::ExchangeEdits(DirectX::XMINT2 columnCoordinates)
+{
+	Column& column = columns_.at(columnCoordinates);
+	for (std::int32_t dz = -1; dz <= 1; ++dz)
+	{
+		for (std::int32_t dx = -1; dx <= 1; ++dx)
+		{
+			const DirectX::XMINT2 neighborCoordinates{columnCoordinates.x + dx, columnCoordinates.y + dz};
+			auto				  it = columns_.find(neighborCoordinates);
+			if (it == columns_.end())
+			{
+				continue;
+			}
+
+			// Includes the column itself, features can spill over into the chunks above and below
+			Column& neighbor = it->second;
+			if (neighbor.stage == ColumnStage::Decorated)
+			{
+				ApplyEdits(column.outgoingEdits, neighborCoordinates, neighbor);
+			}
+
+			// Columns past decoration got this column's edits when it was generated the first time, and since
+			// generation is deterministic it ended up with the same ones again
+			if ((dx != 0 || dz != 0) && neighbor.stage != ColumnStage::Terrain)
+			{
+				ApplyEdits(neighbor.outgoingEdits, columnCoordinates, column);
+			}
+		}
+	}
+}
+
+void ChunkGenerationPipeline::ApplyEdits(const std::vector<BlockEdit>& edits,
+										 DirectX::XMINT2			   targetCoordinates,
+										 Column&					   target) const
+{
+	using Utils::Coordinates::GetChunkCoordinate;
+
+	for (const BlockEdit& edit : edits)
+	{
+		const std::int32_t chunkX	= GetChunkCoordinate<Chunk::CHUNK_SIZE>(edit.position.x);
+		const std::int32_t chunkY	= GetChunkCoordinate<Chunk::CHUNK_SIZE>(edit.position.y);
+		const std::int32_t chunkZ	= GetChunkCoordinate<Chunk::CHUNK_SIZE>(edit.position.z);
+		const bool		   inTarget = chunkX == targetCoordinates.x && chunkZ == targetCoordinates.y;
+		if (inTarget == false || chunkY < minChunkY_ || chunkY > maxChunkY_)
+		{
+			continue;
+		}
+
+		ChunkDecorator::ApplyEdit(target.chunks[chunkY - minChunkY_].get(), edit);
+	}
+}
+
+void ChunkGenerationPipeline::PushJob(Job&& job)
+{
+	++runningJobCount_;
+	{
+		std::lock_guard<std::mutex> lock(jobQueueMutex_);
+		jobQueue_.push(std::move(job));
+	}
+
+	jobQueueCondition_.notify_one();
+}
+
+void ChunkGenerationPipeline::WorkerLoop()
+{
+	PROFILE_THREAD_NAME("Chunk generation");
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(jobQueueMutex_);
+			jobQueueCondition_.wait(lock, [this] { return !jobQueue_.empty() || shuttingDown_; });
+
+			// Unlike meshing, there's no point in finishing the queue, nobody's going to pick up the chunks
+			if (shuttingDown_)
+			{
+				return;
+			}
+
+			job = std::move(jobQueue_.front());
+			jobQueue_.pop();
+		}
+
+		JobResult result{job.columnCoordinates, {}, {}, {}};
+		if (job.stage == ColumnStage::Terrain)
+		{
+			PROFILE_ZONE("Generate terrain");
+			assert(job.chunks.size() == 1);
+			generator_->FillChunk(job.chunks.front());
+
+			ChunkDecorator decorator(job.chunks.front(), result.pendingEdits);
+			generator_->DecorateChunk(decorator);
+		}
+		else
+		{
+			LightColumn(job, result.blockLightSeeds, result.skyLightSeeds);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(resultsMutex_);
+			results_.push_back(std::move(result));
+		}
+	}
+}
+
+void ChunkGenerationPipeline::LightColumn(const Job&				 job,
+										  std::vector<LightNode>& outBlockLightSeeds,
+										  std::vector<LightNode>& outSkyLightSeeds) const
+{
+	PROFILE_FUNCTION();
+	static constexpr auto chunkSize = static_cast<std::int32_t>(Chunk::CHUNK_SIZE);
+	const BlockDatabase&  database	= BlockDatabase::GetDatabase();
+
+	// Sky light goes straight down at full strength until something opaque stops it, same as in VoxelLightingEngine.
+	// Spreading it sideways under overhangs is left to the propagation after the hand-off, from the seeds
+	std::array<bool, Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE> skyVisible;
+	skyVisible.fill(true);
+
+	for (Chunk* chunk : job.chunks | std::views::reverse)
+	{
+		const DirectX::XMINT3 chunkCoordinates = chunk->GetChunkWorldPos();
+		for (std::int32_t y = chunkSize - 1; y >= 0; --y)
+		{
+			for (std::int32_t z = 0; z < chunkSize; ++z)
+			{
+				for (std::int32_t x = 0; x < chunkSize; ++x)
+				{
+					const BlockType	   type			 = chunk->GetBlock(x, y, z).type;
+					const std::uint8_t lightEmission = database.GetLightEmission(type);
+					bool&			   sky			 = skyVisible[x + z * chunkSize];
+
+					sky = sky && database.IsOpaque(type) == false;
+					chunk->SetSkyLightLevel(x, y, z, sky ? 15 : 0);
+
+					if (lightEmission > 0)
+					{
+						outBlockLightSeeds.emplace_back(chunkCoordinates.x * chunkSize + x,
+														chunkCoordinates.y * chunkSize + y,
+														chunkCoordinates.z * chunkSize + z,
+														lightEmission);
+					}
+				}
+			}
+
+			// Only within the column, across its sides it's up to the streamer, the neighbors might not be there yet
+			auto IsDarkOpening = [&](std::int32_t x, std::int32_t z)
+			{
+				return x >= 0
+					&& x < chunkSize
+					&& z >= 0
+					&& z < chunkSize
+					&& skyVisible[x + z * chunkSize] == false
+					&& database.IsOpaque(chunk->GetBlock(x, y, z).type) == false;
+			};
+
+			for (std::int32_t z = 0; z < chunkSize; ++z)
+			{
+				for (std::int32_t x = 0; x < chunkSize; ++x)
+				{
+					if (skyVisible[x + z * chunkSize]
+						&& (IsDarkOpening(x - 1, z)
+							|| IsDarkOpening(x + 1, z)
+							|| IsDarkOpening(x, z - 1)
+							|| IsDarkOpening(x, z + 1)))
+					{
+						outSkyLightSeeds.emplace_back(chunkCoordinates.x * chunkSize + x,
+													  chunkCoordinates.y * chunkSize + y,
+													  chunkCoordinates.z * chunkSize + z,
+													  15);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,152 @@
+﻿#pragma once
+#include <DirectXMath.h>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../Math/DirectXMathOperators.h"
+#include "BlockType.h"
+#include "ChunkGenerators/ChunkDecorator.h"
+#include "ChunkGenerators/IChunkGenerator.h"
+#include "VoxelLightingEngine.h"
+
+class Chunk;
+
+/**
+ * Generates chunk columns on worker threads. A column goes through these stages, each of them starts as soon as its
+ * dependencies are met, so columns flow through independently of each other:
+ *  - Terrain + decoration: one job per chunk, no dependencies. Features spilling over into other chunks come back as
+ *    pending edits. Once a column is decorated, they get applied to the columns in reach that are decorated already,
+ *    and the ones the neighbors made get applied to it. A column keeps its edits around for neighbors that show up
+ *    later
+ *  - Light: one job per column, initial sky light straight down from the top of the column, the blocks it has to
+ *    spread sideways from and a list of emissive blocks. Depends on the 8 surrounding columns being decorated, that's
+ *    the last point their features could still reach into this column
+ *  - Mesh: happens after the hand-off, once all 26 neighbors of a chunk are resident (see ChunkStreamer)
+ * Neighbor columns a dependency needs get generated on their own, but only requested columns get handed off
+ */
+class ChunkGenerationPipeline
+{
+public:
+	struct FinishedColumn
+	{
+		DirectX::XMINT2						columnCoordinates;
+		std::vector<std::unique_ptr<Chunk>> chunks;			 // bottom to top
+		std::vector<LightNode>				blockLightSeeds; // emissive blocks, already written into the chunks
+		std::vector<LightNode>				skyLightSeeds;	 // sky-lit blocks next to open ones the sky doesn't reach
+	};
+
+	ChunkGenerationPipeline() = delete;
+
+	/**
+	 * @param generator has to outlive the pipeline, gets called from all worker threads
+	 * @param minChunkY lowest chunk of every column
+	 * @param maxChunkY highest chunk of every column, its top is open to the sky
+	 */
+	ChunkGenerationPipeline(IChunkGenerator* generator,
+							std::int32_t	 minChunkY,
+							std::int32_t	 maxChunkY,
+							std::uint32_t	 threadCount);
+	~ChunkGenerationPipeline();
+
+	ChunkGenerationPipeline(const ChunkGenerationPipeline&)			   = delete;
+	ChunkGenerationPipeline(ChunkGenerationPipeline&&)				   = delete;
+	ChunkGenerationPipeline& operator=(const ChunkGenerationPipeline&) = delete;
+	ChunkGenerationPipeline& operator=(ChunkGenerationPipeline&&)	   = delete;
+
+	// Queues the column for generation, along with the neighbors it depends on
+	void Request(DirectX::XMINT2 columnCoordinates);
+
+	/**
+	 * Collects finished jobs and starts the stages whose dependencies got met. Main thread only
+	 * @param outFinished requested columns that went through every stage, ownership of the chunks moves to the caller
+	 */
+	void Update(std::vector<FinishedColumn>& outFinished);
+
+	/**
+	 * Forgets the column. Handed off columns stay known to the pipeline until discarded, so they don't get generated
+	 * again as a dependency
+	 * @return false if the column's jobs are still running
+	 */
+	bool Discard(DirectX::XMINT2 columnCoordinates);
+
+	[[nodiscard]] bool						   Contains(DirectX::XMINT2 columnCoordinates) const;
+	[[nodiscard]] bool						   IsRequested(DirectX::XMINT2 columnCoordinates) const;
+	[[nodiscard]] std::vector<DirectX::XMINT2> GetColumns() const;
+
+private:
+	enum class ColumnStage : std::uint8_t
+	{
+		Terrain,   // terrain and decoration jobs running
+		Decorated, // waiting for the neighbors to get decorated
+		Lighting,  // light job running
+		Finished,  // handed off
+	};
+
+	struct Column
+	{
+		ColumnStage							stage		= ColumnStage::Terrain;
+		bool								requested	= false; // false while it only exists for a neighbor's sake
+		std::uint32_t						runningJobs = 0;
+		std::vector<std::unique_ptr<Chunk>> chunks;		   // bottom to top
+		std::vector<BlockEdit>				outgoingEdits; // features of this column landing outside of it
+	};
+
+	struct Job
+	{
+		DirectX::XMINT2		columnCoordinates;
+		ColumnStage			stage;	// Terrain: generate the only chunk, Lighting: light the whole column
+		std::vector<Chunk*> chunks; // bottom to top
+	};
+
+	struct JobResult
+	{
+		DirectX::XMINT2		   columnCoordinates;
+		std::vector<LightNode> blockLightSeeds;
+		std::vector<LightNode> skyLightSeeds;
+		std::vector<BlockEdit> pendingEdits; // spilled over from the decorated chunk
+	};
+
+	Column&			   GetOrCreateColumn(DirectX::XMINT2 columnCoordinates);
+	[[nodiscard]] bool AreNeighborsDecorated(DirectX::XMINT2 columnCoordinates);
+
+	// Swaps pending edits with the surrounding columns, right after the column got decorated
+	void ExchangeEdits(DirectX::XMINT2 columnCoordinates);
+	void ApplyEdits(const std::vector<BlockEdit>& edits, DirectX::XMINT2 targetCoordinates, Column& target) const;
+	void			   PushJob(Job&& job);
+	void			   WorkerLoop();
+	void			   LightColumn(const Job&			   job,
+								   std::vector<LightNode>& outBlockLightSeeds,
+								   std::vector<LightNode>& outSkyLightSeeds) const;
+
+	IChunkGenerator* generator_;
+	std::int32_t	 minChunkY_;
+	std::int32_t	 maxChunkY_;
+
+	// Main thread only
+	std::unordered_map<DirectX::XMINT2, Column, Math::XMINT2Hash> columns_;
+	std::vector<DirectX::XMINT2>								  waitingForLight_; // requested and decorated
+	std::size_t													  runningJobCount_;
+	std::size_t													  chunkCount_; // chunks owned by the pipeline
+
+	std::queue<Job>			jobQueue_;
+	std::mutex				jobQueueMutex_;
+	std::condition_variable jobQueueCondition_;
+	bool					shuttingDown_;
+
+	std::vector<JobResult> results_;
+	std::mutex			   resultsMutex_;
+
+	std::vector<std::thread> workers_;
+
+public:
+	// Getters
+	[[nodiscard]] std::size_t GetRunningJobCount() const { return runningJobCount_; }
+	[[nodiscard]] std::size_t GetChunkCount() const { return chunkCount_; }
+};
@@ -0,0 +1,113 @@
+﻿#include "ChunkDecorator.h"
+#include "../Chunk.h"
+
+#include <cassert>
+
+#include "../BlockDatabase.h"
+
+namespace
+{
+	constexpr std::uint64_t GetTypeBit(BlockType type)
+	{
+		return std::uint64_t{1} << static_cast<std::uint64_t>(type);
+	}
+
+	static_assert(static_cast<std::size_t>(BlockType::MAX_BLOCKS_) <= 64, "Replaceable types don't fit the mask");
+
+	// Chunk-space position of the block, false if it lies outside of the chunk
+	bool GetLocalPosition(const Chunk* chunk, DirectX::XMINT3 position, DirectX::XMUINT3& outLocal)
+	{
+		static constexpr auto chunkSize = static_cast<std::int32_t>(Chunk::CHUNK_SIZE);
+
+		const DirectX::XMINT3 chunkPos = chunk->GetChunkWorldPos();
+		const std::int32_t	  x		   = position.x - chunkPos.x * chunkSize;
+		const std::int32_t	  y		   = position.y - chunkPos.y * chunkSize;
+		const std::int32_t	  z		   = position.z - chunkPos.z * chunkSize;
+		if (x < 0 || y < 0 || z < 0 || x >= chunkSize || y >= chunkSize || z >= chunkSize)
+		{
+			return false;
+		}
+
+		outLocal = {static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(y), static_cast<std::uint32_t>(z)};
+		return true;
+	}
+} // namespace
+
+ChunkDecorator::ChunkDecorator(Chunk* chunk, std::vector<BlockEdit>& outPendingEdits) :
+	chunk_(chunk),
+	pendingEdits_(outPendingEdits)
+{
+	assert(chunk_ != nullptr);
+
+	static constexpr auto chunkSize = static_cast<std::int32_t>(Chunk::CHUNK_SIZE);
+	const DirectX::XMINT3 chunkPos	= chunk_->GetChunkWorldPos();
+	chunkOrigin_					= {chunkPos.x * chunkSize, chunkPos.y * chunkSize, chunkPos.z * chunkSize};
+}
+
+void ChunkDecorator::SetBlock(DirectX::XMINT3 position, BlockType type)
+{
+	assert(GetReplaceableTypes(type) != 0);
+
+	const BlockEdit	 edit{position, type};
+	DirectX::XMUINT3 local;
+	if (GetLocalPosition(chunk_, position, local) == false)
+	{
+		pendingEdits_.push_back(edit);
+		return;
+	}
+
+	ApplyEdit(chunk_, edit);
+}
+
+BlockType ChunkDecorator::GetBlockType(DirectX::XMINT3 position) const
+{
+	DirectX::XMUINT3 local;
+	if (GetLocalPosition(chunk_, position, local) == false)
+	{
+		return BlockType::INVALID_;
+	}
+
+	return chunk_->GetBlock(local).type;
+}
+
+bool ChunkDecorator::ApplyEdit(Chunk* chunk, const BlockEdit& edit)
+{
+	DirectX::XMUINT3 local;
+	if (GetLocalPosition(chunk, edit.position, local) == false)
+	{
+		return false;
+	}
+
+	if ((GetReplaceableTypes(edit.type) & GetTypeBit(chunk->GetBlock(local).type)) == 0)
+	{
+		return false;
+	}
+
+	// Emissive features carry their own block light, same as generated terrain
+	Block			 block{edit.type, 0};
+	const BlockData* data = BlockDatabase::GetDatabase().GetBlockData(edit.type);
+	if (data)
+	{
+		block.lightLevel = data->lightEmissionLevel;
+	}
+
+	return chunk->FillBox(local, {local.x + 1, local.y + 1, local.z + 1}, block);
+}
+
+std::uint64_t ChunkDecorator::GetReplaceableTypes(BlockType type)
+{
+	// Every type has to rank above everything it replaces, otherwise the edit order would start to matter
+	switch (type)
+	{
+		case BlockType::Log:
+			return GetTypeBit(BlockType::Air) | GetTypeBit(BlockType::Glowstone);
+		case BlockType::Glowstone:
+			return GetTypeBit(BlockType::Air);
+		case BlockType::DiamondBlock:
+			return GetTypeBit(BlockType::Stone) | GetTypeBit(BlockType::IronBlock);
+		case BlockType::IronBlock:
+			return GetTypeBit(BlockType::Stone);
+		default:
+			return 0;
+	}
+}
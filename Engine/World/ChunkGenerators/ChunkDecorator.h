@@ -0,0 +1,59 @@
+﻿#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+#include "../BlockType.h"
+
+class Chunk;
+
+// A block placed by a feature
+struct BlockEdit
+{
+	DirectX::XMINT3 position; // world-space
+	BlockType		type;
+};
+
+/**
+ * What generators place their features through. Writes into the decorated chunk land right away, the ones that spill
+ * over into other chunks get buffered as pending edits, the generation pipeline applies them once the chunk they land
+ * in has been generated. That way every chunk can still be decorated on its own thread without locking anything.
+ * A feature block can only replace the few types that rank below it (see GetReplaceableTypes), so overlapping
+ * features end up the same no matter in which order their edits get applied
+ */
+class ChunkDecorator
+{
+public:
+	ChunkDecorator() = delete;
+	ChunkDecorator(Chunk* chunk, std::vector<BlockEdit>& outPendingEdits);
+
+	/**
+	 * @param position world-space, can lie outside of the chunk
+	 * @param type has to be a feature type, see GetReplaceableTypes
+	 */
+	void SetBlock(DirectX::XMINT3 position, BlockType type);
+
+	/**
+	 * @param position world-space
+	 * @return INVALID_ outside of the chunk, the neighbors are being generated at the same time
+	 */
+	[[nodiscard]] BlockType GetBlockType(DirectX::XMINT3 position) const;
+
+	/**
+	 * @return false if the edit doesn't land in the chunk or the block there can't be replaced
+	 */
+	static bool ApplyEdit(Chunk* chunk, const BlockEdit& edit);
+
+	// Bit per BlockType the given feature type can replace, 0 for types that aren't features
+	[[nodiscard]] static std::uint64_t GetReplaceableTypes(BlockType type);
+
+private:
+	Chunk*					chunk_;
+	DirectX::XMINT3			chunkOrigin_; // world-space position of the chunk's first block
+	std::vector<BlockEdit>& pendingEdits_;
+
+public:
+	// Getters
+	[[nodiscard]] Chunk*		  GetChunk() const { return chunk_; }
+	[[nodiscard]] DirectX::XMINT3 GetChunkOrigin() const { return chunkOrigin_; }
+};
@@ -2,6 +2,7 @@
 #include "../Chunk.h"
 
 #include <DirectXMath.h>
+#include <algorithm>
 
 #include "../BlockDatabase.h"
 
@@ -17,40 +18,34 @@ void FlatGenerator::FillChunk(Chunk* chunk)
 	XMINT3		   chunkWorldPos = chunk->GetChunkWorldPos();
 	BlockDatabase& database		 = BlockDatabase::GetDatabase();
 
-	for (std::size_t y = 0; y < Chunk::CHUNK_SIZE; ++y)
+	const std::int64_t chunkBottom = static_cast<std::int64_t>(chunkWorldPos.y) * Chunk::CHUNK_SIZE;
+	const std::int64_t chunkTop	   = chunkBottom + Chunk::CHUNK_SIZE;
+
+	// The first layer reaches all the way down, everything above the last one stays air
+	std::int64_t layerBottom = (std::min)(chunkBottom, std::int64_t{0});
+	std::int64_t layerTop	 = 0;
+	for (const auto& layer : chunkTemplate_)
 	{
-		BlockType		 blockType = GetBlockType(chunkWorldPos.y * Chunk::CHUNK_SIZE + y);
-		const BlockData* data	   = database.GetBlockData(blockType);
-		for (std::size_t x = 0; x < Chunk::CHUNK_SIZE; ++x)
+		layerTop += static_cast<std::int64_t>(layer.height);
+
+		const std::int64_t minY = std::clamp(layerBottom, chunkBottom, chunkTop) - chunkBottom;
+		const std::int64_t maxY = std::clamp(layerTop, chunkBottom, chunkTop) - chunkBottom;
+		layerBottom				= layerTop;
+		if (minY >= maxY)
 		{
-			for (std::size_t z = 0; z < Chunk::CHUNK_SIZE; ++z)
-			{
-				chunk->SetBlockType(x, y, z, blockType);
-				if (data)
-				{
-					chunk->SetSkyLightLevel(x, y, z, 0);
-					chunk->SetBlockLightLevel(x, y, z, 0);
-				}
-				if (data && data->lightEmissionLevel > 0)
-				{
-					chunk->SetBlockLightLevel(x, y, z, data->lightEmissionLevel);
-				}
-			}
+			continue;
 		}
-	}
-}
 
-BlockType FlatGenerator::GetBlockType(std::int64_t worldY)
-{
-	for (std::int64_t i = 0; const auto& layer : chunkTemplate_)
-	{
-		if (worldY < layer.height + i)
+		// No sky light inside the ground, emissive blocks carry their own block light
+		Block			 block{layer.blockType};
+		const BlockData* data = database.GetBlockData(layer.blockType);
+		if (data)
 		{
-			return layer.blockType;
+			block.lightLevel = data->lightEmissionLevel;
 		}
 
-		i += layer.height;
+		chunk->FillBox({0, static_cast<std::uint32_t>(minY), 0},
+					   {Chunk::CHUNK_SIZE, static_cast<std::uint32_t>(maxY), Chunk::CHUNK_SIZE},
+					   block);
 	}
-
-	return BlockType::Air;
 }
@@ -21,6 +21,5 @@ public:
 	void FillChunk(Chunk* chunk) override;
 
 private:
-	BlockType	  GetBlockType(std::int64_t worldY);
 	ChunkTemplate chunkTemplate_;
 };
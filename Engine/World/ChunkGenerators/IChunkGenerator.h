@@ -22,8 +22,16 @@ public:
 	}
 	virtual ~IChunkGenerator() = default;
 
+	// Gets called from multiple generation threads at once
 	virtual void FillChunk(class Chunk* chunk) = 0;
 
+	/**
+	 * Places features (trees, ores...) on top of the terrain, runs right after FillChunk. Gets called from multiple
+	 * generation threads at once, so it can only read the decorated chunk. Features can spill over into the
+	 * neighboring chunks, as long as they stay within one chunk of it
+	 */
+	virtual void DecorateChunk(class ChunkDecorator& decorator) {}
+
 protected:
 	World* world_;
 };
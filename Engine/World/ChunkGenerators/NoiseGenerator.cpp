@@ -0,0 +1,358 @@
+﻿#include "NoiseGenerator.h"
+#include "../Chunk.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+namespace
+{
+	constexpr auto chunkSize = static_cast<std::int32_t>(Chunk::CHUNK_SIZE);
+
+	// Surface blocks need to know what's above them, so the layer right above the chunk gets evaluated too
+	constexpr std::int32_t evaluatedLayers = chunkSize + 1;
+} // namespace
+
+struct NoiseGenerator::ColumnData
+{
+	std::array<float, Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE> surface; // x + z * CHUNK_SIZE
+	std::array<float, Chunk::CHUNK_SIZE>					 rowMinSurface;
+	std::array<float, Chunk::CHUNK_SIZE>					 rowMaxSurface;
+	float													 maxSurface;
+};
+
+// xorshift32, the standard distributions aren't guaranteed to give the same numbers everywhere
+class NoiseGenerator::FeatureRandom
+{
+public:
+	explicit FeatureRandom(std::uint32_t seed) :
+		state_(seed != 0 ? seed : 1)
+	{
+	}
+
+	std::uint32_t Next()
+	{
+		state_ ^= state_ << 13;
+		state_ ^= state_ >> 17;
+		state_ ^= state_ << 5;
+		return state_;
+	}
+
+	// Inclusive on both ends
+	std::int32_t Range(std::int32_t min, std::int32_t max)
+	{
+		return min + static_cast<std::int32_t>(Next() % static_cast<std::uint32_t>(max - min + 1));
+	}
+
+private:
+	std::uint32_t state_;
+};
+
+NoiseGenerator::NoiseGenerator(World* world, std::uint32_t seed, const Settings& settings) :
+	IChunkGenerator(world),
+	settings_(settings)
+{
+	settings_.heightNoise.seed	 += seed;
+	settings_.overhangNoise.seed += seed;
+	settings_.caveNoise.seed	 += seed;
+	settings_.decorationSeed	 += seed;
+}
+
+void NoiseGenerator::FillChunk(Chunk* chunk)
+{
+	using namespace DirectX;
+	using Math::Noise::Fractal3Row;
+
+	const XMINT3							chunkWorldPos = chunk->GetChunkWorldPos();
+	const std::shared_ptr<const ColumnData> column		  = GetColumnData({chunkWorldPos.x, chunkWorldPos.z});
+
+	const std::int32_t chunkBottom = chunkWorldPos.y * chunkSize;
+	const std::int32_t chunkLeft   = chunkWorldPos.x * chunkSize;
+	const std::int32_t chunkBack   = chunkWorldPos.z * chunkSize;
+	const float		   reach	   = settings_.overhangStrength;
+
+	// Nothing reaches up here, the chunk starts out as air already
+	if (static_cast<float>(chunkBottom) > column->maxSurface + reach)
+	{
+		return;
+	}
+
+	// Rows along x, 16 samples each, that's what the noise evaluates in batches
+	std::array<bool, Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE * evaluatedLayers> solid;
+	std::array<float, Chunk::CHUNK_SIZE>									  overhang;
+	std::array<float, Chunk::CHUNK_SIZE>									  cave;
+	bool																	  anySolid = false;
+
+	for (std::int32_t y = 0; y < evaluatedLayers; ++y)
+	{
+		const std::int32_t worldY = chunkBottom + y;
+		const auto		   layerY = static_cast<float>(worldY);
+		for (std::int32_t z = 0; z < chunkSize; ++z)
+		{
+			const float* surface = &column->surface[z * chunkSize];
+			bool*		 row	 = &solid[(y * chunkSize + z) * chunkSize];
+
+			// Only blocks near the surface can have their density pushed over to the other side
+			const bool nearSurface = layerY >= column->rowMinSurface[z] - reach
+								  && layerY <= column->rowMaxSurface[z] + reach;
+			if (nearSurface)
+			{
+				Fractal3Row(chunkLeft, worldY, chunkBack + z, settings_.overhangNoise, overhang);
+			}
+			else
+			{
+				overhang.fill(0.0f);
+			}
+
+			bool anySolidInRow = false;
+			for (std::int32_t x = 0; x < chunkSize; ++x)
+			{
+				row[x]		   = surface[x] - layerY + overhang[x] * reach > 0.0f;
+				anySolidInRow |= row[x];
+			}
+
+			if (anySolidInRow == false)
+			{
+				continue;
+			}
+
+			anySolid = true;
+			Fractal3Row(chunkLeft, worldY, chunkBack + z, settings_.caveNoise, cave);
+			for (std::int32_t x = 0; x < chunkSize; ++x)
+			{
+				row[x] = row[x] && cave[x] <= settings_.caveThreshold;
+			}
+		}
+	}
+
+	if (anySolid == false)
+	{
+		return;
+	}
+
+	// Solid blocks start out dark, the generation pipeline lights whole columns at once
+	constexpr std::size_t blockCount = Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE;
+	std::vector<Block>	  blocks(blockCount, {BlockType::Air, 0b11110000});
+	for (std::int32_t z = 0; z < chunkSize; ++z)
+	{
+		for (std::int32_t y = 0; y < chunkSize; ++y)
+		{
+			const float topsoilY = static_cast<float>(chunkBottom + y + settings_.dirtDepth);
+			for (std::int32_t x = 0; x < chunkSize; ++x)
+			{
+				if (solid[(y * chunkSize + z) * chunkSize + x] == false)
+				{
+					continue;
+				}
+
+				const bool covered = solid[((y + 1) * chunkSize + z) * chunkSize + x];
+				const bool topsoil = topsoilY >= column->surface[x + z * chunkSize];
+
+				BlockType type = BlockType::Stone;
+				if (topsoil)
+				{
+					type = covered ? BlockType::Dirt : BlockType::Grass;
+				}
+
+				blocks[x + y * chunkSize + z * chunkSize * chunkSize] = {type, 0};
+			}
+		}
+	}
+
+	chunk->SetBlocks(std::span<const Block, blockCount>(blocks));
+}
+
+void NoiseGenerator::DecorateChunk(ChunkDecorator& decorator)
+{
+	// Everything gets placed based on the chunk's own blocks only, so the result doesn't depend on the neighbors
+	const DirectX::XMINT3 chunkPos = decorator.GetChunk()->GetChunkWorldPos();
+	FeatureRandom		  random(Math::Noise::Hash(chunkPos.x, chunkPos.y, chunkPos.z, settings_.decorationSeed));
+
+	PlaceVeins(decorator, random, BlockType::IronBlock, settings_.ironVeins, settings_.ironVeinSize, INT32_MAX);
+	PlaceVeins(decorator,
+			   random,
+			   BlockType::DiamondBlock,
+			   settings_.diamondVeins,
+			   settings_.diamondVeinSize,
+			   settings_.maxDiamondY);
+	PlaceTrees(decorator, random);
+	PlaceGlowstone(decorator, random);
+}
+
+void NoiseGenerator::PlaceTrees(ChunkDecorator& decorator, FeatureRandom& random) const
+{
+	static constexpr std::array<DirectX::XMINT2, 4> branchDirections{{{1, 0}, {-1, 0}, {0, 1}, {0, -1}}};
+
+	const DirectX::XMINT3 origin = decorator.GetChunkOrigin();
+	for (std::uint32_t attempt = 0; attempt < settings_.treeAttempts; ++attempt)
+	{
+		const std::int32_t x = origin.x + random.Range(0, chunkSize - 1);
+		const std::int32_t z = origin.z + random.Range(0, chunkSize - 1);
+
+		// Highest grass block with air above it, both have to be inside the chunk to be readable
+		std::int32_t groundY = chunkSize - 2;
+		while (groundY >= 0
+			   && (decorator.GetBlockType({x, origin.y + groundY, z}) != BlockType::Grass
+				   || decorator.GetBlockType({x, origin.y + groundY + 1, z}) != BlockType::Air))
+		{
+			--groundY;
+		}
+
+		if (groundY < 0)
+		{
+			continue;
+		}
+
+		const std::int32_t height = random.Range(settings_.minTreeHeight, settings_.maxTreeHeight);
+		const std::int32_t bottom = origin.y + groundY + 1;
+		for (std::int32_t y = bottom; y < bottom + height; ++y)
+		{
+			decorator.SetBlock({x, y, z}, BlockType::Log);
+		}
+
+		const std::int32_t top = bottom + height - 1;
+		for (DirectX::XMINT2 direction : branchDirections)
+		{
+			const std::int32_t length = random.Range(0, 2);
+			for (std::int32_t step = 1; step <= length; ++step)
+			{
+				decorator.SetBlock({x + direction.x * step, top, z + direction.y * step}, BlockType::Log);
+			}
+		}
+	}
+}
+
+void NoiseGenerator::PlaceGlowstone(ChunkDecorator& decorator, FeatureRandom& random) const
+{
+	const DirectX::XMINT3 origin = decorator.GetChunkOrigin();
+	for (std::uint32_t attempt = 0; attempt < settings_.glowstoneAttempts; ++attempt)
+	{
+		const std::int32_t x = origin.x + random.Range(0, chunkSize - 1);
+		const std::int32_t z = origin.z + random.Range(0, chunkSize - 1);
+
+		// Cave ceilings only, stone doesn't make it up to the surface
+		std::int32_t y = chunkSize - 2;
+		while (y >= 0
+			   && (decorator.GetBlockType({x, origin.y + y, z}) != BlockType::Air
+				   || decorator.GetBlockType({x, origin.y + y + 1, z}) != BlockType::Stone))
+		{
+			--y;
+		}
+
+		if (y >= 0)
+		{
+			const DirectX::XMINT3 start{x, origin.y + y, z};
+			PlaceRandomWalk(decorator, random, start, BlockType::Glowstone, settings_.glowstoneClusterSize);
+		}
+	}
+}
+
+void NoiseGenerator::PlaceVeins(ChunkDecorator& decorator,
+								FeatureRandom&	random,
+								BlockType		type,
+								std::uint32_t	count,
+								std::uint32_t	size,
+								std::int32_t	maxY)
+{
+	const DirectX::XMINT3 origin = decorator.GetChunkOrigin();
+	if (origin.y > maxY)
+	{
+		return;
+	}
+
+	const std::int32_t topY = (std::min)(chunkSize - 1, maxY - origin.y);
+	for (std::uint32_t vein = 0; vein < count; ++vein)
+	{
+		const DirectX::XMINT3 start{origin.x + random.Range(0, chunkSize - 1),
+									origin.y + random.Range(0, topY),
+									origin.z + random.Range(0, chunkSize - 1)};
+
+		// Replacing stone only, veins starting in the air just end up smaller or not at all
+		PlaceRandomWalk(decorator, random, start, type, size);
+	}
+}
+
+void NoiseGenerator::PlaceRandomWalk(ChunkDecorator&	 decorator,
+									 FeatureRandom&	 random,
+									 DirectX::XMINT3 start,
+									 BlockType		 type,
+									 std::uint32_t	 length)
+{
+	static constexpr std::array<DirectX::XMINT3, 6> steps{{
+		{1, 0, 0},
+		{-1, 0, 0},
+		{0, 1, 0},
+		{0, -1, 0},
+		{0, 0, 1},
+		{0, 0, -1},
+	}};
+
+	DirectX::XMINT3 position = start;
+	for (std::uint32_t i = 0; i < length; ++i)
+	{
+		decorator.SetBlock(position, type);
+
+		const DirectX::XMINT3 step = steps[random.Next() % steps.size()];
+		position.x				  += step.x;
+		position.y				  += step.y;
+		position.z				  += step.z;
+	}
+}
+
+std::shared_ptr<const NoiseGenerator::ColumnData> NoiseGenerator::GetColumnData(DirectX::XMINT2 columnCoordinates)
+{
+	{
+		std::lock_guard<std::mutex> lock(columnCacheMutex_);
+		auto						it = columnCache_.find(columnCoordinates);
+		if (it != columnCache_.end())
+		{
+			return it->second;
+		}
+	}
+
+	// Two threads might end up generating the same column, they both get the same result anyway
+	std::shared_ptr<const ColumnData> column = GenerateColumnData(columnCoordinates);
+
+	std::lock_guard<std::mutex> lock(columnCacheMutex_);
+	auto [it, inserted] = columnCache_.try_emplace(columnCoordinates, column);
+	if (inserted)
+	{
+		columnCacheOrder_.push_back(columnCoordinates);
+		while (columnCacheOrder_.size() > settings_.columnCacheSize)
+		{
+			columnCache_.erase(columnCacheOrder_.front());
+			columnCacheOrder_.pop_front();
+		}
+	}
+
+	return column;
+}
+
+std::shared_ptr<const NoiseGenerator::ColumnData> NoiseGenerator::GenerateColumnData(
+	DirectX::XMINT2 columnCoordinates) const
+{
+	auto column		   = std::make_shared<ColumnData>();
+	column->maxSurface = std::numeric_limits<float>::lowest();
+
+	for (std::int32_t z = 0; z < chunkSize; ++z)
+	{
+		const std::span<float, Chunk::CHUNK_SIZE> row(&column->surface[z * chunkSize], Chunk::CHUNK_SIZE);
+		Math::Noise::Fractal2Row(columnCoordinates.x * chunkSize,
+								 columnCoordinates.y * chunkSize + z,
+								 settings_.heightNoise,
+								 row);
+
+		for (float& surface : row)
+		{
+			surface = settings_.baseHeight + settings_.heightAmplitude * surface;
+		}
+
+		const auto [rowMin, rowMax] = std::ranges::minmax(row);
+		column->rowMinSurface[z]	= rowMin;
+		column->rowMaxSurface[z]	= rowMax;
+		column->maxSurface			= (std::max)(column->maxSurface, rowMax);
+	}
+
+	return column;
+}
@@ -0,0 +1,96 @@
+﻿#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "../../Math/DirectXMathOperators.h"
+#include "../../Math/Noise.h"
+#include "../BlockType.h"
+#include "ChunkDecorator.h"
+#include "IChunkGenerator.h"
+
+/**
+ * Rolling terrain out of noise. A 2D heightmap gives the surface, 3D noise added on top of the height difference bends
+ * it into overhangs, a second 3D noise hollows out caves. Decoration adds trees, ore veins and glowstone clusters on
+ * cave ceilings. The same seed always gives the same world, no matter which thread generates what or in which order
+ */
+class NoiseGenerator : public IChunkGenerator
+{
+public:
+	struct Settings
+	{
+		// surface y = baseHeight + heightAmplitude * height noise
+		float						 baseHeight		 = 72.0f;
+		float						 heightAmplitude = 64.0f;
+		Math::Noise::FractalSettings heightNoise{0, 1.0f / 256.0f, 5, 2.0f, 0.5f};
+
+		// Blocks up to this far from the surface can get flipped between solid and air
+		float						 overhangStrength = 12.0f;
+		Math::Noise::FractalSettings overhangNoise{100, 1.0f / 48.0f, 3, 2.0f, 0.5f};
+
+		// Solid blocks where the cave noise goes over the threshold get hollowed out
+		float						 caveThreshold = 0.3f;
+		Math::Noise::FractalSettings caveNoise{200, 1.0f / 40.0f, 2, 2.0f, 0.5f};
+
+		std::int32_t dirtDepth		 = 3;	 // blocks of dirt under the grass
+		std::size_t	 columnCacheSize = 1024; // columns whose heightmap is kept around
+
+		// Decoration, attempts are per chunk. Features have to stay within one chunk of where they start
+		std::uint32_t decorationSeed	   = 300;
+		std::uint32_t treeAttempts		   = 3;
+		std::int32_t  minTreeHeight		   = 4;
+		std::int32_t  maxTreeHeight		   = 7;
+		std::uint32_t ironVeins			   = 6;
+		std::uint32_t ironVeinSize		   = 8;
+		std::uint32_t diamondVeins		   = 1;
+		std::uint32_t diamondVeinSize	   = 4;
+		std::int32_t  maxDiamondY		   = 40; // world-space
+		std::uint32_t glowstoneAttempts	   = 2;
+		std::uint32_t glowstoneClusterSize = 10;
+	};
+
+	/**
+	 * @param seed gets added to the seed of every noise in the settings
+	 */
+	NoiseGenerator(World* world, std::uint32_t seed, const Settings& settings);
+	void FillChunk(Chunk* chunk) override;
+	void DecorateChunk(ChunkDecorator& decorator) override;
+
+private:
+	struct ColumnData;
+	class FeatureRandom;
+
+	void PlaceTrees(ChunkDecorator& decorator, FeatureRandom& random) const;
+	void PlaceGlowstone(ChunkDecorator& decorator, FeatureRandom& random) const;
+
+	/**
+	 * @param maxY world-space, veins don't start above it
+	 */
+	static void PlaceVeins(ChunkDecorator& decorator,
+						   FeatureRandom&  random,
+						   BlockType	   type,
+						   std::uint32_t   count,
+						   std::uint32_t   size,
+						   std::int32_t	   maxY);
+
+	// Wanders off in random directions from the start, trying to place a block at every step
+	static void PlaceRandomWalk(ChunkDecorator&	decorator,
+								FeatureRandom&	random,
+								DirectX::XMINT3 start,
+								BlockType		type,
+								std::uint32_t	length);
+
+	// Every chunk of a column needs the same heightmap, so it's computed once and shared between them
+	[[nodiscard]] std::shared_ptr<const ColumnData> GetColumnData(DirectX::XMINT2 columnCoordinates);
+	[[nodiscard]] std::shared_ptr<const ColumnData> GenerateColumnData(DirectX::XMINT2 columnCoordinates) const;
+
+	Settings settings_;
+
+	// Evicted oldest first, a column's chunks all get generated around the same time
+	std::unordered_map<DirectX::XMINT2, std::shared_ptr<const ColumnData>, Math::XMINT2Hash> columnCache_;
+	std::deque<DirectX::XMINT2>																 columnCacheOrder_;
+	std::mutex																				 columnCacheMutex_;
+};
@@ -0,0 +1,197 @@
+﻿#include "ChunkSerialization.h"
+
+#include <array>
+#include <cassert>
+#include <memory>
+
+namespace
+{
+	constexpr std::uint8_t	formatVersion = 1;
+	constexpr std::size_t	blockCount	  = Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE;
+	constexpr std::uint32_t maxPalette	  = static_cast<std::uint32_t>(BlockType::MAX_BLOCKS_);
+
+	static_assert(maxPalette <= 256, "Block types and palette indices are stored as single bytes");
+
+	// LEB128, run lengths never need more than 2 bytes
+	void WriteVarint(std::uint32_t value, std::vector<std::uint8_t>& outData)
+	{
+		while (value >= 0x80)
+		{
+			outData.push_back(static_cast<std::uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+
+		outData.push_back(static_cast<std::uint8_t>(value));
+	}
+
+	bool ReadVarint(std::span<const std::uint8_t> data, std::size_t& cursor, std::uint32_t& outValue)
+	{
+		outValue = 0;
+		for (std::uint32_t shift = 0; shift < 32; shift += 7)
+		{
+			if (cursor >= data.size())
+			{
+				return false;
+			}
+
+			const std::uint8_t byte	 = data[cursor++];
+			outValue				|= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * Writes (value, run length) pairs for the whole chunk
+	 * @param getValue returns the byte to encode for the block at the given index
+	 */
+	template <typename GetValue>
+	void WriteRuns(GetValue&& getValue, std::vector<std::uint8_t>& outData)
+	{
+		std::size_t start = 0;
+		while (start < blockCount)
+		{
+			const std::uint8_t value = getValue(start);
+			std::size_t		   end	 = start + 1;
+			while (end < blockCount && getValue(end) == value)
+			{
+				++end;
+			}
+
+			outData.push_back(value);
+			WriteVarint(static_cast<std::uint32_t>(end - start), outData);
+			start = end;
+		}
+	}
+
+	/**
+	 * Reads runs until they cover the whole chunk
+	 * @param setValue gets called with the first index of the run, its length and the run's byte
+	 */
+	template <typename SetValue>
+	bool ReadRuns(std::span<const std::uint8_t> data, std::size_t& cursor, SetValue&& setValue)
+	{
+		std::size_t filled = 0;
+		while (filled < blockCount)
+		{
+			if (cursor >= data.size())
+			{
+				return false;
+			}
+
+			const std::uint8_t value = data[cursor++];
+			std::uint32_t	   length;
+			if (ReadVarint(data, cursor, length) == false || length == 0 || length > blockCount - filled)
+			{
+				return false;
+			}
+
+			if (setValue(filled, length, value) == false)
+			{
+				return false;
+			}
+
+			filled += length;
+		}
+
+		return true;
+	}
+} // namespace
+
+void ChunkSerialization::Serialize(const Chunk::BlockArray& blocks, std::vector<std::uint8_t>& outData)
+{
+	// Palette in order of first appearance
+	std::array<std::uint8_t, maxPalette> paletteIndices;
+	std::array<std::uint8_t, maxPalette> palette;
+	std::uint32_t						 paletteSize = 0;
+	paletteIndices.fill(UINT8_MAX);
+
+	for (const Block& block : blocks)
+	{
+		const auto type = static_cast<std::uint8_t>(block.type);
+		assert(type < maxPalette);
+		if (paletteIndices[type] == UINT8_MAX)
+		{
+			paletteIndices[type]   = static_cast<std::uint8_t>(paletteSize);
+			palette[paletteSize++] = type;
+		}
+	}
+
+	outData.push_back(formatVersion);
+	outData.push_back(static_cast<std::uint8_t>(paletteSize));
+	outData.insert(outData.end(), palette.begin(), palette.begin() + paletteSize);
+
+	WriteRuns([&](std::size_t i) { return paletteIndices[static_cast<std::size_t>(blocks[i].type)]; }, outData);
+	WriteRuns([&](std::size_t i) { return blocks[i].lightLevel; }, outData);
+}
+
+std::size_t ChunkSerialization::Deserialize(std::span<const std::uint8_t> data, Chunk& chunk)
+{
+	auto			  blocks = std::make_unique<Chunk::BlockArray>();
+	const std::size_t size	 = Deserialize(data, *blocks);
+	if (size != 0)
+	{
+		chunk.SetBlocks(*blocks);
+	}
+	return size;
+}
+
+std::size_t ChunkSerialization::Deserialize(std::span<const std::uint8_t> data, Chunk::BlockArray& outBlocks)
+{
+	std::size_t cursor = 0;
+	if (data.size() < 2 || data[cursor++] != formatVersion)
+	{
+		return 0;
+	}
+
+	const std::uint32_t paletteSize = data[cursor++];
+	if (paletteSize == 0 || paletteSize > maxPalette || data.size() - cursor < paletteSize)
+	{
+		return 0;
+	}
+
+	std::array<BlockType, maxPalette> palette;
+	for (std::uint32_t i = 0; i < paletteSize; ++i)
+	{
+		if (data[cursor] >= maxPalette)
+		{
+			return 0;
+		}
+
+		palette[i] = static_cast<BlockType>(data[cursor++]);
+	}
+
+	auto setTypes = [&](std::size_t first, std::uint32_t length, std::uint8_t paletteIndex)
+	{
+		if (paletteIndex >= paletteSize)
+		{
+			return false;
+		}
+
+		for (std::size_t i = first; i < first + length; ++i)
+		{
+			outBlocks[i].type = palette[paletteIndex];
+		}
+		return true;
+	};
+
+	auto setLightLevels = [&](std::size_t first, std::uint32_t length, std::uint8_t lightLevel)
+	{
+		for (std::size_t i = first; i < first + length; ++i)
+		{
+			outBlocks[i].lightLevel = lightLevel;
+		}
+		return true;
+	};
+
+	if (ReadRuns(data, cursor, setTypes) == false || ReadRuns(data, cursor, setLightLevels) == false)
+	{
+		return 0;
+	}
+
+	return cursor;
+}
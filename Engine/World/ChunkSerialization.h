@@ -0,0 +1,34 @@
+﻿#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Chunk.h"
+
+/**
+ * Compact binary form of a chunk's blocks. Block types go through a palette of the types the chunk actually uses and
+ * get run-length encoded along with the light levels, in the chunk's own block order. Terrain is mostly long runs
+ * of the same few types, so a chunk usually ends up at a few hundred bytes
+ */
+namespace ChunkSerialization
+{
+	/**
+	 * Appends the blocks' types and light levels to outData
+	 * @param blocks a whole chunk's worth, see Chunk::BlockArray
+	 */
+	void Serialize(const Chunk::BlockArray& blocks, std::vector<std::uint8_t>& outData);
+
+	/**
+	 * @param data starts with a serialized chunk, can go on past it
+	 * @param chunk gets all of its blocks overwritten, left untouched if the data turns out to be corrupt
+	 * @return bytes read, 0 if the data is corrupt
+	 */
+	std::size_t Deserialize(std::span<const std::uint8_t> data, Chunk& chunk);
+
+	/**
+	 * @param data starts with a serialized chunk, can go on past it
+	 * @param outBlocks partially overwritten if the data turns out to be corrupt
+	 * @return bytes read, 0 if the data is corrupt
+	 */
+	std::size_t Deserialize(std::span<const std::uint8_t> data, Chunk::BlockArray& outBlocks);
+} // namespace ChunkSerialization
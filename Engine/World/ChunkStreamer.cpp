@@ -0,0 +1,665 @@
+﻿#include "ChunkStreamer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <ranges>
+
+#include "../Core/Profiler.h"
+#include "../Utils/ChunkUtils.h"
+#include "BlockDatabase.h"
+#include "Chunk.h"
+#include "World.h"
+
+namespace
+{
+	// Calls function(neighbor) for every resident chunk out of the 26 surrounding the given one
+	template <typename Function>
+	void ForEachResidentNeighbor(World& world, DirectX::XMINT3 chunkCoordinates, Function&& function)
+	{
+		for (std::int32_t dz = -1; dz <= 1; ++dz)
+		{
+			for (std::int32_t dy = -1; dy <= 1; ++dy)
+			{
+				for (std::int32_t dx = -1; dx <= 1; ++dx)
+				{
+					if (dx == 0 && dy == 0 && dz == 0)
+					{
+						continue;
+					}
+
+					Chunk* neighbor = world.GetChunk(DirectX::XMINT3{chunkCoordinates.x + dx,
+																	 chunkCoordinates.y + dy,
+																	 chunkCoordinates.z + dz});
+					if (neighbor != nullptr)
+					{
+						function(neighbor);
+					}
+				}
+			}
+		}
+	}
+} // namespace
+
+ChunkStreamer::ChunkStreamer(World*							  world,
+							 std::unique_ptr<IChunkGenerator> generator,
+							 std::unique_ptr<WorldSaver>	  saver,
+							 const Settings&				  settings) :
+	world_(world),
+	generator_(std::move(generator)),
+	settings_(settings),
+	pipeline_(generator_.get(), settings.minChunkY, settings.maxChunkY, settings.generationThreads),
+	saver_(std::move(saver)),
+	centerColumn_(0, 0),
+	hasCenter_(false),
+	loadCursor_(0),
+	lastAutosave_(std::chrono::steady_clock::now()),
+	lastCompressionSweep_(std::chrono::steady_clock::now())
+{
+	assert(world_ != nullptr);
+	assert(settings_.unloadDistance > settings_.viewDistance);
+}
+
+void ChunkStreamer::Update(DirectX::FXMVECTOR viewerPosition)
+{
+	PROFILE_FUNCTION();
+	using namespace DirectX;
+	using Utils::Coordinates::GetChunkCoordinate;
+
+	XMFLOAT3 position;
+	XMStoreFloat3(&position, viewerPosition);
+
+	const XMINT2 center{GetChunkCoordinate<Chunk::CHUNK_SIZE>(position.x),
+						GetChunkCoordinate<Chunk::CHUNK_SIZE>(position.z)};
+
+	if (hasCenter_ == false || center != centerColumn_)
+	{
+		centerColumn_ = center;
+		hasCenter_	  = true;
+		RebuildLoadOrder();
+		UnloadDistantColumns();
+	}
+
+	const std::int32_t viewDistanceSq = settings_.viewDistance * settings_.viewDistance;
+	std::erase_if(pendingUnloads_,
+				  [&](XMINT2 columnCoordinates)
+				  {
+					  if (UnloadColumn(columnCoordinates) == false)
+					  {
+						  return false;
+					  }
+
+					  // The viewer came back while the column was on its way out, it has to be requested again
+					  if (GetDistanceSq(columnCoordinates) <= viewDistanceSq)
+					  {
+						  loadCursor_ = 0;
+					  }
+					  return true;
+				  });
+
+	std::vector<ChunkGenerationPipeline::FinishedColumn> finishedColumns;
+	pipeline_.Update(finishedColumns);
+	for (auto& column : finishedColumns)
+	{
+		AddColumn(column);
+	}
+
+	const std::size_t columnHeight = settings_.maxChunkY - settings_.minChunkY + 1;
+	std::size_t		  columnLoads  = 0;
+	while (loadCursor_ < loadOrder_.size() && pipeline_.GetRunningJobCount() < settings_.maxRunningJobs)
+	{
+		const XMINT2 columnCoordinates = loadOrder_[loadCursor_];
+		if (storedColumns_.contains(columnCoordinates))
+		{
+			++loadCursor_;
+			continue;
+		}
+
+		if (pipeline_.Contains(columnCoordinates) == false)
+		{
+			const std::size_t residentChunks = world_->chunks_.size() + pipeline_.GetChunkCount();
+			if (residentChunks + columnHeight > settings_.maxResidentChunks && EvictFurthestColumn() == false)
+			{
+				break;
+			}
+		}
+
+		// Columns the pipeline only knows as a dependency are still worth loading, they haven't been handed off
+		if (saver_ != nullptr && pipeline_.IsRequested(columnCoordinates) == false)
+		{
+			if (columnLoads == settings_.maxColumnLoads)
+			{
+				break;
+			}
+
+			const WorldSaver::LoadResult result = LoadColumn(columnCoordinates);
+			if (result == WorldSaver::LoadResult::Busy)
+			{
+				break;
+			}
+
+			if (result == WorldSaver::LoadResult::Loaded)
+			{
+				++columnLoads;
+				++loadCursor_;
+				continue;
+			}
+		}
+
+		pipeline_.Request(columnCoordinates);
+		++loadCursor_;
+	}
+
+	UpdateAutosave();
+	UpdateCompression();
+
+	stats_.residentChunks = world_->chunks_.size();
+}
+
+void ChunkStreamer::RebuildLoadOrder()
+{
+	loadOrder_.clear();
+	loadCursor_ = 0;
+
+	const std::int32_t radius	= settings_.viewDistance;
+	const std::int32_t radiusSq = radius * radius;
+	for (std::int32_t dz = -radius; dz <= radius; ++dz)
+	{
+		for (std::int32_t dx = -radius; dx <= radius; ++dx)
+		{
+			if (dx * dx + dz * dz <= radiusSq)
+			{
+				loadOrder_.emplace_back(centerColumn_.x + dx, centerColumn_.y + dz);
+			}
+		}
+	}
+
+	std::ranges::sort(loadOrder_,
+					  {},
+					  [this](DirectX::XMINT2 columnCoordinates) { return GetDistanceSq(columnCoordinates); });
+}
+
+void ChunkStreamer::UnloadDistantColumns()
+{
+	// Handed off columns stay known to the pipeline, so it sees everything that's resident
+	const std::int32_t unloadDistanceSq = settings_.unloadDistance * settings_.unloadDistance;
+	for (DirectX::XMINT2 columnCoordinates : GetResidentColumns())
+	{
+		if (GetDistanceSq(columnCoordinates) > unloadDistanceSq
+			&& std::ranges::find(pendingUnloads_, columnCoordinates) == pendingUnloads_.end())
+		{
+			pendingUnloads_.push_back(columnCoordinates);
+		}
+	}
+}
+
+bool ChunkStreamer::EvictFurthestColumn()
+{
+	bool			found			   = false;
+	DirectX::XMINT2 furthest		   = {};
+	std::int32_t	furthestDistanceSq = settings_.viewDistance * settings_.viewDistance;
+
+	for (DirectX::XMINT2 columnCoordinates : GetResidentColumns())
+	{
+		const std::int32_t distanceSq = GetDistanceSq(columnCoordinates);
+		if (distanceSq > furthestDistanceSq
+			&& std::ranges::find(pendingUnloads_, columnCoordinates) == pendingUnloads_.end())
+		{
+			found			   = true;
+			furthest		   = columnCoordinates;
+			furthestDistanceSq = distanceSq;
+		}
+	}
+
+	if (found == false)
+	{
+		return false;
+	}
+
+	if (UnloadColumn(furthest) == false)
+	{
+		pendingUnloads_.push_back(furthest);
+	}
+	return true;
+}
+
+void ChunkStreamer::AddColumn(ChunkGenerationPipeline::FinishedColumn& column)
+{
+	for (std::unique_ptr<Chunk>& generatedChunk : column.chunks)
+	{
+		Chunk* chunk = world_->AddChunk(std::move(generatedChunk));
+		++stats_.loadedChunks;
+
+		// Meshing a chunk before all of its neighbors are in would only get thrown away once they arrive, so every
+		// chunk gets meshed once, when the last of its neighbors shows up
+		ForEachResidentNeighbor(*world_,
+								chunk->GetChunkWorldPos(),
+								[&](Chunk* neighbor)
+								{
+									chunk->OnNeighborLoaded();
+									neighbor->OnNeighborLoaded();
+									MarkDirtyIfSurrounded(neighbor);
+								});
+		MarkDirtyIfSurrounded(chunk);
+	}
+
+	// Point lights go away with their chunks, so a column coming back needs its lights back as well
+	const BlockDatabase& database = BlockDatabase::GetDatabase();
+	for (const LightNode& emissiveBlock : column.blockLightSeeds)
+	{
+		const BlockData* blockData = database.GetBlockData(world_->GetBlock(emissiveBlock.position).type);
+		assert(blockData != nullptr && blockData->lightEmissionLevel > 0);
+		world_->lightEngine_.AddBlockLight(emissiveBlock.position, *blockData);
+	}
+
+	if (storedColumns_.contains(column.columnCoordinates))
+	{
+		ClearUnsupportedBorderLight(column.columnCoordinates);
+	}
+
+	GatherBorderLightSeeds(column);
+	if (column.blockLightSeeds.empty() == false)
+	{
+		world_->lightEngine_.PropagateBulk(column.blockLightSeeds, true);
+	}
+	if (column.skyLightSeeds.empty() == false)
+	{
+		world_->lightEngine_.PropagateBulk(column.skyLightSeeds, false);
+	}
+}
+
+void ChunkStreamer::ClearUnsupportedBorderLight(DirectX::XMINT2 columnCoordinates)
+{
+	PROFILE_FUNCTION();
+	using namespace DirectX;
+	static constexpr auto		  chunkSize = static_cast<std::int32_t>(Chunk::CHUNK_SIZE);
+	static constexpr std::int32_t last		= chunkSize - 1;
+	static constexpr XMINT3		  offsets[] = {{0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 0, -1}};
+	const BlockDatabase&		  database	= BlockDatabase::GetDatabase();
+
+	std::vector<LightNode> blockLightDarkness;
+	std::vector<LightNode> skyLightDarkness;
+	for (std::int32_t chunkY = settings_.minChunkY; chunkY <= settings_.maxChunkY; ++chunkY)
+	{
+		const XMINT3 chunkCoordinates{columnCoordinates.x, chunkY, columnCoordinates.y};
+		const Chunk* chunk = world_->GetChunk(chunkCoordinates);
+		if (chunk == nullptr)
+		{
+			continue;
+		}
+
+		for (std::int32_t y = 0; y < chunkSize; ++y)
+		{
+			for (std::int32_t z = 0; z < chunkSize; ++z)
+			{
+				for (std::int32_t x = 0; x < chunkSize; ++x)
+				{
+					if (x != 0 && x != last && z != 0 && z != last)
+					{
+						continue;
+					}
+
+					// Full sky light only ever comes straight down the column itself
+					const Block		   block		 = chunk->GetBlock(x, y, z);
+					const std::int32_t blockLight	 = block.GetBlockLightLevel();
+					const std::int32_t skyLight		 = block.GetSkyLightLevel();
+					const std::int32_t lightEmission = database.GetLightEmission(block.type);
+					if (blockLight <= lightEmission && (skyLight == 0 || skyLight == 15))
+					{
+						continue;
+					}
+
+					// The brightest each light type could be, going by the blocks around. Missing chunks give none
+					const XMINT3 position{chunkCoordinates.x * chunkSize + x,
+										  chunkY * chunkSize + y,
+										  chunkCoordinates.z * chunkSize + z};
+					std::int32_t supportedBlockLight = lightEmission;
+					std::int32_t supportedSkyLight	 = 0;
+					for (const XMINT3& offset : offsets)
+					{
+						const Block neighbor = world_->GetBlock(
+							XMINT3{position.x + offset.x, position.y + offset.y, position.z + offset.z});
+						if (neighbor.type == BlockType::INVALID_)
+						{
+							continue;
+						}
+
+						const std::int32_t neighborSkyLight = neighbor.GetSkyLightLevel();
+						supportedBlockLight = (std::max)(supportedBlockLight, neighbor.GetBlockLightLevel() - 1);
+						supportedSkyLight	= (std::max)(supportedSkyLight,
+														 offset.y == 1 ? neighborSkyLight : neighborSkyLight - 1);
+					}
+
+					if (blockLight > supportedBlockLight)
+					{
+						blockLightDarkness.emplace_back(position, static_cast<std::uint8_t>(blockLight));
+					}
+					if (skyLight < 15 && skyLight > supportedSkyLight)
+					{
+						skyLightDarkness.emplace_back(position, static_cast<std::uint8_t>(skyLight));
+					}
+				}
+			}
+		}
+	}
+
+	if (blockLightDarkness.empty() == false || skyLightDarkness.empty() == false)
+	{
+		world_->lightEngine_.RemoveLight(blockLightDarkness, skyLightDarkness);
+	}
+}
+
+void ChunkStreamer::GatherBorderLightSeeds(ChunkGenerationPipeline::FinishedColumn& column) const
+{
+	using namespace DirectX;
+	static constexpr auto		  chunkSize = static_cast<std::int32_t>(Chunk::CHUNK_SIZE);
+	static constexpr std::int32_t last		= chunkSize - 1;
+	const BlockDatabase&		  database	= BlockDatabase::GetDatabase();
+
+	// x and z offsets of the neighbor columns sharing a side with this one
+	static constexpr XMINT2 sides[] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+	// A difference of one is what the propagation would have left there anyway
+	auto TrySeed = [&](std::vector<LightNode>& seeds, XMINT3 from, std::uint8_t fromLevel, Block to, bool isBlockLight)
+	{
+		const std::uint8_t toLevel = isBlockLight ? to.GetBlockLightLevel() : to.GetSkyLightLevel();
+		if (fromLevel > toLevel + 1 && database.IsOpaque(to.type) == false)
+		{
+			seeds.emplace_back(from, fromLevel);
+		}
+	};
+
+	for (std::int32_t chunkY = settings_.minChunkY; chunkY <= settings_.maxChunkY; ++chunkY)
+	{
+		const XMINT3 chunkCoordinates{column.columnCoordinates.x, chunkY, column.columnCoordinates.y};
+		const Chunk* chunk = world_->GetChunk(chunkCoordinates);
+		if (chunk == nullptr)
+		{
+			continue;
+		}
+
+		for (const XMINT2 side : sides)
+		{
+			const Chunk* neighbor = world_->GetChunk(
+				XMINT3{chunkCoordinates.x + side.x, chunkY, chunkCoordinates.z + side.y});
+			if (neighbor == nullptr)
+			{
+				continue;
+			}
+
+			for (std::int32_t y = 0; y < chunkSize; ++y)
+			{
+				for (std::int32_t i = 0; i < chunkSize; ++i)
+				{
+					// The block on the column's side and the one across from it, on the neighbor's opposite side
+					const std::int32_t x	   = side.x == 0 ? i : (side.x < 0 ? 0 : last);
+					const std::int32_t z	   = side.y == 0 ? i : (side.y < 0 ? 0 : last);
+					const Block		   inside  = chunk->GetBlock(x, y, z);
+					const Block		   outside = neighbor->GetBlock(side.x == 0 ? x : last - x,
+																	y,
+																	side.y == 0 ? z : last - z);
+
+					const XMINT3 insidePosition{chunkCoordinates.x * chunkSize + x,
+												chunkY * chunkSize + y,
+												chunkCoordinates.z * chunkSize + z};
+					const XMINT3 outsidePosition{insidePosition.x + side.x,
+												 insidePosition.y,
+												 insidePosition.z + side.y};
+
+					TrySeed(column.blockLightSeeds, insidePosition, inside.GetBlockLightLevel(), outside, true);
+					TrySeed(column.blockLightSeeds, outsidePosition, outside.GetBlockLightLevel(), inside, true);
+					TrySeed(column.skyLightSeeds, insidePosition, inside.GetSkyLightLevel(), outside, false);
+					TrySeed(column.skyLightSeeds, outsidePosition, outside.GetSkyLightLevel(), inside, false);
+				}
+			}
+		}
+	}
+}
+
+WorldSaver::LoadResult ChunkStreamer::LoadColumn(DirectX::XMINT2 columnCoordinates)
+{
+	static constexpr auto chunkSize = static_cast<std::int32_t>(Chunk::CHUNK_SIZE);
+	const BlockDatabase&  database	= BlockDatabase::GetDatabase();
+
+	ChunkGenerationPipeline::FinishedColumn column{columnCoordinates};
+	const WorldSaver::LoadResult			result = saver_->TryLoadColumn(columnCoordinates, column.chunks);
+	if (result != WorldSaver::LoadResult::Loaded)
+	{
+		return result;
+	}
+
+	// The stored light levels already include these, but the neighbors around the column might be new
+	for (const std::unique_ptr<Chunk>& chunk : column.chunks)
+	{
+		chunk->MarkSaved();
+
+		const DirectX::XMINT3 chunkCoordinates = chunk->GetChunkWorldPos();
+		for (std::int32_t y = 0; y < chunkSize; ++y)
+		{
+			for (std::int32_t z = 0; z < chunkSize; ++z)
+			{
+				for (std::int32_t x = 0; x < chunkSize; ++x)
+				{
+					const std::uint8_t lightEmission = database.GetLightEmission(chunk->GetBlock(x, y, z).type);
+					if (lightEmission > 0)
+					{
+						column.blockLightSeeds.emplace_back(chunkCoordinates.x * chunkSize + x,
+															chunkCoordinates.y * chunkSize + y,
+															chunkCoordinates.z * chunkSize + z,
+															lightEmission);
+					}
+				}
+			}
+		}
+	}
+
+	storedColumns_.insert(columnCoordinates);
+	AddColumn(column);
+	return result;
+}
+
+void ChunkStreamer::SaveColumn(DirectX::XMINT2 columnCoordinates)
+{
+	WorldSaver::ColumnSnapshot snapshot{columnCoordinates};
+	bool					   hasChanges = false;
+	for (std::int32_t y = settings_.minChunkY; y <= settings_.maxChunkY; ++y)
+	{
+		Chunk* chunk = world_->GetChunk(DirectX::XMINT3{columnCoordinates.x, y, columnCoordinates.y});
+		if (chunk == nullptr)
+		{
+			continue;
+		}
+
+		// Unchanged chunks go along too, a column is always stored as a whole
+		hasChanges = hasChanges || chunk->HasUnsavedChanges();
+		snapshot.chunks.push_back({y, chunk->GetBlocksSnapshot()});
+		chunk->MarkSaved();
+	}
+
+	if (hasChanges)
+	{
+		saver_->Save(std::move(snapshot));
+		++stats_.savedColumns;
+	}
+}
+
+void ChunkStreamer::UpdateAutosave()
+{
+	if (saver_ == nullptr)
+	{
+		return;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	if (autosaveColumns_.empty() && now - lastAutosave_ >= std::chrono::seconds(settings_.autosaveInterval))
+	{
+		autosaveColumns_ = GetResidentColumns();
+		lastAutosave_	 = now;
+	}
+
+	// Snapshots are cheap, but thousands of columns worth of lookups still add up, so they're spread over updates
+	for (std::size_t i = 0; i < settings_.autosaveColumns && autosaveColumns_.empty() == false; ++i)
+	{
+		SaveColumn(autosaveColumns_.back());
+		autosaveColumns_.pop_back();
+	}
+}
+
+void ChunkStreamer::UpdateCompression()
+{
+	using namespace std::chrono;
+
+	const auto now = steady_clock::now();
+	if (now - lastCompressionSweep_ >= COMPRESSION_SWEEP_INTERVAL)
+	{
+		const float elapsedTime = duration<float>(now - lastCompressionSweep_).count();
+		lastCompressionSweep_	= now;
+
+		struct Candidate
+		{
+			DirectX::XMINT3 chunkCoordinates;
+			float			idleTime;
+		};
+
+		std::vector<Candidate> candidates;
+		std::size_t			   uncompressedBytes = 0;
+		stats_.compressedChunks					 = 0;
+		stats_.compressedBytes					 = 0;
+		for (const auto& [chunkCoordinates, chunk] : world_->chunks_)
+		{
+			const Chunk::CompressionActivity activity  = chunk->UpdateCompressionActivity(elapsedTime);
+			stats_.compressionMisses				  += activity.decompressions;
+			stats_.decompressionNanos				  += activity.decompressNanos;
+			if (chunk->IsCompressed())
+			{
+				++stats_.compressedChunks;
+				stats_.compressedBytes += chunk->GetCompressedSize();
+				continue;
+			}
+
+			if (activity.accessed && activity.decompressions == 0)
+			{
+				++stats_.compressionHits;
+			}
+
+			uncompressedBytes += sizeof(Chunk::BlockArray);
+			candidates.push_back({chunkCoordinates, activity.idleTime});
+		}
+
+		// Past the budget the least recently used chunks go as well, idle or not
+		std::ranges::sort(candidates, std::ranges::greater{}, &Candidate::idleTime);
+		std::size_t compressionCount = 0;
+		if (uncompressedBytes > settings_.maxUncompressedBytes)
+		{
+			const std::size_t excessBytes = uncompressedBytes - settings_.maxUncompressedBytes;
+			compressionCount			  = (excessBytes + sizeof(Chunk::BlockArray) - 1) / sizeof(Chunk::BlockArray);
+		}
+
+		while (compressionCount < candidates.size() &&
+			   candidates[compressionCount].idleTime >= static_cast<float>(settings_.compressionIdleTime))
+		{
+			++compressionCount;
+		}
+
+		compressionQueue_.clear();
+		for (std::size_t i = compressionCount; i > 0; --i)
+		{
+			compressionQueue_.push_back(candidates[i - 1].chunkCoordinates);
+		}
+	}
+
+	// Some of the picked chunks might have been unloaded since the sweep, those just get skipped
+	for (std::size_t i = 0; i < settings_.maxCompressions && compressionQueue_.empty() == false; ++i)
+	{
+		Chunk* chunk = world_->GetChunk(compressionQueue_.back());
+		compressionQueue_.pop_back();
+		if (chunk != nullptr && chunk->Compress())
+		{
+			++stats_.compressedChunks;
+			stats_.compressedBytes += chunk->GetCompressedSize();
+		}
+	}
+}
+
+bool ChunkStreamer::UnloadColumn(DirectX::XMINT2 columnCoordinates)
+{
+	// Half a column can't be saved, so either all of it goes or none of it
+	std::vector<const Chunk*> chunks;
+	for (std::int32_t y = settings_.minChunkY; y <= settings_.maxChunkY; ++y)
+	{
+		const Chunk* chunk = world_->GetChunk(DirectX::XMINT3{columnCoordinates.x, y, columnCoordinates.y});
+		if (chunk == nullptr)
+		{
+			continue;
+		}
+
+		if (chunk->IsMeshPending())
+		{
+			return false;
+		}
+		chunks.push_back(chunk);
+	}
+
+	// Only takes a snapshot, the chunks can go right away
+	if (saver_ != nullptr && chunks.empty() == false)
+	{
+		SaveColumn(columnCoordinates);
+	}
+
+	for (const Chunk* chunk : chunks)
+	{
+		const DirectX::XMINT3 chunkCoordinates = chunk->GetChunkWorldPos();
+		world_->UnloadChunk(chunkCoordinates);
+
+		++stats_.unloadedChunks;
+		ForEachResidentNeighbor(*world_, chunkCoordinates, [](Chunk* neighbor) { neighbor->OnNeighborUnloaded(); });
+	}
+
+	storedColumns_.erase(columnCoordinates);
+	return pipeline_.Discard(columnCoordinates);
+}
+
+void ChunkStreamer::SaveAll()
+{
+	if (saver_ == nullptr)
+	{
+		return;
+	}
+
+	// A column listed twice is fine, the second save finds nothing changed
+	for (DirectX::XMINT2 columnCoordinates : GetResidentColumns())
+	{
+		SaveColumn(columnCoordinates);
+	}
+
+	autosaveColumns_.clear();
+	saver_->Flush();
+}
+
+void ChunkStreamer::MarkDirtyIfSurrounded(Chunk* chunk)
+{
+	// Neighbors above and below the streamed range never get loaded
+	const std::int32_t chunkY		 = chunk->GetChunkWorldPos().y;
+	std::uint32_t	   neighborCount = 26;
+	neighborCount					-= chunkY == settings_.minChunkY ? 9 : 0;
+	neighborCount					-= chunkY == settings_.maxChunkY ? 9 : 0;
+
+	if (chunk->GetLoadedNeighborCount() == neighborCount)
+	{
+		world_->MarkChunkDirty(chunk);
+	}
+}
+
+std::vector<DirectX::XMINT2> ChunkStreamer::GetResidentColumns() const
+{
+	std::vector<DirectX::XMINT2> columns = pipeline_.GetColumns();
+	columns.insert(columns.end(), storedColumns_.begin(), storedColumns_.end());
+	return columns;
+}
+
+std::int32_t ChunkStreamer::GetDistanceSq(DirectX::XMINT2 columnCoordinates) const
+{
+	const std::int32_t dx = columnCoordinates.x - centerColumn_.x;
+	const std::int32_t dz = columnCoordinates.y - centerColumn_.y;
+	return dx * dx + dz * dz;
+}
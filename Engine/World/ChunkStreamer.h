@@ -0,0 +1,174 @@
+﻿#pragma once
+#include <DirectXMath.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "../Math/DirectXMathOperators.h"
+#include "BlockType.h"
+#include "ChunkGenerationPipeline.h"
+#include "ChunkGenerators/IChunkGenerator.h"
+#include "WorldSaver.h"
+
+class Chunk;
+class World;
+
+/**
+ * Keeps the chunk columns around the viewer resident. Missing columns get loaded from the storage or queued for
+ * generation nearest first, and columns past the unload distance get saved and dropped. The gap between the view and
+ * unload distances keeps columns from getting loaded and unloaded over and over when the viewer moves back and forth
+ * over a chunk border. Changed columns also get autosaved periodically, a few of them per update. Saving only takes
+ * block snapshots here, the writing happens on the saver's thread
+ */
+class ChunkStreamer
+{
+public:
+	struct Settings
+	{
+		std::int32_t  viewDistance		   = 8;			// horizontal radius in chunks, everything inside gets loaded
+		std::int32_t  unloadDistance	   = 10;		// horizontal radius in chunks, everything outside gets unloaded
+		std::int32_t  minChunkY			   = 0;			// inclusive
+		std::int32_t  maxChunkY			   = 15;		// inclusive
+		std::size_t	  maxResidentChunks	   = 8192;		// hard cap, distant columns get evicted early to stay under it
+		std::size_t	  maxRunningJobs	   = 256;		// generation jobs in flight, keeps the load order responsive
+		std::size_t	  maxColumnLoads	   = 8;			// columns read from the storage per update, on the main thread
+		std::uint32_t autosaveInterval	   = 30;		// seconds from the start of one autosave to the next
+		std::size_t	  autosaveColumns	   = 64;		// resident columns an autosave snapshots per update
+		std::uint32_t compressionIdleTime  = 20;		// seconds a chunk has to go untouched before it gets compressed
+		std::size_t	  maxUncompressedBytes = 256 << 20; // least recently used chunks get compressed early past it
+		std::size_t	  maxCompressions	   = 16;		// chunks compressed per update, on the main thread
+		std::uint32_t generationThreads	   = (std::max)(std::thread::hardware_concurrency() / 2, 1u);
+	};
+
+	struct Stats
+	{
+		std::size_t	  residentChunks	 = 0;
+		std::uint64_t loadedChunks		 = 0; // total since creation
+		std::uint64_t unloadedChunks	 = 0; // total since creation
+		std::uint64_t savedColumns		 = 0; // snapshots handed to the saver, total since creation
+		std::size_t	  compressedChunks	 = 0;
+		std::size_t	  compressedBytes	 = 0; // in use by the compressed chunks
+		std::uint64_t compressionHits	 = 0; // chunks found accessed while uncompressed, once per sweep, total
+		std::uint64_t compressionMisses	 = 0; // decompressions, total since creation
+		std::uint64_t decompressionNanos = 0; // total since creation
+	};
+
+	ChunkStreamer() = delete;
+
+	/**
+	 * @param saver null if columns should only ever get generated and never saved
+	 */
+	ChunkStreamer(World*						   world,
+				  std::unique_ptr<IChunkGenerator> generator,
+				  std::unique_ptr<WorldSaver>	   saver,
+				  const Settings&				   settings);
+
+	/**
+	 * @param viewerPosition world-space position the load rings are centered on
+	 */
+	void Update(DirectX::FXMVECTOR viewerPosition);
+
+	/**
+	 * Saves every changed resident column without unloading anything and waits until they're written
+	 */
+	void SaveAll();
+
+	/**
+	 * Marks the chunk dirty, but only once all of its neighbors inside the streamed range are loaded. Until then
+	 * its mesh would miss their blocks and get thrown away when they arrive
+	 */
+	void MarkDirtyIfSurrounded(Chunk* chunk);
+
+private:
+	// Chunks only get looked at this often, so their idle times are only ever this accurate
+	static constexpr std::chrono::seconds COMPRESSION_SWEEP_INTERVAL{1};
+
+	// Column coordinates sorted by distance to the center column, which makes the rings
+	void RebuildLoadOrder();
+	void UnloadDistantColumns();
+
+	/**
+	 * Unloads the column furthest from the center, as long as it lies outside the view distance
+	 * @return false if there was nothing to evict
+	 */
+	bool EvictFurthestColumn();
+
+	// Moves a generated column into the world
+	void AddColumn(ChunkGenerationPipeline::FinishedColumn& column);
+
+	/**
+	 * Light stored with a column can have come in from a neighbor that got darker while the column was away. Blocks
+	 * along the column's sides whose light neither their own emission and sky nor any of their neighbors can account
+	 * for go dark, along with the light that spread from them, before the border seeds get gathered. Generated columns
+	 * don't need it, their light only ever comes from themselves
+	 */
+	void ClearUnsupportedBorderLight(DirectX::XMINT2 columnCoordinates);
+
+	/**
+	 * Adds the blocks on both sides of the column's borders that are brighter than the block across from them to the
+	 * column's seeds, so that light flows into the column from its neighbors and out of it into them. Call once the
+	 * column's chunks are in the world
+	 */
+	void GatherBorderLightSeeds(ChunkGenerationPipeline::FinishedColumn& column) const;
+
+	/**
+	 * Reads the column from the storage and moves it into the world
+	 * @return Busy if the storage can't be read right now, nothing changed in that case
+	 */
+	WorldSaver::LoadResult LoadColumn(DirectX::XMINT2 columnCoordinates);
+
+	// Hands a snapshot of the column to the saver, if any of its chunks changed since the last one
+	void SaveColumn(DirectX::XMINT2 columnCoordinates);
+
+	// Snapshots the next few columns of the running autosave, starts a new one once it's time
+	void UpdateAutosave();
+
+	// Compresses the next few idle chunks, looks for more of them once it's time for a sweep
+	void UpdateCompression();
+
+	/**
+	 * Saves the column, then unloads it
+	 * @return false if some of the column's chunks are still being meshed or generated. The column stays untouched if
+	 * it's the meshing, if it's the generation the chunks are gone already
+	 */
+	[[nodiscard]] bool UnloadColumn(DirectX::XMINT2 columnCoordinates);
+
+	// Columns known to the pipeline and the ones loaded from the storage, can contain duplicates
+	[[nodiscard]] std::vector<DirectX::XMINT2> GetResidentColumns() const;
+	[[nodiscard]] std::int32_t				   GetDistanceSq(DirectX::XMINT2 columnCoordinates) const;
+
+	World*							 world_;
+	std::unique_ptr<IChunkGenerator> generator_;
+	Settings						 settings_;
+	Stats							 stats_;
+	ChunkGenerationPipeline			 pipeline_; // declared after the generator, its workers get joined first
+	std::unique_ptr<WorldSaver>		 saver_;	// null if nothing gets saved
+
+	// Columns that came from the storage, the pipeline never saw them
+	std::unordered_set<DirectX::XMINT2, Math::XMINT2Hash> storedColumns_;
+
+	DirectX::XMINT2				 centerColumn_;
+	bool						 hasCenter_;
+	std::vector<DirectX::XMINT2> loadOrder_;
+	std::size_t					 loadCursor_; // everything in front of it has been requested already
+
+	// Once started, an unload goes through even if the viewer comes back, otherwise half a column could stay behind
+	std::vector<DirectX::XMINT2> pendingUnloads_;
+
+	std::vector<DirectX::XMINT2>		  autosaveColumns_; // the running autosave hasn't gotten to these yet
+	std::chrono::steady_clock::time_point lastAutosave_;
+
+	std::vector<DirectX::XMINT3>		  compressionQueue_; // chunks the last sweep picked, most idle last
+	std::chrono::steady_clock::time_point lastCompressionSweep_;
+
+public:
+	// Getters
+	[[nodiscard]] const Settings& GetSettings() const { return settings_; }
+	[[nodiscard]] const Stats&	  GetStats() const { return stats_; }
+	[[nodiscard]] WorldSaver*	  GetSaver() const { return saver_.get(); }
+};
@@ -0,0 +1,78 @@
+﻿#include "EditBatch.h"
+
+#include <cmath>
+
+void EditBatch::SetBlock(DirectX::XMINT3 position, BlockType type)
+{
+	edits_.emplace_back(position, type);
+}
+
+void EditBatch::FillBox(DirectX::XMINT3 min, DirectX::XMINT3 max, BlockType type)
+{
+	if (min.x > max.x || min.y > max.y || min.z > max.z)
+	{
+		return;
+	}
+
+	const auto sizeX = static_cast<std::size_t>(max.x - min.x + 1);
+	const auto sizeY = static_cast<std::size_t>(max.y - min.y + 1);
+	const auto sizeZ = static_cast<std::size_t>(max.z - min.z + 1);
+	edits_.reserve(edits_.size() + sizeX * sizeY * sizeZ);
+
+	for (std::int32_t z = min.z; z <= max.z; ++z)
+	{
+		for (std::int32_t y = min.y; y <= max.y; ++y)
+		{
+			for (std::int32_t x = min.x; x <= max.x; ++x)
+			{
+				edits_.emplace_back(DirectX::XMINT3{x, y, z}, type);
+			}
+		}
+	}
+}
+
+void EditBatch::FillSphere(DirectX::XMINT3 center, float radius, BlockType type)
+{
+	if (radius < 0.0f)
+	{
+		return;
+	}
+
+	const auto	reach		  = static_cast<std::int32_t>(std::floor(radius));
+	const float radiusSquared = radius * radius;
+
+	for (std::int32_t dz = -reach; dz <= reach; ++dz)
+	{
+		for (std::int32_t dy = -reach; dy <= reach; ++dy)
+		{
+			for (std::int32_t dx = -reach; dx <= reach; ++dx)
+			{
+				if (static_cast<float>(dx * dx + dy * dy + dz * dz) <= radiusSquared)
+				{
+					edits_.emplace_back(DirectX::XMINT3{center.x + dx, center.y + dy, center.z + dz}, type);
+				}
+			}
+		}
+	}
+}
+
+void EditBatch::Paste(const BlockClipboard& clipboard, DirectX::XMINT3 origin, bool pasteAir)
+{
+	std::size_t index = 0;
+	for (std::int32_t z = 0; z < clipboard.size.z; ++z)
+	{
+		for (std::int32_t y = 0; y < clipboard.size.y; ++y)
+		{
+			for (std::int32_t x = 0; x < clipboard.size.x; ++x, ++index)
+			{
+				const BlockType type = clipboard.types[index];
+				if (type == BlockType::INVALID_ || (type == BlockType::Air && pasteAir == false))
+				{
+					continue;
+				}
+
+				edits_.emplace_back(DirectX::XMINT3{origin.x + x, origin.y + y, origin.z + z}, type);
+			}
+		}
+	}
+}
@@ -0,0 +1,59 @@
+﻿#pragma once
+#include <DirectXMath.h>
+#include <cstddef>
+#include <vector>
+
+#include "BlockType.h"
+#include "ChunkGenerators/ChunkDecorator.h"
+
+// Block types of a box copied out of the world, see World::CopyBlocks
+struct BlockClipboard
+{
+	DirectX::XMINT3		   size{0, 0, 0};
+	std::vector<BlockType> types; // x + y * size.x + z * size.x * size.y, INVALID_ where no chunk was loaded
+};
+
+/**
+ * Block edits collected up front so that World::ApplyEditBatch can write them chunk by chunk and update the lighting
+ * and the meshes once for the whole batch, instead of once per block like World::SetBlock does. Edits to the same
+ * position override each other in the order they were added
+ */
+class EditBatch
+{
+public:
+	EditBatch() = default;
+
+	/**
+	 * @param position world-space
+	 */
+	void SetBlock(DirectX::XMINT3 position, BlockType type);
+
+	/**
+	 * @param min world-space corner of the box, inclusive
+	 * @param max world-space corner of the box, inclusive
+	 */
+	void FillBox(DirectX::XMINT3 min, DirectX::XMINT3 max, BlockType type);
+
+	/**
+	 * @param center world-space block the sphere is centered on
+	 * @param radius in blocks, every block whose center lies within it gets filled
+	 */
+	void FillSphere(DirectX::XMINT3 center, float radius, BlockType type);
+
+	/**
+	 * @param origin world-space position the clipboard's first block lands on
+	 * @param pasteAir false to leave the blocks under the clipboard's air alone
+	 */
+	void Paste(const BlockClipboard& clipboard, DirectX::XMINT3 origin, bool pasteAir = true);
+
+	void Reserve(std::size_t editCount) { edits_.reserve(editCount); }
+	void Clear() { edits_.clear(); }
+
+private:
+	std::vector<BlockEdit> edits_;
+
+public:
+	// Getters
+	[[nodiscard]] const std::vector<BlockEdit>& GetEdits() const { return edits_; }
+	[[nodiscard]] bool							IsEmpty() const { return edits_.empty(); }
+};
@@ -0,0 +1,320 @@
+﻿#include "RegionFile.h"
+
+#include <algorithm>
+#include <system_error>
+#include <vector>
+
+#include "../Utils/ChunkUtils.h"
+
+namespace
+{
+	constexpr std::uint32_t regionMagic	  = 0x4e474552; // "REGN"
+	constexpr std::uint32_t regionVersion = 1;
+
+	// magic, version, sequence, checksum
+	constexpr std::size_t slotHeaderSize = 4 + 4 + 8 + 8;
+	// offset, size, reserved
+	constexpr std::size_t entrySize	 = 8 + 4 + 4;
+	constexpr std::size_t tableSize	 = entrySize * RegionFile::ENTRY_COUNT;
+	constexpr std::size_t slotSize	 = 20480;
+	constexpr std::size_t dataOffset = slotSize * 2;
+
+	static_assert(slotHeaderSize + tableSize <= slotSize);
+
+	// Only worth the copy once it shrinks the file by more than half and by a meaningful amount
+	constexpr std::uint64_t minCompactionDeadBytes = 1 << 20;
+
+	// Stored little-endian regardless of the platform
+	template <typename T>
+	void Store(std::uint8_t* out, T value)
+	{
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+		{
+			out[i] = static_cast<std::uint8_t>(value >> (i * 8));
+		}
+	}
+
+	template <typename T>
+	T Load(const std::uint8_t* data)
+	{
+		T value = 0;
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+		{
+			value |= static_cast<T>(data[i]) << (i * 8);
+		}
+		return value;
+	}
+
+	// FNV-1a, catches torn header writes
+	std::uint64_t GetChecksum(std::span<const std::uint8_t> data)
+	{
+		std::uint64_t hash = 0xcbf29ce484222325;
+		for (const std::uint8_t byte : data)
+		{
+			hash ^= byte;
+			hash *= 0x100000001b3;
+		}
+		return hash;
+	}
+} // namespace
+
+RegionFile::RegionFile() : sequence_(0), liveBytes_(0), hasUncommittedWrites_(false)
+{
+}
+
+bool RegionFile::Open(const std::filesystem::path& path)
+{
+	path_ = path;
+	view_ = {};
+	entries_.fill({});
+	sequence_			  = 0;
+	liveBytes_			  = 0;
+	hasUncommittedWrites_ = false;
+
+	if (file_.Open(path) == false)
+	{
+		return false;
+	}
+
+	// A new file starts out with an empty table, so there's always an intact slot to fall back on later
+	if (file_.GetSize() == 0 && (WriteHeader(file_, 0, 0, entries_) == false || file_.Flush() == false))
+	{
+		file_.Close();
+		return false;
+	}
+
+	if (ReadHeader() == false)
+	{
+		file_.Close();
+		return false;
+	}
+
+	return true;
+}
+
+std::span<const std::uint8_t> RegionFile::Read(std::uint32_t index)
+{
+	const Entry& entry = entries_[index];
+	if (entry.size == 0)
+	{
+		return {};
+	}
+
+	if (entry.offset + entry.size > view_.size())
+	{
+		view_ = file_.Map();
+		if (entry.offset + entry.size > view_.size())
+		{
+			return {};
+		}
+	}
+
+	return view_.subspan(static_cast<std::size_t>(entry.offset), entry.size);
+}
+
+bool RegionFile::Write(std::uint32_t index, std::span<const std::uint8_t> payload)
+{
+	const std::uint64_t offset = (std::max)(file_.GetSize(), std::uint64_t{dataOffset});
+	if (payload.empty() == false && file_.Write(offset, payload) == false)
+	{
+		return false;
+	}
+
+	Entry& entry  = entries_[index];
+	liveBytes_	 -= entry.size;
+	liveBytes_	 += payload.size();
+	entry		  = {payload.empty() ? 0 : offset, static_cast<std::uint32_t>(payload.size())};
+
+	hasUncommittedWrites_ = true;
+	return true;
+}
+
+bool RegionFile::Commit()
+{
+	if (hasUncommittedWrites_ == false)
+	{
+		return true;
+	}
+
+	// The payloads have to be on the disk before any header points at them
+	if (file_.Flush() == false)
+	{
+		return false;
+	}
+
+	const std::uint64_t sequence = sequence_ + 1;
+	if (WriteHeader(file_, static_cast<std::uint32_t>(sequence % 2), sequence, entries_) == false ||
+		file_.Flush() == false)
+	{
+		return false;
+	}
+
+	sequence_			  = sequence;
+	hasUncommittedWrites_ = false;
+	return true;
+}
+
+bool RegionFile::CompactIfNeeded()
+{
+	if (Commit() == false)
+	{
+		return false;
+	}
+
+	const std::uint64_t fileSize  = file_.GetSize();
+	const std::uint64_t deadBytes = fileSize > dataOffset ? fileSize - dataOffset - liveBytes_ : 0;
+	if (deadBytes <= liveBytes_ || deadBytes <= minCompactionDeadBytes)
+	{
+		return true;
+	}
+
+	std::filesystem::path tempPath = path_;
+	tempPath += ".tmp";
+
+	std::error_code error;
+	std::filesystem::remove(tempPath, error);
+
+	// Copy the live payloads into a fresh file, its header only gets written once all of them are in
+	bool	   copied = true;
+	EntryTable compactedEntries{};
+	{
+		MappedFile compacted;
+		if (compacted.Open(tempPath) == false)
+		{
+			return false;
+		}
+
+		std::uint64_t offset = dataOffset;
+		for (std::uint32_t i = 0; i < ENTRY_COUNT && copied; ++i)
+		{
+			if (entries_[i].size == 0)
+			{
+				continue;
+			}
+
+			const std::span<const std::uint8_t> payload = Read(i);
+			copied = payload.empty() == false && compacted.Write(offset, payload);
+
+			compactedEntries[i]	 = {offset, entries_[i].size};
+			offset				+= entries_[i].size;
+		}
+
+		const std::uint64_t sequence = sequence_ + 1;
+		copied = copied && WriteHeader(compacted, static_cast<std::uint32_t>(sequence % 2), sequence, compactedEntries);
+		copied = copied && compacted.Flush();
+	}
+
+	if (copied == false)
+	{
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+
+	// The file can't be replaced while it's open or mapped. Everything is committed, so reopening it restores the
+	// same state if the rename fails
+	view_ = {};
+	file_.Close();
+	std::error_code renameError;
+	std::filesystem::rename(tempPath, path_, renameError);
+	if (renameError)
+	{
+		std::filesystem::remove(tempPath, error);
+	}
+
+	return Open(path_) && !renameError;
+}
+
+DirectX::XMINT2 RegionFile::GetRegionCoordinates(DirectX::XMINT2 columnCoordinates)
+{
+	using Utils::Coordinates::GetChunkCoordinate;
+
+	return {GetChunkCoordinate<REGION_SIZE>(columnCoordinates.x), GetChunkCoordinate<REGION_SIZE>(columnCoordinates.y)};
+}
+
+std::uint32_t RegionFile::GetEntryIndex(DirectX::XMINT2 columnCoordinates)
+{
+	const DirectX::XMINT2 region = GetRegionCoordinates(columnCoordinates);
+	const std::int32_t	  x		 = columnCoordinates.x - region.x * REGION_SIZE;
+	const std::int32_t	  z		 = columnCoordinates.y - region.y * REGION_SIZE;
+	return static_cast<std::uint32_t>(x + z * REGION_SIZE);
+}
+
+bool RegionFile::ReadHeader()
+{
+	// The header slots get overwritten in place later on, so they're only ever read through this first mapping
+	const std::span<const std::uint8_t> data = file_.Map();
+
+	bool hasIntactSlot = false;
+	for (std::uint32_t slot = 0; slot < 2; ++slot)
+	{
+		const std::size_t slotOffset = slot * slotSize;
+		if (data.size() < slotOffset + slotHeaderSize + tableSize)
+		{
+			continue;
+		}
+
+		const std::uint8_t* header = data.data() + slotOffset;
+		if (Load<std::uint32_t>(header) != regionMagic)
+		{
+			continue;
+		}
+
+		const std::uint64_t					sequence = Load<std::uint64_t>(header + 8);
+		const std::uint64_t					checksum = Load<std::uint64_t>(header + 16);
+		const std::span<const std::uint8_t> table	 = data.subspan(slotOffset + slotHeaderSize, tableSize);
+		if (Load<std::uint32_t>(header + 4) != regionVersion || GetChecksum(table) != checksum ||
+			(hasIntactSlot && sequence <= sequence_))
+		{
+			continue;
+		}
+
+		EntryTable	  entries;
+		std::uint64_t liveBytes = 0;
+		bool		  inBounds	= true;
+		for (std::uint32_t i = 0; i < ENTRY_COUNT; ++i)
+		{
+			const std::uint8_t* entry = table.data() + i * entrySize;
+			entries[i]				  = {Load<std::uint64_t>(entry), Load<std::uint32_t>(entry + 8)};
+
+			liveBytes += entries[i].size;
+			inBounds   = inBounds && (entries[i].size == 0 || (entries[i].offset >= dataOffset &&
+																  entries[i].offset + entries[i].size <= data.size()));
+		}
+
+		if (inBounds)
+		{
+			entries_	  = entries;
+			sequence_	  = sequence;
+			liveBytes_	  = liveBytes;
+			hasIntactSlot = true;
+		}
+	}
+
+	const std::uint64_t fileSize = data.size();
+	file_.Unmap();
+
+	// Without any payloads the file can only have been torn while getting created, nothing is lost by starting over
+	return hasIntactSlot || fileSize <= dataOffset;
+}
+
+bool RegionFile::WriteHeader(MappedFile&	   file,
+							 std::uint32_t	   slot,
+							 std::uint64_t	   sequence,
+							 const EntryTable& entries) const
+{
+	std::vector<std::uint8_t> header(slotHeaderSize + tableSize);
+	for (std::uint32_t i = 0; i < ENTRY_COUNT; ++i)
+	{
+		std::uint8_t* entry = header.data() + slotHeaderSize + i * entrySize;
+		Store(entry, entries[i].offset);
+		Store(entry + 8, entries[i].size);
+		Store(entry + 12, std::uint32_t{0});
+	}
+
+	Store(header.data(), regionMagic);
+	Store(header.data() + 4, regionVersion);
+	Store(header.data() + 8, sequence);
+	Store(header.data() + 16, GetChecksum(std::span(header).subspan(slotHeaderSize)));
+
+	return file.Write(std::uint64_t{slot} * slotSize, header);
+}
@@ -0,0 +1,92 @@
+﻿#pragma once
+#include <DirectXMath.h>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+#include "../Utils/MappedFile.h"
+
+/**
+ * Stores opaque payloads for a REGION_SIZE x REGION_SIZE square of chunk columns in one file. Layout:
+ *  - two header slots, each with a sequence number, a checksum and an offset table with one entry per column
+ *  - payloads, appended at the end of the file, never overwritten in place
+ * A commit flushes the appended payloads first and only then writes the offset table into the older of the two
+ * slots, so a crash at any point leaves at least one slot intact, pointing at payloads that made it to the disk.
+ * Rewritten columns leave dead space behind, the file gets compacted once most of it is dead
+ */
+class RegionFile
+{
+public:
+	static constexpr std::int32_t  REGION_SIZE = 32; // columns along x and z
+	static constexpr std::uint32_t ENTRY_COUNT = REGION_SIZE * REGION_SIZE;
+
+	RegionFile();
+
+	RegionFile(const RegionFile&)			 = delete;
+	RegionFile(RegionFile&&)				 = delete;
+	RegionFile& operator=(const RegionFile&) = delete;
+	RegionFile& operator=(RegionFile&&)		 = delete;
+
+	/**
+	 * Opens the file, creates it if it doesn't exist
+	 * @return false if it couldn't be opened or neither of its header slots is intact
+	 */
+	bool Open(const std::filesystem::path& path);
+
+	/**
+	 * @return the column's payload, empty if it isn't stored or got cut off. Stays valid until the next call on the
+	 * region
+	 */
+	[[nodiscard]] std::span<const std::uint8_t> Read(std::uint32_t index);
+
+	/**
+	 * Appends the payload, it replaces the previous one right away but only survives a crash once committed
+	 */
+	bool Write(std::uint32_t index, std::span<const std::uint8_t> payload);
+
+	// Makes every write so far durable, does nothing if there weren't any
+	bool Commit();
+
+	/**
+	 * Rewrites the file without the dead space, if there's enough of it to be worth it. Commits as well
+	 * @return false if the rewrite failed, the file stays as it was then
+	 */
+	bool CompactIfNeeded();
+
+	// Region the column lies in
+	[[nodiscard]] static DirectX::XMINT2 GetRegionCoordinates(DirectX::XMINT2 columnCoordinates);
+
+	// Offset table index of the column within its region
+	[[nodiscard]] static std::uint32_t GetEntryIndex(DirectX::XMINT2 columnCoordinates);
+
+private:
+	struct Entry
+	{
+		std::uint64_t offset = 0;
+		std::uint32_t size	 = 0; // 0 if the column isn't stored
+	};
+
+	using EntryTable = std::array<Entry, ENTRY_COUNT>;
+
+	// Picks the newest intact header slot
+	bool ReadHeader();
+	bool WriteHeader(MappedFile& file, std::uint32_t slot, std::uint64_t sequence, const EntryTable& entries) const;
+
+	std::filesystem::path path_;
+	MappedFile			  file_;
+	EntryTable			  entries_;
+	std::uint64_t		  sequence_; // of the slot entries_ got read from or last committed to
+	std::uint64_t		  liveBytes_;
+	bool				  hasUncommittedWrites_;
+
+	// Last mapping of the file, only gets remapped when a read lands past its end
+	std::span<const std::uint8_t> view_;
+
+public:
+	// Getters
+	[[nodiscard]] bool			IsOpen() const { return file_.IsOpen(); }
+	[[nodiscard]] bool			Contains(std::uint32_t index) const { return entries_[index].size > 0; }
+	[[nodiscard]] std::uint64_t GetFileSize() const { return file_.GetSize(); }
+	[[nodiscard]] std::uint64_t GetLiveBytes() const { return liveBytes_; }
+};
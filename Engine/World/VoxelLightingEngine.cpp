@@ -1,8 +1,17 @@
 ﻿#include "VoxelLightingEngine.h"
 
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <exception>
 #include <ranges>
+#include <thread>
 
+#include "../Core/Metrics.h"
+#include "../Core/Profiler.h"
+#include "../Utils/ChunkUtils.h"
 #include "BlockDatabase.h"
+#include "Chunk.h"
 #include "World.h"
 
 static constexpr DirectX::XMINT3 offsets[] = {{0, 1, 0}, /**/
@@ -12,12 +21,225 @@ static constexpr DirectX::XMINT3 offsets[] = {{0, 1, 0}, /**/
 											  {0, 0, 1},
 											  {0, 0, -1}};
 
+namespace
+{
+	Metrics::Counter   lightNodesVisited("Lighting.NodesVisited");
+	Metrics::Histogram lightNodesPerPropagation("Lighting.NodesPerPropagation"); // light and darkness alike
+	Metrics::Counter   parallelPropagations("Lighting.ParallelPropagations");
+
+	std::vector<LightNode> DrainQueue(std::queue<LightNode>& queue)
+	{
+		std::vector<LightNode> nodes;
+		nodes.reserve(queue.size());
+		while (queue.empty() == false)
+		{
+			nodes.push_back(queue.front());
+			queue.pop();
+		}
+
+		return nodes;
+	}
+
+	std::uint8_t GetLightLevel(const Block& block, bool useBlockLight)
+	{
+		return useBlockLight ? block.GetBlockLightLevel() : block.GetSkyLightLevel();
+	}
+
+	// Whether light of the given type can enter a block of the given type
+	bool IsLightPassable(BlockType type, bool useBlockLight)
+	{
+		const BlockDatabase& database = BlockDatabase::GetDatabase();
+		if (database.IsOpaque(type) == false)
+		{
+			return true;
+		}
+
+		// Emissive blocks can receive block light, even if opaque
+		return useBlockLight && database.GetLightEmission(type) > 0;
+	}
+
+	// Index into LightRegion::neighbors for a chunk offset in [-1, 1] on every axis
+	constexpr std::size_t GetNeighborIndex(std::int32_t dx, std::int32_t dy, std::int32_t dz)
+	{
+		return static_cast<std::size_t>((dx + 1) + (dy + 1) * 3 + (dz + 1) * 9);
+	}
+
+	using LightNodes = Memory::TrackedVector<LightNode, Memory::Tag::Lighting>;
+
+	// A chunk-sized piece of the world processed by a single worker per round
+	struct LightRegion
+	{
+		Chunk*						chunk = nullptr;
+		DirectX::XMINT3				chunkCoordinates{};
+		std::array<Chunk*, 27>		neighbors{}; // see GetNeighborIndex, only read during propagation
+
+		LightNodes pending;	 // nodes already written into the chunk, waiting to be spread
+		LightNodes incoming; // candidate levels handed over by neighboring regions
+		LightNodes outgoing; // candidate levels for blocks that lie in neighboring regions
+
+		bool		  changed		 = false; // whether the chunk's own mesh is affected
+		std::uint32_t dirtyNeighbors = 0;	  // bitmask over neighbors whose mesh is affected
+	};
+
+	// Returns how many nodes it visited
+	std::uint64_t ProcessLightRegion(LightRegion& region, bool useBlockLight)
+	{
+		PROFILE_FUNCTION();
+		using namespace DirectX;
+		static constexpr std::int32_t bitMask = static_cast<std::int32_t>(Chunk::CHUNK_SIZE) - 1;
+
+		Chunk* chunk = region.chunk;
+
+		auto GetLevel = [&](XMINT3 position) -> std::uint8_t
+		{
+			return GetLightLevel(chunk->GetBlock(position.x & bitMask, position.y & bitMask, position.z & bitMask),
+								 useBlockLight);
+		};
+
+		auto SetLevel = [&](XMINT3 position, std::uint8_t lightLevel)
+		{
+			std::int32_t x = position.x & bitMask;
+			std::int32_t y = position.y & bitMask;
+			std::int32_t z = position.z & bitMask;
+			if (useBlockLight)
+			{
+				chunk->SetBlockLightLevel(x, y, z, lightLevel);
+			}
+			else
+			{
+				chunk->SetSkyLightLevel(x, y, z, lightLevel);
+			}
+
+			region.changed |= chunk->IsLightSampled(x, y, z);
+
+			// Border blocks lie in the padding of up to 7 neighboring chunks (faces, edges and corners)
+			static constexpr std::int32_t last		= static_cast<std::int32_t>(Chunk::CHUNK_SIZE) - 1;
+			static constexpr auto		  chunkSize = static_cast<std::int32_t>(Chunk::CHUNK_SIZE);
+			if (x > 0 && x < last && y > 0 && y < last && z > 0 && z < last)
+			{
+				return;
+			}
+
+			for (std::int32_t dz = (z == 0 ? -1 : 0); dz <= (z == last ? 1 : 0); ++dz)
+			{
+				for (std::int32_t dy = (y == 0 ? -1 : 0); dy <= (y == last ? 1 : 0); ++dy)
+				{
+					for (std::int32_t dx = (x == 0 ? -1 : 0); dx <= (x == last ? 1 : 0); ++dx)
+					{
+						const std::size_t	neighborIndex = GetNeighborIndex(dx, dy, dz);
+						const std::uint32_t neighborBit	  = 1u << neighborIndex;
+						const Chunk*		neighbor	  = region.neighbors[neighborIndex];
+						if ((region.dirtyNeighbors & neighborBit) != 0 || neighbor == nullptr || neighbor == chunk)
+						{
+							continue;
+						}
+
+						if (neighbor->IsLightSampled(x - dx * chunkSize, y - dy * chunkSize, z - dz * chunkSize))
+						{
+							region.dirtyNeighbors |= neighborBit;
+						}
+					}
+				}
+			}
+		};
+
+		std::queue<LightNode> queue;
+		for (const LightNode& node : region.pending)
+		{
+			queue.push(node);
+		}
+		region.pending.clear();
+
+		for (const LightNode& candidate : region.incoming)
+		{
+			const XMINT3& pos	= candidate.position;
+			Block		  block = chunk->GetBlock(pos.x & bitMask, pos.y & bitMask, pos.z & bitMask);
+			if (IsLightPassable(block.type, useBlockLight) && GetLightLevel(block, useBlockLight) < candidate.lightLevel)
+			{
+				SetLevel(pos, candidate.lightLevel);
+				queue.push(candidate);
+			}
+		}
+		region.incoming.clear();
+
+		const XMINT3 chunkMin = {region.chunkCoordinates.x * static_cast<std::int32_t>(Chunk::CHUNK_SIZE),
+								 region.chunkCoordinates.y * static_cast<std::int32_t>(Chunk::CHUNK_SIZE),
+								 region.chunkCoordinates.z * static_cast<std::int32_t>(Chunk::CHUNK_SIZE)};
+
+		std::uint64_t visitedNodes = 0;
+		while (queue.empty() == false)
+		{
+			LightNode node = queue.front();
+			queue.pop();
+			++visitedNodes;
+
+			if (GetLevel(node.position) != node.lightLevel)
+			{
+				continue;
+			}
+
+			for (const auto& offset : offsets)
+			{
+				XMINT3 neighborPos = {node.position.x + offset.x,
+									  node.position.y + offset.y,
+									  node.position.z + offset.z};
+
+				// Sky light travels down without decaying
+				int nextLightLevel = (useBlockLight == false && offset.y == -1) ? node.lightLevel : node.lightLevel - 1;
+				if (nextLightLevel <= 0)
+				{
+					continue;
+				}
+
+				bool insideRegion = static_cast<std::uint32_t>(neighborPos.x - chunkMin.x) < Chunk::CHUNK_SIZE
+								 && static_cast<std::uint32_t>(neighborPos.y - chunkMin.y) < Chunk::CHUNK_SIZE
+								 && static_cast<std::uint32_t>(neighborPos.z - chunkMin.z) < Chunk::CHUNK_SIZE;
+				if (insideRegion == false)
+				{
+					region.outgoing.emplace_back(neighborPos, static_cast<std::uint8_t>(nextLightLevel));
+					continue;
+				}
+
+				Block neighborBlock = chunk->GetBlock(neighborPos.x & bitMask,
+													  neighborPos.y & bitMask,
+													  neighborPos.z & bitMask);
+				if (IsLightPassable(neighborBlock.type, useBlockLight) == false)
+				{
+					continue;
+				}
+
+				if (GetLightLevel(neighborBlock, useBlockLight) < nextLightLevel)
+				{
+					SetLevel(neighborPos, static_cast<std::uint8_t>(nextLightLevel));
+					queue.emplace(neighborPos, static_cast<std::uint8_t>(nextLightLevel));
+				}
+			}
+		}
+
+		return visitedNodes;
+	}
+} // namespace
+
 VoxelLightingEngine::VoxelLightingEngine(World* world)
 {
 	assert(world != nullptr);
 	world_ = world;
 }
 
+VoxelLightingEngine::~VoxelLightingEngine()
+{
+	{
+		std::lock_guard<std::mutex> lock(propagationMutex_);
+		stopPropagationWorkers_ = true;
+	}
+	propagationCondition_.notify_all();
+
+	for (std::thread& worker : propagationWorkers_)
+	{
+		worker.join();
+	}
+}
+
 void VoxelLightingEngine::AddLightSource(std::int32_t x, std::int32_t y, std::int32_t z, std::uint8_t lightLevel)
 {
 	AddLightSource({x, y, z}, lightLevel);
@@ -33,6 +255,7 @@ void VoxelLightingEngine::AddLightSource(DirectX::XMINT3 position, const std::ui
 
 void VoxelLightingEngine::UpdateSkyLight(DirectX::XMINT3 position)
 {
+	PROFILE_FUNCTION();
 	using namespace DirectX;
 
 
@@ -110,6 +333,7 @@ void VoxelLightingEngine::UpdateSkyLight(std::int32_t x, std::int32_t y, std::in
 
 void VoxelLightingEngine::UpdateBlockLight(DirectX::XMINT3 position, BlockType oldBlock, BlockType newBlock)
 {
+	PROFILE_FUNCTION();
 	using namespace DirectX;
 
 
@@ -166,48 +390,509 @@ void VoxelLightingEngine::UpdateBlockLight(int32_t x, int32_t y, int32_t z, Bloc
 	UpdateBlockLight({x, y, z}, oldBlock, newBlock);
 }
 
+void VoxelLightingEngine::UpdateLightBatch(std::span<const BlockChange> changes)
+{
+	PROFILE_FUNCTION();
+	using namespace DirectX;
+
+	BlockDatabase& blockDatabase = BlockDatabase::GetDatabase();
+
+	// Sky light. Everything that got covered up goes dark before any of it gets relit, otherwise the relighting
+	// would spread light that's about to be taken away
+	std::vector<const BlockChange*> brokenBlocks;
+	for (const BlockChange& change : changes)
+	{
+		const BlockData* newBlockData = blockDatabase.GetBlockData(change.newType);
+		if (newBlockData == nullptr)
+		{
+			brokenBlocks.push_back(&change);
+		}
+		else if (newBlockData->isTransparent == false)
+		{
+			darknessQueue.emplace(change.position, world_->GetBlock(change.position).GetSkyLightLevel());
+			world_->SetSkyLightLevel(change.position, 0);
+		}
+	}
+	PropagateSkyDarkness();
+
+	// Top down, so a column of broken blocks gets filled with sunlight by its topmost block alone
+	std::ranges::sort(brokenBlocks,
+					  std::ranges::greater{},
+					  [](const BlockChange* change) { return change->position.y; });
+	for (const BlockChange* change : brokenBlocks)
+	{
+		const XMINT3 position	= change->position;
+		const Block	 blockAbove = world_->GetBlock(XMINT3{position.x, position.y + 1, position.z});
+
+		if (world_->GetBlock(position).GetSkyLightLevel() < 15
+			&& (blockAbove.type == BlockType::INVALID_
+				|| (blockAbove.type == BlockType::Air && blockAbove.GetSkyLightLevel() == 15)))
+		{
+			for (XMINT3 blockPos = position;; blockPos.y -= 1)
+			{
+				const Block block = world_->GetBlock(blockPos);
+				if (block.type == BlockType::INVALID_)
+				{
+					break;
+				}
+
+				const BlockData* blockData = blockDatabase.GetBlockData(block.type);
+				if (blockData != nullptr && blockData->isTransparent == false)
+				{
+					break;
+				}
+
+				world_->SetSkyLightLevel(blockPos, 15);
+				propagationQueue.emplace(blockPos, 15);
+			}
+		}
+
+		for (const auto& offset : offsets)
+		{
+			const XMINT3 neighborPos   = {position.x + offset.x, position.y + offset.y, position.z + offset.z};
+			const Block	 neighborBlock = world_->GetBlock(neighborPos);
+			if (neighborBlock.type != BlockType::INVALID_ && neighborBlock.GetSkyLightLevel() > 0)
+			{
+				propagationQueue.emplace(neighborPos, neighborBlock.GetSkyLightLevel());
+			}
+		}
+	}
+	PropagateSkyLight();
+
+	// Block light, same order. Removed lights and new opaque blocks go dark first, new lights are placed afterwards so
+	// the darkness can't eat them
+	for (const BlockChange& change : changes)
+	{
+		const BlockData* ogBlockData  = blockDatabase.GetBlockData(change.oldType);
+		const BlockData* newBlockData = blockDatabase.GetBlockData(change.newType);
+		if (newBlockData != nullptr && newBlockData->lightEmissionLevel > 0)
+		{
+			continue;
+		}
+
+		if (ogBlockData != nullptr && ogBlockData->lightEmissionLevel > 0)
+		{
+			darknessQueue.emplace(change.position, ogBlockData->lightEmissionLevel);
+			world_->SetBlockLightLevel(change.position, 0);
+			RemoveBlockLight(change.position);
+		}
+		else if (newBlockData != nullptr && newBlockData->isTransparent == false)
+		{
+			darknessQueue.emplace(change.position, world_->GetBlock(change.position).GetBlockLightLevel());
+			world_->SetBlockLightLevel(change.position, 0);
+		}
+	}
+	PropagateBlockDarkness();
+
+	for (const BlockChange& change : changes)
+	{
+		const BlockData* ogBlockData  = blockDatabase.GetBlockData(change.oldType);
+		const BlockData* newBlockData = blockDatabase.GetBlockData(change.newType);
+		if (newBlockData != nullptr && newBlockData->lightEmissionLevel > 0)
+		{
+			world_->SetBlockLightLevel(change.position, newBlockData->lightEmissionLevel);
+			propagationQueue.emplace(change.position, newBlockData->lightEmissionLevel);
+			AddBlockLight(change.position, *newBlockData);
+		}
+		else if ((ogBlockData == nullptr || ogBlockData->lightEmissionLevel == 0)
+				 && (newBlockData == nullptr || newBlockData->isTransparent))
+		{
+			// Non-emissive block broken or a transparent one placed, the light around it can flow in now
+			for (const auto& offset : offsets)
+			{
+				const XMINT3	   neighborPos = {change.position.x + offset.x,
+												  change.position.y + offset.y,
+												  change.position.z + offset.z};
+				const Block		   block	   = world_->GetBlock(neighborPos);
+				const std::uint8_t lightLevel  = block.GetBlockLightLevel();
+				if (block.type != BlockType::INVALID_ && lightLevel > 0)
+				{
+					propagationQueue.emplace(neighborPos, lightLevel);
+				}
+			}
+		}
+	}
+	PropagateBlockLight();
+}
+
 std::vector<PointLightGPU> VoxelLightingEngine::GetLightsInFrustum(const DirectX::BoundingFrustum& frustum) const
 {
 	using namespace DirectX;
+
+	struct Candidate
+	{
+		const PointLightCPU* light;
+		float				 importance;
+	};
+
+	const XMVECTOR eyePosition = XMLoadFloat3(&frustum.Origin);
+
+	std::vector<Candidate> candidates;
+	for (const LightCell& cell : lightCells_ | std::views::values)
+	{
+		const ContainmentType cellContainment = frustum.Contains(cell.bounds);
+		if (cellContainment == DISJOINT)
+		{
+			continue;
+		}
+
+		for (const PointLightCPU& light : cell.lights)
+		{
+			// Lights in a fully contained cell don't need to be tested one by one
+			if (cellContainment != CONTAINS && frustum.Contains(light.bounds) == DISJOINT)
+			{
+				continue;
+			}
+
+			// Rough screen-space contribution: projected size of the light volume scaled by its intensity
+			const float distance   = (std::max)(XMVectorGetX(XMVector3Length(XMLoadFloat3(&light.bounds.Center) - eyePosition)),
+												1.0f);
+			const float radius	   = light.bounds.Radius;
+			const float importance = light.intensity * (radius * radius) / (distance * distance);
+			candidates.emplace_back(&light, importance);
+		}
+	}
+
+	if (candidates.size() > MAX_POINT_LIGHTS)
+	{
+		std::ranges::nth_element(candidates,
+								 candidates.begin() + MAX_POINT_LIGHTS,
+								 std::ranges::greater{},
+								 &Candidate::importance);
+		candidates.resize(MAX_POINT_LIGHTS);
+	}
+
 	std::vector<PointLightGPU> lightsGPU;
-	lightsGPU.reserve((std::min)(lights_.size(), MAX_POINT_LIGHTS));
-	auto view = lights_
-			  | std::views::values
-			  | std::views::filter(
-					[&](auto& light)
+	lightsGPU.reserve(candidates.size());
+	for (const auto& [light, importance] : candidates)
+	{
+		lightsGPU.emplace_back(light->bounds.Center, light->bounds.Radius, light->color, light->intensity);
+	}
+
+	return lightsGPU;
+}
+
+void VoxelLightingEngine::PropagateBulk(std::span<const LightNode> seeds, bool useBlockLight)
+{
+	if (seeds.size() >= PARALLEL_PROPAGATION_THRESHOLD)
+	{
+		PropagateLightParallel(seeds, useBlockLight);
+		return;
+	}
+
+	for (const LightNode& seed : seeds)
+	{
+		propagationQueue.push(seed);
+	}
+
+	if (useBlockLight)
+	{
+		PropagateBlockLight();
+	}
+	else
+	{
+		PropagateSkyLight();
+	}
+}
+
+void VoxelLightingEngine::RemoveLight(std::span<const LightNode> blockLight, std::span<const LightNode> skyLight)
+{
+	PROFILE_FUNCTION();
+
+	// Same order as UpdateLightBatch, all of a light type goes dark before any of it gets relit
+	for (const LightNode& node : skyLight)
+	{
+		darknessQueue.push(node);
+		world_->SetSkyLightLevel(node.position, 0);
+	}
+	PropagateSkyDarkness();
+	PropagateSkyLight();
+
+	for (const LightNode& node : blockLight)
+	{
+		darknessQueue.push(node);
+		world_->SetBlockLightLevel(node.position, 0);
+	}
+	PropagateBlockDarkness();
+	PropagateBlockLight();
+}
+
+void VoxelLightingEngine::PropagateLightParallel(std::span<const LightNode> seeds, bool useBlockLight)
+{
+	PROFILE_FUNCTION();
+	using namespace DirectX;
+	using Utils::Coordinates::GetChunkCoordinate;
+
+	std::unordered_map<XMINT3, LightRegion, Math::XMINT3Hash> regions;
+
+	// Only ever called while no worker is running, chunks that don't exist are treated like INVALID_ blocks
+	auto GetRegion = [&](XMINT3 blockPosition) -> LightRegion*
+	{
+		XMINT3 chunkCoordinates = {GetChunkCoordinate<Chunk::CHUNK_SIZE>(blockPosition.x),
+								   GetChunkCoordinate<Chunk::CHUNK_SIZE>(blockPosition.y),
+								   GetChunkCoordinate<Chunk::CHUNK_SIZE>(blockPosition.z)};
+
+		if (auto it = regions.find(chunkCoordinates); it != regions.end())
+		{
+			return &it->second;
+		}
+
+		Chunk* chunk = world_->GetChunk(chunkCoordinates);
+		if (chunk == nullptr)
+		{
+			return nullptr;
+		}
+
+		// Unsharing or decompressing the blocks on a worker would swap them out under the other workers reading them
+		chunk->DetachBlocksSnapshot();
+
+		LightRegion& region		= regions[chunkCoordinates];
+		region.chunk			= chunk;
+		region.chunkCoordinates = chunkCoordinates;
+		for (std::int32_t dz = -1; dz <= 1; ++dz)
+		{
+			for (std::int32_t dy = -1; dy <= 1; ++dy)
+			{
+				for (std::int32_t dx = -1; dx <= 1; ++dx)
+				{
+					Chunk* neighbor = world_->GetChunk(
+						XMINT3{chunkCoordinates.x + dx, chunkCoordinates.y + dy, chunkCoordinates.z + dz});
+					if (neighbor != nullptr)
+					{
+						neighbor->DetachBlocksSnapshot();
+					}
+					region.neighbors[GetNeighborIndex(dx, dy, dz)] = neighbor;
+				}
+			}
+		}
+		return &region;
+	};
+
+	std::vector<LightRegion*> activeRegions;
+	auto					  CollectActiveRegions = [&]()
+	{
+		activeRegions.clear();
+		for (LightRegion& region : regions | std::views::values)
+		{
+			if (region.pending.empty() == false || region.incoming.empty() == false)
+			{
+				activeRegions.push_back(&region);
+			}
+		}
+	};
+
+	for (const LightNode& seed : seeds)
+	{
+		LightRegion* region = GetRegion(seed.position);
+		if (region != nullptr)
+		{
+			region->pending.push_back(seed);
+		}
+	}
+	CollectActiveRegions();
+
+	std::atomic<std::size_t>   nextRegion	= 0;
+	std::atomic<std::uint64_t> visitedNodes = 0;
+	bool					   finished		= activeRegions.empty();
+
+	// The first exception any of the threads ran into, the propagation stops at the end of that round
+	std::exception_ptr failure;
+	std::mutex		   failureMutex;
+
+	// Runs on the calling thread between rounds, hands the frontier over to the regions it belongs to
+	auto ExchangeFrontier = [&]()
+	{
+		PROFILE_ZONE("Exchange frontier");
+		for (LightRegion* region : activeRegions)
+		{
+			for (const LightNode& node : region->outgoing)
+			{
+				LightRegion* target = GetRegion(node.position);
+				if (target != nullptr)
+				{
+					target->incoming.push_back(node);
+				}
+			}
+			region->outgoing.clear();
+		}
+
+		CollectActiveRegions();
+		nextRegion.store(0, std::memory_order_relaxed);
+		finished = activeRegions.empty();
+	};
+
+	StartPropagationWorkers();
+	std::barrier<> roundBarrier(static_cast<std::ptrdiff_t>(propagationWorkers_.size() + 1));
+
+	// A round ends in two barrier phases with the frontier exchange in between. The exchange allocates, so it can't be
+	// the barrier's completion step, that one has to be noexcept
+	auto Worker = [&](bool exchangesFrontier)
+	{
+		while (finished == false)
+		{
+			try
+			{
+				std::size_t idx;
+				while ((idx = nextRegion.fetch_add(1, std::memory_order_relaxed)) < activeRegions.size())
+				{
+					const std::uint64_t regionVisitedNodes = ProcessLightRegion(*activeRegions[idx], useBlockLight);
+					lightNodesVisited.Add(regionVisitedNodes);
+					visitedNodes.fetch_add(regionVisitedNodes, std::memory_order_relaxed);
+				}
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(failureMutex);
+				if (failure == nullptr)
+				{
+					failure = std::current_exception();
+				}
+			}
+
+			roundBarrier.arrive_and_wait();
+			if (exchangesFrontier)
+			{
+				try
+				{
+					if (failure == nullptr)
 					{
-						ContainmentType containment = frustum.Contains(light.bounds);
-						return containment != DISJOINT;
-					})
-			  | std::views::take(MAX_POINT_LIGHTS);
+						ExchangeFrontier();
+					}
+				}
+				catch (...)
+				{
+					failure = std::current_exception();
+				}
+				finished = finished || failure != nullptr;
+			}
+			roundBarrier.arrive_and_wait();
+		}
+	};
 
-	for (const auto& [bounds, color, intensity] : view)
 	{
-		lightsGPU.emplace_back(bounds.Center, bounds.Radius, color, intensity);
+		std::lock_guard<std::mutex> lock(propagationMutex_);
+		propagationJob_			= [&]() { Worker(false); };
+		busyPropagationWorkers_ = propagationWorkers_.size();
+		++propagationGeneration_;
 	}
+	propagationCondition_.notify_all();
 
-	return lightsGPU;
+	Worker(true);
+
+	{
+		std::unique_lock<std::mutex> lock(propagationMutex_);
+		propagationDoneCondition_.wait(lock, [this]() { return busyPropagationWorkers_ == 0; });
+		propagationJob_ = nullptr;
+	}
+	parallelPropagations.Add();
+	lightNodesPerPropagation.Record(visitedNodes.load(std::memory_order_relaxed));
+
+	// Dirty-marking isn't thread-safe, do it all at once now
+	for (const LightRegion& region : regions | std::views::values)
+	{
+		if (region.changed)
+		{
+			world_->MarkLitChunkDirty(region.chunk);
+		}
+
+		for (std::size_t i = 0; i < region.neighbors.size(); ++i)
+		{
+			if ((region.dirtyNeighbors & (1u << i)) != 0)
+			{
+				world_->MarkLitChunkDirty(region.neighbors[i]);
+			}
+		}
+	}
+
+	// Whatever got written so far is still valid light, just not all of it. Same as if the serial one ran out of memory
+	if (failure != nullptr)
+	{
+		std::rethrow_exception(failure);
+	}
+}
+
+void VoxelLightingEngine::StartPropagationWorkers()
+{
+	if (propagationWorkers_.empty() == false)
+	{
+		return;
+	}
+
+	const unsigned threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+	propagationWorkers_.reserve(threadCount - 1);
+	for (unsigned i = 0; i < threadCount - 1; ++i)
+	{
+		propagationWorkers_.emplace_back(&VoxelLightingEngine::PropagationWorkerLoop, this);
+	}
+}
+
+void VoxelLightingEngine::PropagationWorkerLoop()
+{
+	PROFILE_THREAD_NAME("Light propagation");
+
+	std::uint64_t generation = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(propagationMutex_);
+			propagationCondition_.wait(lock,
+									   [&]()
+									   {
+										   return stopPropagationWorkers_ || propagationGeneration_ != generation;
+									   });
+			if (stopPropagationWorkers_)
+			{
+				return;
+			}
+			generation = propagationGeneration_;
+		}
+
+		propagationJob_();
+
+		{
+			std::lock_guard<std::mutex> lock(propagationMutex_);
+			--busyPropagationWorkers_;
+		}
+		propagationDoneCondition_.notify_one();
+	}
 }
 
 void VoxelLightingEngine::PropagateBlockLight()
 {
+	PROFILE_FUNCTION();
 	using namespace DirectX;
 
+	if (propagationQueue.size() >= PARALLEL_PROPAGATION_THRESHOLD)
+	{
+		PropagateLightParallel(DrainQueue(propagationQueue), true);
+		return;
+	}
+
 	BlockDatabase& blockDatabase = BlockDatabase::GetDatabase();
 
 	// to stop the queue from magically containing 2.5 MILLION entries, most of them dupes
-	std::unordered_set<XMINT3, Math::XMINT3Hash> guardianSet;
+	std::unordered_map<XMINT3, std::uint8_t, Math::XMINT3Hash> guardianMap;
+	std::uint64_t visitedNodes = 0;
 	while (propagationQueue.empty() == false)
 	{
 		LightNode node = propagationQueue.front();
 		propagationQueue.pop();
-		if (guardianSet.contains(node.position))
+		++visitedNodes;
+
+		// Stale node, it either got outshined by a brighter path (which is queued as well) or darkened after being
+		// queued. Either way spreading its level would be wrong
+		if (world_->GetBlock(node.position).GetBlockLightLevel() != node.lightLevel)
+		{
+			continue;
+		}
+
+		if (auto it = guardianMap.find(node.position); it != guardianMap.end() && it->second >= node.lightLevel)
 		{
 			// the node goes bye bye, this is a one-time only ride
 			continue;
 		}
 
-		guardianSet.insert(node.position);
+		guardianMap[node.position] = node.lightLevel;
 
 		for (const auto& offset : offsets)
 		{
@@ -225,10 +910,8 @@ void VoxelLightingEngine::PropagateBlockLight()
 				continue;
 			}
 
-			const BlockData* data = blockDatabase.GetBlockData(neighborBlock.type);
-
 			// Opaque, non-emissive check
-			if (data != nullptr && data->isTransparent == false && data->lightEmissionLevel == 0)
+			if (blockDatabase.IsOpaque(neighborBlock.type) && blockDatabase.GetLightEmission(neighborBlock.type) == 0)
 			{
 				continue;
 			}
@@ -241,19 +924,25 @@ void VoxelLightingEngine::PropagateBlockLight()
 			}
 		}
 	}
+
+	lightNodesVisited.Add(visitedNodes);
+	lightNodesPerPropagation.Record(visitedNodes);
 }
 
 void VoxelLightingEngine::PropagateBlockDarkness()
 {
+	PROFILE_FUNCTION();
 	using namespace DirectX;
 
 	BlockDatabase&								 blockDatabase = BlockDatabase::GetDatabase();
 	std::unordered_set<XMINT3, Math::XMINT3Hash> guardianSet;
 
+	std::uint64_t visitedNodes = 0;
 	while (darknessQueue.empty() == false)
 	{
 		LightNode node = darknessQueue.front();
 		darknessQueue.pop();
+		++visitedNodes;
 		if (guardianSet.contains(node.position))
 		{
 			continue;
@@ -269,8 +958,7 @@ void VoxelLightingEngine::PropagateBlockDarkness()
 				continue;
 			}
 
-			const BlockData* data = blockDatabase.GetBlockData(neighborBlock.type);
-			if (data != nullptr && data->isTransparent == false && data->lightEmissionLevel == 0)
+			if (blockDatabase.IsOpaque(neighborBlock.type) && blockDatabase.GetLightEmission(neighborBlock.type) == 0)
 			{
 				continue;
 			}
@@ -288,23 +976,42 @@ void VoxelLightingEngine::PropagateBlockDarkness()
 			}
 		}
 	}
+
+	lightNodesVisited.Add(visitedNodes);
+	lightNodesPerPropagation.Record(visitedNodes);
 }
 
 void VoxelLightingEngine::PropagateSkyLight()
 {
+	PROFILE_FUNCTION();
+	if (propagationQueue.size() >= PARALLEL_PROPAGATION_THRESHOLD)
+	{
+		PropagateLightParallel(DrainQueue(propagationQueue), false);
+		return;
+	}
+
 	BlockDatabase& blockDatabase = BlockDatabase::GetDatabase();
 
-	std::unordered_set<DirectX::XMINT3, Math::XMINT3Hash> guardianSet;
+	std::unordered_map<DirectX::XMINT3, std::uint8_t, Math::XMINT3Hash> guardianMap;
 
+	std::uint64_t visitedNodes = 0;
 	while (!propagationQueue.empty())
 	{
 		LightNode node = propagationQueue.front();
 		propagationQueue.pop();
-		if (guardianSet.contains(node.position))
+		++visitedNodes;
+
+		// Same as with block light, stale nodes would spread light that's no longer there
+		if (world_->GetBlock(node.position).GetSkyLightLevel() != node.lightLevel)
 		{
 			continue;
 		}
-		guardianSet.insert(node.position);
+
+		if (auto it = guardianMap.find(node.position); it != guardianMap.end() && it->second >= node.lightLevel)
+		{
+			continue;
+		}
+		guardianMap[node.position] = node.lightLevel;
 
 		for (const auto& offset : offsets)
 		{
@@ -327,10 +1034,8 @@ void VoxelLightingEngine::PropagateSkyLight()
 				continue;
 			}
 
-			const BlockData* data = blockDatabase.GetBlockData(neighborBlock.type);
-
 			// Opaque check (Air is transparent)
-			if (data != nullptr && !data->isTransparent)
+			if (blockDatabase.IsOpaque(neighborBlock.type))
 			{
 				continue;
 			}
@@ -346,19 +1051,25 @@ void VoxelLightingEngine::PropagateSkyLight()
 			}
 		}
 	}
+
+	lightNodesVisited.Add(visitedNodes);
+	lightNodesPerPropagation.Record(visitedNodes);
 }
 void VoxelLightingEngine::PropagateSkyDarkness()
 {
+	PROFILE_FUNCTION();
 	using namespace DirectX;
 
 	BlockDatabase& blockDatabase = BlockDatabase::GetDatabase();
 
 	std::unordered_set<XMINT3, Math::XMINT3Hash> guardianSet;
 
+	std::uint64_t visitedNodes = 0;
 	while (darknessQueue.empty() == false)
 	{
 		LightNode node = darknessQueue.front();
 		darknessQueue.pop();
+		++visitedNodes;
 		if (guardianSet.contains(node.position))
 		{
 			continue;
@@ -376,8 +1087,7 @@ void VoxelLightingEngine::PropagateSkyDarkness()
 				continue;
 			}
 
-			const BlockData* data = blockDatabase.GetBlockData(neighborBlock.type);
-			if (data != nullptr && data->isTransparent == false)
+			if (blockDatabase.IsOpaque(neighborBlock.type))
 			{
 				continue;
 			}
@@ -403,71 +1113,128 @@ void VoxelLightingEngine::PropagateSkyDarkness()
 			}
 		}
 	}
+
+	lightNodesVisited.Add(visitedNodes);
+	lightNodesPerPropagation.Record(visitedNodes);
 }
 
 void VoxelLightingEngine::AddBlockLight(const DirectX::XMINT3 position, const struct BlockData& blockData)
 {
 	using namespace DirectX;
+	using Utils::Coordinates::GetChunkCoordinate;
+
 	const float x = static_cast<float>(position.x) + 0.5f;
 	const float y = static_cast<float>(position.y) + 0.5f;
 	const float z = static_cast<float>(position.z) + 0.5f;
 
 	const float			 radius = blockData.lightEmissionLevel;
 	const BoundingSphere lightBounds({x, y, z}, radius);
+	const PointLightCPU	 light{lightBounds, blockData.lightColor, blockData.lightIntensity};
 
-	lights_[position] = {lightBounds, blockData.lightColor, blockData.lightIntensity};
+	const XMINT3 cellCoordinates = {GetChunkCoordinate<Chunk::CHUNK_SIZE>(position.x),
+									GetChunkCoordinate<Chunk::CHUNK_SIZE>(position.y),
+									GetChunkCoordinate<Chunk::CHUNK_SIZE>(position.z)};
+	LightCell&	 cell			 = lightCells_[cellCoordinates];
+
+	if (cell.lights.empty())
+	{
+		RecalculateLightCellBounds(cellCoordinates);
+	}
+
+	const auto [it, inserted] = cell.indices.try_emplace(GetLightCellIndex(position),
+														 static_cast<std::uint32_t>(cell.lights.size()));
+	if (inserted)
+	{
+		cell.positions.push_back(position);
+		cell.lights.push_back(light);
+	}
+	else
+	{
+		cell.lights[it->second] = light;
+	}
+
+	// A replaced light may have had a bigger radius, the bounds stay loose until the next removal in the cell
+	const float extent	= static_cast<float>(Chunk::CHUNK_SIZE) / 2.0f + radius;
+	cell.bounds.Extents = {(std::max)(cell.bounds.Extents.x, extent),
+						   (std::max)(cell.bounds.Extents.y, extent),
+						   (std::max)(cell.bounds.Extents.z, extent)};
 }
 
 void VoxelLightingEngine::RemoveBlockLight(const DirectX::XMINT3 position)
 {
-	lights_.erase(position);
-}
+	using namespace DirectX;
+	using Utils::Coordinates::GetChunkCoordinate;
 
+	const XMINT3 cellCoordinates = {GetChunkCoordinate<Chunk::CHUNK_SIZE>(position.x),
+									GetChunkCoordinate<Chunk::CHUNK_SIZE>(position.y),
+									GetChunkCoordinate<Chunk::CHUNK_SIZE>(position.z)};
 
-std::vector<LightNode> VoxelLightingEngine::GetNodeNeighbors(const LightNode& node, bool useBlockLight)
-{
-	using namespace DirectX;
-	std::vector<LightNode> result;
-	result.reserve(6);
+	auto cellIt = lightCells_.find(cellCoordinates);
+	if (cellIt == lightCells_.end())
+	{
+		return;
+	}
 
-	XMVECTOR current = XMLoadSInt3(&node.position);
+	LightCell& cell = cellIt->second;
+	auto	   it	= cell.indices.find(GetLightCellIndex(position));
+	if (it == cell.indices.end())
+	{
+		return;
+	}
 
-	for (const auto& offset : offsets)
+	// swap and pop, order within a cell doesn't matter
+	const std::uint32_t idx = it->second;
+	cell.indices.erase(it);
+	if (idx + 1 != cell.lights.size())
 	{
-		XMVECTOR next = XMLoadSInt3(&offset);
-		XMINT3	 neighbor;
-		XMStoreSInt3(&neighbor, next + current);
+		cell.positions[idx] = cell.positions.back();
+		cell.lights[idx]	= cell.lights.back();
+		// the last light moved into the hole, its block has to point at the new slot
+		cell.indices[GetLightCellIndex(cell.positions[idx])] = idx;
+	}
+	cell.positions.pop_back();
+	cell.lights.pop_back();
 
-		Block block = world_->GetBlock(neighbor);
-		if (block.type != BlockType::INVALID_)
-		{
-			result.emplace_back(neighbor, useBlockLight ? block.GetBlockLightLevel() : block.GetSkyLightLevel());
-		}
+	if (cell.lights.empty())
+	{
+		lightCells_.erase(cellIt);
+		return;
 	}
 
-	return result;
+	RecalculateLightCellBounds(cellCoordinates);
+}
+
+void VoxelLightingEngine::RemoveChunkLights(DirectX::XMINT3 chunkCoordinates)
+{
+	lightCells_.erase(chunkCoordinates);
 }
-std::vector<LightNode> VoxelLightingEngine::GetHorizontalNodeNeighbors(const LightNode& node, bool useBlockLight)
+
+std::uint16_t VoxelLightingEngine::GetLightCellIndex(DirectX::XMINT3 position)
+{
+	static constexpr std::int32_t bitMask = static_cast<std::int32_t>(Chunk::CHUNK_SIZE) - 1;
+
+	const std::int32_t x = position.x & bitMask;
+	const std::int32_t y = position.y & bitMask;
+	const std::int32_t z = position.z & bitMask;
+	return static_cast<std::uint16_t>(x + Chunk::CHUNK_SIZE * (y + Chunk::CHUNK_SIZE * z));
+}
+
+void VoxelLightingEngine::RecalculateLightCellBounds(DirectX::XMINT3 cellCoordinates)
 {
 	using namespace DirectX;
-	static constexpr XMINT3 offsets[]{{1, 0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 0, -1}};
-	std::vector<LightNode>	result;
-	result.reserve(4);
 
-	XMVECTOR current = XMLoadSInt3(&node.position);
+	LightCell& cell = lightCells_[cellCoordinates];
 
-	for (const auto& offset : offsets)
+	float maxRadius = 0.0f;
+	for (const PointLightCPU& light : cell.lights)
 	{
-		XMVECTOR next = XMLoadSInt3(&offset);
-		XMINT3	 neighbor;
-		XMStoreSInt3(&neighbor, next + current);
-
-		Block block = world_->GetBlock(neighbor);
-		if (block.type != BlockType::INVALID_)
-		{
-			result.emplace_back(neighbor, useBlockLight ? block.GetBlockLightLevel() : block.GetSkyLightLevel());
-		}
+		maxRadius = (std::max)(maxRadius, light.bounds.Radius);
 	}
 
-	return result;
+	const float halfSize = static_cast<float>(Chunk::CHUNK_SIZE) / 2.0f;
+	cell.bounds.Center	 = {static_cast<float>(cellCoordinates.x) * Chunk::CHUNK_SIZE + halfSize,
+							static_cast<float>(cellCoordinates.y) * Chunk::CHUNK_SIZE + halfSize,
+							static_cast<float>(cellCoordinates.z) * Chunk::CHUNK_SIZE + halfSize};
+	cell.bounds.Extents	 = {halfSize + maxRadius, halfSize + maxRadius, halfSize + maxRadius};
 }
+
@@ -1,8 +1,14 @@
 ﻿#pragma once
 #include <DirectXMath.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <queue>
+#include <span>
+#include <thread>
 #include <unordered_map>
 
+#include "../Core/MemoryTracking.h"
 #include "../Graphics/Light.h"
 #include "../Math/DirectXMathOperators.h"
 #include "Block.h"
@@ -24,9 +30,20 @@ struct LightNode
 	{
 	}
 };
+
+// A block whose type got replaced, see VoxelLightingEngine::UpdateLightBatch
+struct BlockChange
+{
+	DirectX::XMINT3 position; // world-space
+	BlockType		oldType;
+	BlockType		newType;
+};
+
 class World;
 class VoxelLightingEngine
 {
+	friend class LightingTests;
+
 	World*				  world_;
 	std::queue<LightNode> propagationQueue;
 	std::queue<LightNode> darknessQueue;
@@ -34,6 +51,12 @@ class VoxelLightingEngine
 public:
 	VoxelLightingEngine() = delete;
 	VoxelLightingEngine(World* world);
+	~VoxelLightingEngine();
+
+	VoxelLightingEngine(const VoxelLightingEngine&)			   = delete;
+	VoxelLightingEngine(VoxelLightingEngine&&)				   = delete;
+	VoxelLightingEngine& operator=(const VoxelLightingEngine&) = delete;
+	VoxelLightingEngine& operator=(VoxelLightingEngine&&)	   = delete;
 
 	void AddLightSource(std::int32_t x, std::int32_t y, std::int32_t z, std::uint8_t lightLevel);
 	void AddLightSource(DirectX::XMINT3 position, const std::uint8_t lightLevel);
@@ -44,20 +67,109 @@ public:
 	void UpdateBlockLight(DirectX::XMINT3 position, BlockType oldBlock, BlockType newBlock);
 	void UpdateBlockLight(std::int32_t x, std::int32_t y, std::int32_t z, BlockType oldBlock, BlockType newBlock);
 
+	/**
+	 * Does what UpdateSkyLight and UpdateBlockLight do for every change, but with a single darkness and a single
+	 * propagation pass per light type for all of them
+	 * @param changes blocks whose new type is already in the world, at most one change per position
+	 */
+	void UpdateLightBatch(std::span<const BlockChange> changes);
+
+	/**
+	 * @param frustum camera frustum, its origin is used as the viewer position
+	 * @return up to MAX_POINT_LIGHTS visible lights. If there's more, the ones with the biggest on-screen contribution
+	 * (based on distance, radius and intensity) are kept
+	 */
 	[[nodiscard]] std::vector<PointLightGPU> GetLightsInFrustum(const DirectX::BoundingFrustum& frustum) const;
 
+	/**
+	 * Spreads light from nodes whose level has already been written into the world. Small batches go through the
+	 * regular queue, large ones (world-gen, bulk edits) get split by chunk and propagated on multiple threads
+	 * @param seeds light nodes to propagate from, their light level has to match the one stored in the world
+	 * @param useBlockLight true for block light, false for sky light
+	 */
+	void PropagateBulk(std::span<const LightNode> seeds, bool useBlockLight);
+
+	/**
+	 * Takes away light that has nothing left to come from. The blocks go dark along with all the light that spread
+	 * from them, then the light still around them flows back in
+	 * @param blockLight blocks whose block light has to go, with the level they have now
+	 * @param skyLight blocks whose sky light has to go, with the level they have now
+	 */
+	void RemoveLight(std::span<const LightNode> blockLight, std::span<const LightNode> skyLight);
+
+	/**
+	 * Gives an emissive block its point light, or updates the one it has. Block edits do this on their own, chunks
+	 * coming in from the generation or the storage need it done for every emissive block
+	 * @param blockData of the emissive block at the position
+	 */
+	void AddBlockLight(const DirectX::XMINT3 position, const struct BlockData& blockData);
+
+	// Forgets the point lights of a chunk that's getting unloaded
+	void RemoveChunkLights(DirectX::XMINT3 chunkCoordinates);
+
 private:
+	// Queues at least this big get propagated by the region-partitioned propagator instead of the serial one
+	static constexpr std::size_t PARALLEL_PROPAGATION_THRESHOLD = 4096;
+
 	void PropagateBlockLight();
 	void PropagateBlockDarkness();
 	void PropagateSkyLight();
 	void PropagateSkyDarkness();
 
-	void AddBlockLight(const DirectX::XMINT3 position, const struct BlockData& blockData);
+	/**
+	 * Parallel BFS over chunk regions. Each worker owns a single chunk per round and only writes inside it, nodes
+	 * crossing a chunk border are handed over to the neighbor's region for the next round. Light only ever increases
+	 * here, so the result is the same fixpoint the serial propagation arrives at, regardless of the processing order
+	 */
+	void PropagateLightParallel(std::span<const LightNode> seeds, bool useBlockLight);
+
+	// Starts the propagation workers if they aren't running yet, they stay around until the engine goes away
+	void StartPropagationWorkers();
+	void PropagationWorkerLoop();
+
 	void RemoveBlockLight(const DirectX::XMINT3 position);
 
+	// Block index within its chunk, what a light cell looks its lights up by
+	[[nodiscard]] static std::uint16_t GetLightCellIndex(DirectX::XMINT3 position);
+
+	// Shrinks the bounds back down after a light is gone, adding one only ever grows them
+	void RecalculateLightCellBounds(DirectX::XMINT3 cellCoordinates);
+
+	template <typename T>
+	using LightingAllocator = Memory::TrackedAllocator<T, Memory::Tag::Lighting>;
+
+	template <typename T>
+	using LightingVector = std::vector<T, LightingAllocator<T>>;
+
+	// Point lights bucketed per chunk, so whole chunks worth of lights can be culled with a single frustum test
+	struct LightCell
+	{
+		DirectX::BoundingBox			bounds; // chunk bounds grown by the largest light radius inside
+		LightingVector<DirectX::XMINT3> positions;
+		LightingVector<PointLightCPU>	lights;
+		std::unordered_map<std::uint16_t,
+						   std::uint32_t,
+						   std::hash<std::uint16_t>,
+						   std::equal_to<std::uint16_t>,
+						   LightingAllocator<std::pair<const std::uint16_t, std::uint32_t>>>
+			indices; // block index within the chunk -> index into positions and lights
+	};
+
+	using LightCellMap = std::unordered_map<DirectX::XMINT3,
+											LightCell,
+											Math::XMINT3Hash,
+											std::equal_to<DirectX::XMINT3>,
+											LightingAllocator<std::pair<const DirectX::XMINT3, LightCell>>>;
 
-	std::vector<LightNode> GetNodeNeighbors(const LightNode& node, bool getBlockLight);
-	std::vector<LightNode> GetHorizontalNodeNeighbors(const LightNode& node, bool getBlockLight);
+	LightCellMap lightCells_; // keyed by chunk coordinates
 
-	std::unordered_map<DirectX::XMINT3, PointLightCPU, Math::XMINT3Hash> lights_;
+	// Helpers of PropagateLightParallel, the calling thread makes up the last participant
+	std::vector<std::thread> propagationWorkers_;
+	std::mutex				 propagationMutex_;
+	std::condition_variable	 propagationCondition_;		// a job got posted or the workers have to stop
+	std::condition_variable	 propagationDoneCondition_; // the last busy worker is done with the job
+	std::function<void()>	 propagationJob_;
+	std::uint64_t			 propagationGeneration_	 = 0; // bumped for every posted job
+	std::size_t				 busyPropagationWorkers_ = 0;
+	bool					 stopPropagationWorkers_ = false;
 };
@@ -3,18 +3,34 @@
 #include <algorithm>
 #include <iostream>
 #include <ranges>
+#include <tuple>
 
+#include "../Core/Metrics.h"
+#include "../Core/Profiler.h"
 #include "../Core/Timer.h"
 #include "../Graphics/Mesher.h"
 #include "../Utils/ChunkUtils.h"
 #include "BlockDatabase.h"
 #include "Chunk.h"
-#include "ChunkGenerators/FlatGenerator.h"
+#include "ChunkGenerators/NoiseGenerator.h"
+
+namespace
+{
+	Metrics::Counter meshJobsQueued("World.MeshJobsQueued");
+	Metrics::Counter meshJobsCompleted("World.MeshJobsCompleted");
+	Metrics::Counter meshJobsDropped("World.MeshJobsDropped"); // finished after their chunk got unloaded
+	Metrics::Gauge	 meshQueueDepth("World.MeshQueueDepth");
+	Metrics::Gauge	 uploadBacklog("World.UploadBacklog");
+	Metrics::Gauge	 loadedChunks("World.LoadedChunks");
+	Metrics::Gauge	 meshBytes("World.MeshBytes");
+} // namespace
+
 World::World() :
 	shuttingDown_(false),
 	device_(nullptr),
 	deviceContext_(nullptr),
 	lightEngine_(this),
+	cachedChunk_(nullptr),
 	timeOfDay_(0.5f)
 {
 }
@@ -32,10 +48,16 @@ World::~World()
 	{
 		t.join();
 	}
+
+	// Everything that's still resident would be lost otherwise, the meshers aren't touching any chunks anymore
+	if (chunkStreamer_ != nullptr)
+	{
+		chunkStreamer_->SaveAll();
+	}
 }
 
 
-bool World::Initialize(ID3D11Device* device)
+bool World::Initialize(ID3D11Device* device, bool persistent)
 {
 	auto threadCount = (std::max)(std::thread::hardware_concurrency() - 1, 1u);
 	for (unsigned i = 0; i < threadCount; i++)
@@ -44,82 +66,27 @@ bool World::Initialize(ID3D11Device* device)
 	}
 	device_ = device;
 	assert(device_ != nullptr);
-	return true;
-}
-
-void World::GenerateTestChunks()
-{
-	DirectX::XMINT3 chunk1{0, 0, 0};
-	DirectX::XMINT3 chunk2{0, 1, 0};
-	DirectX::XMINT3 chunk3{0, -1, 0};
-	DirectX::XMINT3 chunk4{1, 0, 0};
-	DirectX::XMINT3 chunk5{-1, 0, 0};
 
-	chunks_[chunk1] = std::make_unique<Chunk>(chunk1);
-	chunks_[chunk2] = std::make_unique<Chunk>(chunk2);
-	chunks_[chunk3] = std::make_unique<Chunk>(chunk3);
-	chunks_[chunk4] = std::make_unique<Chunk>(chunk4);
-	// chunks_[chunk5] = std::make_unique<Chunk>(chunk5);
+	constexpr std::uint32_t worldSeed = 0;
+	auto					generator = std::make_unique<NoiseGenerator>(this, worldSeed, NoiseGenerator::Settings{});
 
-	for (std::uint8_t z = 0; z < Chunk::CHUNK_SIZE; z++)
+	std::unique_ptr<WorldSaver> saver;
+	if (persistent)
 	{
-		for (std::uint8_t y = 0; y < Chunk::CHUNK_SIZE; y++)
+		auto storage = std::make_unique<WorldStorage>("Saves/World");
+		if (storage->BindBlockIds(BlockDatabase::GetDatabase()) == false)
 		{
-			for (std::uint8_t x = 0; x < Chunk::CHUNK_SIZE; x++)
-			{
-				chunks_[chunk1]->SetBlockType(x, y, z, BlockType::Cobblestone);
-				chunks_[chunk1]->SetBlockLightLevel(x, y, z, 0);
-				chunks_[chunk1]->SetSkyLightLevel(x, y, z, 0);
-
-				chunks_[chunk2]->SetBlockType(x, y, z, BlockType::Stone);
-				chunks_[chunk2]->SetBlockLightLevel(x, y, z, 0);
-				chunks_[chunk2]->SetSkyLightLevel(x, y, z, 0);
-
-				chunks_[chunk3]->SetBlockType(x, y, z, BlockType::Dirt);
-				chunks_[chunk3]->SetBlockLightLevel(x, y, z, 0);
-				chunks_[chunk3]->SetSkyLightLevel(x, y, z, 0);
-
-
-				chunks_[chunk4]->SetBlockType(x, y, z, BlockType::Log);
-				chunks_[chunk4]->SetBlockLightLevel(x, y, z, 0);
-				chunks_[chunk4]->SetSkyLightLevel(x, y, z, 0);
-			}
+			return false;
 		}
-	}
-
-	RequestChunkMeshUpdate(chunks_[chunk1].get());
-	RequestChunkMeshUpdate(chunks_[chunk2].get());
-	RequestChunkMeshUpdate(chunks_[chunk3].get());
-	RequestChunkMeshUpdate(chunks_[chunk4].get());
-	// RequestChunkMeshUpdate(chunks_[chunk5].get());
-}
-
-void World::GenerateTestWorld()
-{
-	FlatGenerator::ChunkTemplate chunkTemplate{
-		{BlockType::Stone, 60},
-		{BlockType::Dirt, 20},
-		{BlockType::Grass, 1},
-	};
 
-	FlatGenerator generator(this, chunkTemplate);
-	for (int z = -8; z < 8; ++z)
-	{
-		for (int x = -8; x < 8; ++x)
-		{
-			for (int y = 0; y < 16; ++y)
-			{
-				chunks_[{x, y, z}] = std::make_unique<Chunk>(DirectX::XMINT3{x, y, z});
-				generator.FillChunk(chunks_[{x, y, z}].get());
-			}
-		}
+		saver = std::make_unique<WorldSaver>(std::move(storage), WorldSaver::Settings{});
 	}
 
-	for (const auto& chunk : chunks_ | std::views::values)
-	{
-		// RequestChunkMeshUpdate(chunk.get());
-		MarkChunkDirty(chunk.get());
-	}
+	chunkStreamer_ = std::make_unique<ChunkStreamer>(this,
+													 std::move(generator),
+													 std::move(saver),
+													 ChunkStreamer::Settings{});
+	return true;
 }
 
 DirectX::XMVECTOR World::GetLightDirection() const
@@ -300,65 +267,151 @@ bool World::SetBlock(DirectX::XMFLOAT3 worldCoordinates, BlockType blockType, Bl
 	double result = perfCounter.GetDeltaTime();
 	std::cout << "light updates took: " << result << " seconds" << std::endl;
 
-	MarkChunkDirty(chunk);
+	MarkBlockChangeDirty(chunk,
+						 DirectX::XMINT3{static_cast<std::int32_t>(std::floorf(worldCoordinates.x)),
+										 static_cast<std::int32_t>(std::floorf(worldCoordinates.y)),
+										 static_cast<std::int32_t>(std::floorf(worldCoordinates.z))});
+
+	return success;
+}
+
+bool World::SetBlock(DirectX::XMINT3 worldCoordinates, BlockType blockType, BlockFace frontFace)
+{
+	float x = static_cast<float>(worldCoordinates.x);
+	float y = static_cast<float>(worldCoordinates.y);
+	float z = static_cast<float>(worldCoordinates.z);
+
+	return SetBlock(DirectX::XMFLOAT3{x, y, z}, blockType, frontFace);
+}
+
+std::size_t World::ApplyEditBatch(const EditBatch& batch)
+{
+	using namespace DirectX;
+	using Utils::Coordinates::GetChunkCoordinate;
 
-	DirectX::XMINT3 chunkCoordinates = chunk->GetChunkWorldPos();
-	// find out if the block was modified on chunk borders
-	std::vector<BlockFace> borderDirections = Chunk::IsBlockOnBorder(x, y, z);
-	for (auto borderDirection : borderDirections)
+	static constexpr std::int32_t bitMask = static_cast<std::int32_t>(Chunk::CHUNK_SIZE) - 1;
+
+	auto GetChunkCoordinates = [](XMINT3 position)
+	{
+		return XMINT3{GetChunkCoordinate<Chunk::CHUNK_SIZE>(position.x),
+					  GetChunkCoordinate<Chunk::CHUNK_SIZE>(position.y),
+					  GetChunkCoordinate<Chunk::CHUNK_SIZE>(position.z)};
+	};
+	auto GetSortKey = [&](const BlockEdit& edit)
+	{
+		const XMINT3 chunk = GetChunkCoordinates(edit.position);
+		return std::tuple(chunk.z, chunk.y, chunk.x, edit.position.z, edit.position.y, edit.position.x);
+	};
+
+	// Grouped by chunk so every chunk gets looked up once. Stable, so the last edit of a position ends up last
+	std::vector<BlockEdit> edits = batch.GetEdits();
+	std::ranges::stable_sort(edits, std::ranges::less{}, GetSortKey);
+
+	std::vector<BlockChange> changes;
+	changes.reserve(edits.size());
+
+	for (std::size_t begin = 0, end = 0; begin < edits.size(); begin = end)
 	{
-		DirectX::XMINT3 neighborChunkCoordinates = chunkCoordinates;
-		switch (borderDirection)
+		const XMINT3 chunkCoordinates = GetChunkCoordinates(edits[begin].position);
+		while (end < edits.size() && GetChunkCoordinates(edits[end].position) == chunkCoordinates)
 		{
-			case BlockFace::North:
-			{
-				neighborChunkCoordinates.z += 1;
-				break;
-			}
-			case BlockFace::South:
+			++end;
+		}
+
+		Chunk* chunk = GetChunk(chunkCoordinates);
+		if (chunk == nullptr)
+		{
+			continue;
+		}
+
+		// Bit per neighbor, (dx + 1) + (dy + 1) * 3 + (dz + 1) * 9, set if a changed block lies in its padding
+		std::uint32_t touchedNeighbors = 0;
+		bool		  changed		   = false;
+
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const BlockEdit& edit = edits[i];
+			if (i + 1 < end && edits[i + 1].position == edit.position)
 			{
-				neighborChunkCoordinates.z -= 1;
-				break;
+				continue; // overridden by a later edit
 			}
-			case BlockFace::West:
+
+			const std::int32_t x		= edit.position.x & bitMask;
+			const std::int32_t y		= edit.position.y & bitMask;
+			const std::int32_t z		= edit.position.z & bitMask;
+			const Block		   oldBlock = chunk->GetBlock(x, y, z);
+			if (oldBlock.type == edit.type || chunk->SetBlockType(x, y, z, edit.type) == false)
 			{
-				neighborChunkCoordinates.x -= 1;
-				break;
+				continue;
 			}
-			case BlockFace::East:
+
+			changes.emplace_back(edit.position, oldBlock.type, edit.type);
+			changed = true;
+
+			// Smooth lighting reads the diagonal blocks as well, so edges and corners reach up to 7 neighbors
+			for (std::int32_t dz = (z == 0 ? -1 : 0); dz <= (z == bitMask ? 1 : 0); ++dz)
 			{
-				neighborChunkCoordinates.x += 1;
-				break;
+				for (std::int32_t dy = (y == 0 ? -1 : 0); dy <= (y == bitMask ? 1 : 0); ++dy)
+				{
+					for (std::int32_t dx = (x == 0 ? -1 : 0); dx <= (x == bitMask ? 1 : 0); ++dx)
+					{
+						touchedNeighbors |= 1u << ((dx + 1) + (dy + 1) * 3 + (dz + 1) * 9);
+					}
+				}
 			}
-			case BlockFace::Top:
+		}
+
+		if (changed == false)
+		{
+			continue;
+		}
+
+		MarkChunkDirty(chunk);
+		for (std::int32_t neighborIndex = 0; neighborIndex < 27; ++neighborIndex)
+		{
+			// The chunk itself is the center bit
+			if (neighborIndex == 13 || (touchedNeighbors & (1u << neighborIndex)) == 0)
 			{
-				neighborChunkCoordinates.y += 1;
-				break;
+				continue;
 			}
-			case BlockFace::Bottom:
+
+			Chunk* neighbor = GetChunk(XMINT3{chunkCoordinates.x + neighborIndex % 3 - 1,
+											  chunkCoordinates.y + neighborIndex / 3 % 3 - 1,
+											  chunkCoordinates.z + neighborIndex / 9 - 1});
+			if (neighbor != nullptr)
 			{
-				neighborChunkCoordinates.y -= 1;
-				break;
+				MarkChunkDirty(neighbor);
 			}
 		}
-
-		Chunk* neighbor = GetChunk(neighborChunkCoordinates);
-		if (neighbor != nullptr)
-		{
-			MarkChunkDirty(neighbor);
-		}
 	}
 
-	return success;
+	lightEngine_.UpdateLightBatch(changes);
+	return changes.size();
 }
 
-bool World::SetBlock(DirectX::XMINT3 worldCoordinates, BlockType blockType, BlockFace frontFace)
+BlockClipboard World::CopyBlocks(DirectX::XMINT3 min, DirectX::XMINT3 max)
 {
-	float x = static_cast<float>(worldCoordinates.x);
-	float y = static_cast<float>(worldCoordinates.y);
-	float z = static_cast<float>(worldCoordinates.z);
+	BlockClipboard clipboard;
+	if (min.x > max.x || min.y > max.y || min.z > max.z)
+	{
+		return clipboard;
+	}
 
-	return SetBlock(DirectX::XMFLOAT3{x, y, z}, blockType, frontFace);
+	clipboard.size = {max.x - min.x + 1, max.y - min.y + 1, max.z - min.z + 1};
+	clipboard.types.reserve(static_cast<std::size_t>(clipboard.size.x) * clipboard.size.y * clipboard.size.z);
+
+	for (std::int32_t z = min.z; z <= max.z; ++z)
+	{
+		for (std::int32_t y = min.y; y <= max.y; ++y)
+		{
+			for (std::int32_t x = min.x; x <= max.x; ++x)
+			{
+				clipboard.types.push_back(GetBlock(DirectX::XMINT3{x, y, z}).type);
+			}
+		}
+	}
+
+	return clipboard;
 }
 
 // MAKE THIS FASTTTTT
@@ -370,18 +423,16 @@ Block World::GetBlock(DirectX::XMFLOAT3 worldCoordinates)
 	std::int32_t	chunkZ = Utils::Coordinates::GetChunkCoordinate<Chunk::CHUNK_SIZE>(worldCoordinates.z);
 	DirectX::XMINT3 chunkCoords(chunkX, chunkY, chunkZ);
 
-	static Chunk* cachedChunk = nullptr;
-
-	if (cachedChunk != nullptr && cachedChunk->GetChunkWorldPos() == chunkCoords)
+	if (cachedChunk_ != nullptr && cachedChunk_->GetChunkWorldPos() == chunkCoords)
 	{
 		static constexpr std::int32_t bitMask = static_cast<std::int32_t>(Chunk::CHUNK_SIZE) - 1;
 
 		std::int32_t x = static_cast<int32_t>(std::floorf(worldCoordinates.x)) & bitMask;
 		std::int32_t y = static_cast<int32_t>(std::floorf(worldCoordinates.y)) & bitMask;
 		std::int32_t z = static_cast<int32_t>(std::floorf(worldCoordinates.z)) & bitMask;
-		return cachedChunk->GetBlock(x, y, z);
+		return cachedChunk_->GetBlock(x, y, z);
 	}
-	// cachedChunk null or last chunk coords not same
+	// cachedChunk_ null or last chunk coords not same
 	if (Chunk* chunk = GetChunkFromBlock(worldCoordinates); chunk != nullptr)
 	{
 		static constexpr std::int32_t bitMask = static_cast<std::int32_t>(Chunk::CHUNK_SIZE) - 1;
@@ -390,7 +441,7 @@ Block World::GetBlock(DirectX::XMFLOAT3 worldCoordinates)
 		std::int32_t y = static_cast<int32_t>(std::floorf(worldCoordinates.y)) & bitMask;
 		std::int32_t z = static_cast<int32_t>(std::floorf(worldCoordinates.z)) & bitMask;
 
-		cachedChunk = chunk;
+		cachedChunk_ = chunk;
 
 		return chunk->GetBlock(x, y, z);
 	}
@@ -409,21 +460,8 @@ Block World::GetBlock(DirectX::XMINT3 worldCoordinates)
 bool World::IsBlockSolid(DirectX::XMFLOAT3 worldCoordinates)
 {
 
-	Block block = GetBlock(worldCoordinates);
-
-	// chunks shouldn't contain invalid blocks, but it might be there's just no chunk here
-	if (block.type == BlockType::INVALID_)
-	{
-		return false;
-	}
-	BlockDatabase&	 database = BlockDatabase::GetDatabase();
-	const BlockData* data	  = database.GetBlockData(block.type);
-	if (data == nullptr)
-	{
-		return false;
-	}
-
-	return data->isSolid;
+	// No chunk here means INVALID_, which isn't solid
+	return BlockDatabase::GetDatabase().IsSolid(GetBlock(worldCoordinates).type);
 }
 bool World::IsBlockSolid(DirectX::XMINT3 worldCoordinates)
 {
@@ -432,16 +470,30 @@ bool World::IsBlockSolid(DirectX::XMINT3 worldCoordinates)
 										  static_cast<float>(worldCoordinates.z)));
 }
 
-void World::Update()
+void World::Update(DirectX::FXMVECTOR viewerPosition)
 {
+	PROFILE_FUNCTION();
+	if (chunkStreamer_ != nullptr)
+	{
+		chunkStreamer_->Update(viewerPosition);
+	}
+
 	{
+		PROFILE_ZONE("Upload meshes");
 		std::lock_guard<std::mutex> lock(uploadQueueMutex_);
 
 		for (const auto& result : uploadQueue_)
 		{
 			Chunk* chunk = GetChunk(result.chunkCoordinates);
-			if (chunk != nullptr)
+			if (chunk == nullptr)
+			{
+				meshJobsDropped.Add();
+			}
+			else
 			{
+				meshBytes.Add(static_cast<std::int64_t>(result.mesh.byteSize) - chunk->GetMeshByteSize());
+				chunk->SetMeshByteSize(result.mesh.byteSize);
+
 				chunk->SetVertexBuffer(result.mesh.vertexBuffer);
 				chunk->SetIndexBuffer(result.mesh.indexBuffer);
 				chunk->SetIndexCount(result.mesh.indexCount);
@@ -449,11 +501,13 @@ void World::Update()
 				chunk->SetShadowProxyVertexBuffer(result.mesh.shadowProxyVertexBuffer);
 				chunk->SetShadowProxyIndexBuffer(result.mesh.shadowProxyIndexBuffer);
 				chunk->SetShadowProxyIndexCount(result.mesh.shadowProxyIndexCount);
+				chunk->OnMeshUploaded(result.mesh.lightSampleMask);
 				chunk->ClearDirtyState();
 			}
 		}
 
 		uploadQueue_.clear();
+		uploadBacklog.Set(0);
 	}
 
 	for (const auto& chunk : dirtyChunks_)
@@ -463,11 +517,63 @@ void World::Update()
 	dirtyChunks_.clear();
 }
 
+Chunk* World::AddChunk(std::unique_ptr<Chunk> chunk)
+{
+	assert(chunk != nullptr);
+	const DirectX::XMINT3 chunkCoordinates = chunk->GetChunkWorldPos();
+	assert(chunks_.contains(chunkCoordinates) == false);
+
+	auto& slot = chunks_[chunkCoordinates];
+	slot	   = std::move(chunk);
+	loadedChunks.Set(static_cast<std::int64_t>(chunks_.size()));
+	return slot.get();
+}
+
+bool World::UnloadChunk(DirectX::XMINT3 chunkCoordinates)
+{
+	auto it = chunks_.find(chunkCoordinates);
+	if (it == chunks_.end())
+	{
+		return true;
+	}
+
+	// The finished mesh would get uploaded into whatever chunk sits at these coordinates by then
+	Chunk* chunk = it->second.get();
+	if (chunk->IsMeshPending())
+	{
+		return false;
+	}
+
+	dirtyChunks_.erase(chunk);
+	if (cachedChunk_ == chunk)
+	{
+		cachedChunk_ = nullptr;
+	}
+
+	lightEngine_.RemoveChunkLights(chunkCoordinates);
+	meshBytes.Add(-static_cast<std::int64_t>(chunk->GetMeshByteSize()));
+	chunks_.erase(it);
+	loadedChunks.Set(static_cast<std::int64_t>(chunks_.size()));
+	return true;
+}
+
 void World::MarkChunkDirty(Chunk* chunk)
 {
 	dirtyChunks_.insert(chunk);
 }
 
+void World::MarkLitChunkDirty(Chunk* chunk)
+{
+	if (chunk->HasMesh() || chunk->IsMeshPending() || chunkStreamer_ == nullptr)
+	{
+		MarkChunkDirty(chunk);
+		return;
+	}
+
+	// Never meshed, light reaching it doesn't make it any more ready for meshing than it was
+	chunkStreamer_->MarkDirtyIfSurrounded(chunk);
+}
+
 void World::RequestChunkMeshUpdate(Chunk* chunk)
 {
 	if (chunk == nullptr)
@@ -475,13 +581,16 @@ void World::RequestChunkMeshUpdate(Chunk* chunk)
 		return;
 	}
 
+	chunk->OnMeshRequested();
 	{
 		std::lock_guard<std::mutex> lock(jobQueueMutex_);
 
 		meshQueue_.push(std::make_unique<ChunkContext>());
 		auto chunkContext = meshQueue_.back().get();
 		FillChunkContext(chunk, chunkContext);
+		meshQueueDepth.Set(static_cast<std::int64_t>(meshQueue_.size()));
 	}
+	meshJobsQueued.Add();
 
 	jobQueueCondition_.notify_one();
 }
@@ -491,69 +600,57 @@ void World::FillChunkContext(const Chunk* mainChunk, ChunkContext* outChunkConte
 	assert(mainChunk != nullptr);
 	assert(outChunkContext != nullptr);
 
-	outChunkContext->mainChunk			  = mainChunk->GetBlocks();
+	static constexpr std::int32_t chunkSize = static_cast<std::int32_t>(Chunk::CHUNK_SIZE);
+
 	DirectX::XMINT3 chunkCoordinates	  = mainChunk->GetChunkWorldPos();
 	outChunkContext->mainChunkCoordinates = chunkCoordinates;
 
-	std::fill(outChunkContext->hasNeighbors.begin(), outChunkContext->hasNeighbors.end(), false);
-	// Get chunk neighbors
-	Chunk* northNeighbor  = nullptr;
-	Chunk* southNeighbor  = nullptr;
-	Chunk* eastNeighbor	  = nullptr;
-	Chunk* westNeighbor	  = nullptr;
-	Chunk* topNeighbor	  = nullptr;
-	Chunk* bottomNeighbor = nullptr;
-
-	DirectX::XMINT3 northNeighborPos{chunkCoordinates.x, chunkCoordinates.y, chunkCoordinates.z + 1};
-	DirectX::XMINT3 southNeighborPos{chunkCoordinates.x, chunkCoordinates.y, chunkCoordinates.z - 1};
-	DirectX::XMINT3 westNeighborPos{chunkCoordinates.x - 1, chunkCoordinates.y, chunkCoordinates.z};
-	DirectX::XMINT3 eastNeighborPos{chunkCoordinates.x + 1, chunkCoordinates.y, chunkCoordinates.z};
-	DirectX::XMINT3 topNeighborPos{chunkCoordinates.x, chunkCoordinates.y + 1, chunkCoordinates.z};
-	DirectX::XMINT3 bottomNeighborPos{chunkCoordinates.x, chunkCoordinates.y - 1, chunkCoordinates.z};
+	auto& paddedBlocks = outChunkContext->paddedBlocks;
+	paddedBlocks.fill({BlockType::Air, 0b11110000});
 
-	northNeighbor  = GetChunk(northNeighborPos);
-	southNeighbor  = GetChunk(southNeighborPos);
-	westNeighbor   = GetChunk(westNeighborPos);
-	eastNeighbor   = GetChunk(eastNeighborPos);
-	topNeighbor	   = GetChunk(topNeighborPos);
-	bottomNeighbor = GetChunk(bottomNeighborPos);
+	// For each axis, the range of padded coordinates a neighbor at offset -1/0/1 covers
+	static constexpr std::int32_t rangeBegin[] = {-1, 0, chunkSize};
+	static constexpr std::int32_t rangeEnd[]   = {0, chunkSize, chunkSize + 1};
 
-	if (northNeighbor != nullptr)
-	{
-		// Direction from the POV of the neighbor, so northern neighbor of a given chunk connects to the chunk by
-		// its southern border
-		northNeighbor->GetBorderSlice(outChunkContext->northNeighbor, BlockFace::South);
-		outChunkContext->hasNeighbors[static_cast<std::uint8_t>(BlockFace::North)] = true;
-	}
-	if (southNeighbor != nullptr)
-	{
-		southNeighbor->GetBorderSlice(outChunkContext->southNeighbor, BlockFace::North);
-		outChunkContext->hasNeighbors[static_cast<std::uint8_t>(BlockFace::South)] = true;
-	}
-	if (westNeighbor != nullptr)
+	for (std::int32_t dz = -1; dz <= 1; ++dz)
 	{
-		westNeighbor->GetBorderSlice(outChunkContext->westNeighbor, BlockFace::East);
-		outChunkContext->hasNeighbors[static_cast<std::uint8_t>(BlockFace::West)] = true;
-	}
-	if (eastNeighbor != nullptr)
-	{
-		eastNeighbor->GetBorderSlice(outChunkContext->eastNeighbor, BlockFace::West);
-		outChunkContext->hasNeighbors[static_cast<std::uint8_t>(BlockFace::East)] = true;
-	}
-	if (topNeighbor != nullptr)
-	{
-		topNeighbor->GetBorderSlice(outChunkContext->topNeighbor, BlockFace::Bottom);
-		outChunkContext->hasNeighbors[static_cast<std::uint8_t>(BlockFace::Top)] = true;
-	}
-	if (bottomNeighbor != nullptr)
-	{
-		bottomNeighbor->GetBorderSlice(outChunkContext->bottomNeighbor, BlockFace::Top);
-		outChunkContext->hasNeighbors[static_cast<std::uint8_t>(BlockFace::Bottom)] = true;
+		for (std::int32_t dy = -1; dy <= 1; ++dy)
+		{
+			for (std::int32_t dx = -1; dx <= 1; ++dx)
+			{
+				const Chunk* chunk = GetChunk(DirectX::XMINT3{chunkCoordinates.x + dx,
+															  chunkCoordinates.y + dy,
+															  chunkCoordinates.z + dz});
+				if (chunk == nullptr)
+				{
+					continue;
+				}
+
+				const Chunk::BlockArray& blocks = chunk->GetBlocks();
+				for (std::int32_t z = rangeBegin[dz + 1]; z < rangeEnd[dz + 1]; ++z)
+				{
+					for (std::int32_t y = rangeBegin[dy + 1]; y < rangeEnd[dy + 1]; ++y)
+					{
+						// x rows are contiguous in both layouts
+						const std::int32_t	sourceX = rangeBegin[dx + 1] - dx * chunkSize;
+						const std::int32_t	sourceY = y - dy * chunkSize;
+						const std::int32_t	sourceZ = z - dz * chunkSize;
+						const std::size_t	source	= sourceX + sourceY * chunkSize + sourceZ * chunkSize * chunkSize;
+						const std::int32_t	length	= rangeEnd[dx + 1] - rangeBegin[dx + 1];
+
+						std::copy_n(blocks.begin() + source,
+									length,
+									paddedBlocks.begin() + Chunk::GetPaddedIndex(rangeBegin[dx + 1], y, z));
+					}
+				}
+			}
+		}
 	}
 }
 
 void World::MesherLoop()
 {
+	PROFILE_THREAD_NAME("Mesher");
 	Mesher mesher;
 	while (true)
 	{
@@ -568,23 +665,23 @@ void World::MesherLoop()
 			}
 			job = std::move(meshQueue_.front());
 			meshQueue_.pop();
+			meshQueueDepth.Set(static_cast<std::int64_t>(meshQueue_.size()));
 		}
 
 		assert(job != nullptr);
 
 
 		MeshGPUData mesh = mesher.CreateMesh(*job, device_);
+		meshJobsCompleted.Add();
 
 		{
 			std::unique_lock<std::mutex> lock(uploadQueueMutex_);
 			uploadQueue_.emplace_back(job->mainChunkCoordinates, mesh);
+			uploadBacklog.Set(static_cast<std::int64_t>(uploadQueue_.size()));
 		}
 	}
 }
 
-// N S E W T B
-static constexpr DirectX::XMINT3 offsets[]{{0, 0, 1}, {0, 0, -1}, {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}};
-
 void World::SetSkyLightLevel(DirectX::XMINT3 worldCoordinates, std::uint8_t lightLevel)
 {
 	if (Chunk* chunk = GetChunkFromBlock(worldCoordinates); chunk != nullptr)
@@ -597,21 +694,7 @@ void World::SetSkyLightLevel(DirectX::XMINT3 worldCoordinates, std::uint8_t ligh
 		std::int32_t z = worldCoordinates.z & bitMask;
 
 		chunk->SetSkyLightLevel(x, y, z, lightLevel);
-		MarkChunkDirty(chunk);
-
-		for (const auto& face : chunk->IsBlockOnBorder(x, y, z))
-		{
-			DirectX::XMINT3 offset = offsets[static_cast<std::uint8_t>(face)];
-			DirectX::XMINT3 nPos   = {worldCoordinates.x + offset.x,
-									  worldCoordinates.y + offset.y,
-									  worldCoordinates.z + offset.z};
-
-			chunk = GetChunkFromBlock(nPos);
-			if (chunk)
-			{
-				MarkChunkDirty(chunk);
-			}
-		}
+		MarkLightChangeDirty(chunk, worldCoordinates);
 	}
 }
 
@@ -622,10 +705,8 @@ void World::SetBlockLightLevel(DirectX::XMINT3 worldCoordinates, std::uint8_t li
 	std::int32_t	chunkZ = Utils::Coordinates::GetChunkCoordinate<Chunk::CHUNK_SIZE>(worldCoordinates.z);
 	DirectX::XMINT3 chunkCoords(chunkX, chunkY, chunkZ);
 
-	static Chunk* cachedChunk = nullptr;
-
 	// fast path
-	if (cachedChunk != nullptr && chunkCoords == cachedChunk->GetChunkWorldPos())
+	if (cachedChunk_ != nullptr && chunkCoords == cachedChunk_->GetChunkWorldPos())
 	{
 		static constexpr std::int32_t bitMask = static_cast<std::int32_t>(Chunk::CHUNK_SIZE) - 1;
 
@@ -633,22 +714,8 @@ void World::SetBlockLightLevel(DirectX::XMINT3 worldCoordinates, std::uint8_t li
 		std::int32_t y = worldCoordinates.y & bitMask;
 		std::int32_t z = worldCoordinates.z & bitMask;
 
-		cachedChunk->SetBlockLightLevel(x, y, z, lightLevel);
-		MarkChunkDirty(cachedChunk);
-
-		for (const auto& face : cachedChunk->IsBlockOnBorder(x, y, z))
-		{
-			DirectX::XMINT3 offset = offsets[static_cast<std::uint8_t>(face)];
-			DirectX::XMINT3 nPos   = {worldCoordinates.x + offset.x,
-									  worldCoordinates.y + offset.y,
-									  worldCoordinates.z + offset.z};
-
-			Chunk* chunk = GetChunkFromBlock(nPos);
-			if (chunk)
-			{
-				MarkChunkDirty(chunk);
-			}
-		}
+		cachedChunk_->SetBlockLightLevel(x, y, z, lightLevel);
+		MarkLightChangeDirty(cachedChunk_, worldCoordinates);
 	}
 	else if (Chunk* chunk = GetChunkFromBlock(worldCoordinates); chunk != nullptr)
 	{
@@ -661,20 +728,83 @@ void World::SetBlockLightLevel(DirectX::XMINT3 worldCoordinates, std::uint8_t li
 
 		chunk->SetBlockLightLevel(x, y, z, lightLevel);
 
-		cachedChunk = chunk;
-		MarkChunkDirty(chunk);
+		cachedChunk_ = chunk;
+		MarkLightChangeDirty(chunk, worldCoordinates);
+	}
+}
+
+void World::MarkBlockChangeDirty(Chunk* chunk, DirectX::XMINT3 worldCoordinates)
+{
+	static constexpr std::int32_t bitMask = static_cast<std::int32_t>(Chunk::CHUNK_SIZE) - 1;
+
+	std::int32_t x = worldCoordinates.x & bitMask;
+	std::int32_t y = worldCoordinates.y & bitMask;
+	std::int32_t z = worldCoordinates.z & bitMask;
+
+	MarkChunkDirty(chunk);
 
-		for (const auto& face : chunk->IsBlockOnBorder(x, y, z))
+	// The block decides the faces and the ambient occlusion of every neighbor whose padding it lies in, on an edge or
+	// a corner of the chunk that includes the diagonal ones
+	const DirectX::XMINT3 chunkCoordinates = chunk->GetChunkWorldPos();
+	for (std::int32_t dz = (z == 0 ? -1 : 0); dz <= (z == bitMask ? 1 : 0); ++dz)
+	{
+		for (std::int32_t dy = (y == 0 ? -1 : 0); dy <= (y == bitMask ? 1 : 0); ++dy)
 		{
-			DirectX::XMINT3 offset = offsets[static_cast<std::uint8_t>(face)];
-			DirectX::XMINT3 nPos   = {worldCoordinates.x + offset.x,
-									  worldCoordinates.y + offset.y,
-									  worldCoordinates.z + offset.z};
+			for (std::int32_t dx = (x == 0 ? -1 : 0); dx <= (x == bitMask ? 1 : 0); ++dx)
+			{
+				if (dx == 0 && dy == 0 && dz == 0)
+				{
+					continue;
+				}
+
+				Chunk* neighbor = GetChunk(DirectX::XMINT3{chunkCoordinates.x + dx,
+														   chunkCoordinates.y + dy,
+														   chunkCoordinates.z + dz});
+				if (neighbor != nullptr)
+				{
+					MarkChunkDirty(neighbor);
+				}
+			}
+		}
+	}
+}
+
+void World::MarkLightChangeDirty(Chunk* chunk, DirectX::XMINT3 worldCoordinates)
+{
+	static constexpr std::int32_t bitMask	= static_cast<std::int32_t>(Chunk::CHUNK_SIZE) - 1;
+	static constexpr std::int32_t chunkSize = static_cast<std::int32_t>(Chunk::CHUNK_SIZE);
 
-			chunk = GetChunkFromBlock(nPos);
-			if (chunk)
+	std::int32_t x = worldCoordinates.x & bitMask;
+	std::int32_t y = worldCoordinates.y & bitMask;
+	std::int32_t z = worldCoordinates.z & bitMask;
+
+	if (chunk->IsLightSampled(x, y, z))
+	{
+		MarkLitChunkDirty(chunk);
+	}
+
+	// Smooth lighting samples diagonal blocks as well, so a block on an edge or a corner of the chunk lies in the
+	// padding of up to 7 neighbors
+	const DirectX::XMINT3 chunkCoordinates = chunk->GetChunkWorldPos();
+	for (std::int32_t dz = (z == 0 ? -1 : 0); dz <= (z == bitMask ? 1 : 0); ++dz)
+	{
+		for (std::int32_t dy = (y == 0 ? -1 : 0); dy <= (y == bitMask ? 1 : 0); ++dy)
+		{
+			for (std::int32_t dx = (x == 0 ? -1 : 0); dx <= (x == bitMask ? 1 : 0); ++dx)
 			{
-				MarkChunkDirty(chunk);
+				if (dx == 0 && dy == 0 && dz == 0)
+				{
+					continue;
+				}
+
+				Chunk* neighbor = GetChunk(DirectX::XMINT3{chunkCoordinates.x + dx,
+														   chunkCoordinates.y + dy,
+														   chunkCoordinates.z + dz});
+				if (neighbor != nullptr
+					&& neighbor->IsLightSampled(x - dx * chunkSize, y - dy * chunkSize, z - dz * chunkSize))
+				{
+					MarkLitChunkDirty(neighbor);
+				}
 			}
 		}
 	}
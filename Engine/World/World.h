@@ -11,6 +11,8 @@
 #include "BlockFace.h"
 #include "BlockType.h"
 #include "ChunkContext.h"
+#include "ChunkStreamer.h"
+#include "EditBatch.h"
 #include "VoxelLightingEngine.h"
 
 class Chunk;
@@ -18,6 +20,8 @@ class World
 {
 public:
 	friend class VoxelLightingEngine;
+	friend class ChunkStreamer;
+	friend class LightingTests;
 	World();
 	~World();
 
@@ -26,9 +30,10 @@ public:
 	World& operator=(const World&) = delete;
 	World& operator=(World&&)	   = delete;
 
-	bool Initialize(ID3D11Device* device);
-	void GenerateTestChunks();
-	void GenerateTestWorld();
+	/**
+	 * @param persistent false to only ever generate the world, without reading or writing the save
+	 */
+	bool Initialize(ID3D11Device* device, bool persistent = true);
 
 	[[nodiscard]] DirectX::XMVECTOR GetLightDirection() const;
 	[[nodiscard]] DirectX::XMVECTOR GetLightDirection(float customTime);
@@ -50,20 +55,68 @@ public:
 	[[nodiscard]] Block GetBlock(DirectX::XMFLOAT3 worldCoordinates);
 	[[nodiscard]] Block GetBlock(DirectX::XMINT3 worldCoordinates);
 
+	/**
+	 * Writes every edit of the batch, then updates the lighting and marks the affected chunks dirty once for all of
+	 * them. Edits landing in chunks that aren't loaded get dropped
+	 * @return number of blocks whose type actually changed
+	 */
+	std::size_t ApplyEditBatch(const EditBatch& batch);
+
+	/**
+	 * @param min world-space corner of the box, inclusive
+	 * @param max world-space corner of the box, inclusive
+	 */
+	[[nodiscard]] BlockClipboard CopyBlocks(DirectX::XMINT3 min, DirectX::XMINT3 max);
+
 	[[nodiscard]] bool						 IsBlockSolid(DirectX::XMFLOAT3 worldCoordinates);
 	[[nodiscard]] bool						 IsBlockSolid(DirectX::XMINT3 worldCoordinates);
 	[[nodiscard]] float						 GetWorldTime() const { return timeOfDay_; };
 	[[nodiscard]] const VoxelLightingEngine& GetVoxelLightingEngine() const { return lightEngine_; };
+	[[nodiscard]] const ChunkStreamer*		 GetChunkStreamer() const { return chunkStreamer_.get(); }
 
-	void Update();
+	/**
+	 * @param viewerPosition world-space position chunks get streamed in around
+	 */
+	void Update(DirectX::FXMVECTOR viewerPosition);
 
 private:
+	/**
+	 * Takes over a generated chunk, meshing is left to the caller
+	 * @param chunk its coordinates have to be free
+	 */
+	Chunk* AddChunk(std::unique_ptr<Chunk> chunk);
+
+	/**
+	 * Frees the chunk, the neighbors keep their meshes
+	 * @return false if the chunk is still being meshed and can't be freed yet
+	 */
+	bool UnloadChunk(DirectX::XMINT3 chunkCoordinates);
+
 	void MarkChunkDirty(Chunk* chunk);
+
+	/**
+	 * For chunks whose light changed. A chunk that was never meshed keeps waiting for its neighbors like
+	 * ChunkStreamer::MarkDirtyIfSurrounded, IsLightSampled is always true for it
+	 */
+	void MarkLitChunkDirty(Chunk* chunk);
 	void RequestChunkMeshUpdate(Chunk* chunk);
 	void FillChunkContext(const Chunk* mainChunk, ChunkContext* outChunkContext);
 	void MesherLoop();
 	void SetSkyLightLevel(DirectX::XMINT3 worldCoordinates, std::uint8_t lightLevel);
 	void SetBlockLightLevel(DirectX::XMINT3 worldCoordinates, std::uint8_t lightLevel);
+
+	/**
+	 * Marks the block's chunk and the neighbors bordering the block dirty, but only the ones whose mesh actually
+	 * uses the block's light level
+	 * @param chunk chunk containing the block
+	 */
+	void MarkLightChangeDirty(Chunk* chunk, DirectX::XMINT3 worldCoordinates);
+
+	/**
+	 * Marks the block's chunk and every neighbor with the block in its padding dirty, up to 7 of them
+	 * @param chunk chunk containing the block
+	 */
+	void MarkBlockChangeDirty(Chunk* chunk, DirectX::XMINT3 worldCoordinates);
 	// Meshing stuff
 
 	std::unordered_set<Chunk*> dirtyChunks_;
@@ -92,6 +145,12 @@ private:
 	// Light engine
 	VoxelLightingEngine lightEngine_;
 
+	// Null until Initialize
+	std::unique_ptr<ChunkStreamer> chunkStreamer_;
+
+	// Last chunk looked up by block coordinates, cleared when it gets unloaded
+	Chunk* cachedChunk_;
+
 	// Sun
 	float timeOfDay_; // 0.0 - midnight, 0.5 - noon
 
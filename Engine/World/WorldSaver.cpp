@@ -0,0 +1,172 @@
+﻿#include "WorldSaver.h"
+
+#include <algorithm>
+#include <cassert>
+
+WorldSaver::WorldSaver(std::unique_ptr<WorldStorage> storage, const Settings& settings) :
+	storage_(std::move(storage)),
+	settings_(settings),
+	savingColumn_(0, 0),
+	isSaving_(false),
+	hasUncommittedSaves_(false),
+	flushRequests_(0),
+	shuttingDown_(false),
+	byteBudget_(0.0),
+	budgetTime_(std::chrono::steady_clock::now())
+{
+	assert(storage_ != nullptr);
+	assert(settings_.maxBytesPerSecond > 0);
+	thread_ = std::thread(&WorldSaver::SaverLoop, this);
+}
+
+WorldSaver::~WorldSaver()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex_);
+		shuttingDown_ = true;
+	}
+
+	queueCondition_.notify_all();
+	thread_.join();
+}
+
+void WorldSaver::Save(ColumnSnapshot&& column)
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex_);
+
+		auto [it, inserted] = queued_.try_emplace(column.columnCoordinates);
+		it->second			= std::move(column.chunks);
+		if (inserted)
+		{
+			queueOrder_.push_back(column.columnCoordinates);
+		}
+	}
+
+	queueCondition_.notify_one();
+}
+
+WorldSaver::LoadResult WorldSaver::TryLoadColumn(DirectX::XMINT2					 columnCoordinates,
+												 std::vector<std::unique_ptr<Chunk>>& outChunks)
+{
+	std::unique_lock<std::mutex> lock(queueMutex_);
+
+	// The stored copy is outdated until the queued one is written
+	if (queued_.contains(columnCoordinates) || (isSaving_ && savingColumn_ == columnCoordinates))
+	{
+		return LoadResult::Busy;
+	}
+
+	std::unique_lock<std::mutex> storageLock(storageMutex_, std::try_to_lock);
+	if (storageLock.owns_lock() == false)
+	{
+		return LoadResult::Busy;
+	}
+
+	// Nothing can be queued for this column while it's being loaded, the main thread is the one doing both
+	lock.unlock();
+	return storage_->LoadColumn(columnCoordinates, outChunks) ? LoadResult::Loaded : LoadResult::NotStored;
+}
+
+void WorldSaver::Flush()
+{
+	std::unique_lock<std::mutex> lock(queueMutex_);
+	++flushRequests_;
+	queueCondition_.notify_all();
+
+	idleCondition_.wait(lock,
+						[this]()
+						{ return queueOrder_.empty() && isSaving_ == false && hasUncommittedSaves_ == false; });
+	--flushRequests_;
+}
+
+WorldSaver::Stats WorldSaver::GetStats()
+{
+	std::lock_guard<std::mutex> lock(queueMutex_);
+
+	Stats stats			= stats_;
+	stats.queuedColumns = queueOrder_.size();
+	return stats;
+}
+
+void WorldSaver::SaverLoop()
+{
+	std::vector<std::uint8_t>	 data;
+	std::unique_lock<std::mutex> lock(queueMutex_);
+	while (true)
+	{
+		if (queueOrder_.empty())
+		{
+			// Out of work, a good time to make everything so far durable
+			if (hasUncommittedSaves_)
+			{
+				hasUncommittedSaves_ = false;
+				isSaving_			 = true;
+				lock.unlock();
+				{
+					std::lock_guard<std::mutex> storageLock(storageMutex_);
+					storage_->Flush();
+				}
+				lock.lock();
+				isSaving_ = false;
+				continue;
+			}
+
+			idleCondition_.notify_all();
+			if (shuttingDown_)
+			{
+				return;
+			}
+
+			queueCondition_.wait(lock);
+			continue;
+		}
+
+		const DirectX::XMINT2 columnCoordinates = queueOrder_.front();
+		queueOrder_.pop_front();
+
+		auto column	  = queued_.extract(columnCoordinates);
+		savingColumn_ = columnCoordinates;
+		isSaving_	  = true;
+		lock.unlock();
+
+		// Encoding only reads the snapshots, the storage isn't needed until the write
+		data.clear();
+		WorldStorage::EncodeColumn(column.mapped(), data);
+		column = {};
+		{
+			std::lock_guard<std::mutex> storageLock(storageMutex_);
+			storage_->SaveColumn(columnCoordinates, data);
+		}
+
+		lock.lock();
+		isSaving_			 = false;
+		hasUncommittedSaves_ = true;
+		++stats_.savedColumns;
+		stats_.writtenBytes += data.size();
+
+		Throttle(lock, data.size());
+	}
+}
+
+void WorldSaver::Throttle(std::unique_lock<std::mutex>& lock, std::size_t byteCount)
+{
+	using namespace std::chrono;
+
+	// Up to a second worth of data can go out in a burst after being idle
+	const auto	 now  = steady_clock::now();
+	const double rate = static_cast<double>(settings_.maxBytesPerSecond);
+	byteBudget_		  = (std::min)(byteBudget_ + duration<double>(now - budgetTime_).count() * rate, rate);
+	byteBudget_		 -= static_cast<double>(byteCount);
+	budgetTime_		  = now;
+
+	if (byteBudget_ >= 0.0 || flushRequests_ > 0 || shuttingDown_)
+	{
+		return;
+	}
+
+	queueCondition_.wait_for(lock,
+							 duration<double>(-byteBudget_ / rate),
+							 [this]() { return flushRequests_ > 0 || shuttingDown_; });
+	stats_.throttledNanos += duration_cast<nanoseconds>(steady_clock::now() - now).count();
+}
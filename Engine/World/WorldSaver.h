@@ -0,0 +1,107 @@
+﻿#pragma once
+#include <DirectXMath.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../Math/DirectXMathOperators.h"
+#include "WorldStorage.h"
+
+/**
+ * Saves columns on a background thread, so the main thread only ever hands over block snapshots. The thread encodes
+ * them, writes them out no faster than the configured rate and commits once it runs out of work. Loads still happen on
+ * the calling thread, but only when the storage isn't busy, so a commit on the save thread never stalls a frame
+ */
+class WorldSaver
+{
+public:
+	struct Settings
+	{
+		std::uint64_t maxBytesPerSecond = 4 << 20; // encoded column data, shutdown and Flush ignore it
+	};
+
+	struct ColumnSnapshot
+	{
+		DirectX::XMINT2							  columnCoordinates;
+		std::vector<WorldStorage::ChunkSnapshot> chunks;
+	};
+
+	enum class LoadResult : std::uint8_t
+	{
+		Loaded,
+		NotStored, // or corrupt, it has to be generated either way
+		Busy,	   // the storage is in use or the column is waiting to be saved, try again later
+	};
+
+	struct Stats
+	{
+		std::size_t	  queuedColumns	 = 0;
+		std::uint64_t savedColumns	 = 0; // total since creation, including the ones that didn't change
+		std::uint64_t writtenBytes	 = 0; // total since creation
+		std::uint64_t throttledNanos = 0; // total time spent waiting on the rate cap
+	};
+
+	WorldSaver() = delete;
+	WorldSaver(std::unique_ptr<WorldStorage> storage, const Settings& settings);
+
+	// Saves what's still queued, without the rate cap
+	~WorldSaver();
+
+	WorldSaver(const WorldSaver&)			 = delete;
+	WorldSaver(WorldSaver&&)				 = delete;
+	WorldSaver& operator=(const WorldSaver&) = delete;
+	WorldSaver& operator=(WorldSaver&&)		 = delete;
+
+	/**
+	 * Queues the column for saving, replaces its older snapshot if that one is still queued
+	 */
+	void Save(ColumnSnapshot&& column);
+
+	/**
+	 * @param outChunks gets the column's chunks appended, bottom to top
+	 */
+	[[nodiscard]] LoadResult TryLoadColumn(DirectX::XMINT2						columnCoordinates,
+										   std::vector<std::unique_ptr<Chunk>>& outChunks);
+
+	// Waits until everything queued so far is saved and committed, without the rate cap
+	void Flush();
+
+	[[nodiscard]] Stats GetStats();
+
+private:
+	void SaverLoop();
+
+	/**
+	 * Blocks until the rate cap allows writing again
+	 * @param lock holds queueMutex_
+	 */
+	void Throttle(std::unique_lock<std::mutex>& lock, std::size_t byteCount);
+
+	std::unique_ptr<WorldStorage> storage_;
+	Settings					  settings_;
+	std::mutex					  storageMutex_; // held by the save thread while it writes or commits
+
+	std::unordered_map<DirectX::XMINT2, std::vector<WorldStorage::ChunkSnapshot>, Math::XMINT2Hash> queued_;
+	std::deque<DirectX::XMINT2> queueOrder_; // oldest first, one entry per queued column
+	DirectX::XMINT2				savingColumn_;
+	bool						isSaving_;
+	bool						hasUncommittedSaves_;
+	std::uint32_t				flushRequests_;
+	bool						shuttingDown_;
+	Stats						stats_;
+	std::mutex					queueMutex_;
+	std::condition_variable		queueCondition_;
+	std::condition_variable		idleCondition_; // signaled once the queue is empty and committed
+
+	// Rate cap, written bytes allowed ahead of time
+	double								  byteBudget_;
+	std::chrono::steady_clock::time_point budgetTime_;
+
+	std::thread thread_;
+};
@@ -0,0 +1,257 @@
+﻿#include "WorldStorage.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <ranges>
+#include <string>
+#include <system_error>
+
+#include "Chunk.h"
+#include "ChunkSerialization.h"
+
+WorldStorage::WorldStorage(std::filesystem::path directory) : directory_(std::move(directory)), uncommittedSaves_(0)
+{
+}
+
+WorldStorage::~WorldStorage()
+{
+	Flush();
+}
+
+bool WorldStorage::BindBlockIds(const BlockDatabase& database)
+{
+	const std::filesystem::path path = directory_ / BLOCK_IDS_FILE_NAME;
+
+	std::bitset<static_cast<std::size_t>(BlockType::MAX_BLOCKS_)> stored;
+	if (std::ifstream file(path); file.is_open())
+	{
+		std::size_t id;
+		std::string name;
+		while (file >> id >> name)
+		{
+			const BlockType	 type = static_cast<BlockType>(id);
+			const BlockData* data = id < stored.size() ? database.GetBlockData(type) : nullptr;
+			if (data == nullptr || data->blockName != name)
+			{
+				std::cerr << "World " << directory_.string() << " has been saved with block " << id << " as " << name
+						  << ", but it's now " << (data != nullptr ? data->blockName : "undefined") << "!"
+						  << std::endl;
+				return false;
+			}
+			stored.set(id);
+		}
+
+		if (file.eof() == false)
+		{
+			std::cerr << "Failed to read " << path.string() << "!" << std::endl;
+			return false;
+		}
+	}
+
+	// Only ever appended to, IDs that are in there stay taken even if the world never placed their blocks
+	std::vector<BlockType> newTypes;
+	std::ranges::copy_if(database.GetBlockTypes(),
+						 std::back_inserter(newTypes),
+						 [&](BlockType type) { return stored[static_cast<std::size_t>(type)] == false; });
+	if (newTypes.empty())
+	{
+		return true;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(directory_, error);
+
+	std::ofstream file(path, std::ios::app);
+	for (const BlockType type : newTypes)
+	{
+		file << static_cast<std::size_t>(type) << " " << database.GetBlockData(type)->blockName << "\n";
+	}
+
+	file.flush();
+	if (file.fail())
+	{
+		std::cerr << "Failed to write " << path.string() << "!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void WorldStorage::EncodeColumn(std::span<const ChunkSnapshot> chunks, std::vector<std::uint8_t>& outData)
+{
+	// Chunk count, then every chunk's y followed by its blocks
+	assert(chunks.size() <= UINT8_MAX);
+	outData.push_back(static_cast<std::uint8_t>(chunks.size()));
+	for (const ChunkSnapshot& chunk : chunks)
+	{
+		const auto y = static_cast<std::uint32_t>(chunk.y);
+		for (std::uint32_t i = 0; i < 4; ++i)
+		{
+			outData.push_back(static_cast<std::uint8_t>(y >> (i * 8)));
+		}
+
+		ChunkSerialization::Serialize(*chunk.blocks, outData);
+	}
+}
+
+bool WorldStorage::SaveColumn(DirectX::XMINT2 columnCoordinates, std::span<const std::uint8_t> data)
+{
+	RegionFile* region = GetRegion(columnCoordinates, true);
+	if (region == nullptr)
+	{
+		return false;
+	}
+
+	// Columns that end up the same as what's stored would only leave dead space behind
+	const std::uint32_t					index  = RegionFile::GetEntryIndex(columnCoordinates);
+	const std::span<const std::uint8_t> stored = region->Read(index);
+	if (std::ranges::equal(stored, data))
+	{
+		++stats_.skippedColumns;
+		return true;
+	}
+
+	if (region->Write(index, data) == false)
+	{
+		return false;
+	}
+
+	++stats_.savedColumns;
+	stats_.bytesWritten += data.size();
+
+	if (++uncommittedSaves_ >= COMMIT_INTERVAL)
+	{
+		return Flush();
+	}
+	return true;
+}
+
+bool WorldStorage::LoadColumn(DirectX::XMINT2 columnCoordinates, std::vector<std::unique_ptr<Chunk>>& outChunks)
+{
+	RegionFile* region = GetRegion(columnCoordinates, false);
+	if (region == nullptr)
+	{
+		return false;
+	}
+
+	const std::span<const std::uint8_t> data = region->Read(RegionFile::GetEntryIndex(columnCoordinates));
+	if (data.empty())
+	{
+		return false;
+	}
+
+	const std::size_t firstChunk = outChunks.size();
+	const std::size_t chunkCount = data[0];
+	std::size_t		  cursor	 = 1;
+	for (std::size_t i = 0; i < chunkCount; ++i)
+	{
+		if (data.size() - cursor < 4)
+		{
+			outChunks.resize(firstChunk);
+			return false;
+		}
+
+		std::uint32_t y = 0;
+		for (std::uint32_t byte = 0; byte < 4; ++byte)
+		{
+			y |= static_cast<std::uint32_t>(data[cursor++]) << (byte * 8);
+		}
+
+		const DirectX::XMINT3 chunkCoordinates{columnCoordinates.x, static_cast<std::int32_t>(y), columnCoordinates.y};
+		auto				  chunk = std::make_unique<Chunk>(chunkCoordinates);
+
+		const std::size_t chunkSize = ChunkSerialization::Deserialize(data.subspan(cursor), *chunk);
+		if (chunkSize == 0)
+		{
+			outChunks.resize(firstChunk);
+			return false;
+		}
+
+		cursor += chunkSize;
+		outChunks.push_back(std::move(chunk));
+	}
+
+	std::sort(outChunks.begin() + firstChunk,
+			  outChunks.end(),
+			  [](const std::unique_ptr<Chunk>& a, const std::unique_ptr<Chunk>& b)
+			  { return a->GetChunkWorldPos().y < b->GetChunkWorldPos().y; });
+
+	++stats_.loadedColumns;
+	stats_.bytesRead += data.size();
+	return true;
+}
+
+bool WorldStorage::HasColumn(DirectX::XMINT2 columnCoordinates)
+{
+	const RegionFile* region = GetRegion(columnCoordinates, false);
+	return region != nullptr && region->Contains(RegionFile::GetEntryIndex(columnCoordinates));
+}
+
+bool WorldStorage::Flush()
+{
+	bool flushed = true;
+	for (const std::unique_ptr<RegionFile>& region : regions_ | std::views::values)
+	{
+		if (region != nullptr)
+		{
+			flushed = region->CompactIfNeeded() && flushed;
+		}
+	}
+
+	uncommittedSaves_ = 0;
+	return flushed;
+}
+
+RegionFile* WorldStorage::GetRegion(DirectX::XMINT2 columnCoordinates, bool create)
+{
+	const DirectX::XMINT2 regionCoordinates = RegionFile::GetRegionCoordinates(columnCoordinates);
+
+	auto it = regions_.find(regionCoordinates);
+	if (it != regions_.end() && (it->second != nullptr || create == false))
+	{
+		return it->second.get();
+	}
+
+	const std::filesystem::path path = GetRegionPath(regionCoordinates);
+
+	std::error_code error;
+	if (std::filesystem::exists(path, error))
+	{
+		// Known already, so it failed to open before
+		if (it != regions_.end())
+		{
+			return nullptr;
+		}
+	}
+	else if (create)
+	{
+		std::filesystem::create_directories(directory_, error);
+	}
+	else
+	{
+		regions_[regionCoordinates] = nullptr;
+		return nullptr;
+	}
+
+	auto region = std::make_unique<RegionFile>();
+	if (region->Open(path) == false)
+	{
+		// Left alone rather than overwritten, whatever is still in there might be recoverable
+		std::cerr << "Failed to open region file " << path.string() << "!" << std::endl;
+		regions_[regionCoordinates] = nullptr;
+		return nullptr;
+	}
+
+	RegionFile* result			= region.get();
+	regions_[regionCoordinates] = std::move(region);
+	return result;
+}
+
+std::filesystem::path WorldStorage::GetRegionPath(DirectX::XMINT2 regionCoordinates) const
+{
+	return directory_
+		   / ("r." + std::to_string(regionCoordinates.x) + "." + std::to_string(regionCoordinates.y) + ".region");
+}
@@ -0,0 +1,108 @@
+﻿#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "../Math/DirectXMathOperators.h"
+#include "BlockDatabase.h"
+#include "Chunk.h"
+#include "RegionFile.h"
+
+/**
+ * Saves and loads whole chunk columns, grouped into region files inside a single directory. Saves get committed in
+ * batches, a crash loses the columns saved since the last commit but never corrupts the ones before it. Not thread
+ * safe, see WorldSaver for saving in the background
+ */
+class WorldStorage
+{
+public:
+	struct ChunkSnapshot
+	{
+		std::int32_t							 y;
+		std::shared_ptr<const Chunk::BlockArray> blocks;
+	};
+
+	struct Stats
+	{
+		std::uint64_t savedColumns	 = 0; // total since creation
+		std::uint64_t skippedColumns = 0; // saves that matched what was already stored
+		std::uint64_t loadedColumns	 = 0; // total since creation
+		std::uint64_t bytesWritten	 = 0;
+		std::uint64_t bytesRead		 = 0;
+	};
+
+	WorldStorage() = delete;
+
+	/**
+	 * @param directory gets created on the first save if it doesn't exist
+	 */
+	explicit WorldStorage(std::filesystem::path directory);
+	~WorldStorage();
+
+	WorldStorage(const WorldStorage&)			 = delete;
+	WorldStorage(WorldStorage&&)				 = delete;
+	WorldStorage& operator=(const WorldStorage&) = delete;
+	WorldStorage& operator=(WorldStorage&&)		 = delete;
+
+	/**
+	 * Checks that every block ID the world has been saved with still means the same block, and records the IDs of
+	 * blocks the world hasn't seen yet. Has to pass before anything gets loaded or saved
+	 * @return false if a stored ID now belongs to another block or to none, the chunks would load as the wrong blocks
+	 */
+	bool BindBlockIds(const BlockDatabase& database);
+
+	/**
+	 * Turns a column into what SaveColumn expects, doesn't touch the storage
+	 * @param chunks the whole column, in any order
+	 */
+	static void EncodeColumn(std::span<const ChunkSnapshot> chunks, std::vector<std::uint8_t>& outData);
+
+	/**
+	 * @param data encoded column, see EncodeColumn
+	 * @return false if it couldn't be written
+	 */
+	bool SaveColumn(DirectX::XMINT2 columnCoordinates, std::span<const std::uint8_t> data);
+
+	/**
+	 * @param outChunks gets the column's chunks appended, bottom to top
+	 * @return false if the column isn't stored or its data is corrupt
+	 */
+	bool LoadColumn(DirectX::XMINT2 columnCoordinates, std::vector<std::unique_ptr<Chunk>>& outChunks);
+
+	[[nodiscard]] bool HasColumn(DirectX::XMINT2 columnCoordinates);
+
+	// Commits every save so far and compacts the region files that need it
+	bool Flush();
+
+private:
+	// Saves in between commits, each commit costs a couple of flushes per touched region
+	static constexpr std::uint32_t COMMIT_INTERVAL = 256;
+
+	/**
+	 * @param create whether to create the region file if it doesn't exist yet
+	 * @return null if the region doesn't exist or couldn't be opened
+	 */
+	RegionFile* GetRegion(DirectX::XMINT2 columnCoordinates, bool create);
+
+	[[nodiscard]] std::filesystem::path GetRegionPath(DirectX::XMINT2 regionCoordinates) const;
+
+	// Names of the block IDs the world has been saved with, as "<id> <name>" lines
+	static constexpr auto BLOCK_IDS_FILE_NAME = "Blocks.txt";
+
+	std::filesystem::path directory_;
+	Stats				  stats_;
+
+	// Regions that don't exist on the disk are kept as null, so lookups don't go to the file system every time
+	std::unordered_map<DirectX::XMINT2, std::unique_ptr<RegionFile>, Math::XMINT2Hash> regions_;
+
+	std::uint32_t uncommittedSaves_;
+
+public:
+	// Getters
+	[[nodiscard]] const Stats&				   GetStats() const { return stats_; }
+	[[nodiscard]] const std::filesystem::path& GetDirectory() const { return directory_; }
+};